@@ -4,6 +4,7 @@ const path = require('path');
 const config = process.env.hasOwnProperty('CONFIG') ? JSON.parse(process.env.CONFIG) : require('./config.js');
 const StateController = require('./stateController');
 const processVideos = require('./processVideos.js');
+const WeatherProxy = require('./weatherProxy.js');
 
 const app = express();
 const PORT = process.env.PORT || 8080;
@@ -48,6 +49,7 @@ app.get('/image', (req, res) => {
 
   try {
     let bitmapData = StateController.getNextFrame(req.query.displayId);
+    setScheduleHeaders(res, req.query.displayId);
     res.setHeader('Content-Type', 'image/bmp');
     res.end(bitmapData);
   } catch (err) {
@@ -57,6 +59,61 @@ app.get('/image', (req, res) => {
 
 });
 
+/*
+  An optional schedule.json in the display directory is passed along to the display as response headers, e.g.
+  { "frameIntervalSeconds": 600, "bedTime": 22, "wakeTime": 6 }
+  Any field can be left out, the display keeps its own setting for it.
+*/
+function setScheduleHeaders(res, displayId) {
+  const scheduleFilePath = path.join(config.DATA_DIR, `display${displayId}`, 'schedule.json');
+  if (!fs.existsSync(scheduleFilePath)) {
+    return;
+  }
+
+  try {
+    const schedule = JSON.parse(fs.readFileSync(scheduleFilePath));
+    if (Number.isInteger(schedule.frameIntervalSeconds)) {
+      res.setHeader('X-Frame-Interval', schedule.frameIntervalSeconds);
+    }
+    if (Number.isInteger(schedule.bedTime)) {
+      res.setHeader('X-Bed-Time', schedule.bedTime);
+    }
+    if (Number.isInteger(schedule.wakeTime)) {
+      res.setHeader('X-Wake-Time', schedule.wakeTime);
+    }
+  } catch (err) {
+    console.error('Ignoring invalid ' + scheduleFilePath + ': ' + err);
+  }
+}
+
+/*
+  Weather for the weather app when it is built with USE_WEATHER_PROXY, in the binary format described in
+  weatherProxy.js.  e.g. /weather?lat=38.87&lon=-77.05&lang=en&version=3.0
+*/
+app.get('/weather', async (req, res) => {
+
+  if (!req.query.lat || !req.query.lon) {
+    res.status(400).send('Missing lat or lon query parameter');
+    return;
+  }
+
+  try {
+    const blob = await WeatherProxy.getWeatherBlob({
+      lat: req.query.lat,
+      lon: req.query.lon,
+      lang: req.query.lang || 'en',
+      version: req.query.version || '3.0'
+    });
+    res.setHeader('Content-Type', 'application/octet-stream');
+    res.end(blob);
+  } catch (err) {
+    // pass OpenWeatherMap's status along, so e.g. a bad API key shows up as 401 on the display
+    res.status(err.status || 502).send('Error fetching weather: ' + err.message);
+    console.error(err);
+  }
+
+});
+
 app.listen(PORT, () => {
   console.log(`Server running at http://localhost:${PORT}/`);
 });
\ No newline at end of file
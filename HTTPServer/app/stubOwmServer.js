@@ -0,0 +1,82 @@
+const express = require('express');
+const fs = require('fs');
+const path = require('path');
+
+/*
+  A stand-in for the OpenWeatherMap endpoints the weather app and weatherProxy.js use, for testing without an API key.
+  It serves the payloads in MicroController/weatherApp/tools/fixtures with every timestamp moved forward so that
+  the current hour is now, and it honours the exclude parameter of One Call and the start/end of air pollution
+  history.  Any appid is accepted, but a request without one gets a 401 like the real API.
+
+    node stubOwmServer.js
+
+  Then set OWM_URL to http://localhost:8081 in the proxy's config, or point the weather app's OWM_ENDPOINT at this
+  machine and build it with USE_HTTP.  STUB_OWM_PORT and STUB_OWM_FIXTURES override the port and fixture directory.
+*/
+
+const PORT = process.env.STUB_OWM_PORT || 8081;
+const FIXTURES = process.env.STUB_OWM_FIXTURES
+  || path.join(__dirname, '..', '..', 'MicroController', 'weatherApp', 'tools', 'fixtures');
+
+const onecall = JSON.parse(fs.readFileSync(path.join(FIXTURES, 'onecall.json')));
+const airPollution = JSON.parse(fs.readFileSync(path.join(FIXTURES, 'air_pollution.json')));
+
+// fields holding a Unix time, 0 means there is none (e.g. no moonrise that day)
+const TIME_FIELDS = new Set(['dt', 'sunrise', 'sunset', 'moonrise', 'moonset', 'start', 'end']);
+
+// A copy of value with every time moved forward by seconds
+function shiftTimes(value, seconds) {
+  if (Array.isArray(value)) {
+    return value.map(v => shiftTimes(v, seconds));
+  }
+  if (value && typeof value === 'object') {
+    const shifted = {};
+    for (const [key, v] of Object.entries(value)) {
+      shifted[key] = TIME_FIELDS.has(key) && typeof v === 'number' && v !== 0 ? v + seconds : shiftTimes(v, seconds);
+    }
+    return shifted;
+  }
+  return value;
+}
+
+// Whole hours from the fixture's current hour to this one, so hourly entries stay on the hour
+function hoursSinceFixture() {
+  const now = Math.floor(Date.now() / 1000);
+  return Math.floor(now / 3600) * 3600 - Math.floor(onecall.current.dt / 3600) * 3600;
+}
+
+const app = express();
+
+app.use((req, res, next) => {
+  console.log((new Date()).toISOString() + ' ' + req.url);
+  if (!req.query.appid) {
+    res.status(401).json({ cod: 401, message: 'Invalid API key.' });
+    return;
+  }
+  next();
+});
+
+app.get('/data/:version/onecall', (req, res) => {
+  const response = shiftTimes(onecall, hoursSinceFixture());
+  response.current.dt = Math.floor(Date.now() / 1000);
+  for (const part of (req.query.exclude || '').split(',')) {
+    delete response[part];
+  }
+  res.json(response);
+});
+
+app.get('/data/2.5/air_pollution/history', (req, res) => {
+  const start = Number(req.query.start);
+  const end = Number(req.query.end);
+  if (!Number.isFinite(start) || !Number.isFinite(end)) {
+    res.status(400).json({ cod: '400', message: 'start and end are required' });
+    return;
+  }
+  const response = shiftTimes(airPollution, hoursSinceFixture());
+  response.list = response.list.filter(entry => entry.dt >= start && entry.dt <= end);
+  res.json(response);
+});
+
+app.listen(PORT, () => {
+  console.log(`Stub OpenWeatherMap server running at http://localhost:${PORT}/ serving ${FIXTURES}`);
+});
@@ -0,0 +1,290 @@
+const config = process.env.hasOwnProperty('CONFIG') ? JSON.parse(process.env.CONFIG) : require('./config.js');
+
+/*
+  Fetches the OpenWeatherMap One Call and air pollution responses for the weather displays, and packs them into the
+  binary blob read by deserializeWeatherBlob in the weather app's api_response.cpp.  Every display on the LAN shares
+  one fetch per location, and the displays don't need TLS or a JSON parser to read it.
+
+  All values are little-endian.  Records follow the firmware's response structs field by field:
+
+    header      char[4] "OWMB", uint8 version, uint8 hourly count, uint8 daily count, uint8 air pollution count
+    location    float lat, float lon, string timezone, int32 timezone_offset
+    current     owm_current_t
+    hourly      owm_hourly_t x hourly count
+    daily       owm_daily_t x daily count
+    alerts      uint8 count, then owm_alerts_t x count
+    text        uint16 length, then the text arena the weather main/description offsets point into
+    air         float lat, float lon, then int32 aqi, float co, no, no2, o3, so2, pm2_5, pm10, nh3 and int64 dt,
+                each x air pollution count
+
+  Strings are a uint8 length followed by that many bytes of UTF-8.
+
+  The OpenWeatherMap API key is read from the OWM_APIKEY environment variable.  Set OWM_URL in the config to point
+  the proxy at stubOwmServer.js for testing without a key.
+*/
+
+const OWM_URL = config.OWM_URL || 'https://api.openweathermap.org';
+const OWM_APIKEY = process.env.OWM_APIKEY || config.OWM_APIKEY;
+const CACHE_SECONDS = config.WEATHER_CACHE_SECONDS || 10 * 60;
+
+const BLOB_VERSION = 1;
+
+// sizes from the weather app's api_response.h
+const NUM_HOURLY = 48;
+const NUM_DAILY = 8;
+const NUM_ALERTS = 8;
+const NUM_AIR_POLLUTION = 24;
+const TEXT_ARENA_SIZE = 512;
+const TIMEZONE_SIZE = 48;
+const ALERT_EVENT_SIZE = 96;
+const ALERT_TAGS_SIZE = 32;
+const TEXT_VALUE_SIZE = 64;
+
+const cache = new Map();  // location -> { time, blob }
+
+/*
+  Returns the blob for the location in query ({ lat, lon, lang, version }), fetching it from OpenWeatherMap if the
+  cached one is older than WEATHER_CACHE_SECONDS.  Requests for a location that is already being fetched wait on
+  that fetch rather than starting another.
+*/
+function getWeatherBlob(query) {
+  const key = [query.lat, query.lon, query.lang, query.version].join(',');
+  const cached = cache.get(key);
+  if (cached && Date.now() - cached.time < CACHE_SECONDS * 1000) {
+    return cached.blob;
+  }
+
+  const blob = fetchWeather(query).then(packWeather);
+  cache.set(key, { time: Date.now(), blob });
+  blob.catch(() => cache.delete(key));  // try again on the next request
+  return blob;
+}
+
+async function fetchWeather(query) {
+  const lat = encodeURIComponent(query.lat);
+  const lon = encodeURIComponent(query.lon);
+  const now = Math.floor(Date.now() / 1000);
+  // minus 1 so exactly NUM_AIR_POLLUTION hours are returned, as the firmware does
+  const start = now - (3600 * NUM_AIR_POLLUTION - 1);
+  const [onecall, airPollution] = await Promise.all([
+    fetchJson(`/data/${encodeURIComponent(query.version)}/onecall?lat=${lat}&lon=${lon}`
+      + `&lang=${encodeURIComponent(query.lang)}&units=standard&exclude=minutely`),
+    fetchJson(`/data/2.5/air_pollution/history?lat=${lat}&lon=${lon}&start=${start}&end=${now}`)
+  ]);
+  return { onecall, airPollution };
+}
+
+async function fetchJson(uri) {
+  console.log((new Date()).toISOString() + ' Fetching ' + OWM_URL + uri);
+  const response = await fetch(OWM_URL + uri + '&appid=' + encodeURIComponent(OWM_APIKEY));
+  if (!response.ok) {
+    const err = new Error(`OpenWeatherMap responded ${response.status} to ${uri}`);
+    err.status = response.status;
+    throw err;
+  }
+  return response.json();
+}
+
+function packWeather({ onecall, airPollution }) {
+  const w = new BlobWriter();
+  const text = new TextArena();
+  const hourly = (onecall.hourly || []).slice(0, NUM_HOURLY);
+  const daily = (onecall.daily || []).slice(0, NUM_DAILY);
+  const alerts = (onecall.alerts || []).slice(0, NUM_ALERTS);
+  const air = (airPollution.list || []).slice(0, NUM_AIR_POLLUTION);
+
+  w.bytes(Buffer.from('OWMB'));
+  w.uint8(BLOB_VERSION);
+  w.uint8(hourly.length);
+  w.uint8(daily.length);
+  w.uint8(air.length);
+
+  w.float(onecall.lat);
+  w.float(onecall.lon);
+  w.string(onecall.timezone, TIMEZONE_SIZE);
+  w.int32(onecall.timezone_offset);
+
+  const c = onecall.current || {};
+  w.int64(c.dt);
+  w.int64(c.sunrise);
+  w.int64(c.sunset);
+  w.float(c.temp);
+  w.float(c.feels_like);
+  w.int32(c.pressure);
+  w.int32(c.humidity);
+  w.float(c.dew_point);
+  w.int32(c.clouds);
+  w.float(c.uvi);
+  w.int32(c.visibility);
+  w.float(c.wind_speed);
+  w.float(c.wind_gust);
+  w.int32(c.wind_deg);
+  w.float(c.rain && c.rain['1h']);
+  w.float(c.snow && c.snow['1h']);
+  packWeatherCondition(w, text, c.weather);
+
+  for (const h of hourly) {
+    w.int64(h.dt);
+    w.float(h.temp);
+    w.float(h.feels_like);
+    w.int32(h.pressure);
+    w.int32(h.humidity);
+    w.float(h.dew_point);
+    w.int32(h.clouds);
+    w.float(h.uvi);
+    w.int32(h.visibility);
+    w.float(h.wind_speed);
+    w.float(h.wind_gust);
+    w.int32(h.wind_deg);
+    w.float(h.pop);
+    w.float(h.rain && h.rain['1h']);
+    w.float(h.snow && h.snow['1h']);
+    packWeatherCondition(w, text, h.weather);
+  }
+
+  for (const d of daily) {
+    const temp = d.temp || {};
+    const feelsLike = d.feels_like || {};
+    w.int64(d.dt);
+    w.int64(d.sunrise);
+    w.int64(d.sunset);
+    w.int64(d.moonrise);
+    w.int64(d.moonset);
+    w.float(d.moon_phase);
+    w.float(temp.morn);
+    w.float(temp.day);
+    w.float(temp.eve);
+    w.float(temp.night);
+    w.float(temp.min);
+    w.float(temp.max);
+    w.float(feelsLike.morn);
+    w.float(feelsLike.day);
+    w.float(feelsLike.eve);
+    w.float(feelsLike.night);
+    w.int32(d.pressure);
+    w.int32(d.humidity);
+    w.float(d.dew_point);
+    w.int32(d.clouds);
+    w.float(d.uvi);
+    w.int32(d.visibility);
+    w.float(d.wind_speed);
+    w.float(d.wind_gust);
+    w.int32(d.wind_deg);
+    w.float(d.pop);
+    w.float(d.rain);
+    w.float(d.snow);
+    packWeatherCondition(w, text, d.weather);
+  }
+
+  w.uint8(alerts.length);
+  for (const a of alerts) {
+    w.string(a.event, ALERT_EVENT_SIZE);
+    w.int64(a.start);
+    w.int64(a.end);
+    w.string(a.tags && a.tags[0], ALERT_TAGS_SIZE);  // the firmware only keeps the first tag
+  }
+
+  w.uint16(text.length);
+  w.bytes(text.buffer.subarray(0, text.length));
+
+  const coord = airPollution.coord || {};
+  w.float(coord.lat);
+  w.float(coord.lon);
+  for (const a of air) w.int32(a.main && a.main.aqi);
+  for (const name of ['co', 'no', 'no2', 'o3', 'so2', 'pm2_5', 'pm10', 'nh3']) {
+    for (const a of air) w.float(a.components && a.components[name]);
+  }
+  for (const a of air) w.int64(a.dt);
+
+  return w.toBuffer();
+}
+
+// owm_weather_t, only the first entry of the weather array is kept
+function packWeatherCondition(w, text, weather) {
+  const first = (weather && weather[0]) || {};
+  w.int32(first.id);
+  w.uint16(text.add(first.main));
+  w.uint16(text.add(first.description));
+  w.uint16(parseIcon(first.icon));
+}
+
+// same encoding as OWM_ICON in api_response.h, "10n" -> (10 << 1) | 1
+function parseIcon(icon) {
+  const match = /^([0-9]{2})([dn])$/.exec(icon || '');
+  return match ? (parseInt(match[1], 10) << 1) | (match[2] === 'n' ? 1 : 0) : 0;
+}
+
+// UTF-8 bytes of str, cut to fit in size bytes including the terminator without splitting a character
+function truncatedUtf8(str, size) {
+  const bytes = Buffer.from(typeof str === 'string' ? str : '', 'utf8');
+  let end = Math.min(bytes.length, size - 1);
+  while (end < bytes.length && end > 0 && (bytes[end] & 0xC0) === 0x80) {
+    end--;
+  }
+  return bytes.subarray(0, end);
+}
+
+/*
+  Builds the text arena the same way owmAddText does on the display: offset 0 is the empty string, each distinct
+  string is stored once, and strings that don't fit come back as offset 0.
+*/
+class TextArena {
+  constructor() {
+    this.buffer = Buffer.alloc(TEXT_ARENA_SIZE);
+    this.length = 1;
+    this.offsets = new Map([['', 0]]);
+  }
+
+  add(str) {
+    const bytes = truncatedUtf8(str, TEXT_VALUE_SIZE);
+    const key = bytes.toString('utf8');
+    if (this.offsets.has(key)) {
+      return this.offsets.get(key);
+    }
+    if (this.length + bytes.length + 1 > TEXT_ARENA_SIZE) {
+      return 0;
+    }
+    const offset = this.length;
+    bytes.copy(this.buffer, offset);
+    this.length += bytes.length + 1;
+    this.offsets.set(key, offset);
+    return offset;
+  }
+}
+
+// Missing and null values are written as 0, which is what the JSON parser on the display leaves them as
+class BlobWriter {
+  constructor() {
+    this.chunks = [];
+  }
+
+  number(value, size, write) {
+    const chunk = Buffer.alloc(size);
+    write.call(chunk, value, 0);
+    this.chunks.push(chunk);
+  }
+
+  uint8(value)  { this.number(value || 0, 1, Buffer.prototype.writeUInt8); }
+  uint16(value) { this.number(value || 0, 2, Buffer.prototype.writeUInt16LE); }
+  int32(value)  { this.number(Math.trunc(Number(value) || 0), 4, Buffer.prototype.writeInt32LE); }
+  int64(value)  { this.number(BigInt(Math.trunc(Number(value) || 0)), 8, Buffer.prototype.writeBigInt64LE); }
+  float(value)  { this.number(Number(value) || 0, 4, Buffer.prototype.writeFloatLE); }
+
+  string(str, size) {
+    const bytes = truncatedUtf8(str, size);
+    this.uint8(bytes.length);
+    this.bytes(bytes);
+  }
+
+  bytes(buffer) {
+    this.chunks.push(Buffer.from(buffer));
+  }
+
+  toBuffer() {
+    return Buffer.concat(this.chunks);
+  }
+}
+
+module.exports = {
+  getWeatherBlob
+};
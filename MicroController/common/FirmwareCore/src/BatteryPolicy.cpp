@@ -0,0 +1,113 @@
+#include "BatteryPolicy.h"
+#include "Logger.h"
+#include <Preferences.h>
+#include <driver/adc.h>
+#include <esp_adc_cal.h>
+#include <esp_sleep.h>
+
+#define LOW_BATTERY_KEY "lowBat"
+
+
+void BatteryPolicy::init(uint8_t adcPin, const BatteryThresholds& thresholds, const char* nvsNamespace) {
+  this->adcPin = adcPin;
+  this->thresholds = thresholds;
+  this->nvsNamespace = nvsNamespace;
+}
+
+/*
+  Samples the battery and returns millivolts.  Also updates the battery level used by the rest of the policy.
+
+  Uses the eFuse ADC calibration bits to get accurate readings.  The ADC is 12 bit with 11db attenuation,
+  which gives a measurable input range of 150mV to 2450mV.  The board has a 1M+1M voltage divider, so readings
+  are multiplied by 2.
+*/
+uint32_t BatteryPolicy::readVoltage() {
+  esp_adc_cal_characteristics_t adc_chars;
+  adc_power_acquire();
+  uint16_t adc_val = analogRead(adcPin);
+  adc_power_release();
+
+  // unused when LOG_LEVEL is below LOG_LEVEL_DEBUG
+  esp_adc_cal_value_t val_type __attribute__((unused)) = esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_11db,
+                                                                                  ADC_WIDTH_BIT_12, 1100, &adc_chars);
+  LOG_DEBUG("BatteryPolicy: ADC calibration %s", val_type == ESP_ADC_CAL_VAL_EFUSE_VREF ? "eFuse Vref"
+                                                  : val_type == ESP_ADC_CAL_VAL_EFUSE_TP ? "Two Point" : "Default");
+
+  millivolts = esp_adc_cal_raw_to_voltage(adc_val, &adc_chars) * 2;
+
+  if (millivolts <= thresholds.critLowMillivolts) {
+    level = BATTERY_CRITICAL;
+  } else if (millivolts <= thresholds.veryLowMillivolts) {
+    level = BATTERY_VERY_LOW;
+  } else if (millivolts <= thresholds.lowMillivolts) {
+    level = BATTERY_LOW;
+  } else {
+    level = BATTERY_OK;
+  }
+
+  LOG_INFO("BatteryPolicy: Battery voltage is %umV", (unsigned)millivolts);
+  return millivolts;
+}
+
+// Last reading, UINT32_MAX until readVoltage has been called
+uint32_t BatteryPolicy::getVoltage() {
+  return millivolts;
+}
+
+BatteryLevel BatteryPolicy::getLevel() {
+  return level;
+}
+
+// WiFi is by far the largest draw, so nothing is fetched once the battery is low
+bool BatteryPolicy::allowWiFi() {
+  return level == BATTERY_OK;
+}
+
+// The shortest sleep the battery can afford, 0 when there is no limit
+uint32_t BatteryPolicy::getMinSleepSeconds() {
+  switch (level) {
+    case BATTERY_LOW:
+      return thresholds.lowSleepSeconds;
+    case BATTERY_VERY_LOW:
+    case BATTERY_CRITICAL:
+      return thresholds.veryLowSleepSeconds;
+    default:
+      return 0;
+  }
+}
+
+/*
+  True only on the first wake with a low battery, so the warning is drawn once rather than on every wake.
+  The flag lives in NVS and is cleared once the battery has been charged.
+*/
+bool BatteryPolicy::shouldShowWarning() {
+  Preferences prefs;
+  prefs.begin(nvsNamespace, false);
+  bool lowBat = prefs.getBool(LOW_BATTERY_KEY, false);
+  bool showWarning = false;
+
+  if (level != BATTERY_OK && !lowBat) {
+    prefs.putBool(LOW_BATTERY_KEY, true);
+    showWarning = true;
+  } else if (level == BATTERY_OK && lowBat) {
+    prefs.putBool(LOW_BATTERY_KEY, false);
+  }
+  prefs.end();
+  return showWarning;
+}
+
+/*
+  Deep sleep for the low battery interval.  A critically low battery doesn't set a timer at all,
+  the device hibernates until someone presses the reset/refresh button.
+*/
+void BatteryPolicy::deepSleep() {
+  if (level == BATTERY_CRITICAL) {
+    LOG_WARN("BatteryPolicy: Battery critically low, hibernating until the reset button is pressed.");
+  } else {
+    uint32_t sleepSeconds = getMinSleepSeconds();
+    LOG_WARN("BatteryPolicy: Battery low, sleeping for %umin", (unsigned)(sleepSeconds / 60));
+    esp_sleep_enable_timer_wakeup(sleepSeconds * 1000000ULL);
+  }
+  flushLog();
+  esp_deep_sleep_start();
+}
@@ -0,0 +1,46 @@
+#ifndef BATTERYPOLICY_H
+#define BATTERYPOLICY_H
+
+#include <Arduino.h>
+
+/*
+  Shared low-battery handling for the video and weather apps.
+
+  Each app passes in its own thresholds and NVS namespace, so the one-time low battery warning
+  is tracked separately per app (each has its own screen to draw it on).
+*/
+
+enum BatteryLevel {
+  BATTERY_OK,
+  BATTERY_LOW,       // stop using WiFi, wake less often
+  BATTERY_VERY_LOW,  // wake even less often
+  BATTERY_CRITICAL   // hibernate until the reset/refresh button is pressed
+};
+
+struct BatteryThresholds {
+  uint32_t lowMillivolts;
+  uint32_t veryLowMillivolts;
+  uint32_t critLowMillivolts;
+  uint32_t lowSleepSeconds;
+  uint32_t veryLowSleepSeconds;
+};
+
+class BatteryPolicy {
+private:
+  uint8_t adcPin;
+  BatteryThresholds thresholds;
+  const char* nvsNamespace;
+  uint32_t millivolts = UINT32_MAX;
+  BatteryLevel level = BATTERY_OK;
+public:
+  void init(uint8_t adcPin, const BatteryThresholds& thresholds, const char* nvsNamespace);
+  uint32_t readVoltage();
+  uint32_t getVoltage();
+  BatteryLevel getLevel();
+  bool allowWiFi();
+  uint32_t getMinSleepSeconds();
+  bool shouldShowWarning();
+  void deepSleep();
+};
+
+#endif
@@ -0,0 +1,73 @@
+#include "BootPartition.h"
+#include "Logger.h"
+#include <Preferences.h>
+#include <esp_ota_ops.h>
+#include <esp_sleep.h>
+#include <esp_system.h>
+
+#define BOOT_NAMESPACE "boot"
+#define WAKE_CAUSE_KEY "wakeCause"
+
+/*
+  Makes the app partition with the given subtype the one booted next (after a restart or deep sleep).
+*/
+bool setBootPartition(esp_partition_subtype_t subtype, const char* appName) {
+  const esp_partition_t* target_partition = esp_partition_find_first(
+    ESP_PARTITION_TYPE_APP, subtype, NULL);
+
+  if (target_partition == NULL) {
+    LOG_ERROR("ERROR: Partition with subtype 0x%02x not found!", (unsigned)subtype);
+    return false;
+  }
+
+  esp_err_t err = esp_ota_set_boot_partition(target_partition);
+  if (err != ESP_OK) {
+    LOG_ERROR("Failed to set boot partition, error: %d", err);
+    return false;
+  }
+
+  LOG_INFO("Boot partition set to %s at 0x%x", appName, (unsigned)target_partition->address);
+  return true;
+}
+
+/*
+  Set the boot partition back to the selector app for the next boot (wake)
+*/
+bool resetBootPartition() {
+  return setBootPartition(ESP_PARTITION_SUBTYPE_APP_FACTORY, "selector app");
+}
+
+/*
+  Called by the selector before it restarts into an app.  The flash is only written when the cause differs
+  from the last wake.
+*/
+void recordWakeCause() {
+  Preferences prefs;
+  if (!prefs.begin(BOOT_NAMESPACE, false)) {
+    return;
+  }
+  uint8_t cause = (uint8_t)esp_sleep_get_wakeup_cause();
+  if (prefs.getUChar(WAKE_CAUSE_KEY, UINT8_MAX) != cause) {  //no cause is UINT8_MAX, so a missing key is written
+    prefs.putUChar(WAKE_CAUSE_KEY, cause);
+  }
+  prefs.end();
+}
+
+/*
+  True if the selector was woken from deep sleep (by the timer or otherwise) and then restarted into
+  this app, false after power up or a press of the reset button.  Read once and remembered.
+*/
+bool wokeFromDeepSleep() {
+  static int woke = -1;
+  if (woke < 0) {
+    uint8_t cause = ESP_SLEEP_WAKEUP_UNDEFINED;
+    Preferences prefs;
+    if (prefs.begin(BOOT_NAMESPACE, true)) {
+      cause = prefs.getUChar(WAKE_CAUSE_KEY, ESP_SLEEP_WAKEUP_UNDEFINED);
+      prefs.end();
+    }
+    // a software reset is the selector's restart, anything else means the app wasn't started by it
+    woke = esp_reset_reason() == ESP_RST_SW && cause != ESP_SLEEP_WAKEUP_UNDEFINED;
+  }
+  return woke;
+}
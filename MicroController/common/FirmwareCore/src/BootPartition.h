@@ -0,0 +1,22 @@
+#ifndef BOOTPARTITION_H
+#define BOOTPARTITION_H
+
+#include <esp_partition.h>
+
+/*
+  The selector app lives in the factory partition and boots the video or weather app (ota_0/ota_1)
+  depending on the switch.  Each app sets the boot partition back to the selector so the switch
+  is read again on the next wake.
+*/
+
+bool setBootPartition(esp_partition_subtype_t subtype, const char* appName);
+bool resetBootPartition();
+
+/*
+  The selector restarts into the app, so the app itself always sees a software reset and no wakeup
+  cause.  The selector records why it woke before restarting, and the app asks here instead.
+*/
+void recordWakeCause();
+bool wokeFromDeepSleep();
+
+#endif
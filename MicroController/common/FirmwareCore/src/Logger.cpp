@@ -0,0 +1,473 @@
+#include "Logger.h"
+#include <ctype.h>
+#include <esp_attr.h>
+#include <esp_idf_version.h>
+#include <stdarg.h>
+
+#ifdef LOG_RTC_RING
+#if ESP_IDF_VERSION_MAJOR >= 5
+#include <esp_app_desc.h>
+#define getFirmwareSha256 esp_app_get_elf_sha256
+#else
+#include <esp_ota_ops.h>
+#define getFirmwareSha256 esp_ota_get_app_elf_sha256
+#endif
+#endif
+
+#define LOG_RING_MAGIC  0x4C4F4733  //"LOG3", changes with the record layout
+#define LOG_IMAGE_SIZE  8           //hex digits of the firmware's SHA-256 kept with the ring
+
+/*
+  A record is this header followed by the arguments, each stored the way the format says it was passed: ints, longs,
+  long longs, size_ts, doubles and pointers as they are, strings as a length byte and the characters.  Formatting
+  parses the format again to read them back.
+*/
+struct LogRecordHeader {
+  uint16_t length;  //of the whole record, 0 marks where the ring wraps
+  uint32_t time;    //millis()
+  const char* format;
+};
+
+// A line's worth of arguments, a string argument takes its length and one byte more
+#define LOG_RECORD_SIZE (sizeof(LogRecordHeader) + LOG_LINE_SIZE)
+
+static_assert(LOG_RECORD_SIZE + sizeof(uint16_t) <= LOG_RING_SIZE, "LOG_RING_SIZE must hold a whole record");
+
+/*
+  Records are kept whole.  One that doesn't fit before the end of the ring goes at the start, after a 0 length.
+*/
+struct LogRing {
+  uint32_t magic;
+  char image[LOG_IMAGE_SIZE];
+  uint32_t tail;       //oldest record
+  uint32_t head;       //where the next record goes
+  uint32_t count;
+  uint32_t unflushed;  //oldest record flushLog hasn't written, the rest after it haven't been either
+  uint32_t unflushedCount;
+  uint8_t data[LOG_RING_SIZE];
+};
+
+#ifdef LOG_RTC_RING
+// RTC_NOINIT so the ring is kept across deep sleep and the selector's restart, the magic tells a kept ring from garbage
+static RTC_NOINIT_ATTR LogRing logRing;
+#else
+static LogRing logRing;
+#endif
+
+static bool ringChecked = false;  //once per boot
+
+enum LogArgType { ARG_NONE, ARG_INT, ARG_LONG, ARG_LLONG, ARG_SIZE, ARG_DOUBLE, ARG_POINTER, ARG_STRING };
+
+struct FormatSpec {
+  const char* start;  //the '%'
+  const char* end;    //just past the conversion
+  bool widthArg;      //width given as *
+  bool precisionArg;  //precision given as *
+  char length;        //h, H for hh, l, L for ll, z, j, t, D for long double, or 0
+  char conversion;
+};
+
+/*
+  Parses the conversion specification at format, which points at a '%'.  Returns false if the format ends in it.
+*/
+static bool parseSpec(const char* format, FormatSpec& spec) {
+  const char* f = format + 1;
+  spec = { format, NULL, false, false, 0, 0 };
+  f += strspn(f, "-+ #0");
+  if (*f == '*') {
+    spec.widthArg = true;
+    f++;
+  }
+  while (isdigit((unsigned char)*f)) {
+    f++;
+  }
+  if (*f == '.') {
+    f++;
+    if (*f == '*') {
+      spec.precisionArg = true;
+      f++;
+    }
+    while (isdigit((unsigned char)*f)) {
+      f++;
+    }
+  }
+  switch (*f) {
+    case 'h':
+    case 'l':
+      spec.length = f[1] == *f ? toupper(*f) : *f;
+      f += f[1] == *f ? 2 : 1;
+      break;
+    case 'z':
+    case 'j':
+    case 't':
+      spec.length = *f++;
+      break;
+    case 'L':
+      spec.length = 'D';
+      f++;
+      break;
+  }
+  if (*f == '\0') {
+    return false;
+  }
+  spec.conversion = *f++;
+  spec.end = f;
+  return true;
+}
+
+static LogArgType argType(const FormatSpec& spec) {
+  switch (spec.conversion) {
+    case 'd': case 'i': case 'o': case 'u': case 'x': case 'X': case 'c':
+      switch (spec.length) {
+        case 'l': return ARG_LONG;
+        case 'L': case 'j': return ARG_LLONG;
+        case 'z': case 't': return ARG_SIZE;
+        default: return ARG_INT;
+      }
+    case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+      return ARG_DOUBLE;
+    case 's':
+      return ARG_STRING;
+    case 'p': case 'n':
+      return ARG_POINTER;
+    default:
+      return ARG_NONE;
+  }
+}
+
+// Appends a value to the record, returns false once it is full
+static bool put(uint8_t* record, size_t& length, const void* value, size_t size) {
+  if (length + size > LOG_RECORD_SIZE) {
+    return false;
+  }
+  memcpy(record + length, value, size);
+  length += size;
+  return true;
+}
+
+static bool putString(uint8_t* record, size_t& length, const char* s) {
+  if (length + 1 > LOG_RECORD_SIZE) {
+    return false;
+  }
+  size_t size = strnlen(s ? s : "(null)", UINT8_MAX);
+  size = size < LOG_RECORD_SIZE - length - 1 ? size : LOG_RECORD_SIZE - length - 1;
+  record[length++] = (uint8_t)size;
+  memcpy(record + length, s ? s : "(null)", size);
+  length += size;
+  return true;
+}
+
+// Reads a value back from the record, returns false past its end
+static bool get(const uint8_t*& arg, const uint8_t* end, void* value, size_t size) {
+  if (arg + size > end) {
+    return false;
+  }
+  memcpy(value, arg, size);
+  arg += size;
+  return true;
+}
+
+/*
+  Formats a record into line the way vsnprintf would have when it was logged, ending it with a newline.  Returns the
+  length of the line.
+*/
+static size_t formatRecord(const uint8_t* record, char* line, size_t size) {
+  LogRecordHeader header;
+  memcpy(&header, record, sizeof(header));
+  const uint8_t* arg = record + sizeof(header);
+  const uint8_t* end = record + header.length;
+
+  // [seconds.milliseconds] message
+  size_t length = snprintf(line, size, "[%lu.%lu] ", (unsigned long)header.time / 1000,
+                           (unsigned long)header.time % 1000);
+  const char* f = header.format;
+  while (*f != '\0' && length < size - 2) {
+    FormatSpec spec;
+    if (*f != '%' || !parseSpec(f, spec) || argType(spec) == ARG_NONE) {
+      line[length++] = (*f == '%' && f[1] == '%') ? *f++ : *f;
+      f++;
+      continue;
+    }
+    f = spec.end;
+
+    // The spec with any * replaced by its value, and the length modifier of the stored type
+    char specText[32];
+    size_t specLength = 0;
+    bool ok = true;
+    for (const char* c = spec.start; c < spec.end - 1 && specLength < sizeof(specText) - 24; c++) {
+      if (*c == '*') {
+        int value = 0;
+        ok = ok && get(arg, end, &value, sizeof(value));
+        specLength += snprintf(specText + specLength, sizeof(specText) - specLength, "%d", value);
+      } else if (strchr("lzjtL", *c) == NULL) {
+        specText[specLength++] = *c;
+      }
+    }
+    LogArgType type = argType(spec);
+    const char* modifier = type == ARG_LONG ? "l" : type == ARG_LLONG ? "ll" : type == ARG_SIZE ? "z" : "";
+    snprintf(specText + specLength, sizeof(specText) - specLength, "%s%c", modifier, spec.conversion);
+
+    int written = 0;
+    char* out = line + length;
+    size_t room = size - length - 1;
+    switch (type) {
+      case ARG_INT: {
+        int value;
+        ok = ok && get(arg, end, &value, sizeof(value));
+        written = ok ? snprintf(out, room, specText, value) : 0;
+        break;
+      }
+      case ARG_LONG: {
+        long value;
+        ok = ok && get(arg, end, &value, sizeof(value));
+        written = ok ? snprintf(out, room, specText, value) : 0;
+        break;
+      }
+      case ARG_LLONG: {
+        long long value;
+        ok = ok && get(arg, end, &value, sizeof(value));
+        written = ok ? snprintf(out, room, specText, value) : 0;
+        break;
+      }
+      case ARG_SIZE: {
+        size_t value;
+        ok = ok && get(arg, end, &value, sizeof(value));
+        written = ok ? snprintf(out, room, specText, value) : 0;
+        break;
+      }
+      case ARG_DOUBLE: {
+        double value;
+        ok = ok && get(arg, end, &value, sizeof(value));
+        written = ok ? snprintf(out, room, specText, value) : 0;
+        break;
+      }
+      case ARG_POINTER: {
+        const void* value;
+        ok = ok && get(arg, end, &value, sizeof(value));
+        written = ok && spec.conversion == 'p' ? snprintf(out, room, specText, value) : 0;
+        break;
+      }
+      case ARG_STRING: {
+        char value[LOG_RECORD_SIZE];
+        uint8_t valueLength = 0;
+        ok = ok && get(arg, end, &valueLength, sizeof(valueLength)) && get(arg, end, value, valueLength);
+        value[ok ? valueLength : 0] = '\0';
+        written = ok ? snprintf(out, room, specText, value) : 0;
+        break;
+      }
+      case ARG_NONE:
+        break;
+    }
+    if (!ok) {
+      break;  //the record was full, the rest of the line is lost
+    }
+    length += written < 0 ? 0 : written;
+  }
+
+  if (length > size - 2) {
+    length = size - 2;  //truncated
+  }
+  line[length++] = '\n';
+  line[length] = '\0';
+  return length;
+}
+
+static uint16_t lengthAt(uint32_t pos) {
+  uint16_t length = 0;
+  if (pos + sizeof(length) <= LOG_RING_SIZE) {
+    memcpy(&length, &logRing.data[pos], sizeof(length));
+  }
+  return length;
+}
+
+// The record at pos, or at the start of the ring if pos is where it wraps
+static uint32_t recordAt(uint32_t pos) {
+  return lengthAt(pos) == 0 ? 0 : pos;
+}
+
+static void writeRecord(Print& out, uint32_t pos) {
+  char line[LOG_LINE_SIZE];
+  size_t length = formatRecord(&logRing.data[pos], line, sizeof(line));
+  out.write((const uint8_t*)line, length);
+}
+
+/*
+  Checks the ring once per boot.  Records kept from earlier wakes were flushed then, or are lost.
+*/
+static void checkRing() {
+  if (ringChecked) {
+    return;
+  }
+  ringChecked = true;
+
+  char image[LOG_IMAGE_SIZE + 1] = "";
+#ifdef LOG_RTC_RING
+  getFirmwareSha256(image, sizeof(image));
+#endif
+  bool valid = logRing.magic == LOG_RING_MAGIC && memcmp(logRing.image, image, LOG_IMAGE_SIZE) == 0
+               && logRing.head <= LOG_RING_SIZE && logRing.tail <= LOG_RING_SIZE && logRing.count <= LOG_RING_SIZE;
+
+  // Walk the records so a ring cut short by a reset can't send dumpLog outside it
+  uint32_t pos = logRing.tail;
+  for (uint32_t i = 0; valid && i < logRing.count; i++) {
+    pos = recordAt(pos);
+    uint16_t length = lengthAt(pos);
+    valid = length >= sizeof(LogRecordHeader) && length <= LOG_RECORD_SIZE && pos + length <= LOG_RING_SIZE;
+    pos += length;
+  }
+  if (!valid || (logRing.count > 0 && pos != logRing.head)) {
+    clearLog();
+    memcpy(logRing.image, image, LOG_IMAGE_SIZE);
+  }
+  logRing.unflushedCount = 0;
+}
+
+static void dropOldest() {
+  uint32_t pos = recordAt(logRing.tail);
+  if (logRing.unflushedCount == logRing.count) {
+    writeRecord(Serial, pos);
+    logRing.unflushed = pos + lengthAt(pos);
+    logRing.unflushedCount--;
+  }
+  logRing.tail = pos + lengthAt(pos);
+  logRing.count--;
+}
+
+// Makes room for a record of the given length, dropping the oldest as needed, and returns where it goes
+static uint32_t reserve(uint16_t length) {
+  for (;;) {
+    if (logRing.count == 0) {
+      logRing.head = 0;
+      logRing.tail = 0;
+      return 0;
+    }
+    if (logRing.head > logRing.tail) {
+      if (LOG_RING_SIZE - logRing.head >= length) {
+        return logRing.head;
+      }
+      if (LOG_RING_SIZE - logRing.head >= sizeof(uint16_t)) {
+        memset(&logRing.data[logRing.head], 0, sizeof(uint16_t));
+      }
+      logRing.head = 0;
+    } else if (logRing.tail - logRing.head >= length) {
+      return logRing.head;
+    } else {
+      dropOldest();
+      logRing.tail = logRing.count > 0 ? recordAt(logRing.tail) : 0;
+    }
+  }
+}
+
+void logPrintf(const char* format, ...) {
+  uint8_t record[LOG_RECORD_SIZE];
+  LogRecordHeader header = { 0, (uint32_t)millis(), format };
+  size_t length = sizeof(header);
+
+  va_list args;
+  va_start(args, format);
+  bool room = true;
+  for (const char* f = strchr(format, '%'); room && f != NULL; f = strchr(f, '%')) {
+    FormatSpec spec;
+    if (!parseSpec(f, spec)) {
+      break;
+    }
+    f = spec.end;
+    if (argType(spec) == ARG_NONE) {
+      continue;  //%% and conversions formatRecord writes out as they are
+    }
+    if (spec.widthArg) {
+      int width = va_arg(args, int);
+      room = put(record, length, &width, sizeof(width));
+    }
+    if (spec.precisionArg) {
+      int precision = va_arg(args, int);
+      room = room && put(record, length, &precision, sizeof(precision));
+    }
+    switch (argType(spec)) {
+      case ARG_INT: {
+        int value = va_arg(args, int);
+        room = room && put(record, length, &value, sizeof(value));
+        break;
+      }
+      case ARG_LONG: {
+        long value = va_arg(args, long);
+        room = room && put(record, length, &value, sizeof(value));
+        break;
+      }
+      case ARG_LLONG: {
+        long long value = va_arg(args, long long);
+        room = room && put(record, length, &value, sizeof(value));
+        break;
+      }
+      case ARG_SIZE: {
+        size_t value = va_arg(args, size_t);
+        room = room && put(record, length, &value, sizeof(value));
+        break;
+      }
+      case ARG_DOUBLE: {
+        double value = spec.length == 'D' ? (double)va_arg(args, long double) : va_arg(args, double);
+        room = room && put(record, length, &value, sizeof(value));
+        break;
+      }
+      case ARG_POINTER: {
+        const void* value = va_arg(args, const void*);
+        room = room && put(record, length, &value, sizeof(value));
+        break;
+      }
+      case ARG_STRING:
+        room = room && putString(record, length, va_arg(args, const char*));
+        break;
+      case ARG_NONE:
+        break;
+    }
+  }
+  va_end(args);
+
+  header.length = length;
+  memcpy(record, &header, sizeof(header));
+
+  checkRing();
+  uint32_t pos = reserve(length);
+  memcpy(&logRing.data[pos], record, length);
+  logRing.head = pos + length;
+  logRing.count++;
+  if (logRing.unflushedCount == 0) {
+    logRing.unflushed = pos;
+  }
+  logRing.unflushedCount++;
+}
+
+/*
+  Formats the records logged since the last flush and writes them to Serial.
+*/
+void flushLog() {
+  checkRing();
+  while (logRing.unflushedCount > 0) {
+    uint32_t pos = recordAt(logRing.unflushed);
+    writeRecord(Serial, pos);
+    logRing.unflushed = pos + lengthAt(pos);
+    logRing.unflushedCount--;
+  }
+}
+
+/*
+  Writes the ring out oldest record first.
+*/
+void dumpLog(Print& out) {
+  checkRing();
+  uint32_t pos = logRing.tail;
+  for (uint32_t i = 0; i < logRing.count; i++) {
+    pos = recordAt(pos);
+    writeRecord(out, pos);
+    pos += lengthAt(pos);
+  }
+}
+
+void clearLog() {
+  logRing.magic = LOG_RING_MAGIC;
+  logRing.tail = 0;
+  logRing.head = 0;
+  logRing.count = 0;
+  logRing.unflushed = 0;
+  logRing.unflushedCount = 0;
+}
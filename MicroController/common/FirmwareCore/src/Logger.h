@@ -0,0 +1,70 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <Arduino.h>
+
+/*
+  Timestamped, printf-style logging shared by all apps.
+
+    LOG_INFO("StorageController: Wrote %s (%d bytes)", filename, bytesWritten);
+
+  Formatting is deferred.  A call only stores the time, the format pointer and the arguments, copying strings, so the
+  format must be a string literal.  flushLog formats what was logged since the last flush and writes it to Serial, so
+  call it where the time doesn't matter, e.g. before deep sleep.  Nothing touches the heap, and a line longer than
+  LOG_LINE_SIZE is truncated.  Levels above LOG_LEVEL compile to nothing, arguments included.  Set it per app in
+  platformio.ini, e.g. -D LOG_LEVEL=LOG_LEVEL_WARN.
+
+  The records are kept in a ring buffer, the oldest written out to Serial before they are dropped if no flush has.
+  With -D LOG_RTC_RING the ring lives in RTC memory and survives deep sleep (and the selector's restart), so the last
+  few wakes can be dumped on demand with dumpLog.  A ring left by other firmware is cleared, as its formats point
+  into that firmware.
+*/
+
+#define LOG_LEVEL_NONE  0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_INFO  3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#ifndef LOG_LINE_SIZE
+#define LOG_LINE_SIZE 128  //longest message, including the timestamp
+#endif
+
+#ifndef LOG_RING_SIZE
+#define LOG_RING_SIZE 2048  //bytes of recent log records kept for dumpLog
+#endif
+
+void logPrintf(const char* format, ...) __attribute__((format(printf, 1, 2)));
+void flushLog();
+void dumpLog(Print& out);
+void clearLog();
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) logPrintf(__VA_ARGS__)
+#else
+#define LOG_ERROR(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(...) logPrintf(__VA_ARGS__)
+#else
+#define LOG_WARN(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...) logPrintf(__VA_ARGS__)
+#else
+#define LOG_INFO(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) logPrintf(__VA_ARGS__)
+#else
+#define LOG_DEBUG(...) do {} while (0)
+#endif
+
+#endif
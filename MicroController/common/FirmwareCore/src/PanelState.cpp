@@ -0,0 +1,48 @@
+#include "PanelState.h"
+#include <Preferences.h>
+
+#define PANEL_NAMESPACE "panel"
+#define PANEL_KEY "contents"
+
+struct PanelContents {
+  uint32_t appId;
+  uint32_t signature;
+};
+
+static PanelContents readPanelContents() {
+  PanelContents contents = {};
+  Preferences prefs;
+  if (!prefs.begin(PANEL_NAMESPACE, true)) {
+    return contents;  //nothing recorded yet
+  }
+  prefs.getBytes(PANEL_KEY, &contents, sizeof(contents));
+  prefs.end();
+  return contents;
+}
+
+bool panelShows(uint32_t appId, uint32_t signature) {
+  if (signature == 0) {
+    return false;
+  }
+  PanelContents contents = readPanelContents();
+  return contents.appId == appId && contents.signature == signature;
+}
+
+// The signature of what appId last drew, or 0 if the panel shows something else
+uint32_t panelSignature(uint32_t appId) {
+  PanelContents contents = readPanelContents();
+  return contents.appId == appId ? contents.signature : 0;
+}
+
+// Called on every wake, so it only writes when the contents changed
+void setPanelContents(uint32_t appId, uint32_t signature) {
+  PanelContents contents = { appId, signature };
+  PanelContents current = readPanelContents();
+  if (current.appId == appId && current.signature == signature) {
+    return;
+  }
+  Preferences prefs;
+  prefs.begin(PANEL_NAMESPACE, false);
+  prefs.putBytes(PANEL_KEY, &contents, sizeof(contents));
+  prefs.end();
+}
@@ -0,0 +1,19 @@
+#ifndef PANELSTATE_H
+#define PANELSTATE_H
+
+#include <Arduino.h>
+
+/*
+  Remembers what is on the e-paper panel, so an app can skip a refresh that would draw the same image
+  again.  Kept in NVS rather than RTC memory: the panel keeps its image through a power cycle, and the
+  other app may have drawn over it since, so both apps record here whenever they draw.
+
+  The signature is whatever the app uses to tell its images apart.  0 means the contents aren't known
+  and never matches.
+*/
+
+bool panelShows(uint32_t appId, uint32_t signature);
+uint32_t panelSignature(uint32_t appId);
+void setPanelContents(uint32_t appId, uint32_t signature);
+
+#endif
@@ -0,0 +1,49 @@
+#include "RtcState.h"
+#include <esp_attr.h>
+#include <rom/crc.h>
+
+#define RTC_STATE_MAGIC 0x52544353  //"RTCS"
+
+struct RtcBlock {
+  uint32_t magic;
+  uint32_t appId;
+  uint32_t size;
+  uint32_t crc;
+  uint8_t data[RTC_STATE_SIZE];
+};
+
+// RTC_NOINIT rather than RTC_DATA, which would be reset every time the selector restarts into the app
+static RTC_NOINIT_ATTR RtcBlock rtcBlock;
+
+static uint32_t blockCrc() {
+  return crc32_le(rtcBlock.appId, rtcBlock.data, rtcBlock.size);
+}
+
+/*
+  Copies the saved state into state.  Returns false (leaving state untouched) if nothing valid was saved
+  by this app with this size.
+*/
+bool loadRtcState(uint32_t appId, void* state, size_t size) {
+  if (rtcBlock.magic != RTC_STATE_MAGIC || rtcBlock.appId != appId || rtcBlock.size != size
+      || size > RTC_STATE_SIZE || rtcBlock.crc != blockCrc()) {
+    return false;
+  }
+  memcpy(state, rtcBlock.data, size);
+  return true;
+}
+
+bool saveRtcState(uint32_t appId, const void* state, size_t size) {
+  if (size > RTC_STATE_SIZE) {
+    return false;
+  }
+  rtcBlock.magic = RTC_STATE_MAGIC;
+  rtcBlock.appId = appId;
+  rtcBlock.size = size;
+  memcpy(rtcBlock.data, state, size);
+  rtcBlock.crc = blockCrc();
+  return true;
+}
+
+void clearRtcState() {
+  rtcBlock.magic = 0;
+}
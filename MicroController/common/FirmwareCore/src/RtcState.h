@@ -0,0 +1,21 @@
+#ifndef RTCSTATE_H
+#define RTCSTATE_H
+
+#include <Arduino.h>
+
+/*
+  A small block of RTC slow memory that survives deep sleep (and the selector app's restart) but not a
+  power cycle or a press of the reset button.  Cheaper than NVS for state that changes on every wake,
+  as nothing is written to flash.
+
+  The block is tagged with the owning app and a CRC, so state left behind by the other app, or garbage
+  after power up, reads back as invalid.
+*/
+
+#define RTC_STATE_SIZE 64  //bytes available to the app
+
+bool loadRtcState(uint32_t appId, void* state, size_t size);
+bool saveRtcState(uint32_t appId, const void* state, size_t size);
+void clearRtcState();
+
+#endif
@@ -0,0 +1,53 @@
+#include "TimingProbe.h"
+
+struct TimingEntry {
+  const char* name;
+  uint32_t count;
+  uint32_t totalMicros;
+  uint32_t maxMicros;
+};
+
+static TimingEntry timings[MAX_TIMING_PROBES];
+static int timingCount = 0;
+
+TimingProbe::TimingProbe(const char* name) : name(name), startMicros(micros()) {
+}
+
+TimingProbe::~TimingProbe() {
+  recordTiming(name, micros() - startMicros);
+}
+
+void recordTiming(const char* name, unsigned long elapsedMicros) {
+  TimingEntry* entry = nullptr;
+  for (int i = 0; i < timingCount; i++) {
+    if (timings[i].name == name || strcmp(timings[i].name, name) == 0) {
+      entry = &timings[i];
+      break;
+    }
+  }
+  if (entry == nullptr) {
+    if (timingCount == MAX_TIMING_PROBES) {
+      return;
+    }
+    entry = &timings[timingCount++];
+    *entry = { name, 0, 0, 0 };
+  }
+
+  entry->count++;
+  entry->totalMicros += elapsedMicros;
+  if (elapsedMicros > entry->maxMicros) {
+    entry->maxMicros = elapsedMicros;
+  }
+}
+
+/*
+  One line per probe: name, number of samples, total and worst case in milliseconds.
+*/
+void printTimingReport(Print& out) {
+  out.printf("Timing (awake %lums)\n", millis());
+  for (int i = 0; i < timingCount; i++) {
+    const TimingEntry& entry = timings[i];
+    out.printf("  %-22s x%-3u total %7.1fms  max %7.1fms\n", entry.name, (unsigned)entry.count,
+               entry.totalMicros / 1000.0, entry.maxMicros / 1000.0);
+  }
+}
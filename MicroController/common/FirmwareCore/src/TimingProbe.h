@@ -0,0 +1,33 @@
+#ifndef TIMINGPROBE_H
+#define TIMINGPROBE_H
+
+#include <Arduino.h>
+
+/*
+  Measures how long a scope takes, so every app reports wake phases the same way.
+
+    {
+      TimingProbe probe("render");
+      ...
+    }
+    printTimingReport(Serial);
+
+  Names must be string literals (only the pointer is kept).  Up to MAX_TIMING_PROBES distinct names are tracked,
+  further names are ignored.
+*/
+
+#define MAX_TIMING_PROBES 16
+
+class TimingProbe {
+private:
+  const char* name;
+  unsigned long startMicros;
+public:
+  TimingProbe(const char* name);
+  ~TimingProbe();
+};
+
+void recordTiming(const char* name, unsigned long elapsedMicros);
+void printTimingReport(Print& out);
+
+#endif
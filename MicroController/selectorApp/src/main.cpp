@@ -1,5 +1,6 @@
 #include <Arduino.h>
-#include "esp_ota_ops.h"
+#include <BootPartition.h>
+#include <Logger.h>
 #include "esp_partition.h"
 
 const int switchPin = 15;  // GPIO15 for the switch
@@ -7,30 +8,15 @@ const int switchPin = 15;  // GPIO15 for the switch
 // Boot to a partition by subtype
 bool bootToPartition(esp_partition_subtype_t subtype, const char* appName) {
   Serial.printf("Attempting to boot to %s\n", appName);
-  
-  // Find the partition by subtype
-  const esp_partition_t* target_partition = esp_partition_find_first(
-    ESP_PARTITION_TYPE_APP, subtype, NULL);
-  
-  if (target_partition != NULL) {
-    Serial.printf("Found partition with subtype 0x%02x at address 0x%x\n", 
-                 subtype, target_partition->address);
-    
-    // Set boot partition
-    esp_err_t err = esp_ota_set_boot_partition(target_partition);
-    if (err == ESP_OK) {
-      Serial.printf("Boot partition set to %s, rebooting...\n", appName);
-      delay(1000);
-      ESP.restart();
-      return true;
-    } else {
-      Serial.printf("Failed to set boot partition, error: %d\n", err);
-      return false;
-    }
-  } else {
-    Serial.printf("ERROR: Partition with subtype 0x%02x not found!\n", subtype);
+  bool bootPartitionSet = setBootPartition(subtype, appName);
+  flushLog();
+  if (!bootPartitionSet) {
     return false;
   }
+  Serial.println("Rebooting...");
+  delay(1000);
+  ESP.restart();
+  return true;
 }
 
 void setup() {
@@ -50,6 +36,9 @@ void setup() {
   }
   esp_partition_iterator_release(it);
   
+  // The app only sees this app's restart, so tell it whether the board woke from deep sleep
+  recordWakeCause();
+
   // Configure GPIO15 as input with pull-up resistor
   pinMode(switchPin, INPUT_PULLUP);
   
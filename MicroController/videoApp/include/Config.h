@@ -10,6 +10,8 @@ constexpr char* httpEndpoint = "http://YOURIP:YOURPORT/image?displayId=1";
 constexpr uint64_t deepSleepTime = 6 * 60 * 1000 * 1000;//min * sec * millisec * microsec
 //constexpr uint64_t deepSleepTime = 15 * 1000 * 1000;//15 seconds, useful during development
 constexpr int imageBytes = 48000;//don't change
+constexpr char* nvsNamespace = "video_app";//Preferences namespace for schedule and battery state
+constexpr uint32_t appId = 0x56494430;//"VID0", tags state kept in RTC memory and the panel state shared with the weather app
 
 // Pin definitions for connecting the screen adapter board (DESPI-C02) to the ESP32
 constexpr int cs_pin = 4;
@@ -17,4 +19,37 @@ constexpr int dc_pin = 19;
 constexpr int rst_pin = 21;
 constexpr int busy_pin = 22;
 
+/*
+  Schedule
+  The clock is set over NTP whenever WiFi is up to refill the cache, and the ESP32 keeps it through deep sleep.
+  Until the clock has been set the frame simply advances every deepSleepTime.
+  See https://github.com/nayarsystems/posix_tz_db/blob/master/zones.csv for time zones.
+*/
+constexpr char* timeZone = "CST6CDT,M3.2.0,M11.1.0";
+constexpr char* ntpServer = "pool.ntp.org";
+constexpr unsigned long ntpTimeout = 5000;//ms, a failed sync only means quiet hours are skipped until the next refill
+
+// Quiet hours.  The frame is not advanced from bedTimeHour until wakeTimeHour (local time, range 0-23).
+// Set both to the same hour to disable.  The server can override these, see README.
+constexpr int bedTimeHour = 22;
+constexpr int wakeTimeHour = 6;
+
+// What to do with the frames that would have been shown during quiet hours.
+//   CATCH_UP_RESUME : pick the video back up where it paused
+//   CATCH_UP_SKIP   : drop the missed frames so playback stays in step with the clock (at most maxCatchUpFrames)
+enum CatchUpPolicy { CATCH_UP_RESUME, CATCH_UP_SKIP };
+constexpr CatchUpPolicy catchUpPolicy = CATCH_UP_RESUME;
+constexpr int maxCatchUpFrames = 100;
+
+// Battery.  Read through the shared BatteryPolicy library, thresholds match weatherApp/src/config.cpp (millivolts).
+// Below lowBatteryVoltage the cache is no longer refilled over WiFi and frames advance at most every lowBatterySleepTime,
+// below veryLowBatteryVoltage every veryLowBatterySleepTime.
+// Below critLowBatteryVoltage the device hibernates until the refresh button is pressed.
+constexpr uint8_t batteryPin = 35;
+constexpr uint32_t lowBatteryVoltage = 3462;// ~10%
+constexpr uint32_t veryLowBatteryVoltage = 3442;// ~8%
+constexpr uint32_t critLowBatteryVoltage = 3404;// ~5%
+constexpr uint64_t lowBatterySleepTime = 30ULL * 60 * 1000 * 1000;
+constexpr uint64_t veryLowBatterySleepTime = 120ULL * 60 * 1000 * 1000;
+
 #endif
\ No newline at end of file
@@ -19,7 +19,6 @@ public:
 private: 
   uint8_t* rotateImage180(const uint8_t* image, uint16_t width, uint16_t height);
   const uint8_t* lastImage;
-  void logWithTimestamp(const String& message);
 };
 
 #endif
\ No newline at end of file
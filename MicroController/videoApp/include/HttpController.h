@@ -4,16 +4,16 @@
 #include <WiFi.h>
 #include <HTTPClient.h>
 #include "DisplayController.h"
+#include "ScheduleController.h"
 
 
 class HttpController {
 private:
   DisplayController* displayController;
-  void logWithTimestamp(const String& message);
-  float readBatteryVoltage();
+  ScheduleController* scheduleController;
 public:
-  void init(DisplayController* displayController);
-  void fetchImage(uint8_t* image);
+  void init(DisplayController* displayController, ScheduleController* scheduleController);
+  void fetchImage(uint8_t* image, uint32_t batteryMillivolts);
   void connectWiFi();
   void disconnectWiFi();
 };
@@ -0,0 +1,27 @@
+#ifndef SCHEDULECONTROLLER_H
+#define SCHEDULECONTROLLER_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <time.h>
+
+
+class ScheduleController {
+private:
+  Preferences prefs;
+  uint32_t frameIntervalSeconds;
+  int bedTime;
+  int wakeTime;
+  bool clockIsSet(tm* timeInfo);
+  bool isQuietHour(int hour);
+public:
+  void init();
+  void syncClock();
+  void applyServerHint(long frameIntervalSeconds, int bedTime, int wakeTime);
+  bool isQuietTime();
+  int getFramesToSkip();
+  void markFrameShown();
+  uint64_t getSleepTime(uint32_t minIntervalSeconds);
+};
+
+#endif
@@ -6,12 +6,14 @@
 #include "DisplayController.h"
 #include <string>
 
+#define IMAGE_FILENAME_SIZE 24
+
 
 class StorageController {
 private:
   DisplayController* displayController;
-  std::string zeroPad(int num, int size);
-  void logWithTimestamp(const String& message);
+  void getImageFilename(int number, char* filename);
+  int getImageNumber(const char* filename);
 public:
   void init(DisplayController* displayController);
   void showAvailableSpace();
@@ -23,6 +25,7 @@ public:
   bool cacheHasRoomForAnotherImage();
   void writeImageToCache(uint8_t* image);
   bool getNextImage(uint8_t* image);
+  int discardImages(int count);
 };
 
 #endif
\ No newline at end of file
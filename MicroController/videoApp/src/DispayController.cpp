@@ -1,4 +1,5 @@
 #include "DisplayController.h"
+#include <Logger.h>
 #include "fonts/FreeMonoBold9pt7b.h"
 #include "Config.h"
 
@@ -10,7 +11,7 @@ GxEPD2_BW< GxEPD2_DRIVER_CLASS, GxEPD2_DRIVER_CLASS::HEIGHT / 2 > display(GxEPD2
 
 void DisplayController::init() {
   display.init(115200);
-  logWithTimestamp("DisplayController: Display initialized");
+  LOG_INFO("DisplayController: Display initialized");
 
   display.setRotation(2); //ribbon at top
   display.setTextColor(GxEPD_BLACK);
@@ -148,15 +149,3 @@ void DisplayController::dismissMessage() {
 void DisplayController::powerDown() {
   display.powerOff();
 }
-
-void DisplayController::logWithTimestamp(const String& message) {
-  // Get the number of milliseconds since the device started
-  unsigned long currentTime = millis();
-
-  // Convert milliseconds to seconds and format as [seconds.milliseconds]
-  unsigned long seconds = currentTime / 1000;
-  unsigned long milliseconds = currentTime % 1000;
-
-  // Prepend the timestamp to the message and print it
-  Serial.println("[" + String(seconds) + "." + String(milliseconds) + "] " + message);
-}
\ No newline at end of file
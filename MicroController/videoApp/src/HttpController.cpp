@@ -1,10 +1,13 @@
 #include "HttpController.h"
+#include <Logger.h>
 #include "Config.h"
 
-#define BATTERY_PIN 35
+// Optional response headers the server uses to pass along a schedule, see ScheduleController::applyServerHint
+const char* scheduleHeaders[] = { "X-Frame-Interval", "X-Bed-Time", "X-Wake-Time" };
 
-void HttpController::init(DisplayController* displayController) {
+void HttpController::init(DisplayController* displayController, ScheduleController* scheduleController) {
   this->displayController = displayController;
+  this->scheduleController = scheduleController;
 }
 
 void HttpController::connectWiFi() {
@@ -12,29 +15,28 @@ void HttpController::connectWiFi() {
   while (WiFi.status() != WL_CONNECTED) {
     delay(1000);
     this->displayController->showMessage("Connecting to WiFi...");
-    logWithTimestamp("HttpController: Connecting to WiFi...");
+    LOG_INFO("HttpController: Connecting to WiFi...");
   }
   this->displayController->showMessage("Connected to WiFi");
-  logWithTimestamp("HttpController: Connected to WiFi");
+  LOG_INFO("HttpController: Connected to WiFi");
 }
 
 void HttpController::disconnectWiFi() {
   WiFi.disconnect();
   this->displayController->showMessage("Disconnected from WiFi");
-  logWithTimestamp("HttpController: Disconnected from WiFi");
+  LOG_INFO("HttpController: Disconnected from WiFi");
 }
 
 //A pointer is passed in of an array to be populated by this function.
-void HttpController::fetchImage(uint8_t* image) {
+void HttpController::fetchImage(uint8_t* image, uint32_t batteryMillivolts) {
   int payloadSize = imageBytes;
   HTTPClient http;
 
-  float batteryVoltage = readBatteryVoltage();
-
-  // Append the battery voltage as a query string parameter to the endpoint
-  String endpointWithVoltageParam = String(httpEndpoint) + "&batteryVoltage=" + String(batteryVoltage, 2);
+  // Append the battery voltage as a query string parameter to the endpoint, the server expects volts
+  String endpointWithVoltageParam = String(httpEndpoint) + "&batteryVoltage=" + String(batteryMillivolts / 1000.0, 2);
 
   http.begin(endpointWithVoltageParam);
+  http.collectHeaders(scheduleHeaders, 3);
   int httpCode = http.GET();
 
   if (httpCode > 0) {  // Check for the returning code
@@ -53,32 +55,17 @@ void HttpController::fetchImage(uint8_t* image) {
 
       // Now you can read the image data
       stream.readBytes(image, payloadSize);
-      logWithTimestamp("HttpController: Successfully fetched image.");
+      LOG_INFO("HttpController: Successfully fetched image.");
+
+      // Absent headers are passed as -1 and leave that setting alone
+      this->scheduleController->applyServerHint(
+        http.hasHeader("X-Frame-Interval") ? http.header("X-Frame-Interval").toInt() : -1,
+        http.hasHeader("X-Bed-Time") ? http.header("X-Bed-Time").toInt() : -1,
+        http.hasHeader("X-Wake-Time") ? http.header("X-Wake-Time").toInt() : -1);
     }
   } else {
-    logWithTimestamp("HttpController: Error on HTTP request");
+    LOG_ERROR("HttpController: Error on HTTP request %d", httpCode);
   }
 
   http.end();  // Free the resources
 }
-
-void HttpController::logWithTimestamp(const String& message) {
-  // Get the number of milliseconds since the device started
-  unsigned long currentTime = millis();
-
-  // Convert milliseconds to seconds and format as [seconds.milliseconds]
-  unsigned long seconds = currentTime / 1000;
-  unsigned long milliseconds = currentTime % 1000;
-
-  // Prepend the timestamp to the message and print it
-  Serial.println("[" + String(seconds) + "." + String(milliseconds) + "] " + message);
-}
-
-float HttpController::readBatteryVoltage() {
-  int raw = analogRead(BATTERY_PIN);
-  float voltage = raw * (3.3 / 4095.0); // Convert ADC reading to voltage (assuming 3.3V reference).  ADC is 12 bit, max value is 4095 (starts at zero).
-  voltage = voltage * 2; // assuming internal voltage divider halves the voltage
-  voltage = voltage * 1.039; // Thom took the reading from the above line and measured the battery directly with a multimeter.  This factor roughly brought the two inline.
-  logWithTimestamp("HttpController: Battery voltage is " + String(voltage, 2) + "V");
-  return voltage;
-}
\ No newline at end of file
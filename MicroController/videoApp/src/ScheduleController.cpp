@@ -0,0 +1,178 @@
+#include "ScheduleController.h"
+#include <Logger.h>
+#include <RtcState.h>
+#include "Config.h"
+#include <esp_sntp.h>
+#include <algorithm>
+
+#define MIN_SLEEP_SECONDS 60  //never wake sooner than this, even if a server asks for it
+
+
+void ScheduleController::init() {
+  // Restore the last schedule hint the server sent, falling back to Config.h
+  prefs.begin(nvsNamespace, true);
+  frameIntervalSeconds = prefs.getULong("interval", deepSleepTime / 1000000ULL);
+  bedTime = prefs.getInt("bedTime", bedTimeHour);
+  wakeTime = prefs.getInt("wakeTime", wakeTimeHour);
+  prefs.end();
+
+  // the clock survives deep sleep, it only needs the time zone re-applied
+  setenv("TZ", timeZone, 1);
+  tzset();
+
+  LOG_INFO("ScheduleController: Frame interval %us, quiet hours %d:00-%d:00",
+           (unsigned)frameIntervalSeconds, bedTime, wakeTime);
+}
+
+/*
+  Set the clock over NTP.  Must be connected to WiFi.
+  This only happens when the cache is refilled, roughly once a day, which is plenty for hour-level quiet hours.
+*/
+void ScheduleController::syncClock() {
+  configTzTime(timeZone, ntpServer);
+  unsigned long timeout = millis() + ntpTimeout;
+  while (sntp_get_sync_status() == SNTP_SYNC_STATUS_RESET && millis() < timeout) {
+    delay(100);
+  }
+
+  tm timeInfo;
+  if (clockIsSet(&timeInfo)) {
+    char buf[32];
+    strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &timeInfo);
+    LOG_INFO("ScheduleController: Clock set to %s", buf);
+  } else {
+    LOG_WARN("ScheduleController: Failed to set clock, quiet hours disabled until next sync.");
+  }
+}
+
+/*
+  The server can attach a schedule to each frame response (see HttpController::fetchImage).
+  Negative values mean the header was absent and the current setting is kept.
+  Only changed values are written to flash.
+*/
+void ScheduleController::applyServerHint(long frameIntervalSeconds, int bedTime, int wakeTime) {
+  bool changed = false;
+  prefs.begin(nvsNamespace, false);
+  if (frameIntervalSeconds >= MIN_SLEEP_SECONDS && frameIntervalSeconds != this->frameIntervalSeconds) {
+    this->frameIntervalSeconds = frameIntervalSeconds;
+    prefs.putULong("interval", frameIntervalSeconds);
+    changed = true;
+  }
+  if (bedTime >= 0 && bedTime < 24 && bedTime != this->bedTime) {
+    this->bedTime = bedTime;
+    prefs.putInt("bedTime", bedTime);
+    changed = true;
+  }
+  if (wakeTime >= 0 && wakeTime < 24 && wakeTime != this->wakeTime) {
+    this->wakeTime = wakeTime;
+    prefs.putInt("wakeTime", wakeTime);
+    changed = true;
+  }
+  prefs.end();
+
+  if (changed) {
+    LOG_INFO("ScheduleController: Server schedule is now every %us, quiet hours %d:00-%d:00",
+             (unsigned)this->frameIntervalSeconds, this->bedTime, this->wakeTime);
+  }
+}
+
+bool ScheduleController::isQuietTime() {
+  tm timeInfo;
+  if (!clockIsSet(&timeInfo)) {
+    return false;
+  }
+  return isQuietHour(timeInfo.tm_hour);
+}
+
+/*
+  With CATCH_UP_SKIP, the number of frames that would have been shown since the last one,
+  had the display not been asleep for quiet hours (or a low battery).
+*/
+int ScheduleController::getFramesToSkip() {
+  if (catchUpPolicy != CATCH_UP_SKIP) {
+    return 0;
+  }
+
+  tm timeInfo;
+  if (!clockIsSet(&timeInfo)) {
+    return 0;
+  }
+
+  // Kept in RTC memory, so a press of the refresh button (which clears it) never skips frames
+  int64_t lastShown;
+  if (!loadRtcState(appId, &lastShown, sizeof(lastShown))) {
+    return 0;
+  }
+
+  time_t now = time(nullptr);
+  // one interval of slack so a slightly late wake doesn't drop a frame
+  long missed = (long)((now - lastShown) / frameIntervalSeconds) - 1;
+  if (missed <= 0) {
+    return 0;
+  }
+  return missed > maxCatchUpFrames ? maxCatchUpFrames : (int)missed;
+}
+
+void ScheduleController::markFrameShown() {
+  if (catchUpPolicy != CATCH_UP_SKIP) {
+    return;
+  }
+
+  tm timeInfo;
+  if (!clockIsSet(&timeInfo)) {
+    return;
+  }
+  int64_t lastShown = time(nullptr);
+  saveRtcState(appId, &lastShown, sizeof(lastShown));
+}
+
+/*
+  Returns microseconds until the next wake.  minIntervalSeconds lets a low battery stretch the frame interval.
+
+  Like the weather app's beginDeepSleep, wakes are aligned to multiples of the frame interval counted from
+  the wake time, and a wake that would land in quiet hours is pushed out to the end of them.
+*/
+uint64_t ScheduleController::getSleepTime(uint32_t minIntervalSeconds) {
+  uint64_t intervalSeconds = std::max<uint64_t>(frameIntervalSeconds, minIntervalSeconds);
+
+  tm timeInfo;
+  if (!clockIsSet(&timeInfo)) {
+    return intervalSeconds * 1000000ULL;
+  }
+
+  // seconds since the most recent wake time, so alignment restarts every morning
+  const int hoursSinceWake = (timeInfo.tm_hour - wakeTime + 24) % 24;
+  const uint64_t secondsSinceWake = hoursSinceWake * 3600ULL + timeInfo.tm_min * 60 + timeInfo.tm_sec;
+
+  uint64_t sleepSeconds = intervalSeconds - (secondsSinceWake % intervalSeconds);
+  if (sleepSeconds < MIN_SLEEP_SECONDS) {
+    sleepSeconds += intervalSeconds;
+  }
+
+  if (bedTime != wakeTime) {
+    const int bedHoursSinceWake = (bedTime - wakeTime + 24) % 24;
+    if (secondsSinceWake + sleepSeconds >= bedHoursSinceWake * 3600ULL) {
+      // next wake would be in quiet hours, sleep through to the next wake time instead
+      sleepSeconds = 24 * 3600ULL - secondsSinceWake;
+    }
+  }
+
+  LOG_INFO("ScheduleController: Sleeping for %lus", (unsigned long)sleepSeconds);
+  return sleepSeconds * 1000000ULL;
+}
+
+bool ScheduleController::clockIsSet(tm* timeInfo) {
+  time_t now = time(nullptr);
+  localtime_r(&now, timeInfo);
+  return timeInfo->tm_year >= (2024 - 1900);  //the clock starts at 1970 until it has been synced
+}
+
+bool ScheduleController::isQuietHour(int hour) {
+  if (bedTime == wakeTime) {
+    return false;
+  }
+  if (bedTime < wakeTime) {
+    return hour >= bedTime && hour < wakeTime;
+  }
+  return hour >= bedTime || hour < wakeTime;  //window wraps past midnight
+}
@@ -1,5 +1,8 @@
 #include "StorageController.h"
+#include <Logger.h>
 #include "Config.h"
+#include <algorithm>
+#include <vector>
 
 int cacheFileNumber = -1;
 
@@ -7,6 +10,7 @@ int cacheFileNumber = -1;
 #define BASE_PATH      "/videoFrames" //cannot be "/"
 #define MAX_OPEN_FILES 5
 #define PARTITION_LABEL "littlefs"
+#define INCOMING_FILENAME "/incoming.tmp"  //images are written here first, then renamed into the cache
 
 
 void StorageController::init(DisplayController* displayController) {
@@ -22,22 +26,28 @@ void StorageController::init(DisplayController* displayController) {
     partitionLabel	const   char*	NULL	Partition label to mount (e.g., "littlefs" — must match partition table)
   */
   if (!LittleFS.begin(FORMAT_ON_FAIL, BASE_PATH, MAX_OPEN_FILES, PARTITION_LABEL)) {
-    logWithTimestamp("Mount failed — attempting to format...");
+    LOG_WARN("Mount failed — attempting to format...");
     
     if (LittleFS.format()) {
-      logWithTimestamp("Format succeeded — re-mounting...");
+      LOG_INFO("Format succeeded — re-mounting...");
       if (LittleFS.begin(FORMAT_ON_FAIL, BASE_PATH, MAX_OPEN_FILES, PARTITION_LABEL)) {
-        logWithTimestamp("Mount after format succeeded!");
+        LOG_INFO("Mount after format succeeded!");
       } else {
-        logWithTimestamp("Mount failed even after format — check partition config.");
+        LOG_ERROR("Mount failed even after format — check partition config.");
         while (1);  // Halt
       }
     } else {
-      logWithTimestamp("Format failed — check partition label/size.");
+      LOG_ERROR("Format failed — check partition label/size.");
       while (1);  // Halt
     }
   } else {
-    logWithTimestamp("LittleFS mounted successfully!");
+    LOG_INFO("LittleFS mounted successfully!");
+  }
+
+  // Left behind if power was lost part way through writing an image
+  if (LittleFS.exists(INCOMING_FILENAME)) {
+    LOG_WARN("StorageController: Removing partially written image.");
+    LittleFS.remove(INCOMING_FILENAME);
   }
 
   //showAvailableSpace();
@@ -99,11 +109,7 @@ int StorageController::getLargestFileNumber() {
   int largestNumber = -1;
   File file = root.openNextFile();
   while (file) {
-    std::string filename = file.name();
-    //logWithTimestamp(filename.c_str());
-    int start = filename.find("image") + 5;
-    int end = filename.find(".bmp");
-    int number = std::stoi(filename.substr(start, end - start));
+    int number = getImageNumber(file.name());
     if (number > largestNumber) {
       largestNumber = number;
     }
@@ -134,11 +140,8 @@ int StorageController::getSmallestFileNumber() {
   int smallestNumber = INT_MAX;
   File file = root.openNextFile();
   while (file) {
-    std::string filename = file.name();
-    int start = filename.find("image") + 5;
-    int end = filename.find(".bmp");
-    int number = std::stoi(filename.substr(start, end - start));
-    if (number < smallestNumber) {
+    int number = getImageNumber(file.name());
+    if (number >= 0 && number < smallestNumber) {
       smallestNumber = number;
     }
     file = root.openNextFile();
@@ -176,7 +179,7 @@ bool StorageController::cacheHasRoomForAnotherImage() {
   size_t totalBytes = LittleFS.totalBytes();
   size_t usedBytes = LittleFS.usedBytes();
   size_t availableBytes = totalBytes - usedBytes;
-  logWithTimestamp(String("StorageController: Available bytes of storage: ") + String(availableBytes));
+  LOG_DEBUG("StorageController: Available bytes of storage: %u", (unsigned)availableBytes);
   return (availableBytes > 49000);  //leave a little headroom
 }
 
@@ -186,14 +189,17 @@ void StorageController::writeImageToCache(uint8_t* image) {
   }
 
   // Generate a unique filename
-  std::string filename = "/image" + zeroPad(cacheFileNumber++, 4) + ".bmp";
+  char filename[IMAGE_FILENAME_SIZE];
+  getImageFilename(cacheFileNumber++, filename);
 
-  // Open the file in write mode
-  File file = LittleFS.open(filename.c_str(), FILE_WRITE);
+  // Write to a temporary file and rename it once complete, so a power loss never leaves a truncated image in the cache.
+  // tools/storage_power_loss.cpp runs this file on littlefs with the power cut, a bit stored wrong or ENOSPC returned
+  // at every flash write, and reports the cost of a refill.
+  File file = LittleFS.open(INCOMING_FILENAME, FILE_WRITE);
 
   if (!file) {
     this->displayController->showMessage("Failed to open file for writing");
-    logWithTimestamp(("StorageController: Failed to open file " + filename + " for writing.  Purging cache.").c_str());
+    LOG_ERROR("StorageController: Failed to open file %s for writing.  Purging cache.", filename);
     purgeCache();  //something is likely corrupt in flash memory, blow it all away
     return;
   }
@@ -202,14 +208,16 @@ void StorageController::writeImageToCache(uint8_t* image) {
   size_t bytesWritten = file.write(image, imageBytes);
   file.close();  // Close the file
 
-  if (bytesWritten < imageBytes) {
+  if (bytesWritten < imageBytes || !LittleFS.rename(INCOMING_FILENAME, filename)) {
     this->displayController->showMessage("Failed to write image!");
-    logWithTimestamp(("StorageController: Failed to write entire image to file " + filename + ". Bytes written: " + String(bytesWritten).c_str()).c_str());
-    logWithTimestamp("Assuming filesystem corruption.  Purging cache.");
+    LOG_ERROR("StorageController: Failed to write entire image to file %s. Bytes written: %u", filename, (unsigned)bytesWritten);
+    LOG_ERROR("Assuming filesystem corruption.  Purging cache.");
     purgeCache();  //something is likely corrupt in flash memory, blow it all away
   } else {
-    this->displayController->showMessage(("Image written to " + filename).c_str());
-    logWithTimestamp(("StorageController: Successfully wrote image to file " + filename).c_str());
+    char message[48];
+    snprintf(message, sizeof(message), "Image written to %s", filename);
+    this->displayController->showMessage(message);
+    LOG_INFO("StorageController: Successfully wrote image to file %s", filename);
   }
 }
 
@@ -217,74 +225,120 @@ bool StorageController::getNextImage(uint8_t* image) {
 
   int lowestFileNumber = this->getSmallestFileNumber();
   if (lowestFileNumber == -1) {
-    logWithTimestamp("StorageController: Unable to determine lowest file number.");
+    LOG_WARN("StorageController: Unable to determine lowest file number.");
     return false;
   }
 
   // Generate a unique filename
-  std::string lowestFilename = "/image" + zeroPad(lowestFileNumber, 4) + ".bmp";
+  char lowestFilename[IMAGE_FILENAME_SIZE];
+  getImageFilename(lowestFileNumber, lowestFilename);
 
-  if (!lowestFilename.empty()) {
+  if (lowestFilename[0] != '\0') {
 
-    logWithTimestamp(String("StorageController: Reading ") + lowestFilename.c_str());
+    LOG_INFO("StorageController: Reading %s", lowestFilename);
 
     // Double check if the file exists
-    if (!LittleFS.exists(lowestFilename.c_str())) {
-      logWithTimestamp(String("StorageController: This shouldn't be possible.  File does not exist: ") + lowestFilename.c_str());
+    if (!LittleFS.exists(lowestFilename)) {
+      LOG_ERROR("StorageController: This shouldn't be possible.  File does not exist: %s", lowestFilename);
       return false;
     }
 
     // Open the file
-    File imageFile = LittleFS.open(lowestFilename.c_str());
+    File imageFile = LittleFS.open(lowestFilename);
     if (!imageFile) {
-      logWithTimestamp("StorageController: Failed to open image file.  Deleting it.");
-      LittleFS.remove(lowestFilename.c_str());  // Delete the file
+      LOG_ERROR("StorageController: Failed to open image file.  Deleting it.");
+      imageFile.close();
+      LittleFS.remove(lowestFilename);  // Delete the file
       return false;
     }
 
-    // Check the file size
-    if (imageFile.size() == 0) {
-      logWithTimestamp("StorageController: File is empty.  Deleting it.");
-      LittleFS.remove(lowestFilename.c_str());  // Delete the file
+    // Check the file size.  Anything other than a whole image would draw garbage.
+    if (imageFile.size() != imageBytes) {
+      LOG_ERROR("StorageController: File is %u bytes, expected %d.  Deleting it.", (unsigned)imageFile.size(), imageBytes);
+      imageFile.close();
+      LittleFS.remove(lowestFilename);  // Delete the file
       return false;
     }
 
     // Read the file
     size_t bytesRead = imageFile.read(image, imageBytes);
-    if (bytesRead == 0) {
-      logWithTimestamp("StorageController: Failed to read image file.  Deleting it.");
-      LittleFS.remove(lowestFilename.c_str());  // Delete the file
+    imageFile.close();                      //free resources
+    if (bytesRead == (size_t)-1) {
+      LOG_ERROR("StorageController: Error occurred while reading file.  Deleting it.");
+      LittleFS.remove(lowestFilename);  // Delete the file
       return false;
-    } else if (bytesRead == -1) {
-      logWithTimestamp("StorageController: Error occurred while reading file.  Deleting it.");
-      LittleFS.remove(lowestFilename.c_str());  // Delete the file
+    } else if (bytesRead < imageBytes) {
+      LOG_ERROR("StorageController: Failed to read image file.  Deleting it.");
+      LittleFS.remove(lowestFilename);  // Delete the file
       return false;
     }
 
-    imageFile.close();                      //free resources
-    LittleFS.remove(lowestFilename.c_str());  // Delete the file.  Think of this as popping off the queue.
+    LittleFS.remove(lowestFilename);  // Delete the file.  Think of this as popping off the queue.
   } else {
-    logWithTimestamp("StorageController: This shouldn't be possible.  No file was found");
+    LOG_ERROR("StorageController: This shouldn't be possible.  No file was found");
     return false;
   }
 
   return true;
 }
 
-std::string StorageController::zeroPad(int num, int size) {
-  std::string s = std::to_string(num);
-  while (s.size() < size) s = "0" + s;
-  return s;
+/*
+  Deletes the next "count" images in the queue without reading them.
+  Used to catch up after frames were skipped during quiet hours.
+  Lists the directory once rather than calling getSmallestFileNumber per image, as that takes seconds each time.
+*/
+int StorageController::discardImages(int count) {
+  if (count <= 0) {
+    return 0;
+  }
+
+  File root = LittleFS.open("/");
+  if (!root || !root.isDirectory()) {
+    return 0;
+  }
+
+  std::vector<int> numbers;
+  File file = root.openNextFile();
+  while (file) {
+    int number = getImageNumber(file.name());
+    if (number >= 0) {
+      numbers.push_back(number);
+    }
+    file = root.openNextFile();
+  }
+  file.close();
+  root.close();
+
+  std::sort(numbers.begin(), numbers.end());
+
+  // always leave one image to show
+  int discarded = 0;
+  for (int i = 0; i < count && i < (int)numbers.size() - 1; i++) {
+    char filename[IMAGE_FILENAME_SIZE];
+    getImageFilename(numbers[i], filename);
+    if (LittleFS.remove(filename)) {
+      discarded++;
+    }
+  }
+
+  LOG_INFO("StorageController: Discarded %d images to catch up.", discarded);
+  return discarded;
 }
 
-void StorageController::logWithTimestamp(const String& message) {
-  // Get the number of milliseconds since the device started
-  unsigned long currentTime = millis();
+// Image files are named /image0001.bmp, /image0002.bmp, ... so they sort in the order they were fetched
+void StorageController::getImageFilename(int number, char* filename) {
+  snprintf(filename, IMAGE_FILENAME_SIZE, "/image%04d.bmp", number);
+}
 
-  // Convert milliseconds to seconds and format as [seconds.milliseconds]
-  unsigned long seconds = currentTime / 1000;
-  unsigned long milliseconds = currentTime % 1000;
+// The number in an image filename, or -1 for anything that isn't an image
+int StorageController::getImageNumber(const char* filename) {
+  const char* name = strrchr(filename, '/');
+  name = name ? name + 1 : filename;
 
-  // Prepend the timestamp to the message and print it
-  Serial.println("[" + String(seconds) + "." + String(milliseconds) + "] " + message);
-}
\ No newline at end of file
+  int number;
+  int length = 0;
+  if (sscanf(name, "image%d.bmp%n", &number, &length) != 1 || length == 0 || name[length] != '\0') {
+    return -1;
+  }
+  return number;
+}
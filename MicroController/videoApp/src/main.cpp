@@ -2,10 +2,13 @@
 #include "StorageController.h"
 #include "HttpController.h"
 #include "DisplayController.h"
-#include "esp_ota_ops.h"
-#include "esp_partition.h"
+#include "ScheduleController.h"
+#include <BatteryPolicy.h>
+#include <BootPartition.h>
+#include <Logger.h>
+#include <PanelState.h>
+#include <TimingProbe.h>
 #include <esp_sleep.h>
-#include <esp_system.h>
 
 #define PURGE_CACHE_BUTTON 2
 
@@ -15,120 +18,151 @@ uint8_t image[imageBytes];
 StorageController storageController;
 HttpController httpController;
 DisplayController displayController;
+ScheduleController scheduleController;
+BatteryPolicy batteryPolicy;
 int failCount;
-
-void logWithTimestamp(const String& message) {
-  // Get the number of milliseconds since the device started
-  unsigned long currentTime = millis();
-  unsigned long seconds = currentTime / 1000;
-  unsigned long milliseconds = currentTime % 1000;
-  Serial.println("[" + String(seconds) + "." + String(milliseconds) + "] " + message);
-}
-
-
-/*
-* Set the boot partition back to the selector app for the next boot (wake)
-*/
-bool resetBootPartition() {
-  // Find the factory partition (selector app)
-  const esp_partition_t* factory_partition = esp_partition_find_first(
-    ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_APP_FACTORY, NULL);
-  
-  if (factory_partition != NULL) {
-    logWithTimestamp(String("Found factory partition at address 0x") + String(factory_partition->address, HEX));
-    
-    // Set boot partition
-    esp_err_t err = esp_ota_set_boot_partition(factory_partition);
-    if (err == ESP_OK) {
-      //logWithTimestamp("Boot partition set to selector app");
-      return true;
-    } else {
-      logWithTimestamp(String("Failed to set boot partition, error: ") + String(err));
-      return false;
-    }
-  } else {
-    logWithTimestamp("ERROR: Factory partition not found!");
-    return false;
-  }
-}
-
+bool showLowBatteryWarning;
 
 void displayNumberOfImagesInCache() {
   int cacheSize = storageController.getCacheSize();
-  std::string cacheSizeStr = std::to_string(cacheSize);
-  const char* numberCStr = cacheSizeStr.c_str();
-  displayController.showMessage((String("Images in cache: ") + numberCStr).c_str());
+  char message[32];
+  snprintf(message, sizeof(message), "Images in cache: %d", cacheSize);
+  displayController.showMessage(message);
 }
 
 void populateCache() {
+  TimingProbe probe("populateCache");
   httpController.connectWiFi();
+  scheduleController.syncClock();  //piggyback on the WiFi connection to keep quiet hours accurate
   while (storageController.cacheHasRoomForAnotherImage()) {
-    httpController.fetchImage(image);
+    httpController.fetchImage(image, batteryPolicy.getVoltage());
+    TimingProbe probe("writeImage");
     storageController.writeImageToCache(image);
   }
   httpController.disconnectWiFi();
 }
 
+void enterDeepSleep() {
+  flushLog();
+  printTimingReport(Serial);
+  uint64_t sleepTime = scheduleController.getSleepTime(batteryPolicy.getMinSleepSeconds());
+  esp_sleep_enable_timer_wakeup(sleepTime);  // Time in microseconds
+  esp_deep_sleep_start();                    // Enter deep sleep mode
+}
+
 void goToDeepSleep() {
-  logWithTimestamp("MainController: Going to deep sleep.");
-  esp_sleep_enable_timer_wakeup(deepSleepTime);  // Time in microseconds
+  LOG_INFO("MainController: Going to deep sleep.");
   displayController.powerDown();                 //power down the display
-  esp_deep_sleep_start();                        // Enter deep sleep mode
+  enterDeepSleep();
 }
 
 void setup() {
   Serial.begin(115200);
   delay(100);  //short delay as next line wasn't showing up in Serial Monitor
-  logWithTimestamp("MainController: Waking Up.");
+  if (!wokeFromDeepSleep()) {
+    // Someone pressed refresh, likely with the Serial Monitor open.  Show what happened on the previous wakes.
+    Serial.println("---- log from previous wakes ----");
+    dumpLog(Serial);
+    Serial.println("---------------------------------");
+  }
+  LOG_INFO("MainController: Waking Up.");
   delay(100);  //short as display init is very fast and was clobbering above println
   resetBootPartition();
+  scheduleController.init();
+  batteryPolicy.init(batteryPin,
+                     { lowBatteryVoltage, veryLowBatteryVoltage, critLowBatteryVoltage,
+                       (uint32_t)(lowBatterySleepTime / 1000000ULL), (uint32_t)(veryLowBatterySleepTime / 1000000ULL) },
+                     nvsNamespace);
+  batteryPolicy.readVoltage();
+
+  // Leave the current frame up with a note on it and hibernate until the refresh button is pressed.
+  // Checked before quiet hours, so a critical battery hibernates rather than keep waking on schedule.
+  if (batteryPolicy.getLevel() == BATTERY_CRITICAL) {
+    displayController.init();
+    setPanelContents(appId, 0);
+    displayController.showMessage("Battery critically low. Charge, then press refresh.");
+    displayController.powerDown();
+    batteryPolicy.deepSleep();
+  }
+
+  // Nobody is watching during quiet hours.  Go straight back to sleep without touching the display or flash.
+  // A press of the refresh button still shows the next frame.
+  if (wokeFromDeepSleep() && scheduleController.isQuietTime()) {
+    LOG_INFO("MainController: Quiet hours, going back to sleep.");
+    enterDeepSleep();
+  }
+
   displayController.init();
-  httpController.init(&displayController);
+  setPanelContents(appId, 0);  //anything drawn from here on replaces the weather app's image
+  httpController.init(&displayController, &scheduleController);
   storageController.init(&displayController);
+  showLowBatteryWarning = batteryPolicy.shouldShowWarning();
 
   pinMode(PURGE_CACHE_BUTTON, INPUT_PULLUP);
   if (digitalRead(PURGE_CACHE_BUTTON) == LOW) {
-    logWithTimestamp("MainController: Purging cache because of button press.");
+    LOG_INFO("MainController: Purging cache because of button press.");
     storageController.purgeCache();
   }
 
+  if (wokeFromDeepSleep()) {
+    storageController.discardImages(scheduleController.getFramesToSkip());
+  }
+
   failCount = 0;
-  logWithTimestamp("MainController: Setup complete");
+  LOG_INFO("MainController: Setup complete");
 }
 
 void loop() {
   if (failCount >= 3) {
-    logWithTimestamp("MainController: Too many failures.  Purging cache.");
+    LOG_ERROR("MainController: Too many failures.  Purging cache.");
     storageController.purgeCache();
     failCount = 0;
   }
   if (storageController.cacheHasImage()) {
-    bool gotImage = storageController.getNextImage(image);
+    bool gotImage;
+    {
+      TimingProbe probe("getNextImage");
+      gotImage = storageController.getNextImage(image);
+    }
     if (gotImage) {
-      logWithTimestamp("Displaying image.");
-      displayController.displayImage(image);
+      LOG_INFO("Displaying image.");
+      {
+        TimingProbe probe("displayImage");
+        displayController.displayImage(image);
+      }
+      scheduleController.markFrameShown();
 
-      if (!storageController.cacheHasImage()) {  //repopulate cache if necessary
+      if (!storageController.cacheHasImage() && batteryPolicy.allowWiFi()) {  //repopulate cache if necessary
         populateCache();
       }
 
-      // Check the reset reason
-      esp_reset_reason_t resetReason = esp_reset_reason();
-      if (resetReason == ESP_RST_DEEPSLEEP) {
-        logWithTimestamp("MainController: Woke up from deep sleep, don't show message.");
+      // Check why the selector woke
+      if (wokeFromDeepSleep()) {
+        LOG_DEBUG("MainController: Woke up from deep sleep, don't show message.");
       } else {
-        logWithTimestamp("MainController: Wake up wasn't from deep sleep, show message.");
+        LOG_DEBUG("MainController: Wake up wasn't from deep sleep, show message.");
         displayNumberOfImagesInCache();
         delay(5000);
         displayController.dismissMessage();
       }
 
+      // Drawn once when the battery first goes low, the next frame clears it
+      if (showLowBatteryWarning) {
+        displayController.showMessage("Battery low. Charge soon.");
+      }
+
       goToDeepSleep();
     } else {
       failCount++;
-      logWithTimestamp("MainController: Failed to get image.  Allowing another loop iteration.");
+      LOG_WARN("MainController: Failed to get image.  Allowing another loop iteration.");
     }
-  } else {
+  } else if (batteryPolicy.allowWiFi()) {
     populateCache();
+  } else {
+    // Keep whatever is on screen rather than spend the battery on WiFi
+    LOG_WARN("MainController: Cache empty and battery too low to refill it.");
+    displayController.showMessage("Battery low. Charge to load more frames.");
+    goToDeepSleep();
   }
+  flushLog();  //a failed pass loops again, write out what it logged first
 }
\ No newline at end of file
@@ -0,0 +1,21 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+/*
+  Host stand-in for the parts of the Arduino core that StorageController.cpp and Logger.h use, so the video app's
+  tools can build them on the host.  Put this directory first on the include path.
+*/
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(const uint8_t* buffer, size_t size) = 0;
+};
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef HOST_FS_H
+#define HOST_FS_H
+
+/*
+  Host stand-in for the Arduino core's FS.h, on top of littlefs, see LittleFS.h in this directory.
+
+  Files behave the way the core's VFS files do where StorageController depends on it:
+  - A File is a shared handle, closed when the last copy goes or close is called.
+  - openNextFile opens each entry of a directory in turn, skipping "." and "..", and name is the entry's name alone.
+  - write and read return the bytes transferred, 0 on an error, and errors from close are dropped.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "Arduino.h"
+#include "lfs.h"
+
+#define FILE_READ  "r"
+#define FILE_WRITE "w"
+
+namespace fs {
+
+class FS;
+
+class File {
+public:
+  File() {}
+  size_t write(const uint8_t* buffer, size_t size);
+  size_t read(uint8_t* buffer, size_t size);
+  size_t size() const;
+  void close();
+  bool isDirectory() const;
+  File openNextFile();
+  const char* name() const;
+  operator bool() const;
+
+private:
+  struct Handle;
+  std::shared_ptr<Handle> handle;
+  explicit File(std::shared_ptr<Handle> handle) : handle(handle) {}
+  friend class FS;
+};
+
+class FS {
+public:
+  File open(const char* path, const char* mode = FILE_READ);
+  bool exists(const char* path);
+  bool remove(const char* path);
+  bool rename(const char* pathFrom, const char* pathTo);
+
+protected:
+  lfs_t lfs;
+  bool mounted = false;
+  uint32_t mountCount = 0;  //handles from an earlier mount are dropped without touching littlefs
+  friend class File;
+};
+
+}  // namespace fs
+
+using fs::File;
+using fs::FS;
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef HOST_GXEPD2_EPD_H
+#define HOST_GXEPD2_EPD_H
+
+// Host stand-in, DisplayController.h includes it but the tools only use its declarations
+
+#endif
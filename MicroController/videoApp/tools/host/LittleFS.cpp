@@ -0,0 +1,207 @@
+#include "LittleFS.h"
+
+LittleFSFS LittleFS;
+
+namespace fs {
+
+struct File::Handle {
+  FS* fs;
+  uint32_t mountCount;
+  bool isDirectory;
+  bool open;
+  lfs_file_t file;
+  lfs_dir_t dir;
+  std::string path;
+  std::string name;
+
+  // Closing is only safe on the mount the handle was opened on, anything older is gone with the power
+  bool live() const {
+    return open && fs->mounted && fs->mountCount == mountCount;
+  }
+
+  void close() {
+    if (live()) {
+      if (isDirectory) {
+        lfs_dir_close(&fs->lfs, &dir);
+      } else {
+        lfs_file_close(&fs->lfs, &file);
+      }
+    }
+    open = false;
+  }
+
+  // Only read-only files are left to close here, so no flash is written from a destructor
+  ~Handle() {
+    close();
+  }
+};
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+  if (!*this || handle->isDirectory) {
+    return 0;
+  }
+  lfs_ssize_t written = lfs_file_write(&handle->fs->lfs, &handle->file, buffer, size);
+  return written < 0 ? 0 : written;
+}
+
+size_t File::read(uint8_t* buffer, size_t size) {
+  if (!*this || handle->isDirectory) {
+    return 0;
+  }
+  lfs_ssize_t bytesRead = lfs_file_read(&handle->fs->lfs, &handle->file, buffer, size);
+  return bytesRead < 0 ? 0 : bytesRead;
+}
+
+size_t File::size() const {
+  if (!*this || handle->isDirectory) {
+    return 0;
+  }
+  lfs_soff_t size = lfs_file_size(&handle->fs->lfs, &handle->file);
+  return size < 0 ? 0 : size;
+}
+
+void File::close() {
+  if (handle) {
+    handle->close();
+  }
+}
+
+bool File::isDirectory() const {
+  return *this && handle->isDirectory;
+}
+
+File File::openNextFile() {
+  if (!isDirectory()) {
+    return File();
+  }
+  struct lfs_info info;
+  while (lfs_dir_read(&handle->fs->lfs, &handle->dir, &info) > 0) {
+    if (strcmp(info.name, ".") == 0 || strcmp(info.name, "..") == 0) {
+      continue;
+    }
+    std::string path = handle->path;
+    if (path.empty() || path.back() != '/') {
+      path += '/';
+    }
+    path += info.name;
+    return handle->fs->open(path.c_str(), FILE_READ);
+  }
+  return File();
+}
+
+const char* File::name() const {
+  return handle ? handle->name.c_str() : NULL;
+}
+
+File::operator bool() const {
+  return handle && handle->live();
+}
+
+File FS::open(const char* path, const char* mode) {
+  if (!mounted) {
+    return File();
+  }
+
+  std::shared_ptr<File::Handle> handle = std::make_shared<File::Handle>();
+  handle->fs = this;
+  handle->mountCount = mountCount;
+  handle->path = path;
+  const char* slash = strrchr(path, '/');
+  handle->name = slash && slash[1] != '\0' ? slash + 1 : path;
+
+  struct lfs_info info;
+  if (mode[0] == 'r' && lfs_stat(&lfs, path, &info) == LFS_ERR_OK && info.type == LFS_TYPE_DIR) {
+    handle->isDirectory = true;
+    handle->open = lfs_dir_open(&lfs, &handle->dir, path) == LFS_ERR_OK;
+  } else {
+    int flags = mode[0] == 'w'   ? LFS_O_WRONLY | LFS_O_CREAT | LFS_O_TRUNC
+                : mode[0] == 'a' ? LFS_O_WRONLY | LFS_O_CREAT | LFS_O_APPEND
+                                 : LFS_O_RDONLY;
+    handle->isDirectory = false;
+    handle->open = lfs_file_open(&lfs, &handle->file, path, flags) == LFS_ERR_OK;
+  }
+  return handle->open ? File(handle) : File();
+}
+
+bool FS::exists(const char* path) {
+  struct lfs_info info;
+  return mounted && lfs_stat(&lfs, path, &info) == LFS_ERR_OK;
+}
+
+bool FS::remove(const char* path) {
+  return mounted && lfs_remove(&lfs, path) == LFS_ERR_OK;
+}
+
+bool FS::rename(const char* pathFrom, const char* pathTo) {
+  return mounted && lfs_rename(&lfs, pathFrom, pathTo) == LFS_ERR_OK;
+}
+
+}  // namespace fs
+
+bool LittleFSFS::begin(bool formatOnFail, const char* basePath, uint8_t maxOpenFiles, const char* partitionLabel) {
+  if (mounted) {
+    return true;
+  }
+  if (config == NULL) {
+    return false;
+  }
+  memset(&lfs, 0, sizeof(lfs));
+  int err = lfs_mount(&lfs, config);
+  if (err != LFS_ERR_OK && formatOnFail) {
+    err = lfs_format(&lfs, config);
+    if (err == LFS_ERR_OK) {
+      err = lfs_mount(&lfs, config);
+    }
+  }
+  mounted = err == LFS_ERR_OK;
+  mountCount++;
+  return mounted;
+}
+
+bool LittleFSFS::format() {
+  if (config == NULL) {
+    return false;
+  }
+  bool wasMounted = mounted;
+  if (mounted) {
+    lfs_unmount(&lfs);
+    mounted = false;
+    mountCount++;
+  }
+  int err = lfs_format(&lfs, config);
+  if (err == LFS_ERR_OK && wasMounted) {
+    err = lfs_mount(&lfs, config);
+    mounted = err == LFS_ERR_OK;
+  }
+  return err == LFS_ERR_OK;
+}
+
+size_t LittleFSFS::totalBytes() {
+  return mounted ? (size_t)config->block_size * config->block_count : 0;
+}
+
+size_t LittleFSFS::usedBytes() {
+  if (!mounted) {
+    return 0;
+  }
+  lfs_ssize_t blocks = lfs_fs_size(&lfs);
+  return blocks < 0 ? 0 : (size_t)blocks * config->block_size;
+}
+
+void LittleFSFS::end() {
+  if (mounted) {
+    lfs_unmount(&lfs);
+  }
+  mounted = false;
+  mountCount++;
+}
+
+void LittleFSFS::setConfig(const struct lfs_config* config) {
+  end();
+  this->config = config;
+}
+
+void LittleFSFS::powerCut() {
+  mounted = false;
+  mountCount++;
+}
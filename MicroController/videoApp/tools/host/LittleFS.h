@@ -0,0 +1,33 @@
+#ifndef HOST_LITTLEFS_H
+#define HOST_LITTLEFS_H
+
+/*
+  Host stand-in for the Arduino core's LittleFS, mounting littlefs on whatever flash the tool hands it with
+  setConfig.  begin, format, totalBytes and usedBytes work out the same as esp_littlefs does them for the board:
+  format remounts a mounted filesystem, and the sizes are whole blocks.
+
+  powerCut is for tools that cut the power.  It forgets the mount without writing anything, as a reset would, and
+  the next begin mounts the flash afresh.
+*/
+
+#include "FS.h"
+
+class LittleFSFS : public fs::FS {
+public:
+  bool begin(bool formatOnFail = false, const char* basePath = "/littlefs", uint8_t maxOpenFiles = 10,
+             const char* partitionLabel = "spiffs");
+  bool format();
+  size_t totalBytes();
+  size_t usedBytes();
+  void end();
+
+  void setConfig(const struct lfs_config* config);
+  void powerCut();
+
+private:
+  const struct lfs_config* config = NULL;
+};
+
+extern LittleFSFS LittleFS;
+
+#endif
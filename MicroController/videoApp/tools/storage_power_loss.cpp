@@ -0,0 +1,557 @@
+/*
+  Host test and benchmark of the frame cache under flash faults.
+
+  Builds StorageController.cpp itself, through the FS.h and LittleFS.h stand-ins in tools/host, on littlefs running
+  over a flash image in RAM with the sizes esp_littlefs uses.  Wakes are driven the way setup and loop in main.cpp
+  drive StorageController: mount and remove a leftover /incoming.tmp, show the oldest frame, and refill the cache
+  from the server once it runs dry.  Every frame the server sends is stamped with its number, so a frame that is torn,
+  mixed with another or older than one already shown is caught when it is read back.
+
+  The flash can be made to
+  - lose power at a given program or erase, which then lands only part way, and stop the wake right there;
+  - get one bit wrong at a given program or erase, as a weak cell would;
+  - fail a given program or erase with LFS_ERR_NOSPC, as littlefs does once it runs out of room;
+  - flip a bit in a block while it sits between wakes.
+
+  Two runs:
+    sweep  a cache of five frames, with each of the first three faults at every program and erase of a wake that
+           shows a frame, and of one that shows the last frame and refills the cache
+    soak   SOAK_WAKES wakes of a cache the size of the littlefs partition, with faults of all four kinds at random
+
+  After a fault, the following wakes must show a frame, only ever whole frames in the order they were sent, and leave
+  nothing but frames in the cache.  littlefs keeps no checksum of file data, so a frame corrupted by a bit flip at
+  rest is counted rather than failed.  Also reported, from the wakes without faults: flash time per wake from typical
+  datasheet timings, host time per wake, and write amplification, the bytes programmed per byte of frame cached.
+
+  littlefs is pinned to v2.9.3.  It is built with -fexceptions, because a power cut stops the wake by throwing out of
+  the block device, through littlefs, the way the CPU stops when the power goes.  Build and run from MicroController:
+
+    git clone --depth 1 --branch v2.9.3 https://github.com/littlefs-project/littlefs.git littlefs
+    gcc -O2 -fexceptions -DLFS_NO_DEBUG -DLFS_NO_WARN -DLFS_NO_ERROR -c littlefs/lfs.c littlefs/lfs_util.c
+    g++ -O2 -std=gnu++17 -DLOG_LEVEL=LOG_LEVEL_NONE -I videoApp/tools/host -I videoApp/include \
+        -I common/FirmwareCore/src -I littlefs \
+        videoApp/tools/storage_power_loss.cpp videoApp/tools/host/LittleFS.cpp videoApp/src/StorageController.cpp \
+        lfs.o lfs_util.o -o storage_power_loss && ./storage_power_loss
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "lfs.h"
+#include <LittleFS.h>
+#include "Config.h"
+#include "DisplayController.h"
+#include "StorageController.h"
+
+#define INCOMING_FILENAME "/incoming.tmp"  //as in StorageController.cpp
+#define BLOCK_SIZE        4096
+#define SWEEP_BLOCKS      64               //room for five frames
+#define PARTITION_BLOCKS  (0x9D0000 / BLOCK_SIZE)  //the littlefs partition in ThomPartitions.csv
+#define SOAK_WAKES        3000
+#define FAULT_ODDS        10               //one wake in this many gets a fault in the soak
+#define REST_FLIP_ODDS    50               //and a bit flips at rest before one in this many
+#define RECOVERY_WAKES    3                //wakes without faults checked after each fault
+#define MAX_LOOP_PASSES   10               //passes of loop() before a wake counts as stuck
+
+// Typical times of a 16 MB SPI NOR flash such as the W25Q128JV, read at 40 MHz on two lines
+#define PAGE_SIZE         256
+#define PAGE_PROGRAM_NS   400000
+#define SECTOR_ERASE_NS   45000000
+#define READ_NS_PER_BYTE  100
+
+enum FaultKind { FAULT_NONE, FAULT_POWER_CUT, FAULT_BAD_BIT, FAULT_NOSPC, NUM_FAULT_KINDS };
+static const char* FAULT_NAMES[] = { "none", "power cut", "bad bit", "ENOSPC" };
+
+// Thrown out of the block device when the power goes, so nothing after the cut runs
+struct PowerCut {};
+
+struct Flash {
+  std::vector<uint8_t> data;
+  std::vector<uint32_t> eraseCounts;
+  std::vector<bool> flippedAtRest;  //a bit flipped at rest since the block was last erased
+  std::mt19937 rng{30};
+
+  FaultKind fault = FAULT_NONE;
+  long faultAt = -1;   //the program or erase the fault hits, counted from the start of the wake
+  bool faultHit = false;
+  long ops = 0;        //programs and erases since the start of the wake
+
+  uint64_t bytesRead = 0;
+  uint64_t bytesProgrammed = 0;
+  uint64_t erases = 0;
+  uint64_t flashNs = 0;
+
+  explicit Flash(lfs_size_t blockCount)
+      : data(blockCount * BLOCK_SIZE, 0xff), eraseCounts(blockCount, 0), flippedAtRest(blockCount, false) {}
+};
+
+static bool faultHere(Flash* flash, FaultKind kind) {
+  return flash->fault == kind && flash->ops == flash->faultAt;
+}
+
+static int flashRead(const struct lfs_config* c, lfs_block_t block, lfs_off_t off, void* buffer, lfs_size_t size) {
+  Flash* flash = (Flash*)c->context;
+  memcpy(buffer, &flash->data[block * c->block_size + off], size);
+  flash->bytesRead += size;
+  flash->flashNs += (uint64_t)size * READ_NS_PER_BYTE;
+  return LFS_ERR_OK;
+}
+
+static int flashProg(const struct lfs_config* c, lfs_block_t block, lfs_off_t off, const void* buffer, lfs_size_t size) {
+  Flash* flash = (Flash*)c->context;
+  uint8_t* cells = &flash->data[block * c->block_size + off];
+  bool powerCut = faultHere(flash, FAULT_POWER_CUT);
+  bool badBit = faultHere(flash, FAULT_BAD_BIT);
+  if (faultHere(flash, FAULT_NOSPC)) {
+    flash->faultHit = true;
+    flash->ops++;
+    return LFS_ERR_NOSPC;
+  }
+  flash->ops++;
+
+  lfs_size_t landed = powerCut ? flash->rng() % size : size;
+  memcpy(cells, buffer, landed);
+  if (badBit) {
+    cells[flash->rng() % size] ^= 1 << (flash->rng() % 8);
+  }
+  flash->bytesProgrammed += landed;
+  flash->flashNs += (uint64_t)((off % PAGE_SIZE + size + PAGE_SIZE - 1) / PAGE_SIZE) * PAGE_PROGRAM_NS;
+
+  if (powerCut || badBit) {
+    flash->faultHit = true;
+  }
+  if (powerCut) {
+    LittleFS.powerCut();
+    throw PowerCut();
+  }
+  return LFS_ERR_OK;
+}
+
+static int flashErase(const struct lfs_config* c, lfs_block_t block) {
+  Flash* flash = (Flash*)c->context;
+  uint8_t* cells = &flash->data[block * c->block_size];
+  bool powerCut = faultHere(flash, FAULT_POWER_CUT);
+  bool badBit = faultHere(flash, FAULT_BAD_BIT);
+  if (faultHere(flash, FAULT_NOSPC)) {
+    flash->faultHit = true;
+    flash->ops++;
+    return LFS_ERR_NOSPC;
+  }
+  flash->ops++;
+
+  memset(cells, 0xff, powerCut ? flash->rng() % c->block_size : c->block_size);
+  if (badBit) {
+    cells[flash->rng() % c->block_size] &= ~(1 << (flash->rng() % 8));  //a cell that won't erase
+  }
+  flash->eraseCounts[block]++;
+  flash->flippedAtRest[block] = false;
+  flash->erases++;
+  flash->flashNs += SECTOR_ERASE_NS;
+
+  if (powerCut || badBit) {
+    flash->faultHit = true;
+  }
+  if (powerCut) {
+    LittleFS.powerCut();
+    throw PowerCut();
+  }
+  return LFS_ERR_OK;
+}
+
+static int flashSync(const struct lfs_config* c) {
+  return LFS_ERR_OK;
+}
+
+// The sizes esp_littlefs uses by default
+static struct lfs_config makeConfig(Flash* flash) {
+  struct lfs_config config;
+  memset(&config, 0, sizeof(config));
+  config.context = flash;
+  config.read = flashRead;
+  config.prog = flashProg;
+  config.erase = flashErase;
+  config.sync = flashSync;
+  config.read_size = 128;
+  config.prog_size = 128;
+  config.block_size = BLOCK_SIZE;
+  config.block_count = flash->eraseCounts.size();
+  config.block_cycles = 512;
+  config.cache_size = 512;
+  config.lookahead_size = 128;
+  return config;
+}
+
+// StorageController only shows messages, nothing is drawn on the host
+void DisplayController::showMessage(const char* message) {}
+
+extern int cacheFileNumber;  //StorageController.cpp, in RAM, so it starts over each wake
+
+static StorageController storageController;
+static DisplayController displayController;
+static uint8_t image[imageBytes];
+
+/*
+  What the server has sent and the display has shown so far.  Saved and restored with the flash, as together they
+  are the state of the display.
+*/
+struct Playback {
+  uint32_t nextFrame = 0;  //number of the next frame the server sends
+  long lastShown = -1;
+  bool lastWakeFaulted = false;
+};
+
+static Playback playback;
+
+// Each byte depends on the frame number and its offset, so torn and mixed frames don't pass for whole ones
+static uint8_t frameByte(uint32_t number, int offset) {
+  return (uint8_t)(number * 131 + offset * 7 + (offset >> 8));
+}
+
+static void stampFrame(uint8_t* frame, uint32_t number) {
+  memcpy(frame, &number, sizeof(number));
+  for (int i = sizeof(number); i < imageBytes; i++) {
+    frame[i] = frameByte(number, i);
+  }
+}
+
+static bool frameIntact(const uint8_t* frame, uint32_t* number) {
+  memcpy(number, frame, sizeof(*number));
+  if (*number >= playback.nextFrame) {
+    return false;
+  }
+  for (int i = sizeof(*number); i < imageBytes; i++) {
+    if (frame[i] != frameByte(*number, i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+struct WakeResult {
+  bool powerCut;
+  bool stuck;
+  bool shown;
+  bool intact;
+  uint32_t frame;
+  int framesSent;
+  uint64_t flashNs;
+  uint64_t hostNs;
+  uint64_t bytesProgrammed;
+  uint64_t erases;
+};
+
+static WakeResult* wakeResult;
+
+// populateCache in main.cpp, with the server sending stamped frames.  Gives up on a refill that never fills the cache.
+static void populateCache(int maxFrames) {
+  while (storageController.cacheHasRoomForAnotherImage()) {
+    if (wakeResult->framesSent >= maxFrames) {
+      wakeResult->stuck = true;
+      return;
+    }
+    stampFrame(image, playback.nextFrame++);
+    wakeResult->framesSent++;
+    storageController.writeImageToCache(image);
+  }
+}
+
+/*
+  One wake, from the reset to deep sleep: setup and then loop in main.cpp, for the parts that use the cache.
+*/
+static WakeResult wake(Flash& flash) {
+  WakeResult result = {};
+  wakeResult = &result;
+  int maxFrames = 2 * flash.eraseCounts.size() * BLOCK_SIZE / imageBytes;
+  uint64_t flashNs = flash.flashNs;
+  uint64_t bytesProgrammed = flash.bytesProgrammed;
+  uint64_t erases = flash.erases;
+  auto start = std::chrono::steady_clock::now();
+
+  LittleFS.powerCut();  //the reset, nothing in RAM survives it
+  cacheFileNumber = -1;
+  flash.ops = 0;
+  flash.faultHit = false;
+  try {
+    storageController.init(&displayController);
+    int failCount = 0;
+    for (int pass = 0; pass < MAX_LOOP_PASSES && !result.shown && !result.stuck; pass++) {
+      if (failCount >= 3) {
+        storageController.purgeCache();
+        failCount = 0;
+      }
+      if (storageController.cacheHasImage()) {
+        if (storageController.getNextImage(image)) {
+          result.shown = true;
+          result.intact = frameIntact(image, &result.frame);
+          if (!storageController.cacheHasImage()) {
+            populateCache(maxFrames);
+          }
+        } else {
+          failCount++;
+        }
+      } else {
+        populateCache(maxFrames);
+      }
+    }
+    result.stuck = result.stuck || !result.shown;
+  } catch (const PowerCut&) {
+    result.powerCut = true;
+  }
+
+  result.hostNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+  result.flashNs = flash.flashNs - flashNs;
+  result.bytesProgrammed = flash.bytesProgrammed - bytesProgrammed;
+  result.erases = flash.erases - erases;
+  return result;
+}
+
+// Returns the number of frames in the cache, or -1 if anything else is in it
+static int countFrames() {
+  File root = LittleFS.open("/");
+  if (!root) {
+    return -1;
+  }
+  int frames = 0;
+  File file = root.openNextFile();
+  while (file) {
+    int number;
+    int length = 0;
+    if (sscanf(file.name(), "image%d.bmp%n", &number, &length) != 1 || file.name()[length] != '\0') {
+      return -1;
+    }
+    frames++;
+    file = root.openNextFile();
+  }
+  return frames;
+}
+
+/*
+  Checks what a wake showed against what came before.  A frame may be shown twice when the power went before the
+  wake that first showed it could pop it, but never out of order.  Returns the first problem, or NULL.
+*/
+static const char* checkWake(const WakeResult& result, bool rested) {
+  if (result.stuck) {
+    return "a wake didn't show a frame";
+  }
+  if (result.shown) {
+    if (!result.intact) {
+      return rested ? NULL : "a torn or mixed up frame was shown";
+    }
+    if ((long)result.frame < playback.lastShown
+        || ((long)result.frame == playback.lastShown && !playback.lastWakeFaulted)) {
+      return "an older frame was shown again";
+    }
+    playback.lastShown = result.frame;
+  }
+  if (!result.powerCut && (LittleFS.exists(INCOMING_FILENAME) || countFrames() < 0)) {
+    return "something other than frames was left in the cache";
+  }
+  return NULL;
+}
+
+/*
+  Wakes with the flash working again after a fault, checking each.  Returns the first problem, or NULL.
+*/
+static const char* recover(Flash& flash, bool rested) {
+  flash.fault = FAULT_NONE;
+  for (int i = 0; i < RECOVERY_WAKES; i++) {
+    WakeResult result = wake(flash);
+    const char* problem = checkWake(result, rested);
+    playback.lastWakeFaulted = false;
+    if (!problem && !result.shown) {
+      problem = "the cache didn't recover";
+    }
+    if (problem) {
+      return problem;
+    }
+  }
+  return NULL;
+}
+
+static long failures = 0;
+
+static void reportFailure(const char* run, FaultKind kind, long at, const char* problem) {
+  if (++failures <= 20) {
+    printf("FAIL: %s, %s at %ld: %s\n", run, FAULT_NAMES[kind], at, problem);
+  }
+}
+
+/*
+  Runs the wake from base with each fault in turn at every program and erase it makes.
+*/
+static void sweep(const char* run, const Flash& base, Playback basePlayback) {
+  Flash counted = base;
+  struct lfs_config config = makeConfig(&counted);
+  LittleFS.setConfig(&config);
+  playback = basePlayback;
+  wake(counted);
+  long ops = counted.ops;
+
+  for (int kind = FAULT_POWER_CUT; kind < NUM_FAULT_KINDS; kind++) {
+    long failed = 0;
+    for (long at = 0; at < ops; at++) {
+      Flash flash = base;
+      config = makeConfig(&flash);
+      LittleFS.setConfig(&config);
+      playback = basePlayback;
+      flash.fault = (FaultKind)kind;
+      flash.faultAt = at;
+
+      WakeResult result = wake(flash);
+      const char* problem = checkWake(result, false);
+      playback.lastWakeFaulted = true;
+      if (!problem) {
+        problem = recover(flash, false);
+      }
+      if (problem) {
+        reportFailure(run, (FaultKind)kind, at, problem);
+        failed++;
+      }
+    }
+    printf("%-18s %-10s at each of %5ld programs and erases: %ld failed\n", run, FAULT_NAMES[kind], ops, failed);
+  }
+}
+
+static void runSweeps() {
+  Flash flash(SWEEP_BLOCKS);
+  struct lfs_config config = makeConfig(&flash);
+  LittleFS.setConfig(&config);
+  playback = Playback();
+
+  // The first wake fills the cache and shows a frame, then every wake shows one until the last is left
+  int frames;
+  do {
+    WakeResult result = wake(flash);
+    if (result.stuck || !result.shown) {
+      printf("FAIL: the cache doesn't fill without faults\n");
+      failures++;
+      return;
+    }
+    playback.lastShown = result.frame;
+    frames = countFrames();
+    if (frames == 2) {
+      sweep("sweep, show wake", flash, playback);
+      LittleFS.setConfig(&config);
+    }
+  } while (frames > 1);
+  sweep("sweep, refill wake", flash, playback);
+}
+
+struct WakeTotals {
+  long wakes = 0;
+  uint64_t flashNs = 0;
+  uint64_t hostNs = 0;
+  uint64_t bytesProgrammed = 0;
+  uint64_t erases = 0;
+  long frames = 0;
+
+  void add(const WakeResult& result) {
+    wakes++;
+    flashNs += result.flashNs;
+    hostNs += result.hostNs;
+    bytesProgrammed += result.bytesProgrammed;
+    erases += result.erases;
+    frames += result.framesSent;
+  }
+};
+
+static void runSoak() {
+  Flash flash(PARTITION_BLOCKS);
+  struct lfs_config config = makeConfig(&flash);
+  LittleFS.setConfig(&config);
+  playback = Playback();
+  std::mt19937 rng(300);
+
+  long faultsHit[NUM_FAULT_KINDS] = {};
+  long restFlips = 0;
+  long corruptAfterFlip = 0;
+  long lostCaches = 0;
+  long framesShown = 0;
+  WakeTotals showWakes;
+  WakeTotals refillWakes;
+  long lastOps = 0;
+  int framesBefore = 0;
+
+  for (long w = 0; w < SOAK_WAKES; w++) {
+    if (w > 0 && rng() % REST_FLIP_ODDS == 0) {
+      size_t block = rng() % flash.eraseCounts.size();
+      flash.data[block * BLOCK_SIZE + rng() % BLOCK_SIZE] ^= 1 << (rng() % 8);
+      flash.flippedAtRest[block] = true;
+      restFlips++;
+    }
+    bool rested = false;
+    for (size_t block = 0; block < flash.flippedAtRest.size() && !rested; block++) {
+      rested = flash.flippedAtRest[block];
+    }
+
+    flash.fault = FAULT_NONE;
+    if (w > 0 && rng() % FAULT_ODDS == 0) {
+      flash.fault = (FaultKind)(FAULT_POWER_CUT + rng() % (NUM_FAULT_KINDS - FAULT_POWER_CUT));
+      flash.faultAt = rng() % (lastOps + 1);
+    }
+    FaultKind fault = flash.fault;
+
+    WakeResult result = wake(flash);
+    bool faulted = flash.faultHit;
+    const char* problem = checkWake(result, rested);
+    playback.lastWakeFaulted = faulted;
+    if (problem) {
+      reportFailure("soak", faulted ? fault : FAULT_NONE, w, problem);
+    }
+    if (result.shown && !result.intact && rested) {
+      corruptAfterFlip++;
+    }
+    framesShown += result.shown;
+
+    if (faulted) {
+      faultsHit[fault]++;
+    } else if (w > 0) {
+      (result.framesSent > 0 ? refillWakes : showWakes).add(result);
+      lastOps = flash.ops;
+    }
+
+    int frames = result.powerCut ? framesBefore : countFrames();
+    if (result.framesSent > 0 && framesBefore > 1) {
+      lostCaches++;  //refilled before the cache ran dry, the frames in it were lost
+    }
+    framesBefore = frames;
+  }
+
+  uint32_t maxWear = 0;
+  uint64_t totalWear = 0;
+  for (uint32_t wear : flash.eraseCounts) {
+    maxWear = wear > maxWear ? wear : maxWear;
+    totalWear += wear;
+  }
+
+  printf("soak: %d wakes of a %d block cache, %ld frames shown\n", SOAK_WAKES, PARTITION_BLOCKS, framesShown);
+  printf("  faults hit: %ld power cuts, %ld bad bits, %ld ENOSPC; %ld bit flips at rest\n",
+         faultsHit[FAULT_POWER_CUT], faultsHit[FAULT_BAD_BIT], faultsHit[FAULT_NOSPC], restFlips);
+  printf("  corrupt frames shown after a bit flip at rest: %ld, caches lost before they ran dry: %ld\n",
+         corruptAfterFlip, lostCaches);
+  if (showWakes.wakes > 0) {
+    printf("  show wake:   %ld wakes, flash %.1f ms, host %.1f us each\n", showWakes.wakes,
+           showWakes.flashNs / 1e6 / showWakes.wakes, showWakes.hostNs / 1e3 / showWakes.wakes);
+  }
+  if (refillWakes.wakes > 0 && refillWakes.frames > 0) {
+    printf("  refill wake: %ld wakes, %.1f frames, flash %.2f s, host %.1f ms each, flash %.1f ms a frame\n",
+           refillWakes.wakes, (double)refillWakes.frames / refillWakes.wakes,
+           refillWakes.flashNs / 1e9 / refillWakes.wakes, refillWakes.hostNs / 1e6 / refillWakes.wakes,
+           refillWakes.flashNs / 1e6 / refillWakes.frames);
+    printf("  write amplification: %.3f bytes programmed per frame byte, %.2f erases per frame\n",
+           (double)refillWakes.bytesProgrammed / ((double)refillWakes.frames * imageBytes),
+           (double)refillWakes.erases / refillWakes.frames);
+  }
+  printf("  block wear: %u erases at most, %.1f on average\n", maxWear, (double)totalWear / flash.eraseCounts.size());
+}
+
+int main() {
+  runSweeps();
+  runSoak();
+  printf("%ld failures\n", failures);
+  return failures ? 1 : 0;
+}
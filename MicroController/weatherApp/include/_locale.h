@@ -18,7 +18,6 @@
 #ifndef ___LOCALE_H__
 #define ___LOCALE_H__
 
-#include <vector>
 #include <Arduino.h>
 #include <aqi.h>
 
@@ -101,6 +100,7 @@ extern const char *TXT_UNITS_PRECIP_INCHES;
 // Title Case
 extern const char *TXT_LOW_BATTERY;
 extern const char *TXT_NETWORK_NOT_AVAILABLE;
+extern const char *TXT_OFFLINE;
 extern const char *TXT_TIME_SYNCHRONIZATION_FAILED;
 extern const char *TXT_WIFI_CONNECTION_FAILED;
 // First Word Capitalized
@@ -121,38 +121,16 @@ extern const char *TXT_READ_FAILED;
 extern const char *TXT_FAILED_TO_GET_TIME;
 extern const char *TXT_HIBERNATING_INDEFINITELY_NOTICE;
 extern const char *TXT_REFERENCING_OLDER_TIME_NOTICE;
+extern const char *TXT_USING_CACHED_WEATHER;
 extern const char *TXT_WAITING_FOR_SNTP;
 extern const char *TXT_LOW_BATTERY_VOLTAGE;
 extern const char *TXT_VERY_LOW_BATTERY_VOLTAGE;
 extern const char *TXT_CRIT_LOW_BATTERY_VOLTAGE;
 
 // ALERTS
-extern const std::vector<String> ALERT_URGENCY;
-// ALERT TERMINOLOGY
-extern const std::vector<String> TERM_SMOG;
-extern const std::vector<String> TERM_SMOKE;
-extern const std::vector<String> TERM_FOG;
-extern const std::vector<String> TERM_METEOR;
-extern const std::vector<String> TERM_NUCLEAR;
-extern const std::vector<String> TERM_BIOHAZARD;
-extern const std::vector<String> TERM_EARTHQUAKE;
-extern const std::vector<String> TERM_FIRE;
-extern const std::vector<String> TERM_HEAT;
-extern const std::vector<String> TERM_WINTER;
-extern const std::vector<String> TERM_TSUNAMI;
-extern const std::vector<String> TERM_LIGHTNING;
-extern const std::vector<String> TERM_SANDSTORM;
-extern const std::vector<String> TERM_FLOOD;
-extern const std::vector<String> TERM_VOLCANO;
-extern const std::vector<String> TERM_AIR_QUALITY;
-extern const std::vector<String> TERM_TORNADO;
-extern const std::vector<String> TERM_SMALL_CRAFT_ADVISORY;
-extern const std::vector<String> TERM_GALE_WARNING;
-extern const std::vector<String> TERM_STORM_WARNING;
-extern const std::vector<String> TERM_HURRICANE_WARNING;
-extern const std::vector<String> TERM_HURRICANE;
-extern const std::vector<String> TERM_DUST;
-extern const std::vector<String> TERM_STRONG_WIND;
+// ALERT_URGENCY and the TERM_* lists of alert terminology are constexpr arrays
+// in the locale source, read only when building: tools/gen_alert_terms.py
+// compiles them into the automaton in alert_automaton.h that matches them.
 
 // AIR QUALITY INDEX
 extern "C" {
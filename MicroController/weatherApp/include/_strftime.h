@@ -18,10 +18,44 @@
 #ifndef ___STRFTIME_H__
 #define ___STRFTIME_H__
 
+#include <cstdint>
 #include <time.h>
 
+// The most conversions and runs of literal text a compiled format can hold.
+#define STRFTIME_MAX_OPS 48
+
+/*
+ * One step of a compiled format: a run of literal text, or a conversion like
+ * %H. Conversions that stand for other formats, like %x or %T, are compiled
+ * into the steps of those formats, so are never a single step.
+ */
+typedef struct strftime_op
+{
+  const char *text; // literal text, points into the format string
+  uint16_t len;     // length of text, 0 for a conversion
+  char     conv;    // conversion character, e.g. 'H' for %H
+  char     pad;     // POSIX 2008 '0' pad, or '\0'
+  char     flag;    // POSIX 2008 '+' flag, or '\0'
+  uint8_t  fw;      // POSIX 2008 field width, 0 if none
+} strftime_op_t;
+
+/*
+ * A format string parsed once by _strftime_compile, so it can be formatted
+ * again and again by _strftime_run without being parsed again. The format
+ * string, and the locale formats it refers to, must outlive it.
+ */
+typedef struct strftime_program
+{
+  uint8_t numOps;
+  bool    noConv; // format has no '%' at all
+  strftime_op_t ops[STRFTIME_MAX_OPS];
+} strftime_program_t;
+
 size_t _strftime(char *s, size_t maxsize, const char *format,
                  const struct tm *timeptr);
+bool _strftime_compile(strftime_program_t *prog, const char *format);
+size_t _strftime_run(char *s, size_t maxsize, const strftime_program_t *prog,
+                     const struct tm *timeptr);
 
 #endif
 
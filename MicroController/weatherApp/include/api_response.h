@@ -19,7 +19,7 @@
 #define __API_RESPONSE_H__
 
 #include <cstdint>
-#include <vector>
+#include <type_traits>
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include <HTTPClient.h>
@@ -31,12 +31,40 @@
 #define OWM_NUM_ALERTS         8 // OpenWeatherMaps does not specify a limit, but if you need more alerts you are probably doomed.
 #define OWM_NUM_AIR_POLLUTION 24 // Depending on AQI scale, hourly concentrations will need to be averaged over a period of 1h to 24h
 
+#define OWM_TEXT_ARENA_SIZE  512 // weather main/description strings, each distinct string is stored once
+#define OWM_TIMEZONE_SIZE     48
+#define OWM_ALERT_EVENT_SIZE  96
+#define OWM_ALERT_TAGS_SIZE   32
+
+// binary copy of both responses served by HTTPServer, see deserializeWeatherBlob
+#define OWM_BLOB_MAGIC   "OWMB"
+#define OWM_BLOB_VERSION 1
+
+/*
+ * Weather icon id. OpenWeatherMap sends these as "01d", "10n", etc. The
+ * number is kept in the upper bits and the low bit is set for night icons.
+ */
+#define OWM_ICON(num, night) (((num) << 1) | (night))
+typedef enum owm_icon : uint16_t
+{
+  OWM_ICON_UNKNOWN = 0,
+  OWM_ICON_01D = OWM_ICON( 1, 0), OWM_ICON_01N = OWM_ICON( 1, 1), // clear sky
+  OWM_ICON_02D = OWM_ICON( 2, 0), OWM_ICON_02N = OWM_ICON( 2, 1), // few clouds
+  OWM_ICON_03D = OWM_ICON( 3, 0), OWM_ICON_03N = OWM_ICON( 3, 1), // scattered clouds
+  OWM_ICON_04D = OWM_ICON( 4, 0), OWM_ICON_04N = OWM_ICON( 4, 1), // broken clouds
+  OWM_ICON_09D = OWM_ICON( 9, 0), OWM_ICON_09N = OWM_ICON( 9, 1), // shower rain
+  OWM_ICON_10D = OWM_ICON(10, 0), OWM_ICON_10N = OWM_ICON(10, 1), // rain
+  OWM_ICON_11D = OWM_ICON(11, 0), OWM_ICON_11N = OWM_ICON(11, 1), // thunderstorm
+  OWM_ICON_13D = OWM_ICON(13, 0), OWM_ICON_13N = OWM_ICON(13, 1), // snow
+  OWM_ICON_50D = OWM_ICON(50, 0), OWM_ICON_50N = OWM_ICON(50, 1), // mist
+} owm_icon_t;
+
 typedef struct owm_weather
 {
-  int     id;               // Weather condition id
-  String  main;             // Group of weather parameters (Rain, Snow, Extreme etc.)
-  String  description;      // Weather condition within the group (full list of weather conditions). Get the output in your language
-  String  icon;             // Weather icon id.
+  int        id;            // Weather condition id
+  uint16_t   main;          // Group of weather parameters (Rain, Snow, Extreme etc.) Offset into owm_resp_onecall_t::text
+  uint16_t   description;   // Weather condition within the group (full list of weather conditions). Get the output in your language. Offset into owm_resp_onecall_t::text
+  owm_icon_t icon;          // Weather icon id.
 } owm_weather_t;
 
 /*
@@ -119,6 +147,31 @@ typedef struct owm_hourly
   owm_weather_t         weather;
 } owm_hourly_t;
 
+/*
+ * The hourly forecast, one array per field of owm_hourly_t, so code that reads
+ * one field of every hour, like the outlook graph, reads it contiguously.
+ * owmHour gathers the fields of one hour into an owm_hourly_t.
+ */
+typedef struct owm_hourly_series
+{
+  int64_t dt[OWM_NUM_HOURLY];         // Time of the forecasted data, unix, UTC
+  float   temp[OWM_NUM_HOURLY];       // Temperature, kelvin
+  float   feels_like[OWM_NUM_HOURLY]; // Perceived temperature, kelvin
+  int     pressure[OWM_NUM_HOURLY];   // Atmospheric pressure on the sea level, hPa
+  int     humidity[OWM_NUM_HOURLY];   // Humidity, %
+  float   dew_point[OWM_NUM_HOURLY];  // Dew point, kelvin
+  int     clouds[OWM_NUM_HOURLY];     // Cloudiness, %
+  float   uvi[OWM_NUM_HOURLY];        // UV index
+  int     visibility[OWM_NUM_HOURLY]; // Average visibility, metres
+  float   wind_speed[OWM_NUM_HOURLY]; // Wind speed, metre/sec
+  float   wind_gust[OWM_NUM_HOURLY];  // (where available) Wind gust, metre/sec
+  int     wind_deg[OWM_NUM_HOURLY];   // Wind direction, degrees (meteorological)
+  float   pop[OWM_NUM_HOURLY];        // Probability of precipitation, 0 - 1
+  float   rain_1h[OWM_NUM_HOURLY];    // (where available) Rain volume for the hour, mm
+  float   snow_1h[OWM_NUM_HOURLY];    // (where available) Snow volume for the hour, mm
+  owm_weather_t weather[OWM_NUM_HOURLY];
+} owm_hourly_series_t;
+
 /*
  * Daily forecast weather data API response
  */
@@ -149,15 +202,16 @@ typedef struct owm_daily
 
 /*
  * National weather alerts data from major national weather warning systems
+ *
+ * sender_name and description are not kept, they can be very long and are
+ * never displayed.
  */
 typedef struct owm_alerts
 {
-  String  sender_name;      // Name of the alert source.
-  String  event;            // Alert event name
+  char    event[OWM_ALERT_EVENT_SIZE]; // Alert event name
   int64_t start;            // Date and time of the start of the alert, Unix, UTC
   int64_t end;              // Date and time of the end of the alert, Unix, UTC
-  String  description;      // Description of the alert
-  String  tags;             // Type of severe weather
+  char    tags[OWM_ALERT_TAGS_SIZE];   // Type of severe weather (first tag only)
 } owm_alerts_t;
 
 /*
@@ -169,16 +223,27 @@ typedef struct owm_resp_onecall
 {
   float   lat;              // Geographical coordinates of the location (latitude)
   float   lon;              // Geographical coordinates of the location (longitude)
-  String  timezone;         // Timezone name for the requested location
+  char    timezone[OWM_TIMEZONE_SIZE]; // Timezone name for the requested location
   int     timezone_offset;  // Shift in seconds from UTC
   owm_current_t   current;
   // owm_minutely_t  minutely[OWM_NUM_MINUTELY];
 
-  owm_hourly_t    hourly[OWM_NUM_HOURLY];
+  owm_hourly_series_t hourly;
   owm_daily_t     daily[OWM_NUM_DAILY];
-  std::vector<owm_alerts_t> alerts;
+  int             num_alerts;
+  owm_alerts_t    alerts[OWM_NUM_ALERTS];
+
+  // Null-terminated strings referred to by owm_weather_t. Offset 0 is always
+  // the empty string.
+  uint16_t        text_len;
+  char            text[OWM_TEXT_ARENA_SIZE];
 } owm_resp_onecall_t;
 
+// The parsed response is one flat block with no pointers into the heap, so it
+// can be copied as-is to RTC memory or flash and read back later.
+static_assert(std::is_trivially_copyable<owm_resp_onecall_t>::value,
+              "owm_resp_onecall_t must stay plain data");
+
 /*
  * Coordinates from the specified location (latitude, longitude)
  */
@@ -211,10 +276,21 @@ typedef struct owm_resp_air_pollution
   int64_t          dt[OWM_NUM_AIR_POLLUTION];         // Date and time, Unix, UTC;
 } owm_resp_air_pollution_t;
 
+static_assert(std::is_trivially_copyable<owm_resp_air_pollution_t>::value,
+              "owm_resp_air_pollution_t must stay plain data");
+
+const char *owmText(const owm_resp_onecall_t &r, uint16_t offset);
+uint16_t owmAddText(owm_resp_onecall_t &r, const char *s);
+owm_hourly_t owmHour(const owm_hourly_series_t &h, int i);
+void owmSetHour(owm_hourly_series_t &h, int i, const owm_hourly_t &hour);
+
 DeserializationError deserializeOneCall(WiFiClient &json,
                                         owm_resp_onecall_t &r);
 DeserializationError deserializeAirQuality(WiFiClient &json,
                                            owm_resp_air_pollution_t &r);
+DeserializationError deserializeWeatherBlob(WiFiClient &stream,
+                                            owm_resp_onecall_t &onecall,
+                                            owm_resp_air_pollution_t &air_pollution);
 
 
 #endif
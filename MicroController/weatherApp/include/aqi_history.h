@@ -0,0 +1,63 @@
+/* AQI history declarations for esp32-weather-epd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __AQI_HISTORY_H__
+#define __AQI_HISTORY_H__
+
+#include <cstdint>
+#include <aqi.h>
+#include "api_response.h"
+
+// The longest averaging period of any AQI scale, in hours.
+#define AQI_HISTORY_HOURS OWM_NUM_AIR_POLLUTION
+
+typedef enum aqi_pollutant
+{
+  AQI_CO,
+  AQI_NH3,
+  AQI_NO,
+  AQI_NO2,
+  AQI_O3,
+  AQI_SO2,
+  AQI_PM10,
+  AQI_PM2_5,
+  AQI_NUM_POLLUTANTS
+} aqi_pollutant_t;
+
+/*
+ * Hourly pollutant concentrations, kept as prefix sums so the average over any
+ * of the last AQI_HISTORY_HOURS hours is one subtraction.
+ *
+ * sum[p][k % (AQI_HISTORY_HOURS + 1)] is the sum of the first k hours of
+ * pollutant p, for the last AQI_HISTORY_HOURS + 1 values of k. Sums are taken
+ * relative to an older hour every AQI_HISTORY_HOURS hours, so they never grow
+ * large enough to lose the precision of a single hour.
+ */
+typedef struct aqi_history
+{
+  int64_t  newest;          // Hour of the newest sample, Unix, UTC, 0 if none
+  uint32_t count;           // Hours appended since the history was started
+  float    sum[AQI_NUM_POLLUTANTS][AQI_HISTORY_HOURS + 1];
+} aqi_history_t;
+
+void resetAqiHistory(aqi_history_t &h);
+void appendAqiSample(aqi_history_t &h, int64_t dt,
+                     const float conc[AQI_NUM_POLLUTANTS]);
+int updateAqiHistory(aqi_history_t &h, const owm_resp_air_pollution_t &p);
+float aqiWindowAvg(const aqi_history_t &h, aqi_pollutant_t p, int hours);
+int calcAqi(aqi_scale_t scale, const aqi_history_t &h);
+
+#endif
@@ -21,9 +21,8 @@
 #include <Arduino.h>
 #include "api_response.h"
 #include "config.h"
-#ifdef USE_HTTP
-  #include <WiFiClient.h>
-#else
+#include <WiFiClient.h>
+#ifndef USE_HTTP
   #include <WiFiClientSecure.h>
 #endif
 
@@ -32,11 +31,19 @@ void killWiFi();
 bool waitForSNTPSync(tm *timeInfo);
 bool printLocalTime(tm *timeInfo);
 #ifdef USE_HTTP
-  int getOWMonecall(WiFiClient &client, owm_resp_onecall_t &r);
-  int getOWMairpollution(WiFiClient &client, owm_resp_air_pollution_t &r);
+  int getOWMonecall(WiFiClient &client, owm_resp_onecall_t &r,
+                    bool includeDaily);
+  int getOWMairpollution(WiFiClient &client, owm_resp_air_pollution_t &r,
+                         int64_t start);
 #else
-  int getOWMonecall(WiFiClientSecure &client, owm_resp_onecall_t &r);
-  int getOWMairpollution(WiFiClientSecure &client, owm_resp_air_pollution_t &r);
+  int getOWMonecall(WiFiClientSecure &client, owm_resp_onecall_t &r,
+                    bool includeDaily);
+  int getOWMairpollution(WiFiClientSecure &client, owm_resp_air_pollution_t &r,
+                         int64_t start);
+#endif
+#ifdef USE_WEATHER_PROXY
+  int getWeatherProxy(WiFiClient &client, owm_resp_onecall_t &onecall,
+                      owm_resp_air_pollution_t &air_pollution);
 #endif
 
 
@@ -58,6 +58,13 @@
   // #define ACCENT_COLOR GxEPD_ORANGE
 #endif
 
+// FULL FRAME BUFFER
+// By default the screen is drawn in pages, a part of the screen at a time, so
+// every draw function runs once for each page. Uncomment this to buffer the
+// whole screen in PSRAM instead, so it is drawn once and sent to the panel in a
+// single transfer. Requires a board with PSRAM, like the LOLIN D32 Pro.
+// #define FULL_FRAME_BUFFER
+
 // LOCALE
 // If your locale is not here, you can add it by copying and modifying one of
 // the files in src/locales. Please feel free to create a pull request to add
@@ -155,6 +162,16 @@
 // #define USE_HTTPS_NO_CERT_VERIF
 //#define USE_HTTPS_WITH_CERT_VERIF // REQUIRES MANUAL UPDATE WHEN CERT EXPIRES
 
+// WEATHER PROXY
+// Get the weather from the HTTPServer on the local network instead of from
+// OpenWeatherMap. The server makes the OpenWeatherMap requests with its own API
+// key, shares them between all displays, and sends each display a compact
+// binary copy of the responses. That saves the TLS handshake and JSON parsing
+// on every update. The requests to the server are always plain HTTP, the
+// HTTP/HTTPS option above is then unused.
+// Set the server address in config.cpp.
+// #define USE_WEATHER_PROXY
+
 // WIND DIRECTION INDICATOR
 // Choose whether the wind direction indicator should be an arrow, number, or
 // expressed in Compass Point Notation (CPN).
@@ -174,19 +191,17 @@
 // #define WIND_INDICATOR_NONE
 
 // WIND DIRECTION ICON PRECISION
-// The wind direction icon shown to the left of the wind speed can indicate wind
-// direction with a minimum error of ±0.5°. This uses more flash storage because
-// 360 24x24 wind direction icons must be stored, totaling ~25kB. For either
-// preference or in case flash space becomes a concern there are a handful of
-// selectable options listed below. 360 points seems excessive, but the option
-// is there.
+// The wind direction arrow shown to the left of the wind speed is drawn at any
+// angle, so it can indicate wind direction with a minimum error of ±0.5° at no
+// cost in flash storage. For preference, the direction can be rounded to one
+// of the coarser precisions listed below instead.
 //
-//   PRECISION                  #     ERROR  STORAGE
-//   Cardinal                   4  ±45.000°     288B  E
-//   Intercardinal (Ordinal)    8  ±22.500°     576B  NE
-//   Secondary Intercardinal   16  ±11.250°   1,152B  NNE
-//   Tertiary Intercardinal    32   ±5.625°   2,304B  NbE
-//   (360)                    360   ±0.500°  25,920B  1°
+//   PRECISION                  #     ERROR
+//   Cardinal                   4  ±45.000°  E
+//   Intercardinal (Ordinal)    8  ±22.500°  NE
+//   Secondary Intercardinal   16  ±11.250°  NNE
+//   Tertiary Intercardinal    32   ±5.625°  NbE
+//   (360)                    360   ±0.500°  1°
 // Uncomment your preferred wind level direction precision.
 // #define WIND_ICONS_CARDINAL
 // #define WIND_ICONS_INTERCARDINAL
@@ -222,6 +237,9 @@
 //   FreeSans font, but this project supports the ability to modularly swap
 //   fonts. Using a font other than FreeSans may result in undesired spacing or
 //   other artifacts.
+//
+//   Only the sizes of the font that are used are compiled, see
+//   tools/pack_assets.py.
 #define FONT_HEADER "fonts/FreeSans.h"
 
 // DAILY PRECIPITATION
@@ -262,6 +280,9 @@
 
 // NON-VOLATILE STORAGE (NVS) NAMESPACE
 #define NVS_NAMESPACE "weather_epd"
+// Identifies this app in state shared with the video app (which app last drew
+// the panel).
+#define APP_ID 0x57454130 // "WEA0"
 
 // DEBUG
 //   If defined, enables increase verbosity over the serial port.
@@ -291,6 +312,8 @@ extern const unsigned HTTP_CLIENT_TCP_TIMEOUT;
 extern const String OWM_APIKEY;
 extern const String OWM_ENDPOINT;
 extern const String OWM_ONECALL_VERSION;
+extern const String WEATHER_PROXY_HOST;
+extern const uint16_t WEATHER_PROXY_PORT;
 extern const String LAT;
 extern const String LON;
 extern const String CITY_STRING;
@@ -306,6 +329,9 @@ extern const int SLEEP_DURATION;
 extern const int BED_TIME;
 extern const int WAKE_TIME;
 extern const int HOURLY_GRAPH_MAX;
+extern const int DAILY_REFRESH_INTERVAL;
+extern const int WEATHER_CACHE_INTERVAL;
+extern const int PARTIAL_REFRESH_LIMIT;
 extern const uint32_t WARN_BATTERY_VOLTAGE;
 extern const uint32_t LOW_BATTERY_VOLTAGE;
 extern const uint32_t VERY_LOW_BATTERY_VOLTAGE;
@@ -322,6 +348,9 @@ extern const uint32_t MIN_BATTERY_VOLTAGE;
       ^ defined(DISP_BW_V1))
   #error Invalid configuration. Exactly one display panel must be selected.
 #endif
+#if defined(FULL_FRAME_BUFFER) && !defined(BOARD_HAS_PSRAM)
+  #error Invalid configuration. FULL_FRAME_BUFFER requires a board with PSRAM.
+#endif
 #if !(  defined(DRIVER_WAVESHARE) \
       ^ defined(DRIVER_DESPI_C02))
   #error Invalid configuration. Exactly one driver board must be selected.
@@ -18,6 +18,8 @@
 #ifndef __CONVERSIONS_H__
 #define __CONVERSIONS_H__
 
+#include <cstdint>
+
 float kelvin_to_celsius(float kelvin);
 float kelvin_to_fahrenheit(float kelvin);
 float celsius_to_kelvin(float celsius);
@@ -44,5 +46,16 @@ float meters_to_feet(float meters);
 float millimeters_to_inches(float meters);
 float millimeters_to_centimeters(float meters);
 
+// Array forms, converting the n values of in to out at once, for the hourly
+// and daily forecasts. out may be in.
+void kelvin_to_celsius(float *out, const float *in, int n);
+void kelvin_to_fahrenheit(float *out, const float *in, int n);
+
+void millimeters_to_inches(float *out, const float *in, int n);
+void millimeters_to_centimeters(float *out, const float *in, int n);
+
+void to_plot_y(int16_t *y, const float *values, int n, float valueMin,
+               float pxPerUnit, int yBase);
+
 #endif
 
@@ -21,6 +21,8 @@
 #include <vector>
 #include <time.h>
 #include "api_response.h"
+#include "aqi_history.h"
+#include "view_model.h"
 
 enum alert_category {
   NOT_FOUND = -1,
@@ -50,17 +52,16 @@ enum alert_category {
   STRONG_WIND
 };
 
-uint32_t readBatteryVoltage();
 uint32_t calcBatPercent(uint32_t v, uint32_t minv, uint32_t maxv);
 const uint8_t *getBatBitmap24(uint32_t batPercent);
 void getDateStr(String &s, tm *timeInfo);
 void getRefreshTimeStr(String &s, bool timeSuccess, tm *timeInfo);
-void toTitleCase(String &text);
-void truncateExtraAlertInfo(String &text);
-void filterAlerts(std::vector<owm_alerts_t> &resp, int *ignore_list);
+void toTitleCase(char *text);
+void truncateExtraAlertInfo(char *text);
+void filterAlerts(owm_alerts_t *resp, int num_alerts, int *ignore_list);
 const char *getUVIdesc(unsigned int uvi);
 float getAvgConc(const float pollutant[], int hours);
-int getAQI(const owm_resp_air_pollution_t &p);
+int getAQI(const aqi_history_t &h);
 const char *getAQIdesc(int aqi);
 const char *getWiFidesc(int rssi);
 const uint8_t *getWiFiBitmap16(int rssi);
@@ -72,10 +73,14 @@ const uint8_t *getCurrentConditionsBitmap196(const owm_current_t &current,
 const uint8_t *getAlertBitmap32(const owm_alerts_t &alert);
 const uint8_t *getAlertBitmap48(const owm_alerts_t &alert);
 enum alert_category getAlertCategory(const owm_alerts_t &alert);
-const uint8_t *getWindBitmap24(int windDeg);
+int getWindArrowDeg(int windDeg);
 const char *getCompassPointNotation(int windDeg);
 const char *getHttpResponsePhrase(int code);
 const char *getWifiStatusPhrase(wl_status_t status);
+uint32_t getRenderSignature(const weather_view_t &view,
+                            const owm_resp_onecall_t &onecall,
+                            const String &dateStr, const String &statusStr,
+                            int rssi, uint32_t batVoltage);
 void printHeapUsage();
 void disableBuiltinLED();
 
@@ -0,0 +1,53 @@
+/* Icon decoder declarations for esp32-weather-epd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ICON_DECODE_H__
+#define __ICON_DECODE_H__
+
+#include <cstdint>
+
+/*
+ * Icons are packed into icon_atlas by tools/pack_assets.py. A packed icon is
+ * its width, its height and its encoding, one byte each, then its pixels:
+ *   ICON_RAW  the 1-bpp bitmap, as drawInvertedBitmap takes it
+ *   ICON_RLE  run lengths of the pixels, row after row, alternating between
+ *             background and ink and starting with background. Each run is a
+ *             sequence of 255s and a final byte below 255, adding up to its
+ *             length.
+ */
+#define ICON_RAW 0
+#define ICON_RLE 1
+
+// A horizontal run of ink, within one row of the icon.
+typedef struct icon_span
+{
+  int16_t x, y;
+  int16_t w;
+} icon_span_t;
+
+typedef struct icon_decoder
+{
+  const uint8_t *data;  // next byte of pixels
+  int16_t  width, height;
+  uint8_t  encoding;
+  int32_t  pos;         // index of the next pixel, row after row
+  int32_t  ink;         // ICON_RLE: pixels left in the current run of ink
+} icon_decoder_t;
+
+void beginIcon(icon_decoder_t &d, const uint8_t *icon);
+bool nextIconSpan(icon_decoder_t &d, icon_span_t &span);
+
+#endif
@@ -0,0 +1,79 @@
+/* Streaming JSON reader declarations for esp32-weather-epd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __JSON_STREAM_H__
+#define __JSON_STREAM_H__
+
+#include <cstdint>
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#define JSON_STREAM_BUFFER_SIZE 256 // bytes read from the stream at a time
+
+/* Pull-based JSON reader.
+ *
+ * Values are read straight off the stream as the caller walks the document,
+ * so nothing is buffered beyond one chunk of input and there is no DOM. Keys
+ * and values the caller doesn't ask for are skipped without being stored.
+ *
+ *   reader.beginObject();
+ *   while (reader.nextKey(key, sizeof(key)))
+ *   {
+ *     if (strcmp(key, "temp") == 0) { t = reader.readFloat(); }
+ *     else                          { reader.skipValue(); }
+ *   }
+ *
+ * The first error is sticky. After it every call returns false/0, so callers
+ * only need to check error() once at the end. Errors use ArduinoJson's codes
+ * so they are reported the same way as before (see getHttpResponsePhrase).
+ */
+class JsonStreamReader
+{
+public:
+  JsonStreamReader(Stream &stream);
+
+  bool   beginObject();
+  bool   nextKey(char *key, size_t size);
+  bool   beginArray();
+  bool   nextElement();
+  char   peek();
+
+  float   readFloat();
+  int     readInt();
+  int64_t readInt64();
+  bool    readString(char *str, size_t size);
+  void    skipValue();
+
+  DeserializationError error() const;
+
+private:
+  Stream &stream;
+  char    buf[JSON_STREAM_BUFFER_SIZE];
+  int     len;
+  int     pos;
+  bool    first;
+  DeserializationError::Code err;
+
+  int  fill();
+  int  nextChar();
+  int  nextNonSpace();
+  bool expect(char c);
+  bool readNumber(char *num, size_t size);
+  bool skipString();
+  void fail(DeserializationError::Code code);
+};
+
+#endif
@@ -0,0 +1,95 @@
+/* Partial refresh declarations for esp32-weather-epd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PARTIAL_REFRESH_H__
+#define __PARTIAL_REFRESH_H__
+
+#include <cstdint>
+#include <Arduino.h>
+#include "api_response.h"
+#include "view_model.h"
+
+typedef enum screen_region
+{
+  REGION_CURRENT,           // current conditions, left side
+  REGION_OUTLOOK,           // outlook graph
+  REGION_FORECAST,          // five day forecast
+  REGION_HEADER,            // alerts, location and date
+  REGION_STATUS_BAR,
+  NUM_SCREEN_REGIONS
+} screen_region_t;
+
+/*
+ * A window of the screen. x and w are multiples of 8, so the window starts and
+ * ends on a byte of the panel's memory.
+ */
+typedef struct screen_rect
+{
+  int16_t x, y;
+  int16_t w, h;
+} screen_rect_t;
+
+/*
+ * What the header is drawn from.
+ */
+typedef struct screen_header
+{
+  owm_alerts_t alerts[OWM_NUM_ALERTS];
+  int32_t      num_alerts;
+  char         date[48];
+} screen_header_t;
+
+/*
+ * What identifies a refresh, and what the status bar is drawn from. The status
+ * bar shows the refresh time, so this changes on every refresh.
+ */
+typedef struct screen_info
+{
+  char     firmware[17];        // ELF SHA-256 prefix of the firmware that drew it
+  uint32_t signature;           // render signature, as stored by setPanelContents
+  int32_t  partial_refreshes;   // partial refreshes since the last full refresh
+  uint32_t crc[REGION_STATUS_BAR]; // CRC of what each other region is drawn from
+  char     status[64];
+  char     refresh_time[32];
+  int32_t  rssi;
+  uint32_t bat_voltage;
+} screen_info_t;
+
+/*
+ * Everything the weather screen is drawn from. The state of the last refresh
+ * is kept in NVS, so the next one can tell which regions changed, and can
+ * draw what is on the panel again: the panel's controller loses the old image
+ * while it is powered off, and a partial refresh only drives the pixels that
+ * differ from it.
+ */
+typedef struct screen_state
+{
+  screen_info_t   info;
+  weather_view_t  view;
+  screen_header_t header;
+} screen_state_t;
+
+void setScreenState(screen_state_t &s, const weather_view_t &view,
+                    const owm_resp_onecall_t &onecall, const String &dateStr,
+                    const String &statusStr, const String &refreshTimeStr,
+                    int rssi, uint32_t batVoltage, uint32_t signature);
+bool loadScreenState(screen_state_t &s);
+bool saveScreenState(const screen_state_t &s);
+int planPartialRefresh(const screen_state_t &last, const screen_state_t &next,
+                       uint32_t panelSignature,
+                       screen_rect_t windows[NUM_SCREEN_REGIONS]);
+
+#endif
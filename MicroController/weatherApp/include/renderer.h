@@ -23,36 +23,58 @@
 #include <time.h>
 #include "api_response.h"
 #include "config.h"
+#include "view_model.h"
+
+// Number of pages the screen is drawn in, see FULL_FRAME_BUFFER in config.h.
+#ifdef FULL_FRAME_BUFFER
+  #define DISP_PAGES 1
+#endif
 
 #ifdef DISP_BW_V2
   #define DISP_WIDTH  800
   #define DISP_HEIGHT 480
+  #ifndef DISP_PAGES
+    #define DISP_PAGES 2
+  #endif
   #include <GxEPD2_BW.h>
-  extern GxEPD2_BW<GxEPD2_750_GDEY075T7,
-                   GxEPD2_750_GDEY075T7::HEIGHT / 2> display;
+  typedef GxEPD2_BW<GxEPD2_750_GDEY075T7,
+                    GxEPD2_750_GDEY075T7::HEIGHT / DISP_PAGES> display_t;
 #endif
 #ifdef DISP_3C_B
   #define DISP_WIDTH  800
   #define DISP_HEIGHT 480
+  #ifndef DISP_PAGES
+    #define DISP_PAGES 2
+  #endif
   #include <GxEPD2_3C.h>
-  extern GxEPD2_3C<GxEPD2_750c_Z08,
-                   GxEPD2_750c_Z08::HEIGHT / 2> display;
+  typedef GxEPD2_3C<GxEPD2_750c_Z08,
+                    GxEPD2_750c_Z08::HEIGHT / DISP_PAGES> display_t;
 #endif
 #ifdef DISP_7C_F
   #define DISP_WIDTH  800
   #define DISP_HEIGHT 480
+  #ifndef DISP_PAGES
+    #define DISP_PAGES 4
+  #endif
   #include <GxEPD2_7C.h>
-  extern GxEPD2_7C<GxEPD2_730c_GDEY073D46, 
-                   GxEPD2_730c_GDEY073D46::HEIGHT / 4> display;
+  typedef GxEPD2_7C<GxEPD2_730c_GDEY073D46,
+                    GxEPD2_730c_GDEY073D46::HEIGHT / DISP_PAGES> display_t;
 #endif
 #ifdef DISP_BW_V1
   #define DISP_WIDTH  640
   #define DISP_HEIGHT 384
+  #ifndef DISP_PAGES
+    #define DISP_PAGES 1
+  #endif
   #include <GxEPD2_BW.h>
-  extern GxEPD2_BW<GxEPD2_750,
-                   GxEPD2_750::HEIGHT> display;
+  typedef GxEPD2_BW<GxEPD2_750,
+                    GxEPD2_750::HEIGHT / DISP_PAGES> display_t;
 #endif
 
+// Draw on it after initDisplay. With FULL_FRAME_BUFFER it lives in PSRAM and is
+// NULL until the first initDisplay, see renderer.cpp.
+extern display_t *display;
+
 typedef enum alignment
 {
   LEFT,
@@ -60,6 +82,7 @@ typedef enum alignment
   CENTER
 } alignment_t;
 
+void setFont(const GFXfont *font);
 uint16_t getStringWidth(const String &text);
 uint16_t getStringHeight(const String &text);
 void drawString(int16_t x, int16_t y, const String &text, alignment_t alignment,
@@ -68,18 +91,23 @@ void drawMultiLnString(int16_t x, int16_t y, const String &text,
                        alignment_t alignment, uint16_t max_width,
                        uint16_t max_lines, int16_t line_spacing,
                        uint16_t color=GxEPD_BLACK);
-void initDisplay();
+void drawIcon(int16_t x, int16_t y, const uint8_t *icon,
+              uint16_t color=GxEPD_BLACK);
+void drawWindArrow(int16_t x, int16_t y, int16_t size, int windDeg,
+                   uint16_t color=GxEPD_BLACK);
+bool initDisplay();
+bool initDisplayPartial();
+void clearDisplayCanvas();
+void writeDisplayWindow(int16_t x, int16_t y, int16_t w, int16_t h,
+                        bool previous);
+void refreshDisplayWindow(int16_t x, int16_t y, int16_t w, int16_t h);
 void powerOffDisplay();
-void drawCurrentConditions(const owm_current_t &current,
-                           const owm_daily_t &today,
-                           const owm_resp_air_pollution_t &owm_air_pollution,
-                           float inTemp, float inHumidity);
-void drawForecast(const owm_daily_t *daily, tm timeInfo);
-void drawAlerts(std::vector<owm_alerts_t> &alerts,
+void drawCurrentConditions(const current_view_t &view);
+void drawForecast(const forecast_view_t &view);
+void drawAlerts(owm_alerts_t *alerts, int num_alerts,
                 const String &city, const String &date);
 void drawLocationDate(const String &city, const String &date);
-void drawOutlookGraph(const owm_hourly_t *hourly, const owm_daily_t *daily,
-                      tm timeInfo);
+void drawOutlookGraph(const outlook_view_t &view);
 void drawStatusBar(const String &statusStr, const String &refreshTimeStr,
                    int rssi, uint32_t batVoltage);
 void drawError(const uint8_t *bitmap_196x196,
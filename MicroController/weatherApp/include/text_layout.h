@@ -0,0 +1,47 @@
+/* Text layout declarations for esp32-weather-epd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TEXT_LAYOUT_H__
+#define __TEXT_LAYOUT_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <gfxfont.h>
+
+// Measured strings kept between calls, a power of 2. A full render measures
+// fewer distinct strings than this, so the second page of a paged render finds
+// them all.
+#define TEXT_LAYOUT_CACHE_SIZE 128
+// Bytes of each measured string kept in the cache to check a hit against.
+// Longer strings are also checked against a second hash of the whole string.
+#define TEXT_LAYOUT_PREFIX_SIZE 24
+
+/*
+ * Bounding box of a string drawn with its cursor at 0,0, as returned by
+ * Adafruit_GFX::getTextBounds.
+ */
+typedef struct text_bounds
+{
+  int16_t  x1;              // Left edge
+  int16_t  y1;              // Top edge, negative above the baseline
+  uint16_t w;               // Width
+  uint16_t h;               // Height
+} text_bounds_t;
+
+text_bounds_t measureText(const GFXfont *font, const char *text, size_t len,
+                          const char *suffix = "");
+
+#endif
@@ -0,0 +1,124 @@
+/* View model declarations for esp32-weather-epd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __VIEW_MODEL_H__
+#define __VIEW_MODEL_H__
+
+#include <cstdint>
+#include <time.h>
+#include "api_response.h"
+#include "aqi_history.h"
+
+// number of days drawn by drawForecast
+#define FORECAST_DAYS 5
+// number of intervals on the y axis of the outlook graph
+#define OUTLOOK_Y_TICKS 5
+
+// Sizes of the formatted strings, including the terminator.
+#define VIEW_VALUE_SIZE 12  // a number, e.g. "> 10" or "29.92"
+#define VIEW_TEXT_SIZE  48  // a label or unit, e.g. "Feels Like 72\260"
+
+/*
+ * The view model holds everything the weather screen shows, already converted
+ * to the configured units and formatted, and the outlook graph already laid
+ * out in display coordinates. It is built once per refresh by
+ * buildWeatherView, and the draw functions in renderer.cpp only read it, so
+ * none of this is redone for each page.
+ *
+ * It is plain data with no padding left uninitialized, so two views can be
+ * compared byte for byte.
+ */
+
+typedef struct current_view
+{
+  const uint8_t *icon;                      // 196x196 current conditions icon
+  char        temp[VIEW_VALUE_SIZE];
+  const char *tempUnit;
+  char        feelsLike[VIEW_TEXT_SIZE];
+  char        sunrise[12];                  // big enough for "hh:mm:ss am"
+  char        sunset[12];
+  int16_t     windArrowDeg;                 // direction of the 24x24 wind arrow
+  char        windSpeed[VIEW_VALUE_SIZE];
+  char        windUnit[VIEW_TEXT_SIZE];     // with a leading space
+  char        windDir[VIEW_VALUE_SIZE];     // degrees or compass point, empty if not shown
+  char        uvi[VIEW_VALUE_SIZE];
+  const char *uviDesc;
+  const char *aqiLabel;
+  char        aqi[VIEW_VALUE_SIZE];
+  const char *aqiDesc;
+  char        inTemp[VIEW_VALUE_SIZE];
+  char        humidity[VIEW_VALUE_SIZE];
+  char        pressure[VIEW_VALUE_SIZE];
+  char        pressureUnit[VIEW_TEXT_SIZE]; // with a leading space
+  char        visibility[VIEW_VALUE_SIZE];
+  char        visibilityUnit[VIEW_TEXT_SIZE]; // with a leading space
+  char        inHumidity[VIEW_VALUE_SIZE];
+} current_view_t;
+
+typedef struct forecast_day_view
+{
+  const uint8_t *icon;                      // 64x64 daily forecast icon
+  char        day[8];                       // abbreviated day of the week
+  char        hi[VIEW_VALUE_SIZE];
+  char        lo[VIEW_VALUE_SIZE];
+  char        precip[VIEW_TEXT_SIZE];       // empty if not shown
+} forecast_day_view_t;
+
+typedef struct forecast_view
+{
+  forecast_day_view_t days[FORECAST_DAYS];
+} forecast_view_t;
+
+typedef struct outlook_tick
+{
+  int16_t     hour;                         // index of the hour the tick is drawn with
+  int16_t     x;
+  char        label[12];                    // big enough for "hh:mm:ss am"
+} outlook_tick_t;
+
+typedef struct outlook_view
+{
+  int16_t     x0, y0, x1, y1;               // bounds of the plot area
+  int16_t     hours;                        // number of hours plotted
+  int16_t     yTicks[OUTLOOK_Y_TICKS + 1];  // y of each y axis tick, top first
+  char        tempLabels[OUTLOOK_Y_TICKS + 1][VIEW_VALUE_SIZE];
+  bool        showPrecipLabels;
+  char        precipLabels[OUTLOOK_Y_TICKS + 1][VIEW_VALUE_SIZE];
+  char        precipUnit[VIEW_TEXT_SIZE];
+  int16_t     tempX[OWM_NUM_HOURLY];        // temperature line points
+  int16_t     tempY[OWM_NUM_HOURLY];
+  int16_t     hourX[OWM_NUM_HOURLY];        // left edge of each hour
+  int16_t     barX[OWM_NUM_HOURLY + 1];     // precipitation bar edges
+  int16_t     barY[OWM_NUM_HOURLY];         // precipitation bar tops
+  const uint8_t *icons[OWM_NUM_HOURLY];     // 32x32, nullptr where there is none
+  int16_t     iconY[OWM_NUM_HOURLY];
+  int16_t     numTicks;
+  outlook_tick_t ticks[OWM_NUM_HOURLY + 1];
+} outlook_view_t;
+
+typedef struct weather_view
+{
+  current_view_t  current;
+  outlook_view_t  outlook;
+  forecast_view_t forecast;
+} weather_view_t;
+
+void buildWeatherView(weather_view_t &view,
+                      const owm_resp_onecall_t &onecall,
+                      const aqi_history_t &aqi_history,
+                      float inTemp, float inHumidity, tm timeInfo);
+
+#endif
@@ -0,0 +1,63 @@
+/* Weather cache declarations for esp32-weather-epd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __WEATHER_CACHE_H__
+#define __WEATHER_CACHE_H__
+
+#include <time.h>
+#include "api_response.h"
+#include "aqi_history.h"
+
+// Bump whenever the layout of the response structs changes, so a snapshot
+// written by older firmware is never read back as the new layout.
+#define WEATHER_CACHE_VERSION 6
+
+typedef struct weather_cache_info
+{
+  int64_t fetched;          // When current conditions were fetched, Unix, UTC
+  int64_t hourly_fetched;   // When the saved hourly forecast was fetched, Unix, UTC
+  int64_t daily_fetched;    // When the daily forecast was fetched, Unix, UTC
+  uint32_t current_crc;     // CRC-32 of the saved current conditions
+  uint32_t onecall_crc;     // CRC-32 of the saved One Call response
+  uint32_t daily_crc;       // CRC-32 of the daily forecast in it, text included
+  uint32_t aqi_history_crc; // CRC-32 of the saved AQI history
+} weather_cache_info_t;
+
+/*
+ * What to request from OpenWeatherMap this update, decided from what is cached.
+ */
+typedef struct fetch_plan
+{
+  bool    daily;            // Include the daily forecast in the One Call request
+  bool    air_pollution;    // Request air pollution history at all
+  int64_t air_pollution_start; // Start of the history to request, 0 for the full AQI_HISTORY_HOURS
+} fetch_plan_t;
+
+bool saveWeatherCache(const owm_resp_onecall_t   &onecall,
+                      const aqi_history_t        &aqi_history,
+                      const weather_cache_info_t &info);
+bool loadWeatherCache(owm_resp_onecall_t   &onecall,
+                      aqi_history_t        &aqi_history,
+                      weather_cache_info_t &info);
+fetch_plan_t planWeatherFetch(bool cached,
+                              const owm_resp_onecall_t   &onecall,
+                              const aqi_history_t        &aqi_history,
+                              const weather_cache_info_t &info,
+                              time_t now);
+void keepDailyForecast(owm_resp_onecall_t &r, const char *oldText);
+bool shiftWeatherToNow(owm_resp_onecall_t &r, time_t now);
+
+#endif
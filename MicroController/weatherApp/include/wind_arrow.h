@@ -0,0 +1,44 @@
+/* Wind arrow declarations for esp32-weather-epd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __WIND_ARROW_H__
+#define __WIND_ARROW_H__
+
+#include <cstdint>
+#include "icon_decode.h"
+
+#define WIND_ARROW_VERTICES 4
+
+/*
+ * Rasterizes the wind direction arrow, a dart pointing the way the wind is
+ * going, at any size and angle. Coordinates are fixed point with 8 fractional
+ * bits, and pixels are filled where their center is inside the arrow, so there
+ * is no anti-aliasing, as on the panel.
+ */
+typedef struct wind_arrow
+{
+  int32_t x[WIND_ARROW_VERTICES];  // vertices, relative to the top left corner
+  int32_t y[WIND_ARROW_VERTICES];
+  int16_t size;
+  int16_t row;                     // next row to fill
+  int16_t spans;                   // spans left in the row
+  int32_t edges[WIND_ARROW_VERTICES]; // x where the edges cross the row, sorted
+} wind_arrow_t;
+
+void beginWindArrow(wind_arrow_t &a, int16_t size, int windDeg);
+bool nextWindArrowSpan(wind_arrow_t &a, icon_span_t &span);
+
+#endif
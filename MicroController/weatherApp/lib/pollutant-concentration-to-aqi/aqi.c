@@ -138,6 +138,98 @@ int compute_piecewise_aqi(float i_lo, float i_hi,
                              * (c - c_lo) + i_lo)));
 } // end compute_piecewise_aqi
 
+/* A band of a piecewise-linear AQI scale: concentrations c_lo to c_hi map to
+ * indices i_lo to i_hi. A concentration falls in the first band of its table
+ * whose limit it is below, or at, for scales whose bands include their limit.
+ * Tables are in increasing order of limit. A last band with an INFINITY limit
+ * is bounded by a check in its scale's function instead.
+ */
+typedef struct {
+  double limit;
+  float  c_lo, c_hi;
+  short  i_lo, i_hi;
+} aqi_band_t;
+
+// whether a value at the limit of a band falls in that band
+#define LIMIT_INCLUSIVE 1
+#define LIMIT_EXCLUSIVE 0
+
+#define BAND_AQI(bands, inclusive, c) \
+  band_aqi(bands, sizeof(bands) / sizeof((bands)[0]), inclusive, c)
+#define LIMIT_LEVEL(limits, inclusive, x) \
+  limit_level(limits, sizeof(limits) / sizeof((limits)[0]), inclusive, x)
+#define MAX_SUB_INDEX(sub) \
+  max_sub_index(sub, sizeof(sub) / sizeof((sub)[0]))
+
+/* Returns the index of concentration c, interpolated within its band, found
+ * by binary search. If inclusive, c falls in the first band with
+ * c <= limit, otherwise the first with c < limit.
+ *
+ * Returns -1 if c is past the limit of the last band.
+ */
+static int band_aqi(const aqi_band_t *bands, int n, int inclusive, float c)
+{
+  int lo = 0;
+  int hi = n;
+  while (lo < hi)
+  {
+    int mid = (lo + hi) / 2;
+    if (inclusive ? c <= bands[mid].limit : c < bands[mid].limit)
+    {
+      hi = mid;
+    }
+    else
+    {
+      lo = mid + 1;
+    }
+  }
+  if (lo == n)
+  {
+    return -1;
+  }
+  return compute_piecewise_aqi(bands[lo].i_lo, bands[lo].i_hi,
+                               bands[lo].c_lo, bands[lo].c_hi, c);
+} // end band_aqi
+
+/* Returns the level of x, 1 plus how many of the increasing limits it is past,
+ * found by binary search. If inclusive, x is past a limit if x > limit,
+ * otherwise if x >= limit.
+ */
+static int limit_level(const double *limits, int n, int inclusive, float x)
+{
+  int lo = 0;
+  int hi = n;
+  while (lo < hi)
+  {
+    int mid = (lo + hi) / 2;
+    if (inclusive ? x > limits[mid] : x >= limits[mid])
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+  return lo + 1;
+} // end limit_level
+
+/* Returns the largest of the sub-indices, or -1 if any of them is -1.
+ */
+static int max_sub_index(const int *sub, int n)
+{
+  int aqi = 0;
+  for (int i = 0; i < n; ++i)
+  {
+    if (sub[i] < 0)
+    {
+      return -1;
+    }
+    aqi = max(aqi, sub[i]);
+  }
+  return aqi;
+} // end max_sub_index
+
 /* Australia (AQI)
  *
  * References:
@@ -190,2193 +282,681 @@ int canada_aqhi(float no2_3h, float o3_3h, float pm2_5_3h)
  *   https://en.wikipedia.org/wiki/Air_quality_index#Mainland_China
  *   https://datadrivenlab.org/air-quality-2/chinas-new-air-quality-index-how-does-it-measure-up/
  */
+// co    μg/m^3, Carbon Monoxide (CO)
+// 1mg/m^3 = 1000 μg/m^3
+static const aqi_band_t CHINA_CO_1H[] = {
+  {  5000,      0,   5000,   0,  50},
+  { 10000,   5000,  10000,  51, 100},
+  { 35000,  10000,  35000, 101, 150},
+  { 60000,  35000,  60000, 151, 200},
+  { 90000,  60000,  90000, 201, 300},
+  {120000,  90000, 120000, 301, 400},
+  {150000, 120000, 150000, 401, 500},
+};
+
+static const aqi_band_t CHINA_CO_24H[] = {
+  { 2000,     0,  2000,   0,  50},
+  { 4000,  2000,  4000,  51, 100},
+  {14000,  4000, 14000, 101, 150},
+  {24000, 14000, 24000, 151, 200},
+  {36000, 24000, 36000, 201, 300},
+  {48000, 36000, 48000, 301, 400},
+  {60000, 48000, 60000, 401, 500},
+};
+
+// no2   μg/m^3, Nitrogen Dioxide (NO2)
+static const aqi_band_t CHINA_NO2_1H[] = {
+  { 100,    0,  100,   0,  50},
+  { 200,  100,  200,  51, 100},
+  { 700,  200,  700, 101, 150},
+  {1200,  700, 1200, 151, 200},
+  {2340, 1200, 2340, 201, 300},
+  {3090, 2340, 3090, 301, 400},
+  {3840, 3090, 3840, 401, 500},
+};
+
+static const aqi_band_t CHINA_NO2_24H[] = {
+  { 40,   0,  40,   0,  50},
+  { 80,  40,  80,  51, 100},
+  {180,  80, 180, 101, 150},
+  {280, 180, 280, 151, 200},
+  {565, 280, 565, 201, 300},
+  {750, 565, 750, 301, 400},
+  {940, 750, 940, 401, 500},
+};
+
+// o3    μg/m^3, Ozone (O3)
+static const aqi_band_t CHINA_O3_1H[] = {
+  { 160,    0,  160,   0,  50},
+  { 200,  160,  200,  51, 100},
+  { 300,  200,  300, 101, 150},
+  { 400,  300,  400, 151, 200},
+  { 800,  400,  800, 201, 300},
+  {1000,  800, 1000, 301, 400},
+  {1200, 1000, 1200, 401, 500},
+};
+
+static const aqi_band_t CHINA_O3_8H[] = {
+  {     100,   0, 100,   0,  50},
+  {     160, 100, 160,  51, 100},
+  {     215, 160, 215, 101, 150},
+  {     265, 215, 265, 151, 200},
+  {INFINITY, 265, 800, 201, 300},
+};
+
+// so2   μg/m^3, Sulfur Dioxide (SO2)
+static const aqi_band_t CHINA_SO2_1H[] = {
+  {     150,   0, 150,   0,  50},
+  {     500, 150, 500,  51, 100},
+  {     650, 500, 650, 101, 150},
+  {INFINITY, 650, 800, 151, 200},
+};
+
+static const aqi_band_t CHINA_SO2_24H[] = {
+  {  50,    0,   50,   0,  50},
+  { 150,   50,  150,  51, 100},
+  { 475,  150,  475, 101, 150},
+  { 800,  475,  800, 151, 200},
+  {1600,  800, 1600, 201, 300},
+  {2100, 1600, 2100, 301, 400},
+  {2620, 2100, 2620, 401, 500},
+};
+
+// pm10  μg/m^3, Coarse Particulate Matter (<10μm)
+static const aqi_band_t CHINA_PM10_24H[] = {
+  { 50,   0,  50,   0,  50},
+  {150,  50, 150,  51, 100},
+  {250, 150, 250, 101, 150},
+  {350, 250, 350, 151, 200},
+  {420, 350, 420, 201, 300},
+  {500, 420, 500, 301, 400},
+  {600, 500, 600, 401, 500},
+};
+
+// pm2_5 μg/m^3, Fine Particulate Matter (<2.5μm)
+static const aqi_band_t CHINA_PM2_5_24H[] = {
+  { 35,   0,  35,   0,  50},
+  { 75,  35,  75,  51, 100},
+  {115,  75, 115, 101, 150},
+  {150, 115, 150, 151, 200},
+  {250, 150, 250, 201, 300},
+  {350, 250, 350, 301, 400},
+  {500, 350, 500, 401, 500},
+};
+
 int china_aqi(float co_1h, float co_24h, float no2_1h, float no2_24h,
               float o3_1h, float o3_8h,  float so2_1h, float so2_24h,
               float pm10_24h, float pm2_5_24h)
 {
-  int aqi = 0;
-  float i_lo, i_hi;
-  float c_lo, c_hi;
-
-  // co    μg/m^3, Carbon Monoxide (CO)
-  // 1mg/m^3 = 1000 μg/m^3
-  if (co_1h <= 5000)
+  const int sub[] = {
+    BAND_AQI(CHINA_CO_1H,     LIMIT_INCLUSIVE, co_1h),
+    BAND_AQI(CHINA_CO_24H,    LIMIT_INCLUSIVE, co_24h),
+    BAND_AQI(CHINA_NO2_1H,    LIMIT_INCLUSIVE, no2_1h),
+    BAND_AQI(CHINA_NO2_24H,   LIMIT_INCLUSIVE, no2_24h),
+    BAND_AQI(CHINA_O3_1H,     LIMIT_INCLUSIVE, o3_1h),
+    BAND_AQI(CHINA_SO2_24H,   LIMIT_INCLUSIVE, so2_24h),
+    BAND_AQI(CHINA_PM10_24H,  LIMIT_INCLUSIVE, pm10_24h),
+    BAND_AQI(CHINA_PM2_5_24H, LIMIT_INCLUSIVE, pm2_5_24h),
+  };
+  int aqi = MAX_SUB_INDEX(sub);
+  if (aqi < 0)
   {
-    i_lo = 0;
-    i_hi = 50;
-    c_lo = 0;
-    c_hi = 5000;
+    // index > 500
+    return CHINA_AQI_MAX + 1;
   }
-  else if (co_1h <= 10000)
+
+  // If 8 hour average of o3 is > 800 μg/m^3 don't calculate it.
+  if (o3_8h <= 800)
   {
-    i_lo = 51;
-    i_hi = 100;
-    c_lo = 5000;
-    c_hi = 10000;
+    aqi = max(aqi, BAND_AQI(CHINA_O3_8H, LIMIT_INCLUSIVE, o3_8h));
   }
-  else if (co_1h <= 35000)
+  // If 1 hour average of so2 is > 800 μg/m^3 don't calculate it.
+  if (so2_1h <= 800)
   {
-    i_lo = 101;
-    i_hi = 150;
-    c_lo = 10000;
-    c_hi = 35000;
+    aqi = max(aqi, BAND_AQI(CHINA_SO2_1H, LIMIT_INCLUSIVE, so2_1h));
   }
-  else if (co_1h <= 60000)
+
+  return aqi;
+} // end china_aqi
+
+/* European Union (CAQI)
+ *
+ * References:
+ *   http://airqualitynow.eu/about_indices_definition.php
+ *   https://en.wikipedia.org/wiki/Air_quality_index#CAQI
+ */
+// no2   μg/m^3, Nitrogen Dioxide (NO2)
+static const aqi_band_t EUROPEAN_UNION_NO2_1H[] = {
+  { 50,   0,  50,  0,  25},
+  {100,  50, 100, 26,  50},
+  {200, 100, 200, 51,  75},
+  {400, 200, 400, 76, 100},
+};
+
+// o3    μg/m^3, Ground-Level Ozone (O3)
+static const aqi_band_t EUROPEAN_UNION_O3_1H[] = {
+  { 60,   0,  60,  0,  25},
+  {120,  60, 120, 25,  50},
+  {180, 120, 180, 51,  75},
+  {240, 180, 240, 76, 100},
+};
+
+// pm10  μg/m^3, Coarse Particulate Matter (<10μm)
+static const aqi_band_t EUROPEAN_UNION_PM10_1H[] = {
+  { 25,  0,  25,  0,  25},
+  { 50, 25,  50, 26,  50},
+  { 90, 50,  90, 51,  75},
+  {180, 90, 180, 76, 100},
+};
+
+// pm2_5 μg/m^3, Fine Particulate Matter (<2.5μm)
+static const aqi_band_t EUROPEAN_UNION_PM2_5_1H[] = {
+  { 15,  0,  15,  0,  25},
+  { 30, 15,  30, 26,  50},
+  { 55, 30,  55, 51,  75},
+  {110, 55, 110, 76, 100},
+};
+
+int european_union_caqi(float no2_1h, float o3_1h, float pm10_1h, float pm2_5_1h)
+{
+  const int sub[] = {
+    BAND_AQI(EUROPEAN_UNION_NO2_1H,   LIMIT_INCLUSIVE, no2_1h),
+    BAND_AQI(EUROPEAN_UNION_O3_1H,    LIMIT_INCLUSIVE, o3_1h),
+    BAND_AQI(EUROPEAN_UNION_PM10_1H,  LIMIT_INCLUSIVE, pm10_1h),
+    BAND_AQI(EUROPEAN_UNION_PM2_5_1H, LIMIT_INCLUSIVE, pm2_5_1h),
+  };
+  int caqi = MAX_SUB_INDEX(sub);
+  if (caqi < 0)
   {
-    i_lo = 151;
-    i_hi = 200;
-    c_lo = 35000;
-    c_hi = 60000;
+    // index > 100
+    return EUROPEAN_UNION_CAQI_MAX + 1;
   }
-  else if (co_1h <= 90000)
+  return caqi;
+} // end european_union_caqi
+
+/* Hong Kong (AQHI)
+ *
+ * References:
+ *   https://www.aqhi.gov.hk/en/what-is-aqhi/faqs.html
+ *   https://aqicn.org/faq/2015-06-03/overview-of-hong-kongs-air-quality-health-index/
+ */
+// the most added health risk, in %, of each AQHI from 1 to 10
+static const double HONG_KONG_AR[] = {
+  1.88, 3.76, 5.64, 7.52, 9.41, 11.29, 12.91, 15.07, 17.22, 19.37,
+};
+
+int hong_kong_aqhi(float no2_3h,  float o3_3h, float so2_3h,
+                   float pm10_3h, float pm2_5_3h)
+{
+  float ar = ((exp(0.0004462559 * no2_3h) - 1) * 100) + ((exp(0.0001393235 * so2_3h) - 1) * 100) + ((exp(0.0005116328 * o3_3h) - 1) * 100) + fmax(((exp(0.0002821751 * pm10_3h) - 1) * 100), ((exp(0.0002180567 * pm2_5_3h) - 1) * 100));
+  // 11 when index > 10
+  return LIMIT_LEVEL(HONG_KONG_AR, LIMIT_INCLUSIVE, ar);
+} // end hong_kong_aqhi
+
+/* India (AQI)
+ *
+ * References:
+ *   https://www.aqi.in/blog/aqi/
+ *   https://www.pranaair.com/blog/what-is-air-quality-index-aqi-and-its-calculation/
+ */
+// co    μg/m^3, Carbon Monoxide (CO)
+// 1mg/m^3 = 1000 μg/m^3
+static const aqi_band_t INDIA_CO_8H[] = {
+  { 1050,     0,  1000,   0,  50},
+  { 2050,  1100,  2000,  51, 100},
+  {10050,  2100, 10000, 101, 200},
+  {17050, 10100, 17000, 201, 300},
+  {34050, 17100, 34000, 301, 400},
+};
+
+// nh3   μg/m^3, Ammonia (NH3)
+static const aqi_band_t INDIA_NH3_24H[] = {
+  { 200.5,    0,  200,   0,  50},
+  { 400.5,  201,  400,  51, 100},
+  { 800.5,  401,  800, 101, 200},
+  {1200.5,  801, 1200, 201, 300},
+  {1800.5, 1201, 1800, 301, 400},
+};
+
+// no2   μg/m^3, Nitrogen Dioxide (NO2)
+static const aqi_band_t INDIA_NO2_24H[] = {
+  { 40.5,   0,  40,   0,  50},
+  { 80.5,  41,  80,  51, 100},
+  {180.5,  81, 180, 101, 200},
+  {280.5, 181, 280, 201, 300},
+  {400.5, 281, 400, 301, 400},
+};
+
+// o3    μg/m^3, Ozone (O3)
+static const aqi_band_t INDIA_O3_8H[] = {
+  { 50.5,   0,  50,   0,  50},
+  {100.5,  51, 100,  51, 100},
+  {168.5, 101, 168, 101, 200},
+  {208.5, 169, 208, 201, 300},
+  {748.5, 209, 748, 301, 400},
+};
+
+// pb    μg/m^3, Lead (Pb)
+static const aqi_band_t INDIA_PB_24H[] = {
+  {0.55,   0, 0.5,   0,  50},
+  {1.05, 0.6, 1.0,  51, 100},
+  {2.05, 1.1, 2.0, 101, 200},
+  {3.05, 2.1, 3.0, 201, 300},
+  {3.55, 3.1, 3.5, 301, 400},
+};
+
+// so2   μg/m^3, Sulfur Dioxide (SO2)
+static const aqi_band_t INDIA_SO2_24H[] = {
+  {  40.5,   0,   40,   0,  50},
+  {  80.5,  41,   80,  51, 100},
+  { 380.5,  81,  380, 101, 200},
+  { 800.5, 381,  800, 201, 300},
+  {1600.5, 801, 1600, 301, 400},
+};
+
+// pm10  μg/m^3, Coarse Particulate Matter (<10μm)
+static const aqi_band_t INDIA_PM10_24H[] = {
+  { 50.5,   0,  50,   0,  50},
+  {100.5,  51, 100,  51, 100},
+  {250.5, 101, 250, 101, 200},
+  {350.5, 251, 350, 201, 300},
+  {430.5, 351, 430, 301, 400},
+};
+
+// pm2_5 μg/m^3, Fine Particulate Matter (<2.5μm)
+static const aqi_band_t INDIA_PM2_5_24H[] = {
+  { 30.5,   0,  30,   0,  50},
+  { 60.5,  31,  60,  51, 100},
+  { 90.5,  61,  90, 101, 200},
+  {120.5,  91, 120, 201, 300},
+  {250.5, 121, 250, 301, 400},
+};
+
+int india_aqi(float co_8h,  float nh3_24h, float no2_24h,  float o3_8h,
+              float pb_24h, float so2_24h, float pm10_24h, float pm2_5_24h)
+{
+  const int sub[] = {
+    BAND_AQI(INDIA_CO_8H,     LIMIT_EXCLUSIVE, co_8h),
+    BAND_AQI(INDIA_NH3_24H,   LIMIT_EXCLUSIVE, nh3_24h),
+    BAND_AQI(INDIA_NO2_24H,   LIMIT_EXCLUSIVE, no2_24h),
+    BAND_AQI(INDIA_O3_8H,     LIMIT_EXCLUSIVE, o3_8h),
+    BAND_AQI(INDIA_PB_24H,    LIMIT_EXCLUSIVE, pb_24h),
+    BAND_AQI(INDIA_SO2_24H,   LIMIT_EXCLUSIVE, so2_24h),
+    BAND_AQI(INDIA_PM10_24H,  LIMIT_EXCLUSIVE, pm10_24h),
+    BAND_AQI(INDIA_PM2_5_24H, LIMIT_EXCLUSIVE, pm2_5_24h),
+  };
+  int aqi = MAX_SUB_INDEX(sub);
+  if (aqi < 0)
   {
-    i_lo = 201;
-    i_hi = 300;
-    c_lo = 60000;
-    c_hi = 90000;
+    // index > 400
+    return INDIA_AQI_MAX + 1;
   }
-  else if (co_1h <= 120000)
+  return aqi;
+} // end india_aqi
+
+/* Singapore (PSI)
+ *
+ * References:
+ *   https://www.haze.gov.sg/
+ *   http://www.haze.gov.sg/docs/default-source/faq/computation-of-the-pollutant-standards-index-%28psi%29.pdf
+ */
+// co    μg/m^3, Carbon Monoxide (CO)
+// 1mg/m^3 = 1000 μg/m^3
+static const aqi_band_t SINGAPORE_CO_8H[] = {
+  { 5050,     0,  5000,   0,  50},
+  {10050,  5100, 10000,  51, 100},
+  {17050, 10100, 17000, 101, 200},
+  {34050, 17100, 34000, 201, 300},
+  {46050, 34100, 46000, 301, 400},
+  {57550, 46100, 57500, 401, 500},
+};
+
+// no2   μg/m^3, Nitrogen Dioxide (NO2)
+// only calculated if >= 1130 μg/m^3
+static const aqi_band_t SINGAPORE_NO2_1H[] = {
+  {2260.5, 1131, 2260, 201, 300},
+  {3000.5, 2261, 3000, 301, 400},
+  {3750.5, 3001, 3750, 401, 500},
+};
+
+// o3    μg/m^3, Ozone (O3)
+static const aqi_band_t SINGAPORE_O3_8H[] = {
+  {   118.5,   0, 118,   0,  50},
+  {   157.5, 119, 157,  51, 100},
+  {   235.5, 158, 235, 101, 200},
+  {INFINITY, 236, 785, 201, 300},
+};
+
+static const aqi_band_t SINGAPORE_O3_1H[] = {
+  { 118.5,   0,  118,   0,  50},
+  { 157.5, 119,  157,  51, 100},
+  { 235.5, 158,  235, 101, 200},
+  { 785.5, 236,  785, 201, 300},
+  { 980.5, 786,  980, 301, 400},
+  {1180.5, 981, 1180, 401, 500},
+};
+
+// so2   μg/m^3, Sulfur Dioxide (SO2)
+static const aqi_band_t SINGAPORE_SO2_24H[] = {
+  {  80.5,    0,   80,   0,  50},
+  { 365.5,   81,  365,  51, 100},
+  { 800.5,  366,  800, 101, 200},
+  {1600.5,  801, 1600, 201, 300},
+  {2100.5, 1601, 2100, 301, 400},
+  {2620.5, 2101, 2620, 401, 500},
+};
+
+// pm10  μg/m^3, Coarse Particulate Matter (<10μm)
+static const aqi_band_t SINGAPORE_PM10_24H[] = {
+  { 50.5,   0,  50,   0,  50},
+  {150.5,  51, 150,  51, 100},
+  {350.5, 151, 350, 101, 200},
+  {420.5, 351, 420, 201, 300},
+  {500.5, 421, 500, 301, 400},
+  {600.5, 501, 600, 401, 500},
+};
+
+// pm2_5 μg/m^3, Fine Particulate Matter (<2.5μm)
+static const aqi_band_t SINGAPORE_PM2_5_24H[] = {
+  { 12.5,   0,  12,   0,  50},
+  { 55.5,  13,  55,  51, 100},
+  {150.5,  56, 150, 101, 200},
+  {250.5, 151, 250, 201, 300},
+  {350.5, 251, 350, 301, 400},
+  {500.5, 351, 500, 401, 500},
+};
+
+int singapore_psi(float co_8h,   float no2_1h,   float o3_1h, float o3_8h,
+                  float so2_24h, float pm10_24h, float pm2_5_24h)
+{
+  int sub[] = {
+    BAND_AQI(SINGAPORE_CO_8H,     LIMIT_EXCLUSIVE, co_8h),
+    BAND_AQI(SINGAPORE_SO2_24H,   LIMIT_EXCLUSIVE, so2_24h),
+    BAND_AQI(SINGAPORE_PM10_24H,  LIMIT_EXCLUSIVE, pm10_24h),
+    BAND_AQI(SINGAPORE_PM2_5_24H, LIMIT_EXCLUSIVE, pm2_5_24h),
+    0, // no2
+    0, // o3
+  };
+
+  if (no2_1h >= 1129.5)
   {
-    i_lo = 301;
-    i_hi = 400;
-    c_lo = 90000;
-    c_hi = 120000;
+    sub[4] = BAND_AQI(SINGAPORE_NO2_1H, LIMIT_EXCLUSIVE, no2_1h);
+    if (sub[4] >= 0 && no2_1h < 1130.5)
+    {
+      sub[4] = 200;
+    }
   }
-  else if (co_1h <= 150000)
+
+  // When 8-hour o3 concentration is > 785 μg/m^3, then the PSI sub-index is
+  // calculated using the 1 hour concentration.
+  if (o3_8h <= 785)
   {
-    i_lo = 401;
-    i_hi = 500;
-    c_lo = 120000;
-    c_hi = 150000;
+    sub[5] = BAND_AQI(SINGAPORE_O3_8H, LIMIT_EXCLUSIVE, o3_8h);
   }
   else
   {
-    // index > 500
-    return 501;
+    sub[5] = BAND_AQI(SINGAPORE_O3_1H, LIMIT_EXCLUSIVE, o3_1h);
   }
-  aqi = max(aqi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, co_1h));
 
-  if (co_24h <= 2000)
-  {
-    i_lo = 0;
-    i_hi = 50;
-    c_lo = 0;
-    c_hi = 2000;
-  }
-  else if (co_24h <= 4000)
-  {
-    i_lo = 51;
-    i_hi = 100;
-    c_lo = 2000;
-    c_hi = 4000;
-  }
-  else if (co_24h <= 14000)
+  int psi = MAX_SUB_INDEX(sub);
+  if (psi < 0)
   {
-    i_lo = 101;
-    i_hi = 150;
-    c_lo = 4000;
-    c_hi = 14000;
+    // index > 500
+    return SINGAPORE_PSI_MAX + 1;
   }
-  else if (co_24h <= 24000)
+  return psi;
+} // end singapore_psi
+
+/* South Korea (CAI)
+ *
+ * References:
+ *   https://www.airkorea.or.kr/eng/khaiInfo?pMENU_NO=166
+ */
+// co    μg/m^3, Carbon Monoxide (CO)
+// 1ppm * 1000ppb/1ppm * 1.1456 μg/m^3/ppb = 1145.6 μg/m^3
+static const aqi_band_t SOUTH_KOREA_CO_1H[] = {
+  { 2348.48,        0,  2291.2,   0,  50},
+  {10367.68,  2405.76, 10310.4,  51, 100},
+  {17241.28, 10424.96,   17184, 101, 250},
+  {57337.28, 17298.56,   57280, 251, 500},
+};
+
+// no2   μg/m^3, Nitrogen Dioxide (NO2)
+// 1ppm * 1000ppb/1ppm * 1.8816 μg/m^3/ppb = 1881.6 μg/m^3
+static const aqi_band_t SOUTH_KOREA_NO2_1H[] = {
+  { 57.3888,        0,  56.448,   0,  50},
+  {113.8368,  58.3296, 112.896,  51, 100},
+  {377.2608, 114.7776,  376.32, 101, 250},
+  {3772.608, 378.2016,  3763.2, 251, 500},
+};
+
+// o3    μg/m^3, Ozone (O3)
+// 1ppm * 1000ppb/1ppm * 1.9632 μg/m^3/ppb = 1963.2 μg/m^3
+static const aqi_band_t SOUTH_KOREA_O3_1H[] = {
+  {  59.8776,        0,  58.896,   0,  50},
+  { 177.6696,  60.8592, 176.688,  51, 100},
+  { 295.4616, 178.6512,  294.48, 101, 250},
+  {1178.9016, 296.4432, 1177.92, 251, 500},
+};
+
+// so2   μg/m^3, Sulfur Dioxide (SO2)
+// 1ppm * 1000ppb/1ppm * 8.4744 μg/m^3/ppb = 8474.4 μg/m^3
+static const aqi_band_t SOUTH_KOREA_SO2_1H[] = {
+  { 173.7252,         0, 169.488,   0,  50},
+  { 427.9572,  177.9624,  423.72,  51, 100},
+  {  1271.16,  432.1944, 1271.16, 101, 250},
+  {8478.6372, 1279.6344,  8474.4, 251, 500},
+};
+
+// pm10  μg/m^3, Coarse Particulate Matter (<10μm)
+static const aqi_band_t SOUTH_KOREA_PM10_24H[] = {
+  { 30.5,   0,  30,   0,  50},
+  { 80.5,  31,  80,  51, 100},
+  {150.5,  81, 150, 101, 250},
+  {600.5, 151, 600, 251, 500},
+};
+
+// pm2_5 μg/m^3, Fine Particulate Matter (<2.5μm)
+static const aqi_band_t SOUTH_KOREA_PM2_5_24H[] = {
+  { 15.5,  0,  15,   0,  50},
+  { 35.5, 16,  35,  51, 100},
+  { 75.5, 36,  75, 101, 250},
+  {500.5, 76, 500, 251, 500},
+};
+
+int south_korea_cai(float co_1h,  float no2_1h,   float o3_1h,
+                    float so2_1h, float pm10_24h, float pm2_5_24h)
+{
+  const int sub[] = {
+    BAND_AQI(SOUTH_KOREA_CO_1H,     LIMIT_EXCLUSIVE, co_1h),
+    BAND_AQI(SOUTH_KOREA_NO2_1H,    LIMIT_EXCLUSIVE, no2_1h),
+    BAND_AQI(SOUTH_KOREA_O3_1H,     LIMIT_EXCLUSIVE, o3_1h),
+    BAND_AQI(SOUTH_KOREA_SO2_1H,    LIMIT_EXCLUSIVE, so2_1h),
+    BAND_AQI(SOUTH_KOREA_PM10_24H,  LIMIT_EXCLUSIVE, pm10_24h),
+    BAND_AQI(SOUTH_KOREA_PM2_5_24H, LIMIT_EXCLUSIVE, pm2_5_24h),
+  };
+  int cai = MAX_SUB_INDEX(sub);
+  if (cai < 0)
   {
-    i_lo = 151;
-    i_hi = 200;
-    c_lo = 14000;
-    c_hi = 24000;
+    // index > 500
+    return SOUTH_KOREA_CAI_MAX + 1;
   }
-  else if (co_24h <= 36000)
+  return cai;
+} // end south_korea_cai
+
+/* United Kingdom (DAQI)
+ *
+ * References:
+ *   https://uk-air.defra.gov.uk/air-pollution/daqi?view=more-info
+ *   https://en.wikipedia.org/wiki/Air_quality_index#United_Kingdom
+ *   https://uk-air.defra.gov.uk/library/reports?report_id=750
+ */
+// the lowest concentration, in μg/m^3, of each DAQI from 2 to 10
+// Pollutant averages are rounded to nearest integer
+static const double UNITED_KINGDOM_O3_8H[] = {
+  33.5, 66.5, 100.5, 120.5, 140.5, 160.5, 187.5, 213.5, 240.5,
+};
+static const double UNITED_KINGDOM_NO2_1H[] = {
+  67.5, 134.5, 200.5, 267.5, 334.5, 400.5, 467.5, 534.5, 600.5,
+};
+static const double UNITED_KINGDOM_SO2_15MIN[] = {
+  88.5, 177.5, 266.5, 354.5, 443.5, 532.5, 710.5, 887.5, 1064.5,
+};
+static const double UNITED_KINGDOM_PM2_5_24H[] = {
+  11.5, 23.5, 35.5, 41.5, 47.5, 53.5, 58.5, 64.5, 70.5,
+};
+static const double UNITED_KINGDOM_PM10_24H[] = {
+  16.5, 33.5, 50.5, 58.5, 66.5, 75.5, 83.5, 91.5, 100.5,
+};
+
+int united_kingdom_daqi(float no2_1h,   float o3_8h, float so2_15min,
+                        float pm10_24h, float pm2_5_24h)
+{
+  const int sub[] = {
+    LIMIT_LEVEL(UNITED_KINGDOM_O3_8H,     LIMIT_EXCLUSIVE, o3_8h),
+    LIMIT_LEVEL(UNITED_KINGDOM_NO2_1H,    LIMIT_EXCLUSIVE, no2_1h),
+    LIMIT_LEVEL(UNITED_KINGDOM_SO2_15MIN, LIMIT_EXCLUSIVE, so2_15min),
+    LIMIT_LEVEL(UNITED_KINGDOM_PM2_5_24H, LIMIT_EXCLUSIVE, pm2_5_24h),
+    LIMIT_LEVEL(UNITED_KINGDOM_PM10_24H,  LIMIT_EXCLUSIVE, pm10_24h),
+  };
+  return MAX_SUB_INDEX(sub);
+} // end united_kingdom_daqi
+
+/* United States (AQI)
+ *
+ * References:
+ *   https://www.epa.gov/outdoor-air-quality-data/how-aqi-calculated
+ *   https://www.airnow.gov/sites/default/files/2020-05/aqi-technical-assistance-document-sept2018.pdf
+ *   https://en.wikipedia.org/wiki/Air_quality_index#United_States
+ */
+// co    ppm, Carbon Monoxide (CO)
+static const aqi_band_t UNITED_STATES_CO_8H[] = {
+  { 4.4,    0,  4.4,   0,  50},
+  { 9.4,  4.5,  9.4,  51, 100},
+  {12.4,  9.5, 12.4, 101, 150},
+  {15.4, 12.5, 15.4, 151, 200},
+  {30.4, 15.5, 30.4, 201, 300},
+  {40.4, 30.5, 40.4, 301, 400},
+  {50.4, 40.5, 50.4, 401, 500},
+};
+
+// no2   ppb, Nitrogen Dioxide (NO2)
+static const aqi_band_t UNITED_STATES_NO2_1H[] = {
+  {  53,    0,   53,   0,  50},
+  { 100,   54,  100,  51, 100},
+  { 360,  101,  360, 101, 150},
+  { 649,  361,  649, 151, 200},
+  {1249,  350, 1249, 201, 300},
+  {1649, 1250, 1649, 301, 400},
+  {2049, 1650, 2049, 401, 500},
+};
+
+// o3    ppm, Ground-Level Ozone (O3)
+static const aqi_band_t UNITED_STATES_O3_1H[] = {
+  {0.164, 0.125, 0.164, 101, 150},
+  {0.204, 0.165, 0.204, 151, 200},
+  {0.404, 0.205, 0.404, 201, 300},
+  { 1649,  1250,  1649, 301, 400},
+  { 2049,  1650,  2049, 401, 500},
+};
+
+static const aqi_band_t UNITED_STATES_O3_8H[] = {
+  {   0.054,     0, 0.054,   0,  50},
+  {   0.070, 0.055, 0.070,  51, 100},
+  {   0.085, 0.071, 0.085, 101, 150},
+  {   0.105, 0.086, 0.105, 151, 200},
+  {INFINITY, 0.106, 0.200, 201, 300},
+};
+
+// so2   ppb, Sulfur Dioxide (SO2)
+static const aqi_band_t UNITED_STATES_SO2_1H[] = {
+  {      35,  0,  35,   0,  50},
+  {      75, 36,  75,  51, 100},
+  {INFINITY, 76, 185, 101, 150},
+};
+
+static const aqi_band_t UNITED_STATES_SO2_24H[] = {
+  {  35,   0,   35,   0,  50},
+  {  75,  36,   75,  51, 100},
+  { 185,  76,  185, 101, 150},
+  { 304, 186,  304, 151, 200},
+  { 604, 305,  604, 201, 300},
+  { 804, 605,  804, 301, 400},
+  {1004, 805, 1004, 401, 500},
+};
+
+// pm10  μg/m^3, Coarse Particulate Matter (<10μm)
+static const aqi_band_t UNITED_STATES_PM10_24H[] = {
+  { 54,   0,  54,   0,  50},
+  {154,  55, 154,  51, 100},
+  {254, 155, 254, 101, 150},
+  {354, 255, 354, 151, 200},
+  {424, 355, 424, 201, 300},
+  {504, 425, 504, 301, 400},
+  {604, 505, 604, 401, 500},
+};
+
+// pm2_5 μg/m^3, Fine Particulate Matter (<2.5μm)
+static const aqi_band_t UNITED_STATES_PM2_5_24H[] = {
+  { 12.0,     0,  12.0,   0,  50},
+  { 35.4,  12.1,  35.4,  51, 100},
+  { 55.4,  35.5,  55.4, 101, 150},
+  {150.4,  55.5, 150.4, 151, 200},
+  {250.4, 150.5, 250.4, 201, 300},
+  {350.4, 250.5, 350.4, 301, 400},
+  {500.4, 350.5, 500.4, 401, 500},
+};
+
+int united_states_aqi(float co_8h,    float no2_1h,
+                      float o3_1h,    float o3_8h,
+                      float so2_1h,   float so2_24h,
+                      float pm10_24h, float pm2_5_24h)
+{
+  // Pollutant averages are truncated
+  co_8h = truncate_float(co_8h / 1145.6, 1); // (ppm) truncate to 1 decimal place
+  no2_1h = (int)(no2_1h / 1.8816);           // (ppb) truncate to integer
+  o3_1h = truncate_float(o3_1h / 1963.2, 3); // (ppm) truncate to 3 decimal places
+  o3_8h = truncate_float(o3_8h / 1963.2, 3); // (ppm) truncate to 3 decimal places
+  so2_1h = (int)(so2_1h / 8.4744);           // (ppb) truncate to integer
+  pm10_24h = (int)pm10_24h;                  // (μg/m^3) truncate to integer
+  pm2_5_24h = truncate_float(pm2_5_24h, 1);  // (μg/m^3) truncate to 1 decimal place
+
+  int sub[] = {
+    BAND_AQI(UNITED_STATES_CO_8H,     LIMIT_INCLUSIVE, co_8h),
+    BAND_AQI(UNITED_STATES_NO2_1H,    LIMIT_INCLUSIVE, no2_1h),
+    BAND_AQI(UNITED_STATES_PM10_24H,  LIMIT_INCLUSIVE, pm10_24h),
+    BAND_AQI(UNITED_STATES_PM2_5_24H, LIMIT_INCLUSIVE, pm2_5_24h),
+    0, // o3 1h
+    0, // o3 8h
+    0, // so2
+  };
+
+  // 1 hour o3 only counts from 0.125 ppm
+  if (o3_1h >= 0.125)
   {
-    i_lo = 201;
-    i_hi = 300;
-    c_lo = 24000;
-    c_hi = 36000;
+    sub[4] = BAND_AQI(UNITED_STATES_O3_1H, LIMIT_INCLUSIVE, o3_1h);
   }
-  else if (co_24h <= 48000)
+  // 8 hour o3 only counts up to 0.200 ppm
+  if (o3_8h <= 0.200)
   {
-    i_lo = 301;
-    i_hi = 400;
-    c_lo = 36000;
-    c_hi = 48000;
+    sub[5] = BAND_AQI(UNITED_STATES_O3_8H, LIMIT_INCLUSIVE, o3_8h);
   }
-  else if (co_24h <= 60000)
+  // above 185 ppb, so2 is taken from the 24 hour average
+  if (so2_1h <= 185)
   {
-    i_lo = 401;
-    i_hi = 500;
-    c_lo = 48000;
-    c_hi = 60000;
+    sub[6] = BAND_AQI(UNITED_STATES_SO2_1H, LIMIT_INCLUSIVE, so2_1h);
   }
   else
   {
-    // index > 500
-    return 501;
+    sub[6] = BAND_AQI(UNITED_STATES_SO2_24H, LIMIT_INCLUSIVE, so2_24h);
   }
-  aqi = max(aqi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, co_24h));
 
-  // no2   μg/m^3, Nitrogen Dioxide (NO2)
-  if (no2_1h <= 100)
-  {
-    i_lo = 0;
-    i_hi = 50;
-    c_lo = 0;
-    c_hi = 100;
-  }
-  else if (no2_1h <= 200)
+  int aqi = MAX_SUB_INDEX(sub);
+  if (aqi < 0)
   {
-    i_lo = 51;
-    i_hi = 100;
-    c_lo = 100;
-    c_hi = 200;
+    // index > 500
+    return UNITED_STATES_AQI_MAX + 1;
   }
-  else if (no2_1h <= 700)
-  {
-    i_lo = 101;
-    i_hi = 150;
-    c_lo = 200;
-    c_hi = 700;
-  }
-  else if (no2_1h <= 1200)
-  {
-    i_lo = 151;
-    i_hi = 200;
-    c_lo = 700;
-    c_hi = 1200;
-  }
-  else if (no2_1h <= 2340)
-  {
-    i_lo = 201;
-    i_hi = 300;
-    c_lo = 1200;
-    c_hi = 2340;
-  }
-  else if (no2_1h <= 3090)
-  {
-    i_lo = 301;
-    i_hi = 400;
-    c_lo = 2340;
-    c_hi = 3090;
-  }
-  else if (no2_1h <= 3840)
-  {
-    i_lo = 401;
-    i_hi = 500;
-    c_lo = 3090;
-    c_hi = 3840;
-  }
-  else
-  {
-    // index > 500
-    return 501;
-  }
-  aqi = max(aqi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, no2_1h));
-
-  if (no2_24h <= 40)
-  {
-    i_lo = 0;
-    i_hi = 50;
-    c_lo = 0;
-    c_hi = 40;
-  }
-  else if (no2_24h <= 80)
-  {
-    i_lo = 51;
-    i_hi = 100;
-    c_lo = 40;
-    c_hi = 80;
-  }
-  else if (no2_24h <= 180)
-  {
-    i_lo = 101;
-    i_hi = 150;
-    c_lo = 80;
-    c_hi = 180;
-  }
-  else if (no2_24h <= 280)
-  {
-    i_lo = 151;
-    i_hi = 200;
-    c_lo = 180;
-    c_hi = 280;
-  }
-  else if (no2_24h <= 565)
-  {
-    i_lo = 201;
-    i_hi = 300;
-    c_lo = 280;
-    c_hi = 565;
-  }
-  else if (no2_24h <= 750)
-  {
-    i_lo = 301;
-    i_hi = 400;
-    c_lo = 565;
-    c_hi = 750;
-  }
-  else if (no2_24h <= 940)
-  {
-    i_lo = 401;
-    i_hi = 500;
-    c_lo = 750;
-    c_hi = 940;
-  }
-  else
-  {
-    // index > 500
-    return 501;
-  }
-  aqi = max(aqi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, no2_24h));
-
-  // o3    μg/m^3, Ozone (O3)
-  if (o3_1h <= 160)
-  {
-    i_lo = 0;
-    i_hi = 50;
-    c_lo = 0;
-    c_hi = 160;
-  }
-  else if (o3_1h <= 200)
-  {
-    i_lo = 51;
-    i_hi = 100;
-    c_lo = 160;
-    c_hi = 200;
-  }
-  else if (o3_1h <= 300)
-  {
-    i_lo = 101;
-    i_hi = 150;
-    c_lo = 200;
-    c_hi = 300;
-  }
-  else if (o3_1h <= 400)
-  {
-    i_lo = 151;
-    i_hi = 200;
-    c_lo = 300;
-    c_hi = 400;
-  }
-  else if (o3_1h <= 800)
-  {
-    i_lo = 201;
-    i_hi = 300;
-    c_lo = 400;
-    c_hi = 800;
-  }
-  else if (o3_1h <= 1000)
-  {
-    i_lo = 301;
-    i_hi = 400;
-    c_lo = 800;
-    c_hi = 1000;
-  }
-  else if (o3_1h <= 1200)
-  {
-    i_lo = 401;
-    i_hi = 500;
-    c_lo = 1000;
-    c_hi = 1200;
-  }
-  else
-  {
-    // index > 500
-    return 501;
-  }
-  aqi = max(aqi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, o3_1h));
-
-  // If 8 hour average of o3 is > 800 μg/m^3 don't calculate it.
-  if (o3_8h <= 800)
-  {
-    if (o3_8h <= 100)
-    {
-      i_lo = 0;
-      i_hi = 50;
-      c_lo = 0;
-      c_hi = 100;
-    }
-    else if (o3_8h <= 160)
-    {
-      i_lo = 51;
-      i_hi = 100;
-      c_lo = 100;
-      c_hi = 160;
-    }
-    else if (o3_8h <= 215)
-    {
-      i_lo = 101;
-      i_hi = 150;
-      c_lo = 160;
-      c_hi = 215;
-    }
-    else if (o3_8h <= 265)
-    {
-      i_lo = 151;
-      i_hi = 200;
-      c_lo = 215;
-      c_hi = 265;
-    }
-    else
-    {
-      // 265 < o3_8h <= 800
-      i_lo = 201;
-      i_hi = 300;
-      c_lo = 265;
-      c_hi = 800;
-    }
-    aqi = max(aqi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, o3_8h));
-  }
-
-  // so2   μg/m^3, Sulfur Dioxide (SO2)
-  // If 1 hour average of so2 is > 800 μg/m^3 don't calculate it.
-  if (so2_1h <= 800)
-  {
-    if (so2_1h <= 150)
-    {
-      i_lo = 0;
-      i_hi = 50;
-      c_lo = 0;
-      c_hi = 150;
-    }
-    else if (so2_1h <= 500)
-    {
-      i_lo = 51;
-      i_hi = 100;
-      c_lo = 150;
-      c_hi = 500;
-    }
-    else if (so2_1h <= 650)
-    {
-      i_lo = 101;
-      i_hi = 150;
-      c_lo = 500;
-      c_hi = 650;
-    }
-    else
-    {
-      // 650 < so2_1h <= 800
-      i_lo = 151;
-      i_hi = 200;
-      c_lo = 650;
-      c_hi = 800;
-    }
-    aqi = max(aqi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, so2_1h));
-  }
-
-  if (so2_24h <= 50)
-  {
-    i_lo = 0;
-    i_hi = 50;
-    c_lo = 0;
-    c_hi = 50;
-  }
-  else if (so2_24h <= 150)
-  {
-    i_lo = 51;
-    i_hi = 100;
-    c_lo = 50;
-    c_hi = 150;
-  }
-  else if (so2_24h <= 475)
-  {
-    i_lo = 101;
-    i_hi = 150;
-    c_lo = 150;
-    c_hi = 475;
-  }
-  else if (so2_24h <= 800)
-  {
-    i_lo = 151;
-    i_hi = 200;
-    c_lo = 475;
-    c_hi = 800;
-  }
-  else if (so2_24h <= 1600)
-  {
-    i_lo = 201;
-    i_hi = 300;
-    c_lo = 800;
-    c_hi = 1600;
-  }
-  else if (so2_24h <= 2100)
-  {
-    i_lo = 301;
-    i_hi = 400;
-    c_lo = 1600;
-    c_hi = 2100;
-  }
-  else if (so2_24h <= 2620)
-  {
-    i_lo = 401;
-    i_hi = 500;
-    c_lo = 2100;
-    c_hi = 2620;
-  }
-  else
-  {
-    // index > 500
-    return 501;
-  }
-  aqi = max(aqi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, so2_24h));
-
-  // pm10  μg/m^3, Coarse Particulate Matter (<10μm)
-  if (pm10_24h <= 50)
-  {
-    i_lo = 0;
-    i_hi = 50;
-    c_lo = 0;
-    c_hi = 50;
-  }
-  else if (pm10_24h <= 150)
-  {
-    i_lo = 51;
-    i_hi = 100;
-    c_lo = 50;
-    c_hi = 150;
-  }
-  else if (pm10_24h <= 250)
-  {
-    i_lo = 101;
-    i_hi = 150;
-    c_lo = 150;
-    c_hi = 250;
-  }
-  else if (pm10_24h <= 350)
-  {
-    i_lo = 151;
-    i_hi = 200;
-    c_lo = 250;
-    c_hi = 350;
-  }
-  else if (pm10_24h <= 420)
-  {
-    i_lo = 201;
-    i_hi = 300;
-    c_lo = 350;
-    c_hi = 420;
-  }
-  else if (pm10_24h <= 500)
-  {
-    i_lo = 301;
-    i_hi = 400;
-    c_lo = 420;
-    c_hi = 500;
-  }
-  else if (pm10_24h <= 600)
-  {
-    i_lo = 401;
-    i_hi = 500;
-    c_lo = 500;
-    c_hi = 600;
-  }
-  else
-  {
-    // index > 500
-    return 501;
-  }
-  aqi = max(aqi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, pm10_24h));
-
-  // pm2_5 μg/m^3, Fine Particulate Matter (<2.5μm)
-  if (pm2_5_24h <= 35)
-  {
-    i_lo = 0;
-    i_hi = 50;
-    c_lo = 0;
-    c_hi = 35;
-  }
-  else if (pm2_5_24h <= 75)
-  {
-    i_lo = 51;
-    i_hi = 100;
-    c_lo = 35;
-    c_hi = 75;
-  }
-  else if (pm2_5_24h <= 115)
-  {
-    i_lo = 101;
-    i_hi = 150;
-    c_lo = 75;
-    c_hi = 115;
-  }
-  else if (pm2_5_24h <= 150)
-  {
-    i_lo = 151;
-    i_hi = 200;
-    c_lo = 115;
-    c_hi = 150;
-  }
-  else if (pm2_5_24h <= 250)
-  {
-    i_lo = 201;
-    i_hi = 300;
-    c_lo = 150;
-    c_hi = 250;
-  }
-  else if (pm2_5_24h <= 350)
-  {
-    i_lo = 301;
-    i_hi = 400;
-    c_lo = 250;
-    c_hi = 350;
-  }
-  else if (pm2_5_24h <= 500)
-  {
-    i_lo = 401;
-    i_hi = 500;
-    c_lo = 350;
-    c_hi = 500;
-  }
-  else
-  {
-    // index > 500
-    return 501;
-  }
-  aqi = max(aqi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, pm2_5_24h));
-
-  return aqi;
-} // end china_aqi
-
-/* European Union (CAQI)
- *
- * References:
- *   http://airqualitynow.eu/about_indices_definition.php
- *   https://en.wikipedia.org/wiki/Air_quality_index#CAQI
- */
-int european_union_caqi(float no2_1h, float o3_1h, float pm10_1h, float pm2_5_1h)
-{
-  int caqi = 0;
-  float i_lo, i_hi;
-  float c_lo, c_hi;
-
-  // no2   μg/m^3, Nitrogen Dioxide (NO2)
-  if (no2_1h <= 50)
-  {
-    i_lo = 0;
-    i_hi = 25;
-    c_lo = 0;
-    c_hi = 50;
-  }
-  else if (no2_1h <= 100)
-  {
-    i_lo = 26;
-    i_hi = 50;
-    c_lo = 50;
-    c_hi = 100;
-  }
-  else if (no2_1h <= 200)
-  {
-    i_lo = 51;
-    i_hi = 75;
-    c_lo = 100;
-    c_hi = 200;
-  }
-  else if (no2_1h <= 400)
-  {
-    i_lo = 76;
-    i_hi = 100;
-    c_lo = 200;
-    c_hi = 400;
-  }
-  else
-  {
-    // index > 100
-    return 101;
-  }
-  caqi = max(caqi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, no2_1h));
-
-  // o3    μg/m^3, Ground-Level Ozone (O3)
-  if (o3_1h <= 60)
-  {
-    i_lo = 0;
-    i_hi = 25;
-    c_lo = 0;
-    c_hi = 60;
-  }
-  else if (o3_1h <= 120)
-  {
-    i_lo = 25;
-    i_hi = 50;
-    c_lo = 60;
-    c_hi = 120;
-  }
-  else if (o3_1h <= 180)
-  {
-    i_lo = 51;
-    i_hi = 75;
-    c_lo = 120;
-    c_hi = 180;
-  }
-  else if (o3_1h <= 240)
-  {
-    i_lo = 76;
-    i_hi = 100;
-    c_lo = 180;
-    c_hi = 240;
-  }
-  else
-  {
-    // index > 100
-    return 101;
-  }
-  caqi = max(caqi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, o3_1h));
-
-  // pm10  μg/m^3, Coarse Particulate Matter (<10μm)
-  if (pm10_1h <= 25)
-  {
-    i_lo = 0;
-    i_hi = 25;
-    c_lo = 0;
-    c_hi = 25;
-  }
-  else if (pm10_1h <= 50)
-  {
-    i_lo = 26;
-    i_hi = 50;
-    c_lo = 25;
-    c_hi = 50;
-  }
-  else if (pm10_1h <= 90)
-  {
-    i_lo = 51;
-    i_hi = 75;
-    c_lo = 50;
-    c_hi = 90;
-  }
-  else if (pm10_1h <= 180)
-  {
-    i_lo = 76;
-    i_hi = 100;
-    c_lo = 90;
-    c_hi = 180;
-  }
-  else
-  {
-    // index > 100
-    return 101;
-  }
-  caqi = max(caqi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, pm10_1h));
-
-  // pm2_5 μg/m^3, Fine Particulate Matter (<2.5μm)
-  if (pm2_5_1h <= 15)
-  {
-    i_lo = 0;
-    i_hi = 25;
-    c_lo = 0;
-    c_hi = 15;
-  }
-  else if (pm2_5_1h <= 30)
-  {
-    i_lo = 26;
-    i_hi = 50;
-    c_lo = 15;
-    c_hi = 30;
-  }
-  else if (pm2_5_1h <= 55)
-  {
-    i_lo = 51;
-    i_hi = 75;
-    c_lo = 30;
-    c_hi = 55;
-  }
-  else if (pm2_5_1h <= 110)
-  {
-    i_lo = 76;
-    i_hi = 100;
-    c_lo = 55;
-    c_hi = 110;
-  }
-  else
-  {
-    // index > 100
-    return 101;
-  }
-  caqi = max(caqi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, pm2_5_1h));
-
-  return caqi;
-} // end european_union_caqi
-
-/* Hong Kong (AQHI)
- *
- * References:
- *   https://www.aqhi.gov.hk/en/what-is-aqhi/faqs.html
- *   https://aqicn.org/faq/2015-06-03/overview-of-hong-kongs-air-quality-health-index/
- */
-int hong_kong_aqhi(float no2_3h,  float o3_3h, float so2_3h,
-                   float pm10_3h, float pm2_5_3h)
-{
-  float ar = ((exp(0.0004462559 * no2_3h) - 1) * 100) + ((exp(0.0001393235 * so2_3h) - 1) * 100) + ((exp(0.0005116328 * o3_3h) - 1) * 100) + fmax(((exp(0.0002821751 * pm10_3h) - 1) * 100), ((exp(0.0002180567 * pm2_5_3h) - 1) * 100));
-  if (ar <= 1.88)
-  {
-    return 1;
-  }
-  else if (ar <= 3.76)
-  {
-    return 2;
-  }
-  else if (ar <= 5.64)
-  {
-    return 3;
-  }
-  else if (ar <= 7.52)
-  {
-    return 4;
-  }
-  else if (ar <= 9.41)
-  {
-    return 5;
-  }
-  else if (ar <= 11.29)
-  {
-    return 6;
-  }
-  else if (ar <= 12.91)
-  {
-    return 7;
-  }
-  else if (ar <= 15.07)
-  {
-    return 8;
-  }
-  else if (ar <= 17.22)
-  {
-    return 9;
-  }
-  else if (ar <= 19.37)
-  {
-    return 10;
-  }
-  else
-  {
-    // index > 10
-    return 11;
-  }
-} // end hong_kong_aqhi
-
-/* India (AQI)
- *
- * References:
- *   https://www.aqi.in/blog/aqi/
- *   https://www.pranaair.com/blog/what-is-air-quality-index-aqi-and-its-calculation/
- */
-int india_aqi(float co_8h,  float nh3_24h, float no2_24h,  float o3_8h,
-              float pb_24h, float so2_24h, float pm10_24h, float pm2_5_24h)
-{
-  int aqi = 0;
-  float i_lo, i_hi;
-  float c_lo, c_hi;
-
-  // co    μg/m^3, Carbon Monoxide (CO)
-  // 1mg/m^3 = 1000 μg/m^3
-  if (co_8h < 1050)
-  {
-    i_lo = 0;
-    i_hi = 50;
-    c_lo = 0;
-    c_hi = 1000;
-  }
-  else if (co_8h < 2050)
-  {
-    i_lo = 51;
-    i_hi = 100;
-    c_lo = 1100;
-    c_hi = 2000;
-  }
-  else if (co_8h < 10050)
-  {
-    i_lo = 101;
-    i_hi = 200;
-    c_lo = 2100;
-    c_hi = 10000;
-  }
-  else if (co_8h < 17050)
-  {
-    i_lo = 201;
-    i_hi = 300;
-    c_lo = 10100;
-    c_hi = 17000;
-  }
-  else if (co_8h < 34050)
-  {
-    i_lo = 301;
-    i_hi = 400;
-    c_lo = 17100;
-    c_hi = 34000;
-  }
-  else
-  {
-    // index > 400
-    return 401;
-  }
-  aqi = max(aqi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, co_8h));
-
-  // nh3   μg/m^3, Ammonia (NH3)
-  if (nh3_24h < 200.5)
-  {
-    i_lo = 0;
-    i_hi = 50;
-    c_lo = 0;
-    c_hi = 200;
-  }
-  else if (nh3_24h < 400.5)
-  {
-    i_lo = 51;
-    i_hi = 100;
-    c_lo = 201;
-    c_hi = 400;
-  }
-  else if (nh3_24h < 800.5)
-  {
-    i_lo = 101;
-    i_hi = 200;
-    c_lo = 401;
-    c_hi = 800;
-  }
-  else if (nh3_24h < 1200.5)
-  {
-    i_lo = 201;
-    i_hi = 300;
-    c_lo = 801;
-    c_hi = 1200;
-  }
-  else if (nh3_24h < 1800.5)
-  {
-    i_lo = 301;
-    i_hi = 400;
-    c_lo = 1201;
-    c_hi = 1800;
-  }
-  else
-  {
-    // index > 400
-    return 401;
-  }
-  aqi = max(aqi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, nh3_24h));
-
-  // no2   μg/m^3, Nitrogen Dioxide (NO2)
-  if (no2_24h < 40.5)
-  {
-    i_lo = 0;
-    i_hi = 50;
-    c_lo = 0;
-    c_hi = 40;
-  }
-  else if (no2_24h < 80.5)
-  {
-    i_lo = 51;
-    i_hi = 100;
-    c_lo = 41;
-    c_hi = 80;
-  }
-  else if (no2_24h < 180.5)
-  {
-    i_lo = 101;
-    i_hi = 200;
-    c_lo = 81;
-    c_hi = 180;
-  }
-  else if (no2_24h < 280.5)
-  {
-    i_lo = 201;
-    i_hi = 300;
-    c_lo = 181;
-    c_hi = 280;
-  }
-  else if (no2_24h < 400.5)
-  {
-    i_lo = 301;
-    i_hi = 400;
-    c_lo = 281;
-    c_hi = 400;
-  }
-  else
-  {
-    // index > 400
-    return 401;
-  }
-  aqi = max(aqi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, no2_24h));
-
-  // o3    μg/m^3, Ozone (O3)
-  if (o3_8h < 50.5)
-  {
-    i_lo = 0;
-    i_hi = 50;
-    c_lo = 0;
-    c_hi = 50;
-  }
-  else if (o3_8h < 100.5)
-  {
-    i_lo = 51;
-    i_hi = 100;
-    c_lo = 51;
-    c_hi = 100;
-  }
-  else if (o3_8h < 168.5)
-  {
-    i_lo = 101;
-    i_hi = 200;
-    c_lo = 101;
-    c_hi = 168;
-  }
-  else if (o3_8h < 208.5)
-  {
-    i_lo = 201;
-    i_hi = 300;
-    c_lo = 169;
-    c_hi = 208;
-  }
-  else if (o3_8h < 748.5)
-  {
-    i_lo = 301;
-    i_hi = 400;
-    c_lo = 209;
-    c_hi = 748;
-  }
-  else
-  {
-    // index > 400
-    return 401;
-  }
-  aqi = max(aqi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, o3_8h));
-
-  // pb    μg/m^3, Lead (Pb)
-  if (pb_24h < 0.55)
-  {
-    i_lo = 0;
-    i_hi = 50;
-    c_lo = 0;
-    c_hi = 0.5;
-  }
-  else if (pb_24h < 1.05)
-  {
-    i_lo = 51;
-    i_hi = 100;
-    c_lo = 0.6;
-    c_hi = 1.0;
-  }
-  else if (pb_24h < 2.05)
-  {
-    i_lo = 101;
-    i_hi = 200;
-    c_lo = 1.1;
-    c_hi = 2.0;
-  }
-  else if (pb_24h < 3.05)
-  {
-    i_lo = 201;
-    i_hi = 300;
-    c_lo = 2.1;
-    c_hi = 3.0;
-  }
-  else if (pb_24h < 3.55)
-  {
-    i_lo = 301;
-    i_hi = 400;
-    c_lo = 3.1;
-    c_hi = 3.5;
-  }
-  else
-  {
-    // index > 400
-    return 401;
-  }
-  aqi = max(aqi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, pb_24h));
-
-  // so2   μg/m^3, Sulfur Dioxide (SO2)
-  if (so2_24h < 40.5)
-  {
-    i_lo = 0;
-    i_hi = 50;
-    c_lo = 0;
-    c_hi = 40;
-  }
-  else if (so2_24h < 80.5)
-  {
-    i_lo = 51;
-    i_hi = 100;
-    c_lo = 41;
-    c_hi = 80;
-  }
-  else if (so2_24h < 380.5)
-  {
-    i_lo = 101;
-    i_hi = 200;
-    c_lo = 81;
-    c_hi = 380;
-  }
-  else if (so2_24h < 800.5)
-  {
-    i_lo = 201;
-    i_hi = 300;
-    c_lo = 381;
-    c_hi = 800;
-  }
-  else if (so2_24h < 1600.5)
-  {
-    i_lo = 301;
-    i_hi = 400;
-    c_lo = 801;
-    c_hi = 1600;
-  }
-  else
-  {
-    // index > 400
-    return 401;
-  }
-  aqi = max(aqi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, so2_24h));
-
-  // pm10  μg/m^3, Coarse Particulate Matter (<10μm)
-  if (pm10_24h < 50.5)
-  {
-    i_lo = 0;
-    i_hi = 50;
-    c_lo = 0;
-    c_hi = 50;
-  }
-  else if (pm10_24h < 100.5)
-  {
-    i_lo = 51;
-    i_hi = 100;
-    c_lo = 51;
-    c_hi = 100;
-  }
-  else if (pm10_24h < 250.5)
-  {
-    i_lo = 101;
-    i_hi = 200;
-    c_lo = 101;
-    c_hi = 250;
-  }
-  else if (pm10_24h < 350.5)
-  {
-    i_lo = 201;
-    i_hi = 300;
-    c_lo = 251;
-    c_hi = 350;
-  }
-  else if (pm10_24h < 430.5)
-  {
-    i_lo = 301;
-    i_hi = 400;
-    c_lo = 351;
-    c_hi = 430;
-  }
-  else
-  {
-    // index > 400
-    return 401;
-  }
-  aqi = max(aqi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, pm10_24h));
-
-  // pm2_5 μg/m^3, Fine Particulate Matter (<2.5μm)
-  if (pm2_5_24h < 30.5)
-  {
-    i_lo = 0;
-    i_hi = 50;
-    c_lo = 0;
-    c_hi = 30;
-  }
-  else if (pm2_5_24h < 60.5)
-  {
-    i_lo = 51;
-    i_hi = 100;
-    c_lo = 31;
-    c_hi = 60;
-  }
-  else if (pm2_5_24h < 90.5)
-  {
-    i_lo = 101;
-    i_hi = 200;
-    c_lo = 61;
-    c_hi = 90;
-  }
-  else if (pm2_5_24h < 120.5)
-  {
-    i_lo = 201;
-    i_hi = 300;
-    c_lo = 91;
-    c_hi = 120;
-  }
-  else if (pm2_5_24h < 250.5)
-  {
-    i_lo = 301;
-    i_hi = 400;
-    c_lo = 121;
-    c_hi = 250;
-  }
-  else
-  {
-    // index > 400
-    return 401;
-  }
-  aqi = max(aqi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, pm2_5_24h));
-
-  return aqi;
-} // end india_aqi
-
-/* Singapore (PSI)
- *
- * References:
- *   https://www.haze.gov.sg/
- *   http://www.haze.gov.sg/docs/default-source/faq/computation-of-the-pollutant-standards-index-%28psi%29.pdf
- */
-int singapore_psi(float co_8h,   float no2_1h,   float o3_1h, float o3_8h,
-                  float so2_24h, float pm10_24h, float pm2_5_24h)
-{
-  int psi = 0;
-  float i_lo, i_hi;
-  float c_lo, c_hi;
-
-  // co    μg/m^3, Carbon Monoxide (CO)
-  // 1mg/m^3 = 1000 μg/m^3
-  if (co_8h < 5050)
-  {
-    i_lo = 0;
-    i_hi = 50;
-    c_lo = 0;
-    c_hi = 5000;
-  }
-  else if (co_8h < 10050)
-  {
-    i_lo = 51;
-    i_hi = 100;
-    c_lo = 5100;
-    c_hi = 10000;
-  }
-  else if (co_8h < 17050)
-  {
-    i_lo = 101;
-    i_hi = 200;
-    c_lo = 10100;
-    c_hi = 17000;
-  }
-  else if (co_8h < 34050)
-  {
-    i_lo = 201;
-    i_hi = 300;
-    c_lo = 17100;
-    c_hi = 34000;
-  }
-  else if (co_8h < 46050)
-  {
-    i_lo = 301;
-    i_hi = 400;
-    c_lo = 34100;
-    c_hi = 46000;
-  }
-  else if (co_8h < 57550)
-  {
-    i_lo = 401;
-    i_hi = 500;
-    c_lo = 46100;
-    c_hi = 57500;
-  }
-  else
-  {
-    // index > 500
-    return 501;
-  }
-  psi = max(psi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, co_8h));
-
-  // no2   μg/m^3, Nitrogen Dioxide (NO2)
-  // only calculated if >= 1130 μg/m^3
-  if (no2_1h >= 1129.5)
-  {
-    if (no2_1h < 2260.5)
-    {
-      i_lo = 201;
-      i_hi = 300;
-      c_lo = 1131;
-      c_hi = 2260;
-    }
-    else if (no2_1h < 3000.5)
-    {
-      i_lo = 301;
-      i_hi = 400;
-      c_lo = 2261;
-      c_hi = 3000;
-    }
-    else if (no2_1h < 3750.5)
-    {
-      i_lo = 401;
-      i_hi = 500;
-      c_lo = 3001;
-      c_hi = 3750;
-    }
-    else
-    {
-      // index > 500
-      return 501;
-    }
-    if (no2_1h >= 1129.5 && no2_1h < 1130.5)
-    {
-      psi = max(psi, 200);
-    }
-    else
-    {
-      psi = max(psi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, no2_1h));
-    }
-  }
-
-  // o3    μg/m^3, Ozone (O3)
-  // When 8-hour o3 concentration is > 785 μg/m^3, then the PSI sub-index is
-  // calculated using the 1 hour concentration.
-  if (o3_8h <= 785)
-  {
-    if (o3_8h < 118.5)
-    {
-      i_lo = 0;
-      i_hi = 50;
-      c_lo = 0;
-      c_hi = 118;
-    }
-    else if (o3_8h < 157.5)
-    {
-      i_lo = 51;
-      i_hi = 100;
-      c_lo = 119;
-      c_hi = 157;
-    }
-    else if (o3_8h < 235.5)
-    {
-      i_lo = 101;
-      i_hi = 200;
-      c_lo = 158;
-      c_hi = 235;
-    }
-    else
-    {
-      // o3_8h <= 785
-      i_lo = 201;
-      i_hi = 300;
-      c_lo = 236;
-      c_hi = 785;
-    }
-    psi = max(psi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, o3_8h));
-  }
-  else
-  {
-    if (o3_1h < 118.5)
-    {
-      i_lo = 0;
-      i_hi = 50;
-      c_lo = 0;
-      c_hi = 118;
-    }
-    else if (o3_1h < 157.5)
-    {
-      i_lo = 51;
-      i_hi = 100;
-      c_lo = 119;
-      c_hi = 157;
-    }
-    else if (o3_1h < 235.5)
-    {
-      i_lo = 101;
-      i_hi = 200;
-      c_lo = 158;
-      c_hi = 235;
-    }
-    else if (o3_1h < 785.5)
-    {
-      i_lo = 201;
-      i_hi = 300;
-      c_lo = 236;
-      c_hi = 785;
-    }
-    else if (o3_1h < 980.5)
-    {
-      i_lo = 301;
-      i_hi = 400;
-      c_lo = 786;
-      c_hi = 980;
-    }
-    else if (o3_1h < 1180.5)
-    {
-      i_lo = 401;
-      i_hi = 500;
-      c_lo = 981;
-      c_hi = 1180;
-    }
-    else
-    {
-      // index > 500
-      return 501;
-    }
-    psi = max(psi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, o3_1h));
-  }
-
-  // so2   μg/m^3, Sulfur Dioxide (SO2)
-  if (so2_24h < 80.5)
-  {
-    i_lo = 0;
-    i_hi = 50;
-    c_lo = 0;
-    c_hi = 80;
-  }
-  else if (so2_24h < 365.5)
-  {
-    i_lo = 51;
-    i_hi = 100;
-    c_lo = 81;
-    c_hi = 365;
-  }
-  else if (so2_24h < 800.5)
-  {
-    i_lo = 101;
-    i_hi = 200;
-    c_lo = 366;
-    c_hi = 800;
-  }
-  else if (so2_24h < 1600.5)
-  {
-    i_lo = 201;
-    i_hi = 300;
-    c_lo = 801;
-    c_hi = 1600;
-  }
-  else if (so2_24h < 2100.5)
-  {
-    i_lo = 301;
-    i_hi = 400;
-    c_lo = 1601;
-    c_hi = 2100;
-  }
-  else if (so2_24h < 2620.5)
-  {
-    i_lo = 401;
-    i_hi = 500;
-    c_lo = 2101;
-    c_hi = 2620;
-  }
-  else
-  {
-    // index > 500
-    return 501;
-  }
-  psi = max(psi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, so2_24h));
-
-  // pm10  μg/m^3, Coarse Particulate Matter (<10μm)
-  if (pm10_24h < 50.5)
-  {
-    i_lo = 0;
-    i_hi = 50;
-    c_lo = 0;
-    c_hi = 50;
-  }
-  else if (pm10_24h < 150.5)
-  {
-    i_lo = 51;
-    i_hi = 100;
-    c_lo = 51;
-    c_hi = 150;
-  }
-  else if (pm10_24h < 350.5)
-  {
-    i_lo = 101;
-    i_hi = 200;
-    c_lo = 151;
-    c_hi = 350;
-  }
-  else if (pm10_24h < 420.5)
-  {
-    i_lo = 201;
-    i_hi = 300;
-    c_lo = 351;
-    c_hi = 420;
-  }
-  else if (pm10_24h < 500.5)
-  {
-    i_lo = 301;
-    i_hi = 400;
-    c_lo = 421;
-    c_hi = 500;
-  }
-  else if (pm10_24h < 600.5)
-  {
-    i_lo = 401;
-    i_hi = 500;
-    c_lo = 501;
-    c_hi = 600;
-  }
-  else
-  {
-    // index > 500
-    return 501;
-  }
-  psi = max(psi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, pm10_24h));
-
-  // pm2_5 μg/m^3, Fine Particulate Matter (<2.5μm)
-  if (pm2_5_24h < 12.5)
-  {
-    i_lo = 0;
-    i_hi = 50;
-    c_lo = 0;
-    c_hi = 12;
-  }
-  else if (pm2_5_24h < 55.5)
-  {
-    i_lo = 51;
-    i_hi = 100;
-    c_lo = 13;
-    c_hi = 55;
-  }
-  else if (pm2_5_24h < 150.5)
-  {
-    i_lo = 101;
-    i_hi = 200;
-    c_lo = 56;
-    c_hi = 150;
-  }
-  else if (pm2_5_24h < 250.5)
-  {
-    i_lo = 201;
-    i_hi = 300;
-    c_lo = 151;
-    c_hi = 250;
-  }
-  else if (pm2_5_24h < 350.5)
-  {
-    i_lo = 301;
-    i_hi = 400;
-    c_lo = 251;
-    c_hi = 350;
-  }
-  else if (pm2_5_24h < 500.5)
-  {
-    i_lo = 401;
-    i_hi = 500;
-    c_lo = 351;
-    c_hi = 500;
-  }
-  else
-  {
-    // index > 500
-    return 501;
-  }
-  psi = max(psi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, pm2_5_24h));
-
-  return psi;
-} // end singapore_psi
-
-/* South Korea (CAI)
- *
- * References:
- *   https://www.airkorea.or.kr/eng/khaiInfo?pMENU_NO=166
- */
-int south_korea_cai(float co_1h,  float no2_1h,   float o3_1h,
-                    float so2_1h, float pm10_24h, float pm2_5_24h)
-{
-  int cai = 0;
-  float i_lo, i_hi;
-  float c_lo, c_hi;
-
-  // co    μg/m^3, Carbon Monoxide (CO)
-  // 1ppm * 1000ppb/1ppm * 1.1456 μg/m^3/ppb = 1145.6 μg/m^3
-  if (co_1h < 2348.48)
-  {
-    i_lo = 0;
-    i_hi = 50;
-    c_lo = 0;
-    c_hi = 2291.2;
-  }
-  else if (co_1h < 10367.68)
-  {
-    i_lo = 51;
-    i_hi = 100;
-    c_lo = 2405.76;
-    c_hi = 10310.4;
-  }
-  else if (co_1h < 17241.28)
-  {
-    i_lo = 101;
-    i_hi = 250;
-    c_lo = 10424.96;
-    c_hi = 17184;
-  }
-  else if (co_1h < 57337.28)
-  {
-    i_lo = 251;
-    i_hi = 500;
-    c_lo = 17298.56;
-    c_hi = 57280;
-  }
-  else
-  {
-    // index > 500
-    return 501;
-  }
-  cai = max(cai, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, co_1h));
-
-  // no2   μg/m^3, Nitrogen Dioxide (NO2)
-  // 1ppm * 1000ppb/1ppm * 1.8816 μg/m^3/ppb = 1881.6 μg/m^3
-  if (no2_1h < 57.3888)
-  {
-    i_lo = 0;
-    i_hi = 50;
-    c_lo = 0;
-    c_hi = 56.448;
-  }
-  else if (no2_1h < 113.8368)
-  {
-    i_lo = 51;
-    i_hi = 100;
-    c_lo = 58.3296;
-    c_hi = 112.896;
-  }
-  else if (no2_1h < 377.2608)
-  {
-    i_lo = 101;
-    i_hi = 250;
-    c_lo = 114.7776;
-    c_hi = 376.32;
-  }
-  else if (no2_1h < 3772.608)
-  {
-    i_lo = 251;
-    i_hi = 500;
-    c_lo = 378.2016;
-    c_hi = 3763.2;
-  }
-  else
-  {
-    // index > 500
-    return 501;
-  }
-  cai = max(cai, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, no2_1h));
-
-  // o3    μg/m^3, Ozone (O3)
-  // 1ppm * 1000ppb/1ppm * 1.9632 μg/m^3/ppb = 1963.2 μg/m^3
-  if (o3_1h < 59.8776)
-  {
-    i_lo = 0;
-    i_hi = 50;
-    c_lo = 0;
-    c_hi = 58.896;
-  }
-  else if (o3_1h < 177.6696)
-  {
-    i_lo = 51;
-    i_hi = 100;
-    c_lo = 60.8592;
-    c_hi = 176.688;
-  }
-  else if (o3_1h < 295.4616)
-  {
-    i_lo = 101;
-    i_hi = 250;
-    c_lo = 178.6512;
-    c_hi = 294.48;
-  }
-  else if (o3_1h < 1178.9016)
-  {
-    i_lo = 251;
-    i_hi = 500;
-    c_lo = 296.4432;
-    c_hi = 1177.92;
-  }
-  else
-  {
-    // index > 500
-    return 501;
-  }
-  cai = max(cai, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, o3_1h));
-
-  // so2   μg/m^3, Sulfur Dioxide (SO2)
-  // 1ppm * 1000ppb/1ppm * 8.4744 μg/m^3/ppb = 8474.4 μg/m^3
-  if (so2_1h < 173.7252)
-  {
-    i_lo = 0;
-    i_hi = 50;
-    c_lo = 0;
-    c_hi = 169.488;
-  }
-  else if (so2_1h < 427.9572)
-  {
-    i_lo = 51;
-    i_hi = 100;
-    c_lo = 177.9624;
-    c_hi = 423.72;
-  }
-  else if (so2_1h < 1271.16)
-  {
-    i_lo = 101;
-    i_hi = 250;
-    c_lo = 432.1944;
-    c_hi = 1271.16;
-  }
-  else if (so2_1h < 8478.6372)
-  {
-    i_lo = 251;
-    i_hi = 500;
-    c_lo = 1279.6344;
-    c_hi = 8474.4;
-  }
-  else
-  {
-    // index > 500
-    return 501;
-  }
-  cai = max(cai, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, so2_1h));
-
-  // pm10  μg/m^3, Coarse Particulate Matter (<10μm)
-  if (pm10_24h < 30.5)
-  {
-    i_lo = 0;
-    i_hi = 50;
-    c_lo = 0;
-    c_hi = 30;
-  }
-  else if (pm10_24h < 80.5)
-  {
-    i_lo = 51;
-    i_hi = 100;
-    c_lo = 31;
-    c_hi = 80;
-  }
-  else if (pm10_24h < 150.5)
-  {
-    i_lo = 101;
-    i_hi = 250;
-    c_lo = 81;
-    c_hi = 150;
-  }
-  else if (pm10_24h < 600.5)
-  {
-    i_lo = 251;
-    i_hi = 500;
-    c_lo = 151;
-    c_hi = 600;
-  }
-  else
-  {
-    // index > 500
-    return 501;
-  }
-  cai = max(cai, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, pm10_24h));
-
-  // pm2_5 μg/m^3, Fine Particulate Matter (<2.5μm)
-  if (pm2_5_24h < 15.5)
-  {
-    i_lo = 0;
-    i_hi = 50;
-    c_lo = 0;
-    c_hi = 15;
-  }
-  else if (pm2_5_24h < 35.5)
-  {
-    i_lo = 51;
-    i_hi = 100;
-    c_lo = 16;
-    c_hi = 35;
-  }
-  else if (pm2_5_24h < 75.5)
-  {
-    i_lo = 101;
-    i_hi = 250;
-    c_lo = 36;
-    c_hi = 75;
-  }
-  else if (pm2_5_24h < 500.5)
-  {
-    i_lo = 251;
-    i_hi = 500;
-    c_lo = 76;
-    c_hi = 500;
-  }
-  else
-  {
-    // index > 500
-    return 501;
-  }
-  cai = max(cai, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, pm2_5_24h));
-
-  return cai;
-} // end south_korea_cai
-
-/* United Kingdom (DAQI)
- *
- * References:
- *   https://uk-air.defra.gov.uk/air-pollution/daqi?view=more-info
- *   https://en.wikipedia.org/wiki/Air_quality_index#United_Kingdom
- *   https://uk-air.defra.gov.uk/library/reports?report_id=750
- */
-int united_kingdom_daqi(float no2_1h,   float o3_8h, float so2_15min,
-                        float pm10_24h, float pm2_5_24h)
-{
-  // Pollutant averages are rounded to nearest integer
-  if (o3_8h >= 240.5 || no2_1h >= 600.5 || so2_15min >= 1064.5 ||
-      pm2_5_24h >= 70.5 || pm10_24h >= 100.5)
-  {
-    return 10;
-  }
-  else if (o3_8h >= 213.5 || no2_1h >= 534.5 || so2_15min >= 887.5 ||
-           pm2_5_24h >= 64.5 || pm10_24h >= 91.5)
-  {
-    return 9;
-  }
-  else if (o3_8h >= 187.5 || no2_1h >= 467.5 || so2_15min >= 710.5 ||
-           pm2_5_24h >= 58.5 || pm10_24h >= 83.5)
-  {
-    return 8;
-  }
-  else if (o3_8h >= 160.5 || no2_1h >= 400.5 || so2_15min >= 532.5 ||
-           pm2_5_24h >= 53.5 || pm10_24h >= 75.5)
-  {
-    return 7;
-  }
-  else if (o3_8h >= 140.5 || no2_1h >= 334.5 || so2_15min >= 443.5 ||
-           pm2_5_24h >= 47.5 || pm10_24h >= 66.5)
-  {
-    return 6;
-  }
-  else if (o3_8h >= 120.5 || no2_1h >= 267.5 || so2_15min >= 354.5 ||
-           pm2_5_24h >= 41.5 || pm10_24h >= 58.5)
-  {
-    return 5;
-  }
-  else if (o3_8h >= 100.5 || no2_1h >= 200.5 || so2_15min >= 266.5 ||
-           pm2_5_24h >= 35.5 || pm10_24h >= 50.5)
-  {
-    return 4;
-  }
-  else if (o3_8h >= 66.5 || no2_1h >= 134.5 || so2_15min >= 177.5 ||
-           pm2_5_24h >= 23.5 || pm10_24h >= 33.5)
-  {
-    return 3;
-  }
-  else if (o3_8h >= 33.5 || no2_1h >= 67.5 || so2_15min >= 88.5 ||
-           pm2_5_24h >= 11.5 || pm10_24h >= 16.5)
-  {
-    return 2;
-  }
-  else
-  {
-    return 1;
-  }
-} // end united_kingdom_daqi
-
-/* United States (AQI)
- *
- * References:
- *   https://www.epa.gov/outdoor-air-quality-data/how-aqi-calculated
- *   https://www.airnow.gov/sites/default/files/2020-05/aqi-technical-assistance-document-sept2018.pdf
- *   https://en.wikipedia.org/wiki/Air_quality_index#United_States
- */
-int united_states_aqi(float co_8h,    float no2_1h,
-                      float o3_1h,    float o3_8h,
-                      float so2_1h,   float so2_24h,
-                      float pm10_24h, float pm2_5_24h)
-{
-  int aqi = 0;
-  float i_lo, i_hi;
-  float c_lo, c_hi;
-
-  // Pollutant averages are truncated
-  co_8h = truncate_float(co_8h / 1145.6, 1); // (ppm) truncate to 1 decimal place
-  no2_1h = (int)(no2_1h / 1.8816);           // (ppb) truncate to integer
-  o3_1h = truncate_float(o3_1h / 1963.2, 3); // (ppm) truncate to 3 decimal places
-  o3_8h = truncate_float(o3_8h / 1963.2, 3); // (ppm) truncate to 3 decimal places
-  so2_1h = (int)(so2_1h / 8.4744);           // (ppb) truncate to integer
-  pm10_24h = (int)pm10_24h;                  // (μg/m^3) truncate to integer
-  pm2_5_24h = truncate_float(pm2_5_24h, 1);  // (μg/m^3) truncate to 1 decimal place
-
-  // co    μg/m^3, Carbon Monoxide (CO)
-  if (co_8h <= 4.4)
-  {
-    i_lo = 0;
-    i_hi = 50;
-    c_lo = 0;
-    c_hi = 4.4;
-  }
-  else if (co_8h <= 9.4)
-  {
-    i_lo = 51;
-    i_hi = 100;
-    c_lo = 4.5;
-    c_hi = 9.4;
-  }
-  else if (co_8h <= 12.4)
-  {
-    i_lo = 101;
-    i_hi = 150;
-    c_lo = 9.5;
-    c_hi = 12.4;
-  }
-  else if (co_8h <= 15.4)
-  {
-    i_lo = 151;
-    i_hi = 200;
-    c_lo = 12.5;
-    c_hi = 15.4;
-  }
-  else if (co_8h <= 30.4)
-  {
-    i_lo = 201;
-    i_hi = 300;
-    c_lo = 15.5;
-    c_hi = 30.4;
-  }
-  else if (co_8h <= 40.4)
-  {
-    i_lo = 301;
-    i_hi = 400;
-    c_lo = 30.5;
-    c_hi = 40.4;
-  }
-  else if (co_8h <= 50.4)
-  {
-    i_lo = 401;
-    i_hi = 500;
-    c_lo = 40.5;
-    c_hi = 50.4;
-  }
-  else
-  {
-    // index > 500
-    return 501;
-  }
-  aqi = max(aqi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, co_8h));
-
-  // no2   μg/m^3, Nitrogen Dioxide (NO2)
-  if (no2_1h <= 53)
-  {
-    i_lo = 0;
-    i_hi = 50;
-    c_lo = 0;
-    c_hi = 53;
-  }
-  else if (no2_1h <= 100)
-  {
-    i_lo = 51;
-    i_hi = 100;
-    c_lo = 54;
-    c_hi = 100;
-  }
-  else if (no2_1h <= 360)
-  {
-    i_lo = 101;
-    i_hi = 150;
-    c_lo = 101;
-    c_hi = 360;
-  }
-  else if (no2_1h <= 649)
-  {
-    i_lo = 151;
-    i_hi = 200;
-    c_lo = 361;
-    c_hi = 649;
-  }
-  else if (no2_1h <= 1249)
-  {
-    i_lo = 201;
-    i_hi = 300;
-    c_lo = 350;
-    c_hi = 1249;
-  }
-  else if (no2_1h <= 1649)
-  {
-    i_lo = 301;
-    i_hi = 400;
-    c_lo = 1250;
-    c_hi = 1649;
-  }
-  else if (no2_1h <= 2049)
-  {
-    i_lo = 401;
-    i_hi = 500;
-    c_lo = 1650;
-    c_hi = 2049;
-  }
-  else
-  {
-    // index > 500
-    return 501;
-  }
-  aqi = max(aqi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, no2_1h));
-
-  // o3    μg/m^3, Ground-Level Ozone (O3)
-  if (o3_1h >= 0.125)
-  {
-    if (o3_1h <= 0.164)
-    {
-      i_lo = 101;
-      i_hi = 150;
-      c_lo = 0.125;
-      c_hi = 0.164;
-    }
-    else if (o3_1h <= 0.204)
-    {
-      i_lo = 151;
-      i_hi = 200;
-      c_lo = 0.165;
-      c_hi = 0.204;
-    }
-    else if (o3_1h <= 0.404)
-    {
-      i_lo = 201;
-      i_hi = 300;
-      c_lo = 0.205;
-      c_hi = 0.404;
-    }
-    else if (o3_1h <= 1649)
-    {
-      i_lo = 301;
-      i_hi = 400;
-      c_lo = 1250;
-      c_hi = 1649;
-    }
-    else if (o3_1h <= 2049)
-    {
-      i_lo = 401;
-      i_hi = 500;
-      c_lo = 1650;
-      c_hi = 2049;
-    }
-    else
-    {
-      // index > 500
-      return 501;
-    }
-    aqi = max(aqi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, o3_1h));
-  }
-  if (o3_8h <= 0.200)
-  {
-    if (o3_8h <= 0.054)
-    {
-      i_lo = 0;
-      i_hi = 50;
-      c_lo = 0;
-      c_hi = 0.054;
-    }
-    else if (o3_8h <= 0.070)
-    {
-      i_lo = 51;
-      i_hi = 100;
-      c_lo = 0.055;
-      c_hi = 0.070;
-    }
-    else if (o3_8h <= 0.085)
-    {
-      i_lo = 101;
-      i_hi = 150;
-      c_lo = 0.071;
-      c_hi = 0.085;
-    }
-    else if (o3_8h <= 0.105)
-    {
-      i_lo = 151;
-      i_hi = 200;
-      c_lo = 0.086;
-      c_hi = 0.105;
-    }
-    else
-    {
-      // 0.106 <= o3_8h <= 0.200
-      i_lo = 201;
-      i_hi = 300;
-      c_lo = 0.106;
-      c_hi = 0.200;
-    }
-    aqi = max(aqi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, o3_8h));
-  }
-
-  // so2   μg/m^3, Sulfur Dioxide (SO2)
-  if (so2_1h <= 185)
-  {
-    if (so2_1h <= 35)
-    {
-      i_lo = 0;
-      i_hi = 50;
-      c_lo = 0;
-      c_hi = 35;
-    }
-    else if (so2_1h <= 75)
-    {
-      i_lo = 51;
-      i_hi = 100;
-      c_lo = 36;
-      c_hi = 75;
-    }
-    else
-    {
-      // 76 <= so2_1h <= 185
-      i_lo = 101;
-      i_hi = 150;
-      c_lo = 76;
-      c_hi = 185;
-    }
-    aqi = max(aqi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, so2_1h));
-  }
-  else
-  {
-    if (so2_24h <= 35)
-    {
-      i_lo = 0;
-      i_hi = 50;
-      c_lo = 0;
-      c_hi = 35;
-    }
-    else if (so2_24h <= 75)
-    {
-      i_lo = 51;
-      i_hi = 100;
-      c_lo = 36;
-      c_hi = 75;
-    }
-    else if (so2_24h <= 185)
-    {
-      i_lo = 101;
-      i_hi = 150;
-      c_lo = 76;
-      c_hi = 185;
-    }
-    else if (so2_24h <= 304)
-    {
-      i_lo = 151;
-      i_hi = 200;
-      c_lo = 186;
-      c_hi = 304;
-    }
-    else if (so2_24h <= 604)
-    {
-      i_lo = 201;
-      i_hi = 300;
-      c_lo = 305;
-      c_hi = 604;
-    }
-    else if (so2_24h <= 804)
-    {
-      i_lo = 301;
-      i_hi = 400;
-      c_lo = 605;
-      c_hi = 804;
-    }
-    else if (so2_24h <= 1004)
-    {
-      i_lo = 401;
-      i_hi = 500;
-      c_lo = 805;
-      c_hi = 1004;
-    }
-    else
-    {
-      // index > 500
-      return 501;
-    }
-    aqi = max(aqi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, so2_24h));
-  }
-
-  // pm10  μg/m^3, Coarse Particulate Matter (<10μm)
-  if (pm10_24h <= 54)
-  {
-    i_lo = 0;
-    i_hi = 50;
-    c_lo = 0;
-    c_hi = 54;
-  }
-  else if (pm10_24h <= 154)
-  {
-    i_lo = 51;
-    i_hi = 100;
-    c_lo = 55;
-    c_hi = 154;
-  }
-  else if (pm10_24h <= 254)
-  {
-    i_lo = 101;
-    i_hi = 150;
-    c_lo = 155;
-    c_hi = 254;
-  }
-  else if (pm10_24h <= 354)
-  {
-    i_lo = 151;
-    i_hi = 200;
-    c_lo = 255;
-    c_hi = 354;
-  }
-  else if (pm10_24h <= 424)
-  {
-    i_lo = 201;
-    i_hi = 300;
-    c_lo = 355;
-    c_hi = 424;
-  }
-  else if (pm10_24h <= 504)
-  {
-    i_lo = 301;
-    i_hi = 400;
-    c_lo = 425;
-    c_hi = 504;
-  }
-  else if (pm10_24h <= 604)
-  {
-    i_lo = 401;
-    i_hi = 500;
-    c_lo = 505;
-    c_hi = 604;
-  }
-  else
-  {
-    // index > 500
-    return 501;
-  }
-  aqi = max(aqi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, pm10_24h));
-
-  // pm2_5 μg/m^3, Fine Particulate Matter (<2.5μm)
-  if (pm2_5_24h <= 12.0)
-  {
-    i_lo = 0;
-    i_hi = 50;
-    c_lo = 0;
-    c_hi = 12.0;
-  }
-  else if (pm2_5_24h <= 35.4)
-  {
-    i_lo = 51;
-    i_hi = 100;
-    c_lo = 12.1;
-    c_hi = 35.4;
-  }
-  else if (pm2_5_24h <= 55.4)
-  {
-    i_lo = 101;
-    i_hi = 150;
-    c_lo = 35.5;
-    c_hi = 55.4;
-  }
-  else if (pm2_5_24h <= 150.4)
-  {
-    i_lo = 151;
-    i_hi = 200;
-    c_lo = 55.5;
-    c_hi = 150.4;
-  }
-  else if (pm2_5_24h <= 250.4)
-  {
-    i_lo = 201;
-    i_hi = 300;
-    c_lo = 150.5;
-    c_hi = 250.4;
-  }
-  else if (pm2_5_24h <= 350.4)
-  {
-    i_lo = 301;
-    i_hi = 400;
-    c_lo = 250.5;
-    c_hi = 350.4;
-  }
-  else if (pm2_5_24h <= 500.4)
-  {
-    i_lo = 401;
-    i_hi = 500;
-    c_lo = 350.5;
-    c_hi = 500.4;
-  }
-  else
-  {
-    // index > 500
-    return 501;
-  }
-  aqi = max(aqi, compute_piecewise_aqi(i_lo, i_hi, c_lo, c_hi, pm2_5_24h));
-
   return aqi;
 } // end united_states_aqi
 
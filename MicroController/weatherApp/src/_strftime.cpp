@@ -34,8 +34,14 @@
  * The code for %c, and %x follows the C11 specification for the "C" locale.
  *
  * Note: No implementations for %z and %Z.
+ *
+ * A format is parsed into a program of literal text and conversions, with the
+ * formats that %c, %x, %X, %r, %D, %R and %T stand for parsed into it too.
+ * Formats used again and again are compiled once by _strftime_compile, then
+ * each time only their conversions are formatted, by _strftime_run.
  */
 
+#include <algorithm>
 #include <cctype>
 #include <cmath>
 #include <cstdio>
@@ -210,418 +216,533 @@ static void iso_8601_2000_year(char *buf, int year, size_t fw)
 }
 #endif // POSIX_2008
 
-/* The strftime() function formats the broken-down time tm according to the
- * format specification format and places the result in the character array s of
- * size max.
+/* Writes i as at least two digits, like sprintf "%02d", without sprintf for
+ * the usual 0 - 99.
  */
-size_t _strftime(char *s, size_t maxsize, const char *format,
-                 const struct tm *timeptr)
+static void twoDigits(char *buf, int i)
+{
+  if (i < 0 || i > 99)
+  {
+    sprintf(buf, "%02d", i);
+    return;
+  }
+  buf[0] = '0' + i / 10;
+  buf[1] = '0' + i % 10;
+  buf[2] = '\0';
+} // end twoDigits
+
+/* Formats the conversion of op into tbuf, which holds 100 characters.
+ */
+static void formatConv(char *tbuf, const strftime_op_t &op,
+                       const struct tm *timeptr)
 {
-  char *endp = s + maxsize;
-  char *start = s;
-  char tbuf[100];
   int i, w;
   long y;
-
 #ifdef POSIX_2008
-  int pad;
-  size_t fw;
-  char flag;
+  size_t fw = op.fw;
 #endif // POSIX_2008
 
-  if (s == NULL || format == NULL || timeptr == NULL || maxsize == 0)
-    return 0;
+  tbuf[0] = '\0';
+  switch (op.conv)
+  {
+  case 'a': // abbreviated weekday name
+    if (timeptr->tm_wday < 0 || timeptr->tm_wday > 6)
+      strcpy(tbuf, "?");
+    else
+      strcpy(tbuf, LC_ABDAY[timeptr->tm_wday]);
+    break;
 
-  // quick check if we even need to bother
-  if (strchr(format, '%') == NULL && strlen(format) + 1 >= maxsize)
-    return 0;
+  case 'A': // full weekday name
+    if (timeptr->tm_wday < 0 || timeptr->tm_wday > 6)
+      strcpy(tbuf, "?");
+    else
+      strcpy(tbuf, LC_DAY[timeptr->tm_wday]);
+    break;
 
-  for (; *format && s < endp - 1; format++)
-  {
-    tbuf[0] = '\0';
-    if (*format != '%')
-    {
-      *s++ = *format;
-      continue;
-    }
-#ifdef POSIX_2008
-    pad = '\0';
-    fw = 0;
-    flag = '\0';
-    switch (*++format)
-    {
-    case '+':
-      flag = '+';
-      // fall through
-    case '0':
-      pad = '0';
-      format++;
-      break;
+  case 'b': // abbreviated month name
+  case 'h':
+    if (timeptr->tm_mon < 0 || timeptr->tm_mon > 11)
+      strcpy(tbuf, "?");
+    else
+      strcpy(tbuf, LC_ABMON[timeptr->tm_mon]);
+    break;
 
-    case '1':
-    case '2':
-    case '3':
-    case '4':
-    case '5':
-    case '6':
-    case '7':
-    case '8':
-    case '9':
-      break;
+  case 'B': // full month name
+    if (timeptr->tm_mon < 0 || timeptr->tm_mon > 11)
+      strcpy(tbuf, "?");
+    else
+      strcpy(tbuf, LC_MON[timeptr->tm_mon]);
+    break;
 
-    default:
-      format--;
-      goto again;
-    }
-    for (; isdigit(*format); format++)
+  case 'C':
+#ifdef POSIX_2008
+    if (op.pad != '\0' && fw > 0)
     {
-      fw = fw * 10 + (*format - '0');
+      size_t min_fw = (op.flag ? 3 : 2);
+
+      fw = max(fw, min_fw);
+      sprintf(tbuf, op.flag ? "%+0*ld" : "%0*ld", (int)fw,
+              (timeptr->tm_year + 1900L) / 100);
     }
-    format--;
+    else
 #endif // POSIX_2008
+      sprintf(tbuf, "%02ld", (timeptr->tm_year + 1900L) / 100);
+    break;
 
-  again:
-    switch (*++format)
-    {
-    case '\0':
-      *s++ = '%';
-      goto out;
+  case 'd': // day of the month, 01 - 31
+    twoDigits(tbuf, range(1, timeptr->tm_mday, 31));
+    break;
 
-    case '%':
-      *s++ = '%';
-      continue;
+  case 'e': // day of month, blank padded
+    twoDigits(tbuf, range(1, timeptr->tm_mday, 31));
+    if (tbuf[0] == '0')
+      tbuf[0] = ' ';
+    break;
 
-    case 'a': // abbreviated weekday name
-      if (timeptr->tm_wday < 0 || timeptr->tm_wday > 6)
-        strcpy(tbuf, "?");
-      else
-        strcpy(tbuf, LC_ABDAY[timeptr->tm_wday]);
-      break;
+  case 'F': // ISO 8601 date representation
+  {
+#ifdef POSIX_2008
+    // Field width for %F is for the whole thing.
+    // It must be at least 10.
 
-    case 'A': // full weekday name
-      if (timeptr->tm_wday < 0 || timeptr->tm_wday > 6)
-        strcpy(tbuf, "?");
-      else
-        strcpy(tbuf, LC_DAY[timeptr->tm_wday]);
-      break;
+    size_t min_fw = 10;
 
-    case 'b': // abbreviated month name
-      if (timeptr->tm_mon < 0 || timeptr->tm_mon > 11)
-        strcpy(tbuf, "?");
-      else
-        strcpy(tbuf, LC_ABMON[timeptr->tm_mon]);
-      break;
+    if (op.pad != '\0' && fw > 0)
+    {
+      fw = max(fw, min_fw);
+    }
+    else
+    {
+      fw = min_fw;
+    }
 
-    case 'B': // full month name
-      if (timeptr->tm_mon < 0 || timeptr->tm_mon > 11)
-        strcpy(tbuf, "?");
-      else
-        strcpy(tbuf, LC_MON[timeptr->tm_mon]);
-      break;
+    fw -= 6; // -XX-XX at end are invariant
 
-    case 'c':
-      _strftime(tbuf, sizeof(tbuf), LC_D_T_FMT, timeptr);
-      break;
+    iso_8601_2000_year(tbuf, timeptr->tm_year + 1900, fw);
+#else
+    sprintf(tbuf, "%ld", 1900L + timeptr->tm_year);
+#endif // POSIX_2008
+    char *m_d = tbuf + strlen(tbuf);
+    m_d[0] = '-';
+    twoDigits(m_d + 1, range(0, timeptr->tm_mon, 11) + 1);
+    m_d[3] = '-';
+    twoDigits(m_d + 4, range(1, timeptr->tm_mday, 31));
+  }
+  break;
+
+  case 'g':
+  case 'G':
+    // Year of ISO week.
+    //
+    // If it's December but the ISO week number is one,
+    // that week is in next year.
+    // If it's January but the ISO week number is 52 or
+    // 53, that week is in last year.
+    // Otherwise, it's this year.
+
+    w = iso8601wknum(timeptr);
+    if (timeptr->tm_mon == 11 && w == 1)
+      y = 1900L + timeptr->tm_year + 1;
+    else if (timeptr->tm_mon == 0 && w >= 52)
+      y = 1900L + timeptr->tm_year - 1;
+    else
+      y = 1900L + timeptr->tm_year;
 
-    case 'C':
+    if (op.conv == 'G')
+    {
 #ifdef POSIX_2008
-      if (pad != '\0' && fw > 0)
+      if (op.pad != '\0' && fw > 0)
       {
-        size_t min_fw = (flag ? 3 : 2);
+        size_t min_fw = 4;
 
         fw = max(fw, min_fw);
-        sprintf(tbuf, flag ? "%+0*ld" : "%0*ld", (int)fw,
-                (timeptr->tm_year + 1900L) / 100);
+        sprintf(tbuf, op.flag ? "%+0*ld" : "%0*ld", (int)fw,
+                y);
       }
       else
 #endif // POSIX_2008
-        sprintf(tbuf, "%02ld", (timeptr->tm_year + 1900L) / 100);
-      break;
-
-    case 'd': // day of the month, 01 - 31
-      i = range(1, timeptr->tm_mday, 31);
-      sprintf(tbuf, "%02d", i);
-      break;
+        sprintf(tbuf, "%ld", y);
+    }
+    else
+      sprintf(tbuf, "%02ld", y % 100);
+    break;
 
-    case 'D': // date as %m/%d/%y
-      _strftime(tbuf, sizeof(tbuf), "%m/%d/%y", timeptr);
-      break;
+  case 'H': // hour, 24-hour clock, 00 - 23
+    twoDigits(tbuf, range(0, timeptr->tm_hour, 23));
+    break;
 
-    case 'e': // day of month, blank padded
-      sprintf(tbuf, "%2d", range(1, timeptr->tm_mday, 31));
-      break;
+  case 'I': // hour, 12-hour clock, 01 - 12
+    i = range(0, timeptr->tm_hour, 23);
+    if (i == 0)
+      i = 12;
+    else if (i > 12)
+      i -= 12;
+    twoDigits(tbuf, i);
+    break;
 
-    case 'E':
-      // POSIX (now C99) locale extensions, ignored for now
-      goto again;
+  case 'j': // day of the year, 001 - 366
+    sprintf(tbuf, "%03d", timeptr->tm_yday + 1);
+    break;
 
-    case 'F': // ISO 8601 date representation
-    {
-#ifdef POSIX_2008
-      // Field width for %F is for the whole thing.
-      // It must be at least 10.
+  case 'm': // month, 01 - 12
+    twoDigits(tbuf, range(0, timeptr->tm_mon, 11) + 1);
+    break;
 
-      char m_d[10];
-      _strftime(m_d, sizeof(m_d), "-%m-%d", timeptr);
-      size_t min_fw = 10;
+  case 'M': // minute, 00 - 59
+    twoDigits(tbuf, range(0, timeptr->tm_min, 59));
+    break;
 
-      if (pad != '\0' && fw > 0)
-      {
-        fw = max(fw, min_fw);
-      }
-      else
-      {
-        fw = min_fw;
-      }
+  case 'n': // same as \n
+    tbuf[0] = '\n';
+    tbuf[1] = '\0';
+    break;
 
-      fw -= 6; // -XX-XX at end are invariant
+  case 'p': // am or pm based on 12-hour clock
+    i = range(0, timeptr->tm_hour, 23);
+    if (i < 12)
+      strcpy(tbuf, LC_AM_STR);
+    else
+      strcpy(tbuf, LC_PM_STR);
+    break;
 
-      iso_8601_2000_year(tbuf, timeptr->tm_year + 1900, fw);
-      strcat(tbuf, m_d);
-#else
-      _strftime(tbuf, sizeof(tbuf), "%Y-%m-%d", timeptr);
-#endif // POSIX_2008
+#ifdef GNU_EXT
+  case 'P': // Like %p but in lowercase: "am" or "pm"
+    i = range(0, timeptr->tm_hour, 23);
+    if (i < 12)
+      strcpy(tbuf, LC_AM_STR);
+    else
+      strcpy(tbuf, LC_PM_STR);
+    for (i = 0; tbuf[i] != '\0'; ++i)
+    {
+      tbuf[i] = tolower(tbuf[i]);
     }
     break;
+#endif
 
-    case 'g':
-    case 'G':
-      // Year of ISO week.
-      //
-      // If it's December but the ISO week number is one,
-      // that week is in next year.
-      // If it's January but the ISO week number is 52 or
-      // 53, that week is in last year.
-      // Otherwise, it's this year.
-
-      w = iso8601wknum(timeptr);
-      if (timeptr->tm_mon == 11 && w == 1)
-        y = 1900L + timeptr->tm_year + 1;
-      else if (timeptr->tm_mon == 0 && w >= 52)
-        y = 1900L + timeptr->tm_year - 1;
-      else
-        y = 1900L + timeptr->tm_year;
+  case 's': // time as seconds since the Epoch
+  {
+    struct tm non_const_timeptr;
 
-      if (*format == 'G')
-      {
-#ifdef POSIX_2008
-        if (pad != '\0' && fw > 0)
-        {
-          size_t min_fw = 4;
-
-          fw = max(fw, min_fw);
-          sprintf(tbuf, flag ? "%+0*ld" : "%0*ld", (int)fw,
-                  y);
-        }
-        else
-#endif // POSIX_2008
-          sprintf(tbuf, "%ld", y);
-      }
-      else
-        sprintf(tbuf, "%02ld", y % 100);
-      break;
+    non_const_timeptr = *timeptr;
+    sprintf(tbuf, "%ld", mktime(&non_const_timeptr));
+    break;
+  }
 
-    case 'h': // abbreviated month name
-      if (timeptr->tm_mon < 0 || timeptr->tm_mon > 11)
-        strcpy(tbuf, "?");
-      else
-        strcpy(tbuf, LC_ABMON[timeptr->tm_mon]);
-      break;
+  case 'S': // second, 00 - 60
+    twoDigits(tbuf, range(0, timeptr->tm_sec, 60));
+    break;
 
-    case 'H': // hour, 24-hour clock, 00 - 23
-      i = range(0, timeptr->tm_hour, 23);
-      sprintf(tbuf, "%02d", i);
-      break;
+  case 't': // same as \t
+    tbuf[0] = '\t';
+    tbuf[1] = '\0';
+    break;
 
-    case 'I': // hour, 12-hour clock, 01 - 12
-      i = range(0, timeptr->tm_hour, 23);
-      if (i == 0)
-        i = 12;
-      else if (i > 12)
-        i -= 12;
-      sprintf(tbuf, "%02d", i);
-      break;
+  case 'u':
+    // ISO 8601: Weekday as a decimal number [1 (Monday) - 7]
+    sprintf(tbuf, "%d", timeptr->tm_wday == 0 ? 7 : timeptr->tm_wday);
+    break;
 
-    case 'j': // day of the year, 001 - 366
-      sprintf(tbuf, "%03d", timeptr->tm_yday + 1);
-      break;
+  case 'U': // week of year, Sunday is first day of week
+    twoDigits(tbuf, weeknumber(timeptr, 0));
+    break;
 
-    case 'm': // month, 01 - 12
-      i = range(0, timeptr->tm_mon, 11);
-      sprintf(tbuf, "%02d", i + 1);
-      break;
+  case 'V': // week of year according ISO 8601
+    twoDigits(tbuf, iso8601wknum(timeptr));
+    break;
 
-    case 'M': // minute, 00 - 59
-      i = range(0, timeptr->tm_min, 59);
-      sprintf(tbuf, "%02d", i);
-      break;
+  case 'w': // weekday, Sunday == 0, 0 - 6
+    i = range(0, timeptr->tm_wday, 6);
+    sprintf(tbuf, "%d", i);
+    break;
 
-    case 'n': // same as \n
-      tbuf[0] = '\n';
-      tbuf[1] = '\0';
-      break;
+  case 'W': // week of year, Monday is first day of week
+    twoDigits(tbuf, weeknumber(timeptr, 1));
+    break;
 
-    case 'O':
-      // POSIX (now C99) locale extensions, ignored for now
-      goto again;
+  case 'y': // year without a century, 00 - 99
+    twoDigits(tbuf, timeptr->tm_year % 100);
+    break;
 
-    case 'p': // am or pm based on 12-hour clock
-      i = range(0, timeptr->tm_hour, 23);
-      if (i < 12)
-        strcpy(tbuf, LC_AM_STR);
-      else
-        strcpy(tbuf, LC_PM_STR);
-      break;
+  case 'Y': // year with century
+#ifdef POSIX_2008
+    if (op.pad != '\0' && fw > 0)
+    {
+      size_t min_fw = 4;
 
-#ifdef GNU_EXT
-    case 'P': // Like %p but in lowercase: "am" or "pm"
-      i = range(0, timeptr->tm_hour, 23);
-      if (i < 12)
-        strcpy(tbuf, LC_AM_STR);
-      else
-        strcpy(tbuf, LC_PM_STR);
-      i = 0;
-      while(tbuf[i] != '\0' && i != sizeof(tbuf))
-      {
-        tbuf[i] = tolower(tbuf[i]);
-        ++i;
-      }
-      break;
+      fw = max(fw, min_fw);
+      sprintf(tbuf, op.flag ? "%+0*ld" : "%0*ld", (int)fw,
+              1900L + timeptr->tm_year);
+    }
+    else
+#endif // POSIX_2008
+      sprintf(tbuf, "%ld", 1900L + timeptr->tm_year);
+    break;
+
+#ifdef TZ_EXT
+  case 'k': // hour, 24-hour clock, blank pad
+    twoDigits(tbuf, range(0, timeptr->tm_hour, 23));
+    if (tbuf[0] == '0')
+      tbuf[0] = ' ';
+    break;
+
+  case 'l': // hour, 12-hour clock, 1 - 12, blank pad
+    i = range(0, timeptr->tm_hour, 23);
+    if (i == 0)
+      i = 12;
+    else if (i > 12)
+      i -= 12;
+    twoDigits(tbuf, i);
+    if (tbuf[0] == '0')
+      tbuf[0] = ' ';
+    break;
 #endif
 
-    case 'r': // time in a.m. or p.m. notation
-      _strftime(tbuf, sizeof(tbuf), LC_T_FMT_AMPM, timeptr);
-      break;
+#ifdef VMS_EXT
+  case 'v': // date as dd-bbb-YYYY
+    sprintf(tbuf, "%2d-%3.3s-%4ld",
+            range(1, timeptr->tm_mday, 31),
+            LC_ABMON[range(0, timeptr->tm_mon, 11)],
+            timeptr->tm_year + 1900L);
+    for (i = 3; i < 6; i++)
+      if (islower(tbuf[i]))
+        tbuf[i] = toupper(tbuf[i]);
+    break;
+#endif
 
-    case 'R': // time as %H:%M
-      _strftime(tbuf, sizeof(tbuf), "%H:%M", timeptr);
-      break;
+  default:
+    tbuf[0] = '%';
+    tbuf[1] = op.conv;
+    tbuf[2] = '\0';
+    break;
+  }
+  return;
+} // end formatConv
 
-    case 's': // time as seconds since the Epoch
+/* Appends len characters of literal text to prog, joining them to the text
+ * before if they follow it in the same string.
+ *
+ * Returns false if prog is full.
+ */
+static bool appendText(strftime_program_t *prog, const char *text, size_t len)
+{
+  if (prog->numOps > 0)
+  {
+    strftime_op_t &last = prog->ops[prog->numOps - 1];
+    if (last.len > 0 && last.text + last.len == text
+     && last.len + len <= UINT16_MAX)
     {
-      struct tm non_const_timeptr;
+      last.len += len;
+      return true;
+    }
+  }
+  if (prog->numOps == STRFTIME_MAX_OPS || len > UINT16_MAX)
+    return false;
+
+  strftime_op_t &op = prog->ops[prog->numOps++];
+  op.text = text;
+  op.len = len;
+  op.conv = '\0';
+  op.pad = '\0';
+  op.flag = '\0';
+  op.fw = 0;
+  return true;
+} // end appendText
+
+/* Compiles format into the end of prog. Formats nest, e.g. %c is compiled
+ * from LC_D_T_FMT, which may use %r, so depth bounds how deep they may go.
+ *
+ * Returns false if prog is full or the formats nest too deep.
+ */
+static bool compileFormat(strftime_program_t *prog, const char *format,
+                          int depth)
+{
+  if (depth > 4)
+    return false;
 
-      non_const_timeptr = *timeptr;
-      sprintf(tbuf, "%ld", mktime(&non_const_timeptr));
-      break;
+  while (*format)
+  {
+    if (*format != '%')
+    {
+      size_t len = strcspn(format, "%");
+      if (!appendText(prog, format, len))
+        return false;
+      format += len;
+      continue;
     }
 
-    case 'S': // second, 00 - 60
-      i = range(0, timeptr->tm_sec, 60);
-      sprintf(tbuf, "%02d", i);
-      break;
+    const char *percent = format++;
+    char pad = '\0';
+    char flag = '\0';
+    size_t fw = 0;
+#ifdef POSIX_2008
+    if (*format == '+')
+    {
+      flag = '+';
+      pad = '0';
+      format++;
+    }
+    else if (*format == '0')
+    {
+      pad = '0';
+      format++;
+    }
+    for (; isdigit(*format); format++)
+    {
+      // wider fields would not fit the 100 characters of formatConv
+      fw = std::min<size_t>(fw * 10 + (*format - '0'), 99);
+    }
+#endif // POSIX_2008
 
-    case 't': // same as \t
-      tbuf[0] = '\t';
-      tbuf[1] = '\0';
-      break;
+    // POSIX (now C99) locale extensions, ignored for now
+    while (*format == 'E' || *format == 'O')
+      format++;
 
-    case 'T': // time as %H:%M:%S
-      _strftime(tbuf, sizeof(tbuf), "%H:%M:%S", timeptr);
+    bool ok = true;
+    switch (*format)
+    {
+    case '\0':
+      return appendText(prog, percent, 1);
+
+    case '%':
+      ok = appendText(prog, format, 1);
       break;
 
-    case 'u':
-      // ISO 8601: Weekday as a decimal number [1 (Monday) - 7]
-      sprintf(tbuf, "%d", timeptr->tm_wday == 0 ? 7 : timeptr->tm_wday);
+    case 'c':
+      ok = compileFormat(prog, LC_D_T_FMT, depth + 1);
       break;
 
-    case 'U': // week of year, Sunday is first day of week
-      sprintf(tbuf, "%02d", weeknumber(timeptr, 0));
+    case 'D': // date as %m/%d/%y
+      ok = compileFormat(prog, "%m/%d/%y", depth + 1);
       break;
 
-    case 'V': // week of year according ISO 8601
-      sprintf(tbuf, "%02d", iso8601wknum(timeptr));
+    case 'r': // time in a.m. or p.m. notation
+      ok = compileFormat(prog, LC_T_FMT_AMPM, depth + 1);
       break;
 
-    case 'w': // weekday, Sunday == 0, 0 - 6
-      i = range(0, timeptr->tm_wday, 6);
-      sprintf(tbuf, "%d", i);
+    case 'R': // time as %H:%M
+      ok = compileFormat(prog, "%H:%M", depth + 1);
       break;
 
-    case 'W': // week of year, Monday is first day of week
-      sprintf(tbuf, "%02d", weeknumber(timeptr, 1));
+    case 'T': // time as %H:%M:%S
+      ok = compileFormat(prog, "%H:%M:%S", depth + 1);
       break;
 
     case 'x': // appropriate date representation
-      _strftime(tbuf, sizeof(tbuf), LC_D_FMT, timeptr);
+      ok = compileFormat(prog, LC_D_FMT, depth + 1);
       break;
 
     case 'X': // appropriate time representation
-      _strftime(tbuf, sizeof(tbuf), LC_T_FMT, timeptr);
+      ok = compileFormat(prog, LC_T_FMT, depth + 1);
       break;
 
-    case 'y': // year without a century, 00 - 99
-      i = timeptr->tm_year % 100;
-      sprintf(tbuf, "%02d", i);
+    default:
+      if (prog->numOps == STRFTIME_MAX_OPS)
+        return false;
+      strftime_op_t &op = prog->ops[prog->numOps++];
+      op.text = percent;
+      op.len = 0;
+      op.conv = *format;
+      op.pad = pad;
+      op.flag = flag;
+      op.fw = fw;
       break;
+    }
+    if (!ok)
+      return false;
+    format++;
+  }
+  return true;
+} // end compileFormat
 
-    case 'Y': // year with century
-#ifdef POSIX_2008
-      if (pad != '\0' && fw > 0)
-      {
-        size_t min_fw = 4;
+/* Parses format, and the locale formats it refers to, into prog once, so it
+ * can be formatted by _strftime_run without parsing it again.
+ *
+ * Returns false, leaving prog empty, if format has more than STRFTIME_MAX_OPS
+ * conversions and runs of literal text.
+ */
+bool _strftime_compile(strftime_program_t *prog, const char *format)
+{
+  prog->numOps = 0;
+  prog->noConv = false;
+  if (format == NULL)
+    return false;
 
-        fw = max(fw, min_fw);
-        sprintf(tbuf, flag ? "%+0*ld" : "%0*ld", (int)fw,
-                1900L + timeptr->tm_year);
-      }
-      else
-#endif // POSIX_2008
-        sprintf(tbuf, "%ld", 1900L + timeptr->tm_year);
-      break;
+  if (!compileFormat(prog, format, 0))
+  {
+    prog->numOps = 0;
+    return false;
+  }
+  prog->noConv = strchr(format, '%') == NULL;
+  return true;
+} // end _strftime_compile
 
-#ifdef TZ_EXT
-    case 'k': // hour, 24-hour clock, blank pad
-      sprintf(tbuf, "%2d", range(0, timeptr->tm_hour, 23));
-      break;
+/* Formats the broken-down time tm according to the format compiled into prog,
+ * and places the result in the character array s of size max, like _strftime.
+ */
+size_t _strftime_run(char *s, size_t maxsize, const strftime_program_t *prog,
+                     const struct tm *timeptr)
+{
+  char *endp = s + maxsize;
+  char *start = s;
+  char tbuf[100];
 
-    case 'l': // hour, 12-hour clock, 1 - 12, blank pad
-      i = range(0, timeptr->tm_hour, 23);
-      if (i == 0)
-        i = 12;
-      else if (i > 12)
-        i -= 12;
-      sprintf(tbuf, "%2d", i);
-      break;
-#endif
+  if (s == NULL || prog == NULL || timeptr == NULL || maxsize == 0)
+    return 0;
 
-#ifdef VMS_EXT
-    case 'v': // date as dd-bbb-YYYY
-      sprintf(tbuf, "%2d-%3.3s-%4ld",
-              range(1, timeptr->tm_mday, 31),
-              LC_ABMON[range(0, timeptr->tm_mon, 11)],
-              timeptr->tm_year + 1900L);
-      for (i = 3; i < 6; i++)
-        if (islower(tbuf[i]))
-          tbuf[i] = toupper(tbuf[i]);
-      break;
-#endif
+  // quick check if we even need to bother
+  if (prog->noConv)
+  {
+    size_t len = 0;
+    for (int n = 0; n < prog->numOps; ++n)
+      len += prog->ops[n].len;
+    if (len + 1 >= maxsize)
+      return 0;
+  }
 
-    default:
-      tbuf[0] = '%';
-      tbuf[1] = *format;
-      tbuf[2] = '\0';
-      break;
+  for (int n = 0; n < prog->numOps; ++n)
+  {
+    const strftime_op_t &op = prog->ops[n];
+    if (s >= endp - 1)
+      return 0;
+
+    if (op.len > 0)
+    {
+      if (op.len > endp - 1 - s)
+        return 0;
+      memcpy(s, op.text, op.len);
+      s += op.len;
+      continue;
     }
-    i = strlen(tbuf);
+
+    formatConv(tbuf, op, timeptr);
+    size_t i = strlen(tbuf);
     if (i)
     {
       if (s + i < endp - 1)
       {
-        strcpy(s, tbuf);
+        memcpy(s, tbuf, i);
         s += i;
       }
       else
         return 0;
     }
   }
-out:
-  if (s < endp && *format == '\0')
-  {
-    *s = '\0';
-    return (s - start);
-  }
-  else
+  *s = '\0';
+  return (s - start);
+} // end _strftime_run
+
+/* The strftime() function formats the broken-down time tm according to the
+ * format specification format and places the result in the character array s of
+ * size max.
+ *
+ * format is compiled on every call, formats used again and again are better
+ * compiled once with _strftime_compile and formatted with _strftime_run.
+ */
+size_t _strftime(char *s, size_t maxsize, const char *format,
+                 const struct tm *timeptr)
+{
+  strftime_program_t prog;
+  if (!_strftime_compile(&prog, format))
     return 0;
+  return _strftime_run(s, maxsize, &prog, timeptr);
 } // end _strftime
-
@@ -15,241 +15,795 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
-#include <vector>
+#include <cstring>
 #include <ArduinoJson.h>
 #include "api_response.h"
 #include "config.h"
+#include "json_stream.h"
 
-DeserializationError deserializeOneCall(WiFiClient &json,
-                                        owm_resp_onecall_t &r)
+// longest key we need to tell apart, longer keys are truncated and skipped
+#define KEY_SIZE 24
+// longest weather main/description we keep
+#define VALUE_SIZE 64
+
+/* Returns the string stored at offset in r's text arena.
+ */
+const char *owmText(const owm_resp_onecall_t &r, uint16_t offset)
 {
-  int i;
+  return offset < r.text_len ? &r.text[offset] : "";
+} // end owmText
 
-  JsonDocument filter;
-  filter["current"]  = true;
-  filter["minutely"] = false;
-  filter["hourly"]   = true;
-  filter["daily"]    = true;
-#if !DISPLAY_ALERTS
-  filter["alerts"]   = false;
-#else
-  // description can be very long so they are filtered out to save on memory
-  // along with sender_name
-  for (int i = 0; i < OWM_NUM_ALERTS; ++i)
-  {
-    filter["alerts"][i]["sender_name"] = false;
-    filter["alerts"][i]["event"]       = true;
-    filter["alerts"][i]["start"]       = true;
-    filter["alerts"][i]["end"]         = true;
-    filter["alerts"][i]["description"] = false;
-    filter["alerts"][i]["tags"]        = true;
+/* Stores s in r's text arena and returns its offset. Weather descriptions
+ * repeat a lot across the hourly/daily forecast, so a string that is already
+ * in the arena is reused. If the arena is full the empty string is returned.
+ */
+uint16_t owmAddText(owm_resp_onecall_t &r, const char *s)
+{
+  uint16_t offset = 0;
+  while (offset < r.text_len)
+  {
+    if (strcmp(&r.text[offset], s) == 0)
+    {
+      return offset;
+    }
+    offset += strlen(&r.text[offset]) + 1;
   }
-#endif
 
-  JsonDocument doc;
+  size_t len = strlen(s) + 1;
+  if (r.text_len + len > OWM_TEXT_ARENA_SIZE)
+  {
+    return 0;
+  }
+  memcpy(&r.text[r.text_len], s, len);
+  r.text_len += len;
+  return offset;
+} // end owmAddText
+
+/* Returns hour i of the hourly forecast h as one struct.
+ */
+owm_hourly_t owmHour(const owm_hourly_series_t &h, int i)
+{
+  owm_hourly_t hour;
+  hour.dt         = h.dt[i];
+  hour.temp       = h.temp[i];
+  hour.feels_like = h.feels_like[i];
+  hour.pressure   = h.pressure[i];
+  hour.humidity   = h.humidity[i];
+  hour.dew_point  = h.dew_point[i];
+  hour.clouds     = h.clouds[i];
+  hour.uvi        = h.uvi[i];
+  hour.visibility = h.visibility[i];
+  hour.wind_speed = h.wind_speed[i];
+  hour.wind_gust  = h.wind_gust[i];
+  hour.wind_deg   = h.wind_deg[i];
+  hour.pop        = h.pop[i];
+  hour.rain_1h    = h.rain_1h[i];
+  hour.snow_1h    = h.snow_1h[i];
+  hour.weather    = h.weather[i];
+  return hour;
+} // end owmHour
 
-  DeserializationError error = deserializeJson(doc, json,
-                                         DeserializationOption::Filter(filter));
-#if DEBUG_LEVEL >= 1
-  Serial.println("[debug] doc.overflowed() : "
-                 + String(doc.overflowed()));
-#endif
-#if DEBUG_LEVEL >= 2
-  serializeJsonPretty(doc, Serial);
-#endif
-  if (error) {
-    return error;
-  }
-
-  r.lat             = doc["lat"]            .as<float>();
-  r.lon             = doc["lon"]            .as<float>();
-  r.timezone        = doc["timezone"]       .as<const char *>();
-  r.timezone_offset = doc["timezone_offset"].as<int>();
-
-  JsonObject current = doc["current"];
-  r.current.dt         = current["dt"]        .as<int64_t>();
-  r.current.sunrise    = current["sunrise"]   .as<int64_t>();
-  r.current.sunset     = current["sunset"]    .as<int64_t>();
-  r.current.temp       = current["temp"]      .as<float>();
-  r.current.feels_like = current["feels_like"].as<float>();
-  r.current.pressure   = current["pressure"]  .as<int>();
-  r.current.humidity   = current["humidity"]  .as<int>();
-  r.current.dew_point  = current["dew_point"] .as<float>();
-  r.current.clouds     = current["clouds"]    .as<int>();
-  r.current.uvi        = current["uvi"]       .as<float>();
-  r.current.visibility = current["visibility"].as<int>();
-  r.current.wind_speed = current["wind_speed"].as<float>();
-  r.current.wind_gust  = current["wind_gust"] .as<float>();
-  r.current.wind_deg   = current["wind_deg"]  .as<int>();
-  r.current.rain_1h    = current["rain"]["1h"].as<float>();
-  r.current.snow_1h    = current["snow"]["1h"].as<float>();
-  JsonObject current_weather = current["weather"][0];
-  r.current.weather.id          = current_weather["id"]         .as<int>();
-  r.current.weather.main        = current_weather["main"]       .as<const char *>();
-  r.current.weather.description = current_weather["description"].as<const char *>();
-  r.current.weather.icon        = current_weather["icon"]       .as<const char *>();
-
-  // minutely forecast is currently unused
-  // i = 0;
-  // for (JsonObject minutely : doc["minutely"].as<JsonArray>())
-  // {
-  //   r.minutely[i].dt            = minutely["dt"]           .as<int64_t>();
-  //   r.minutely[i].precipitation = minutely["precipitation"].as<float>();
-
-  //   if (i == OWM_NUM_MINUTELY - 1)
-  //   {
-  //     break;
-  //   }
-  //   ++i;
-  // }
-
-  i = 0;
-  for (JsonObject hourly : doc["hourly"].as<JsonArray>())
-  {
-    r.hourly[i].dt         = hourly["dt"]        .as<int64_t>();
-    r.hourly[i].temp       = hourly["temp"]      .as<float>();
-    r.hourly[i].feels_like = hourly["feels_like"].as<float>();
-    r.hourly[i].pressure   = hourly["pressure"]  .as<int>();
-    r.hourly[i].humidity   = hourly["humidity"]  .as<int>();
-    r.hourly[i].dew_point  = hourly["dew_point"] .as<float>();
-    r.hourly[i].clouds     = hourly["clouds"]    .as<int>();
-    r.hourly[i].uvi        = hourly["uvi"]       .as<float>();
-    r.hourly[i].visibility = hourly["visibility"].as<int>();
-    r.hourly[i].wind_speed = hourly["wind_speed"].as<float>();
-    r.hourly[i].wind_gust  = hourly["wind_gust"] .as<float>();
-    r.hourly[i].wind_deg   = hourly["wind_deg"]  .as<int>();
-    r.hourly[i].pop        = hourly["pop"]       .as<float>();
-    r.hourly[i].rain_1h    = hourly["rain"]["1h"].as<float>();
-    r.hourly[i].snow_1h    = hourly["snow"]["1h"].as<float>();
-    JsonObject hourly_weather = hourly["weather"][0];
-    r.hourly[i].weather.id          = hourly_weather["id"]         .as<int>();
-    r.hourly[i].weather.main        = hourly_weather["main"]       .as<const char *>();
-    r.hourly[i].weather.description = hourly_weather["description"].as<const char *>();
-    r.hourly[i].weather.icon        = hourly_weather["icon"]       .as<const char *>();
-
-    if (i == OWM_NUM_HOURLY - 1)
-    {
-      break;
-    }
-    ++i;
-  }
-
-  i = 0;
-  for (JsonObject daily : doc["daily"].as<JsonArray>())
-  {
-    r.daily[i].dt         = daily["dt"]        .as<int64_t>();
-    r.daily[i].sunrise    = daily["sunrise"]   .as<int64_t>();
-    r.daily[i].sunset     = daily["sunset"]    .as<int64_t>();
-    r.daily[i].moonrise   = daily["moonrise"]  .as<int64_t>();
-    r.daily[i].moonset    = daily["moonset"]   .as<int64_t>();
-    r.daily[i].moon_phase = daily["moon_phase"].as<float>();
-    JsonObject daily_temp = daily["temp"];
-    r.daily[i].temp.morn  = daily_temp["morn"] .as<float>();
-    r.daily[i].temp.day   = daily_temp["day"]  .as<float>();
-    r.daily[i].temp.eve   = daily_temp["eve"]  .as<float>();
-    r.daily[i].temp.night = daily_temp["night"].as<float>();
-    r.daily[i].temp.min   = daily_temp["min"]  .as<float>();
-    r.daily[i].temp.max   = daily_temp["max"]  .as<float>();
-    JsonObject daily_feels_like = daily["feels_like"];
-    r.daily[i].feels_like.morn  = daily_feels_like["morn"] .as<float>();
-    r.daily[i].feels_like.day   = daily_feels_like["day"]  .as<float>();
-    r.daily[i].feels_like.eve   = daily_feels_like["eve"]  .as<float>();
-    r.daily[i].feels_like.night = daily_feels_like["night"].as<float>();
-    r.daily[i].pressure   = daily["pressure"]  .as<int>();
-    r.daily[i].humidity   = daily["humidity"]  .as<int>();
-    r.daily[i].dew_point  = daily["dew_point"] .as<float>();
-    r.daily[i].clouds     = daily["clouds"]    .as<int>();
-    r.daily[i].uvi        = daily["uvi"]       .as<float>();
-    r.daily[i].visibility = daily["visibility"].as<int>();
-    r.daily[i].wind_speed = daily["wind_speed"].as<float>();
-    r.daily[i].wind_gust  = daily["wind_gust"] .as<float>();
-    r.daily[i].wind_deg   = daily["wind_deg"]  .as<int>();
-    r.daily[i].pop        = daily["pop"]       .as<float>();
-    r.daily[i].rain       = daily["rain"]      .as<float>();
-    r.daily[i].snow       = daily["snow"]      .as<float>();
-    JsonObject daily_weather = daily["weather"][0];
-    r.daily[i].weather.id          = daily_weather["id"]         .as<int>();
-    r.daily[i].weather.main        = daily_weather["main"]       .as<const char *>();
-    r.daily[i].weather.description = daily_weather["description"].as<const char *>();
-    r.daily[i].weather.icon        = daily_weather["icon"]       .as<const char *>();
-
-    if (i == OWM_NUM_DAILY - 1)
-    {
-      break;
-    }
-    ++i;
+/* Stores hour as hour i of the hourly forecast h.
+ */
+void owmSetHour(owm_hourly_series_t &h, int i, const owm_hourly_t &hour)
+{
+  h.dt[i]         = hour.dt;
+  h.temp[i]       = hour.temp;
+  h.feels_like[i] = hour.feels_like;
+  h.pressure[i]   = hour.pressure;
+  h.humidity[i]   = hour.humidity;
+  h.dew_point[i]  = hour.dew_point;
+  h.clouds[i]     = hour.clouds;
+  h.uvi[i]        = hour.uvi;
+  h.visibility[i] = hour.visibility;
+  h.wind_speed[i] = hour.wind_speed;
+  h.wind_gust[i]  = hour.wind_gust;
+  h.wind_deg[i]   = hour.wind_deg;
+  h.pop[i]        = hour.pop;
+  h.rain_1h[i]    = hour.rain_1h;
+  h.snow_1h[i]    = hour.snow_1h;
+  h.weather[i]    = hour.weather;
+  return;
+} // end owmSetHour
+
+/* Converts an icon id string like "10d" to its owm_icon_t.
+ */
+static owm_icon_t parseIcon(const char *icon)
+{
+  if (icon[0] < '0' || icon[0] > '9'
+   || icon[1] < '0' || icon[1] > '9'
+   || (icon[2] != 'd' && icon[2] != 'n')
+   || icon[3] != '\0')
+  {
+    return OWM_ICON_UNKNOWN;
   }
+  int num = (icon[0] - '0') * 10 + (icon[1] - '0');
+  return static_cast<owm_icon_t>(OWM_ICON(num, icon[2] == 'n'));
+} // end parseIcon
 
-#if DISPLAY_ALERTS
-  i = 0;
-  for (JsonObject alerts : doc["alerts"].as<JsonArray>())
+/* Reads the first entry of a "weather" array, the rest are skipped.
+ */
+static void readWeather(JsonStreamReader &reader, owm_resp_onecall_t &r,
+                        owm_weather_t &w)
+{
+  char key[KEY_SIZE];
+  char value[VALUE_SIZE];
+  bool haveFirst = false;
+  if (reader.peek() != '[')
   {
-    owm_alerts_t new_alert = {};
-    // new_alert.sender_name = alerts["sender_name"].as<const char *>();
-    new_alert.event       = alerts["event"]      .as<const char *>();
-    new_alert.start       = alerts["start"]      .as<int64_t>();
-    new_alert.end         = alerts["end"]        .as<int64_t>();
-    // new_alert.description = alerts["description"].as<const char *>();
-    new_alert.tags        = alerts["tags"][0]    .as<const char *>();
-    r.alerts.push_back(new_alert);
+    reader.skipValue();
+    return;
+  }
+  reader.beginArray();
+  while (reader.nextElement())
+  {
+    if (haveFirst)
+    {
+      reader.skipValue();
+      continue;
+    }
+    haveFirst = true;
+    reader.beginObject();
+    while (reader.nextKey(key, sizeof(key)))
+    {
+      if (strcmp(key, "id") == 0)
+      {
+        w.id = reader.readInt();
+      }
+      else if (strcmp(key, "main") == 0)
+      {
+        reader.readString(value, sizeof(value));
+        w.main = owmAddText(r, value);
+      }
+      else if (strcmp(key, "description") == 0)
+      {
+        reader.readString(value, sizeof(value));
+        w.description = owmAddText(r, value);
+      }
+      else if (strcmp(key, "icon") == 0)
+      {
+        reader.readString(value, sizeof(value));
+        w.icon = parseIcon(value);
+      }
+      else
+      {
+        reader.skipValue();
+      }
+    }
+  }
+} // end readWeather
 
-    if (i == OWM_NUM_ALERTS - 1)
+/* Reads the "1h" volume out of a {"1h": x} rain/snow object.
+ */
+static float readVolume1h(JsonStreamReader &reader)
+{
+  char key[KEY_SIZE];
+  float volume = 0;
+  if (reader.peek() != '{')
+  {
+    reader.skipValue();
+    return volume;
+  }
+  reader.beginObject();
+  while (reader.nextKey(key, sizeof(key)))
+  {
+    if (strcmp(key, "1h") == 0)
     {
-      break;
+      volume = reader.readFloat();
+    }
+    else
+    {
+      reader.skipValue();
     }
-    ++i;
   }
+  return volume;
+} // end readVolume1h
+
+static void readCurrent(JsonStreamReader &reader, owm_resp_onecall_t &r,
+                        owm_current_t &c)
+{
+  char key[KEY_SIZE];
+  c = {};
+  reader.beginObject();
+  while (reader.nextKey(key, sizeof(key)))
+  {
+    if      (strcmp(key, "dt")         == 0) { c.dt         = reader.readInt64(); }
+    else if (strcmp(key, "sunrise")    == 0) { c.sunrise    = reader.readInt64(); }
+    else if (strcmp(key, "sunset")     == 0) { c.sunset     = reader.readInt64(); }
+    else if (strcmp(key, "temp")       == 0) { c.temp       = reader.readFloat(); }
+    else if (strcmp(key, "feels_like") == 0) { c.feels_like = reader.readFloat(); }
+    else if (strcmp(key, "pressure")   == 0) { c.pressure   = reader.readInt();   }
+    else if (strcmp(key, "humidity")   == 0) { c.humidity   = reader.readInt();   }
+    else if (strcmp(key, "dew_point")  == 0) { c.dew_point  = reader.readFloat(); }
+    else if (strcmp(key, "clouds")     == 0) { c.clouds     = reader.readInt();   }
+    else if (strcmp(key, "uvi")        == 0) { c.uvi        = reader.readFloat(); }
+    else if (strcmp(key, "visibility") == 0) { c.visibility = reader.readInt();   }
+    else if (strcmp(key, "wind_speed") == 0) { c.wind_speed = reader.readFloat(); }
+    else if (strcmp(key, "wind_gust")  == 0) { c.wind_gust  = reader.readFloat(); }
+    else if (strcmp(key, "wind_deg")   == 0) { c.wind_deg   = reader.readInt();   }
+    else if (strcmp(key, "rain")       == 0) { c.rain_1h    = readVolume1h(reader); }
+    else if (strcmp(key, "snow")       == 0) { c.snow_1h    = readVolume1h(reader); }
+    else if (strcmp(key, "weather")    == 0) { readWeather(reader, r, c.weather); }
+    else                                     { reader.skipValue(); }
+  }
+} // end readCurrent
+
+/* Reads hour i of the hourly forecast straight into its place in r.hourly.
+ */
+static void readHourly(JsonStreamReader &reader, owm_resp_onecall_t &r, int i)
+{
+  char key[KEY_SIZE];
+  owm_hourly_series_t &h = r.hourly;
+  owmSetHour(h, i, {});
+  reader.beginObject();
+  while (reader.nextKey(key, sizeof(key)))
+  {
+    if      (strcmp(key, "dt")         == 0) { h.dt[i]         = reader.readInt64(); }
+    else if (strcmp(key, "temp")       == 0) { h.temp[i]       = reader.readFloat(); }
+    else if (strcmp(key, "feels_like") == 0) { h.feels_like[i] = reader.readFloat(); }
+    else if (strcmp(key, "pressure")   == 0) { h.pressure[i]   = reader.readInt();   }
+    else if (strcmp(key, "humidity")   == 0) { h.humidity[i]   = reader.readInt();   }
+    else if (strcmp(key, "dew_point")  == 0) { h.dew_point[i]  = reader.readFloat(); }
+    else if (strcmp(key, "clouds")     == 0) { h.clouds[i]     = reader.readInt();   }
+    else if (strcmp(key, "uvi")        == 0) { h.uvi[i]        = reader.readFloat(); }
+    else if (strcmp(key, "visibility") == 0) { h.visibility[i] = reader.readInt();   }
+    else if (strcmp(key, "wind_speed") == 0) { h.wind_speed[i] = reader.readFloat(); }
+    else if (strcmp(key, "wind_gust")  == 0) { h.wind_gust[i]  = reader.readFloat(); }
+    else if (strcmp(key, "wind_deg")   == 0) { h.wind_deg[i]   = reader.readInt();   }
+    else if (strcmp(key, "pop")        == 0) { h.pop[i]        = reader.readFloat(); }
+    else if (strcmp(key, "rain")       == 0) { h.rain_1h[i]    = readVolume1h(reader); }
+    else if (strcmp(key, "snow")       == 0) { h.snow_1h[i]    = readVolume1h(reader); }
+    else if (strcmp(key, "weather")    == 0) { readWeather(reader, r, h.weather[i]); }
+    else                                     { reader.skipValue(); }
+  }
+} // end readHourly
+
+/* Reads a temp/feels_like object. Fields that don't exist in t (feels_like has
+ * no min/max) are given as nullptr.
+ */
+static void readDailyTemp(JsonStreamReader &reader,
+                          float *morn, float *day, float *eve, float *night,
+                          float *min, float *max)
+{
+  char key[KEY_SIZE];
+  reader.beginObject();
+  while (reader.nextKey(key, sizeof(key)))
+  {
+    float *dst = nullptr;
+    if      (strcmp(key, "morn")  == 0) { dst = morn;  }
+    else if (strcmp(key, "day")   == 0) { dst = day;   }
+    else if (strcmp(key, "eve")   == 0) { dst = eve;   }
+    else if (strcmp(key, "night") == 0) { dst = night; }
+    else if (strcmp(key, "min")   == 0) { dst = min;   }
+    else if (strcmp(key, "max")   == 0) { dst = max;   }
+
+    if (dst != nullptr)
+    {
+      *dst = reader.readFloat();
+    }
+    else
+    {
+      reader.skipValue();
+    }
+  }
+} // end readDailyTemp
+
+static void readDaily(JsonStreamReader &reader, owm_resp_onecall_t &r,
+                      owm_daily_t &d)
+{
+  char key[KEY_SIZE];
+  d = {};
+  reader.beginObject();
+  while (reader.nextKey(key, sizeof(key)))
+  {
+    if      (strcmp(key, "dt")         == 0) { d.dt         = reader.readInt64(); }
+    else if (strcmp(key, "sunrise")    == 0) { d.sunrise    = reader.readInt64(); }
+    else if (strcmp(key, "sunset")     == 0) { d.sunset     = reader.readInt64(); }
+    else if (strcmp(key, "moonrise")   == 0) { d.moonrise   = reader.readInt64(); }
+    else if (strcmp(key, "moonset")    == 0) { d.moonset    = reader.readInt64(); }
+    else if (strcmp(key, "moon_phase") == 0) { d.moon_phase = reader.readFloat(); }
+    else if (strcmp(key, "temp")       == 0)
+    {
+      readDailyTemp(reader, &d.temp.morn, &d.temp.day, &d.temp.eve,
+                    &d.temp.night, &d.temp.min, &d.temp.max);
+    }
+    else if (strcmp(key, "feels_like") == 0)
+    {
+      readDailyTemp(reader, &d.feels_like.morn, &d.feels_like.day,
+                    &d.feels_like.eve, &d.feels_like.night, nullptr, nullptr);
+    }
+    else if (strcmp(key, "pressure")   == 0) { d.pressure   = reader.readInt();   }
+    else if (strcmp(key, "humidity")   == 0) { d.humidity   = reader.readInt();   }
+    else if (strcmp(key, "dew_point")  == 0) { d.dew_point  = reader.readFloat(); }
+    else if (strcmp(key, "clouds")     == 0) { d.clouds     = reader.readInt();   }
+    else if (strcmp(key, "uvi")        == 0) { d.uvi        = reader.readFloat(); }
+    else if (strcmp(key, "visibility") == 0) { d.visibility = reader.readInt();   }
+    else if (strcmp(key, "wind_speed") == 0) { d.wind_speed = reader.readFloat(); }
+    else if (strcmp(key, "wind_gust")  == 0) { d.wind_gust  = reader.readFloat(); }
+    else if (strcmp(key, "wind_deg")   == 0) { d.wind_deg   = reader.readInt();   }
+    else if (strcmp(key, "pop")        == 0) { d.pop        = reader.readFloat(); }
+    else if (strcmp(key, "rain")       == 0) { d.rain       = reader.readFloat(); }
+    else if (strcmp(key, "snow")       == 0) { d.snow       = reader.readFloat(); }
+    else if (strcmp(key, "weather")    == 0) { readWeather(reader, r, d.weather); }
+    else                                     { reader.skipValue(); }
+  }
+} // end readDaily
+
+#if DISPLAY_ALERTS
+/* sender_name and description can be very long, so they are skipped to save
+ * on memory. Only the first tag is kept.
+ */
+static void readAlert(JsonStreamReader &reader, owm_alerts_t &a)
+{
+  char key[KEY_SIZE];
+  reader.beginObject();
+  while (reader.nextKey(key, sizeof(key)))
+  {
+    if (strcmp(key, "event") == 0)
+    {
+      reader.readString(a.event, sizeof(a.event));
+    }
+    else if (strcmp(key, "start") == 0)
+    {
+      a.start = reader.readInt64();
+    }
+    else if (strcmp(key, "end") == 0)
+    {
+      a.end = reader.readInt64();
+    }
+    else if (strcmp(key, "tags") == 0 && reader.peek() == '[')
+    {
+      reader.beginArray();
+      bool haveFirst = false;
+      while (reader.nextElement())
+      {
+        if (haveFirst)
+        {
+          reader.skipValue();
+          continue;
+        }
+        haveFirst = true;
+        reader.readString(a.tags, sizeof(a.tags));
+      }
+    }
+    else
+    {
+      reader.skipValue();
+    }
+  }
+} // end readAlert
+#endif
+
+/* Parses the OneCall response as it arrives, straight into r. Arrays longer
+ * than r has room for are skipped over rather than stored.
+ */
+DeserializationError deserializeOneCall(WiFiClient &json,
+                                        owm_resp_onecall_t &r)
+{
+  char key[KEY_SIZE];
+  int i;
+  JsonStreamReader reader(json);
+
+  r.num_alerts = 0;
+  r.text[0] = '\0';
+  r.text_len = 1;
+  reader.beginObject();
+  while (reader.nextKey(key, sizeof(key)))
+  {
+    if (strcmp(key, "lat") == 0)
+    {
+      r.lat = reader.readFloat();
+    }
+    else if (strcmp(key, "lon") == 0)
+    {
+      r.lon = reader.readFloat();
+    }
+    else if (strcmp(key, "timezone") == 0)
+    {
+      reader.readString(r.timezone, sizeof(r.timezone));
+    }
+    else if (strcmp(key, "timezone_offset") == 0)
+    {
+      r.timezone_offset = reader.readInt();
+    }
+    else if (strcmp(key, "current") == 0)
+    {
+      readCurrent(reader, r, r.current);
+    }
+    else if (strcmp(key, "hourly") == 0)
+    {
+      i = 0;
+      reader.beginArray();
+      while (reader.nextElement())
+      {
+        if (i < OWM_NUM_HOURLY)
+        {
+          readHourly(reader, r, i++);
+        }
+        else
+        {
+          reader.skipValue();
+        }
+      }
+    }
+    else if (strcmp(key, "daily") == 0)
+    {
+      i = 0;
+      reader.beginArray();
+      while (reader.nextElement())
+      {
+        if (i < OWM_NUM_DAILY)
+        {
+          readDaily(reader, r, r.daily[i++]);
+        }
+        else
+        {
+          reader.skipValue();
+        }
+      }
+    }
+#if DISPLAY_ALERTS
+    else if (strcmp(key, "alerts") == 0)
+    {
+      reader.beginArray();
+      while (reader.nextElement())
+      {
+        if (r.num_alerts < OWM_NUM_ALERTS)
+        {
+          owm_alerts_t &new_alert = r.alerts[r.num_alerts++];
+          new_alert = {};
+          readAlert(reader, new_alert);
+        }
+        else
+        {
+          reader.skipValue();
+        }
+      }
+    }
 #endif
+    else
+    {
+      // minutely forecast is currently unused
+      reader.skipValue();
+    }
+  }
 
-  return error;
+  return reader.error();
 } // end deserializeOneCall
 
+static void readAirPollutionEntry(JsonStreamReader &reader,
+                                  owm_resp_air_pollution_t &r, int i)
+{
+  char key[KEY_SIZE];
+  reader.beginObject();
+  while (reader.nextKey(key, sizeof(key)))
+  {
+    if (strcmp(key, "dt") == 0)
+    {
+      r.dt[i] = reader.readInt64();
+    }
+    else if (strcmp(key, "main") == 0)
+    {
+      reader.beginObject();
+      while (reader.nextKey(key, sizeof(key)))
+      {
+        if (strcmp(key, "aqi") == 0)
+        {
+          r.main_aqi[i] = reader.readInt();
+        }
+        else
+        {
+          reader.skipValue();
+        }
+      }
+    }
+    else if (strcmp(key, "components") == 0)
+    {
+      reader.beginObject();
+      while (reader.nextKey(key, sizeof(key)))
+      {
+        if      (strcmp(key, "co")    == 0) { r.components.co[i]    = reader.readFloat(); }
+        else if (strcmp(key, "no")    == 0) { r.components.no[i]    = reader.readFloat(); }
+        else if (strcmp(key, "no2")   == 0) { r.components.no2[i]   = reader.readFloat(); }
+        else if (strcmp(key, "o3")    == 0) { r.components.o3[i]    = reader.readFloat(); }
+        else if (strcmp(key, "so2")   == 0) { r.components.so2[i]   = reader.readFloat(); }
+        else if (strcmp(key, "pm2_5") == 0) { r.components.pm2_5[i] = reader.readFloat(); }
+        else if (strcmp(key, "pm10")  == 0) { r.components.pm10[i]  = reader.readFloat(); }
+        else if (strcmp(key, "nh3")   == 0) { r.components.nh3[i]   = reader.readFloat(); }
+        else                                { reader.skipValue(); }
+      }
+    }
+    else
+    {
+      reader.skipValue();
+    }
+  }
+} // end readAirPollutionEntry
+
 DeserializationError deserializeAirQuality(WiFiClient &json,
                                            owm_resp_air_pollution_t &r)
 {
+  char key[KEY_SIZE];
   int i = 0;
+  JsonStreamReader reader(json);
 
-  JsonDocument doc;
+  reader.beginObject();
+  while (reader.nextKey(key, sizeof(key)))
+  {
+    if (strcmp(key, "coord") == 0)
+    {
+      reader.beginObject();
+      while (reader.nextKey(key, sizeof(key)))
+      {
+        if      (strcmp(key, "lat") == 0) { r.coord.lat = reader.readFloat(); }
+        else if (strcmp(key, "lon") == 0) { r.coord.lon = reader.readFloat(); }
+        else                              { reader.skipValue(); }
+      }
+    }
+    else if (strcmp(key, "list") == 0)
+    {
+      reader.beginArray();
+      while (reader.nextElement())
+      {
+        if (i < OWM_NUM_AIR_POLLUTION)
+        {
+          readAirPollutionEntry(reader, r, i++);
+        }
+        else
+        {
+          reader.skipValue();
+        }
+      }
+    }
+    else
+    {
+      reader.skipValue();
+    }
+  }
 
-  DeserializationError error = deserializeJson(doc, json);
-#if DEBUG_LEVEL >= 1
-  Serial.println("[debug] doc.overflowed() : "
-                 + String(doc.overflowed()));
-#endif
-#if DEBUG_LEVEL >= 2
-  serializeJsonPretty(doc, Serial);
-#endif
-  if (error) {
-    return error;
+  return reader.error();
+} // end deserializeAirQuality
+
+
+/* Reads the fixed-size fields of a weather blob. The blob is little-endian,
+ * like the ESP32, so values are copied straight into place. Once a read comes
+ * up short everything after it reads as 0.
+ */
+class BlobReader
+{
+public:
+  BlobReader(Stream &stream) : stream(stream), ok(true) {}
+
+  void read(void *dst, size_t n)
+  {
+    if (ok && stream.readBytes(static_cast<char *>(dst), n) != n)
+    {
+      ok = false;
+    }
+    if (!ok)
+    {
+      memset(dst, 0, n);
+    }
   }
 
-  r.coord.lat = doc["coord"]["lat"].as<float>();
-  r.coord.lon = doc["coord"]["lon"].as<float>();
+  void skip(size_t n)
+  {
+    char discard[32];
+    while (n > 0)
+    {
+      size_t chunk = n < sizeof(discard) ? n : sizeof(discard);
+      read(discard, chunk);
+      n -= chunk;
+    }
+  }
+
+  uint8_t  u8()  { uint8_t  v; read(&v, sizeof(v)); return v; }
+  uint16_t u16() { uint16_t v; read(&v, sizeof(v)); return v; }
+  int32_t  i32() { int32_t  v; read(&v, sizeof(v)); return v; }
+  int64_t  i64() { int64_t  v; read(&v, sizeof(v)); return v; }
+  float    f32() { float    v; read(&v, sizeof(v)); return v; }
 
-  for (JsonObject list : doc["list"].as<JsonArray>())
+  /* Reads a length-prefixed string into str, truncated to fit.
+   */
+  void str(char *str, size_t size)
   {
+    size_t len = u8();
+    size_t keep = len < size - 1 ? len : size - 1;
+    read(str, keep);
+    str[keep] = '\0';
+    skip(len - keep);
+  }
 
-    r.main_aqi[i] = list["main"]["aqi"].as<int>();
+  Stream &stream;
+  bool    ok;
+};
 
-    JsonObject list_components = list["components"];
-    r.components.co[i]    = list_components["co"].as<float>();
-    r.components.no[i]    = list_components["no"].as<float>();
-    r.components.no2[i]   = list_components["no2"].as<float>();
-    r.components.o3[i]    = list_components["o3"].as<float>();
-    r.components.so2[i]   = list_components["so2"].as<float>();
-    r.components.pm2_5[i] = list_components["pm2_5"].as<float>();
-    r.components.pm10[i]  = list_components["pm10"].as<float>();
-    r.components.nh3[i]   = list_components["nh3"].as<float>();
+static void readBlobWeather(BlobReader &blob, owm_weather_t &w)
+{
+  w.id          = blob.i32();
+  w.main        = blob.u16();
+  w.description = blob.u16();
+  w.icon        = static_cast<owm_icon_t>(blob.u16());
+} // end readBlobWeather
+
+static void readBlobCurrent(BlobReader &blob, owm_current_t &c)
+{
+  c.dt         = blob.i64();
+  c.sunrise    = blob.i64();
+  c.sunset     = blob.i64();
+  c.temp       = blob.f32();
+  c.feels_like = blob.f32();
+  c.pressure   = blob.i32();
+  c.humidity   = blob.i32();
+  c.dew_point  = blob.f32();
+  c.clouds     = blob.i32();
+  c.uvi        = blob.f32();
+  c.visibility = blob.i32();
+  c.wind_speed = blob.f32();
+  c.wind_gust  = blob.f32();
+  c.wind_deg   = blob.i32();
+  c.rain_1h    = blob.f32();
+  c.snow_1h    = blob.f32();
+  readBlobWeather(blob, c.weather);
+} // end readBlobCurrent
 
-    r.dt[i] = list["dt"].as<int64_t>();
+static void readBlobHourly(BlobReader &blob, owm_hourly_t &h)
+{
+  h.dt         = blob.i64();
+  h.temp       = blob.f32();
+  h.feels_like = blob.f32();
+  h.pressure   = blob.i32();
+  h.humidity   = blob.i32();
+  h.dew_point  = blob.f32();
+  h.clouds     = blob.i32();
+  h.uvi        = blob.f32();
+  h.visibility = blob.i32();
+  h.wind_speed = blob.f32();
+  h.wind_gust  = blob.f32();
+  h.wind_deg   = blob.i32();
+  h.pop        = blob.f32();
+  h.rain_1h    = blob.f32();
+  h.snow_1h    = blob.f32();
+  readBlobWeather(blob, h.weather);
+} // end readBlobHourly
+
+static void readBlobDaily(BlobReader &blob, owm_daily_t &d)
+{
+  d.dt               = blob.i64();
+  d.sunrise          = blob.i64();
+  d.sunset           = blob.i64();
+  d.moonrise         = blob.i64();
+  d.moonset          = blob.i64();
+  d.moon_phase       = blob.f32();
+  d.temp.morn        = blob.f32();
+  d.temp.day         = blob.f32();
+  d.temp.eve         = blob.f32();
+  d.temp.night       = blob.f32();
+  d.temp.min         = blob.f32();
+  d.temp.max         = blob.f32();
+  d.feels_like.morn  = blob.f32();
+  d.feels_like.day   = blob.f32();
+  d.feels_like.eve   = blob.f32();
+  d.feels_like.night = blob.f32();
+  d.pressure         = blob.i32();
+  d.humidity         = blob.i32();
+  d.dew_point        = blob.f32();
+  d.clouds           = blob.i32();
+  d.uvi              = blob.f32();
+  d.visibility       = blob.i32();
+  d.wind_speed       = blob.f32();
+  d.wind_gust        = blob.f32();
+  d.wind_deg         = blob.i32();
+  d.pop              = blob.f32();
+  d.rain             = blob.f32();
+  d.snow             = blob.f32();
+  readBlobWeather(blob, d.weather);
+} // end readBlobDaily
 
-    if (i == OWM_NUM_AIR_POLLUTION - 1)
+/* Reads count values of one air pollution field into dst, which has room for
+ * OWM_NUM_AIR_POLLUTION.
+ */
+template <typename T>
+static void readBlobSeries(BlobReader &blob, T *dst, int count)
+{
+  for (int i = 0; i < count; ++i)
+  {
+    T v;
+    blob.read(&v, sizeof(v));
+    if (i < OWM_NUM_AIR_POLLUTION)
     {
-      break;
+      dst[i] = v;
     }
-    ++i;
   }
+} // end readBlobSeries
 
-  return error;
-} // end deserializeAirQuality
+/* Reads the blob served by HTTPServer's /weather endpoint, which holds both the
+ * One Call and air pollution responses already parsed into the same fields as
+ * the structs here. The layout is described in HTTPServer/app/weatherProxy.js.
+ *
+ * Errors are reported with ArduinoJson's codes, like the JSON responses.
+ */
+DeserializationError deserializeWeatherBlob(WiFiClient &stream,
+                                            owm_resp_onecall_t &onecall,
+                                            owm_resp_air_pollution_t &air_pollution)
+{
+  BlobReader blob(stream);
+  char magic[4];
+  blob.read(magic, sizeof(magic));
+  uint8_t version = blob.u8();
+  if (!blob.ok)
+  {
+    return DeserializationError::IncompleteInput;
+  }
+  if (memcmp(magic, OWM_BLOB_MAGIC, sizeof(magic)) != 0
+   || version != OWM_BLOB_VERSION)
+  {
+    return DeserializationError::InvalidInput;
+  }
+  int numHourly = blob.u8();
+  int numDaily  = blob.u8();
+  int numAir    = blob.u8();
+
+  onecall = {};
+  onecall.lat = blob.f32();
+  onecall.lon = blob.f32();
+  blob.str(onecall.timezone, sizeof(onecall.timezone));
+  onecall.timezone_offset = blob.i32();
+  readBlobCurrent(blob, onecall.current);
+
+  owm_hourly_t hourly;
+  for (int i = 0; i < numHourly; ++i)
+  {
+    readBlobHourly(blob, hourly);
+    if (i < OWM_NUM_HOURLY)
+    {
+      owmSetHour(onecall.hourly, i, hourly);
+    }
+  }
+  owm_daily_t daily;
+  for (int i = 0; i < numDaily; ++i)
+  {
+    readBlobDaily(blob, i < OWM_NUM_DAILY ? onecall.daily[i] : daily);
+  }
+
+  int numAlerts = blob.u8();
+  owm_alerts_t alert;
+  for (int i = 0; i < numAlerts; ++i)
+  {
+    owm_alerts_t &a = i < OWM_NUM_ALERTS ? onecall.alerts[i] : alert;
+    blob.str(a.event, sizeof(a.event));
+    a.start = blob.i64();
+    a.end   = blob.i64();
+    blob.str(a.tags, sizeof(a.tags));
+  }
+#if DISPLAY_ALERTS
+  onecall.num_alerts = numAlerts < OWM_NUM_ALERTS ? numAlerts : OWM_NUM_ALERTS;
+#endif
+
+  // the weather offsets point into this, so it can't be truncated
+  onecall.text_len = blob.u16();
+  if (onecall.text_len == 0 || onecall.text_len > OWM_TEXT_ARENA_SIZE)
+  {
+    return DeserializationError::InvalidInput;
+  }
+  blob.read(onecall.text, onecall.text_len);
+  onecall.text[onecall.text_len - 1] = '\0';
+
+  air_pollution = {};
+  air_pollution.coord.lat = blob.f32();
+  air_pollution.coord.lon = blob.f32();
+  owm_components_t &c = air_pollution.components;
+  readBlobSeries(blob, air_pollution.main_aqi, numAir);
+  readBlobSeries(blob, c.co,    numAir);
+  readBlobSeries(blob, c.no,    numAir);
+  readBlobSeries(blob, c.no2,   numAir);
+  readBlobSeries(blob, c.o3,    numAir);
+  readBlobSeries(blob, c.so2,   numAir);
+  readBlobSeries(blob, c.pm2_5, numAir);
+  readBlobSeries(blob, c.pm10,  numAir);
+  readBlobSeries(blob, c.nh3,   numAir);
+  readBlobSeries(blob, air_pollution.dt, numAir);
 
+  return blob.ok ? DeserializationError::Ok
+                 : DeserializationError::IncompleteInput;
+} // end deserializeWeatherBlob
@@ -0,0 +1,186 @@
+/* AQI history for esp32-weather-epd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include "aqi_history.h"
+
+#define SLOTS (AQI_HISTORY_HOURS + 1)
+
+/* Empties the history.
+ */
+void resetAqiHistory(aqi_history_t &h)
+{
+  memset(&h, 0, sizeof(h));
+  return;
+} // end resetAqiHistory
+
+/* Appends the concentrations of the hour dt, the hour after h.newest.
+ */
+void appendAqiSample(aqi_history_t &h, int64_t dt,
+                     const float conc[AQI_NUM_POLLUTANTS])
+{
+  const int last = h.count % SLOTS;
+  const int next = (h.count + 1) % SLOTS;
+  for (int p = 0; p < AQI_NUM_POLLUTANTS; ++p)
+  {
+    h.sum[p][next] = h.sum[p][last] + conc[p];
+  }
+  ++h.count;
+  h.newest = dt;
+
+  if (h.count % AQI_HISTORY_HOURS == 0)
+  { // make the sums relative to the oldest one still in use
+    const int oldest = (h.count - AQI_HISTORY_HOURS) % SLOTS;
+    for (int p = 0; p < AQI_NUM_POLLUTANTS; ++p)
+    {
+      const float base = h.sum[p][oldest];
+      for (int k = 0; k < SLOTS; ++k)
+      {
+        h.sum[p][k] -= base;
+      }
+    }
+  }
+  return;
+} // end appendAqiSample
+
+/* Appends the hours of p that are newer than the history, oldest first.
+ *
+ * Hours missing between them are taken to have the concentrations of the hour
+ * before, unless so many are missing that none of the history is left, then
+ * the history starts over.
+ *
+ * Returns the number of hours appended.
+ */
+int updateAqiHistory(aqi_history_t &h, const owm_resp_air_pollution_t &p)
+{
+  const owm_components_t &c = p.components;
+  int appended = 0;
+  for (int i = 0; i < OWM_NUM_AIR_POLLUTION; ++i)
+  {
+    if (p.dt[i] <= h.newest)
+    {
+      continue; // already have it, or past the end of p
+    }
+
+    if (h.count > 0)
+    {
+      const int64_t missing = (p.dt[i] - h.newest) / 3600 - 1;
+      if (missing >= AQI_HISTORY_HOURS)
+      {
+        resetAqiHistory(h);
+      }
+      else if (missing > 0)
+      {
+        float last[AQI_NUM_POLLUTANTS];
+        for (int k = 0; k < AQI_NUM_POLLUTANTS; ++k)
+        {
+          last[k] = aqiWindowAvg(h, static_cast<aqi_pollutant_t>(k), 1);
+        }
+        for (int64_t m = 0; m < missing; ++m)
+        {
+          appendAqiSample(h, h.newest + 3600, last);
+        }
+        appended += missing;
+      }
+    }
+
+    const float conc[AQI_NUM_POLLUTANTS] = {
+      c.co[i], c.nh3[i], c.no[i], c.no2[i], c.o3[i], c.so2[i], c.pm10[i],
+      c.pm2_5[i]};
+    appendAqiSample(h, p.dt[i], conc);
+    ++appended;
+  }
+  return appended;
+} // end updateAqiHistory
+
+/* Returns the average concentration of pollutant p over the last hours hours,
+ * or over as many as the history holds if that is fewer.
+ */
+float aqiWindowAvg(const aqi_history_t &h, aqi_pollutant_t p, int hours)
+{
+  if (h.count == 0)
+  {
+    return 0.f;
+  }
+  if (hours > AQI_HISTORY_HOURS)
+  {
+    hours = AQI_HISTORY_HOURS;
+  }
+  if (static_cast<uint32_t>(hours) > h.count)
+  {
+    hours = h.count;
+  }
+  const float newer = h.sum[p][h.count % SLOTS];
+  const float older = h.sum[p][(h.count - hours) % SLOTS];
+  return (newer - older) / static_cast<float>(hours);
+} // end aqiWindowAvg
+
+/* Returns the Air Quality Index of the history on the given scale, like
+ * calc_aqi, but with every average taken from the prefix sums.
+ *
+ * OpenWeatherMap does not provide pb (lead) concentrations, so they are 0.
+ */
+int calcAqi(aqi_scale_t scale, const aqi_history_t &h)
+{
+  auto avg = [&h](aqi_pollutant_t p, int hours) {
+    return aqiWindowAvg(h, p, hours);
+  };
+
+  switch (scale)
+  {
+  case AUSTRALIA_AQI:
+    return australia_aqi(avg(AQI_CO, 8), avg(AQI_NO2, 1), avg(AQI_O3, 1),
+                         avg(AQI_O3, 4), avg(AQI_SO2, 1), avg(AQI_PM10, 24),
+                         avg(AQI_PM2_5, 24));
+  case CANADA_AQHI:
+    return canada_aqhi(avg(AQI_NO2, 3), avg(AQI_O3, 3), avg(AQI_PM2_5, 3));
+  case CHINA_AQI:
+    return china_aqi(avg(AQI_CO, 1), avg(AQI_CO, 24), avg(AQI_NO2, 1),
+                     avg(AQI_NO2, 24), avg(AQI_O3, 1), avg(AQI_O3, 8),
+                     avg(AQI_SO2, 1), avg(AQI_SO2, 24), avg(AQI_PM10, 24),
+                     avg(AQI_PM2_5, 24));
+  case EUROPEAN_UNION_CAQI:
+    return european_union_caqi(avg(AQI_NO2, 1), avg(AQI_O3, 1),
+                               avg(AQI_PM10, 1), avg(AQI_PM2_5, 1));
+  case HONG_KONG_AQHI:
+    return hong_kong_aqhi(avg(AQI_NO2, 3), avg(AQI_O3, 3), avg(AQI_SO2, 3),
+                          avg(AQI_PM10, 3), avg(AQI_PM2_5, 3));
+  case INDIA_AQI:
+    return india_aqi(avg(AQI_CO, 8), avg(AQI_NH3, 24), avg(AQI_NO2, 24),
+                     avg(AQI_O3, 8), 0.f, avg(AQI_SO2, 24), avg(AQI_PM10, 24),
+                     avg(AQI_PM2_5, 24));
+  case SINGAPORE_PSI:
+    return singapore_psi(avg(AQI_CO, 8), avg(AQI_NO2, 1), avg(AQI_O3, 1),
+                         avg(AQI_O3, 8), avg(AQI_SO2, 24), avg(AQI_PM10, 24),
+                         avg(AQI_PM2_5, 24));
+  case SOUTH_KOREA_CAI:
+    return south_korea_cai(avg(AQI_CO, 1), avg(AQI_NO2, 1), avg(AQI_O3, 1),
+                           avg(AQI_SO2, 1), avg(AQI_PM10, 24),
+                           avg(AQI_PM2_5, 24));
+  case UNITED_KINGDOM_DAQI:
+    // the 15min so2 average is not available, use the last hour
+    return united_kingdom_daqi(avg(AQI_NO2, 1), avg(AQI_O3, 8),
+                               avg(AQI_SO2, 1), avg(AQI_PM10, 24),
+                               avg(AQI_PM2_5, 24));
+  case UNITED_STATES_AQI:
+    return united_states_aqi(avg(AQI_CO, 8), avg(AQI_NO2, 1), avg(AQI_O3, 1),
+                             avg(AQI_O3, 8), avg(AQI_SO2, 1), avg(AQI_SO2, 24),
+                             avg(AQI_PM10, 24), avg(AQI_PM2_5, 24));
+  default:
+    return 0;
+  }
+} // end calcAqi
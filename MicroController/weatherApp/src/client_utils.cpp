@@ -30,6 +30,7 @@
 // additional libraries
 #include <Adafruit_BusIO_Register.h>
 #include <ArduinoJson.h>
+#include <Logger.h>
 
 // header files
 #include "_locale.h"
@@ -58,7 +59,7 @@
 wl_status_t startWiFi(int &wifiRSSI)
 {
   WiFi.mode(WIFI_STA);
-  Serial.printf("%s '%s'", TXT_CONNECTING_TO, WIFI_SSID);
+  LOG_INFO("%s '%s'", TXT_CONNECTING_TO, WIFI_SSID);
   WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
 
   // timeout if WiFi does not connect in WIFI_TIMEOUT ms from now
@@ -67,21 +68,19 @@ wl_status_t startWiFi(int &wifiRSSI)
 
   while ((connection_status != WL_CONNECTED) && (millis() < timeout))
   {
-    Serial.print(".");
     delay(50);
     connection_status = WiFi.status();
   }
-  Serial.println();
 
   if (connection_status == WL_CONNECTED)
   {
     wifiRSSI = WiFi.RSSI(); // get WiFi signal strength now, because the WiFi
                             // will be turned off to save power!
-    Serial.println("IP: " + WiFi.localIP().toString());
+    LOG_INFO("IP: %s", WiFi.localIP().toString().c_str());
   }
   else
   {
-    Serial.printf("%s '%s'\n", TXT_COULD_NOT_CONNECT_TO, WIFI_SSID);
+    LOG_ERROR("%s '%s'", TXT_COULD_NOT_CONNECT_TO, WIFI_SSID);
   }
   return connection_status;
 } // startWiFi
@@ -103,10 +102,12 @@ bool printLocalTime(tm *timeInfo)
   int attempts = 0;
   while (!getLocalTime(timeInfo) && attempts++ < 3)
   {
-    Serial.println(TXT_FAILED_TO_GET_TIME);
+    LOG_ERROR("%s", TXT_FAILED_TO_GET_TIME);
     return false;
   }
-  Serial.println(timeInfo, "%A, %B %d, %Y %H:%M:%S");
+  char timeStr[64];
+  strftime(timeStr, sizeof(timeStr), "%A, %B %d, %Y %H:%M:%S", timeInfo);
+  LOG_INFO("%s", timeStr);
   return true;
 } // printLocalTime
 
@@ -124,15 +125,13 @@ bool waitForSNTPSync(tm *timeInfo)
   if ((sntp_get_sync_status() == SNTP_SYNC_STATUS_RESET)
       && (millis() < timeout))
   {
-    Serial.print(TXT_WAITING_FOR_SNTP);
+    LOG_INFO("%s", TXT_WAITING_FOR_SNTP);
     delay(100); // ms
     while ((sntp_get_sync_status() == SNTP_SYNC_STATUS_RESET)
         && (millis() < timeout))
     {
-      Serial.print(".");
       delay(100); // ms
     }
-    Serial.println();
   }
   return printLocalTime(timeInfo);
 } // waitForSNTPSync
@@ -141,12 +140,17 @@ bool waitForSNTPSync(tm *timeInfo)
  * If data is received, it will be parsed and stored in the global variable
  * owm_onecall.
  *
+ * If includeDaily is false the daily forecast is excluded from the request and
+ * r.daily is left as it was.
+ *
  * Returns the HTTP Status Code.
  */
 #ifdef USE_HTTP
-  int getOWMonecall(WiFiClient &client, owm_resp_onecall_t &r)
+  int getOWMonecall(WiFiClient &client, owm_resp_onecall_t &r,
+                    bool includeDaily)
 #else
-  int getOWMonecall(WiFiClientSecure &client, owm_resp_onecall_t &r)
+  int getOWMonecall(WiFiClientSecure &client, owm_resp_onecall_t &r,
+                    bool includeDaily)
 #endif
 {
   int attempts = 0;
@@ -159,6 +163,10 @@ bool waitForSNTPSync(tm *timeInfo)
   // exclude alerts
   uri += ",alerts";
 #endif
+  if (!includeDaily)
+  {
+    uri += ",daily";
+  }
 
   // This string is printed to terminal to help with debugging. The API key is
   // censored to reduce the risk of users exposing their key.
@@ -166,8 +174,7 @@ bool waitForSNTPSync(tm *timeInfo)
 
   uri += "&appid=" + OWM_APIKEY;
 
-  Serial.print(TXT_ATTEMPTING_HTTP_REQ);
-  Serial.println(": " + sanitizedUri);
+  LOG_INFO("%s: %s", TXT_ATTEMPTING_HTTP_REQ, sanitizedUri.c_str());
   int httpResponse = 0;
   while (!rxSuccess && attempts < 3)
   {
@@ -195,8 +202,8 @@ bool waitForSNTPSync(tm *timeInfo)
     }
     client.stop();
     http.end();
-    Serial.println("  " + String(httpResponse, DEC) + " "
-                   + getHttpResponsePhrase(httpResponse));
+    LOG_INFO("  %d %s", httpResponse,
+             getHttpResponsePhrase(httpResponse).c_str());
     ++attempts;
   }
 
@@ -207,24 +214,33 @@ bool waitForSNTPSync(tm *timeInfo)
  * If data is received, it will be parsed and stored in the global variable
  * owm_air_pollution.
  *
+ * The history from start until now is requested. If start is 0, the last 24
+ * hours are requested.
+ *
  * Returns the HTTP Status Code.
  */
 #ifdef USE_HTTP
-  int getOWMairpollution(WiFiClient &client, owm_resp_air_pollution_t &r)
+  int getOWMairpollution(WiFiClient &client, owm_resp_air_pollution_t &r,
+                         int64_t start)
 #else
-  int getOWMairpollution(WiFiClientSecure &client, owm_resp_air_pollution_t &r)
+  int getOWMairpollution(WiFiClientSecure &client, owm_resp_air_pollution_t &r,
+                         int64_t start)
 #endif
 {
   int attempts = 0;
   bool rxSuccess = false;
   DeserializationError jsonErr = {};
 
-  // set start and end to appropriate values so that the last 24 hours of air
+  // set start and end to appropriate values so that the requested air
   // pollution history is returned. Unix, UTC.
   time_t now;
   int64_t end = time(&now);
-  // minus 1 is important here, otherwise we could get an extra hour of history
-  int64_t start = end - ((3600 * OWM_NUM_AIR_POLLUTION) - 1);
+  if (start == 0)
+  {
+    // minus 1 is important here, otherwise we could get an extra hour of
+    // history
+    start = end - ((3600 * OWM_NUM_AIR_POLLUTION) - 1);
+  }
   char endStr[22];
   char startStr[22];
   sprintf(endStr, "%lld", end);
@@ -239,8 +255,7 @@ bool waitForSNTPSync(tm *timeInfo)
                + "&start=" + startStr + "&end=" + endStr
                + "&appid={API key}";
 
-  Serial.print(TXT_ATTEMPTING_HTTP_REQ);
-  Serial.println(": " + sanitizedUri);
+  LOG_INFO("%s: %s", TXT_ATTEMPTING_HTTP_REQ, sanitizedUri.c_str());
   int httpResponse = 0;
   while (!rxSuccess && attempts < 3)
   {
@@ -268,25 +283,80 @@ bool waitForSNTPSync(tm *timeInfo)
     }
     client.stop();
     http.end();
-    Serial.println("  " + String(httpResponse, DEC) + " "
-                   + getHttpResponsePhrase(httpResponse));
+    LOG_INFO("  %d %s", httpResponse,
+             getHttpResponsePhrase(httpResponse).c_str());
     ++attempts;
   }
 
   return httpResponse;
 } // getOWMairpollution
 
+#ifdef USE_WEATHER_PROXY
+/* Perform an HTTP GET request to the weather proxy on the local network (see
+ * HTTPServer). It makes the One Call and Air Pollution requests for us and
+ * sends back both responses in one compact binary blob.
+ *
+ * Returns the HTTP Status Code.
+ */
+int getWeatherProxy(WiFiClient &client, owm_resp_onecall_t &onecall,
+                    owm_resp_air_pollution_t &air_pollution)
+{
+  int attempts = 0;
+  bool rxSuccess = false;
+  DeserializationError blobErr = {};
+  String uri = "/weather?lat=" + LAT + "&lon=" + LON + "&lang=" + OWM_LANG
+               + "&version=" + OWM_ONECALL_VERSION;
+
+  LOG_INFO("%s: %s%s", TXT_ATTEMPTING_HTTP_REQ, WEATHER_PROXY_HOST.c_str(),
+           uri.c_str());
+  int httpResponse = 0;
+  while (!rxSuccess && attempts < 3)
+  {
+    wl_status_t connection_status = WiFi.status();
+    if (connection_status != WL_CONNECTED)
+    {
+      // -512 offset distinguishes these errors from httpClient errors
+      return -512 - static_cast<int>(connection_status);
+    }
+
+    HTTPClient http;
+    http.setConnectTimeout(HTTP_CLIENT_TCP_TIMEOUT); // default 5000ms
+    http.setTimeout(HTTP_CLIENT_TCP_TIMEOUT); // default 5000ms
+    http.begin(client, WEATHER_PROXY_HOST, WEATHER_PROXY_PORT, uri);
+    httpResponse = http.GET();
+    if (httpResponse == HTTP_CODE_OK)
+    {
+      blobErr = deserializeWeatherBlob(http.getStream(), onecall,
+                                       air_pollution);
+      if (blobErr)
+      {
+        // -256 offset distinguishes these errors from httpClient errors
+        httpResponse = -256 - static_cast<int>(blobErr.code());
+      }
+      rxSuccess = !blobErr;
+    }
+    client.stop();
+    http.end();
+    LOG_INFO("  %d %s", httpResponse,
+             getHttpResponsePhrase(httpResponse).c_str());
+    ++attempts;
+  }
+
+  return httpResponse;
+} // getWeatherProxy
+#endif
+
 /* Prints debug information about heap usage.
  */
 void printHeapUsage() {
-  Serial.println("[debug] Heap Size       : "
-                 + String(ESP.getHeapSize()) + " B");
-  Serial.println("[debug] Available Heap  : "
-                 + String(ESP.getFreeHeap()) + " B");
-  Serial.println("[debug] Min Free Heap   : "
-                 + String(ESP.getMinFreeHeap()) + " B");
-  Serial.println("[debug] Max Allocatable : "
-                 + String(ESP.getMaxAllocHeap()) + " B");
+  LOG_INFO("[debug] Heap Size       : %lu B",
+           (unsigned long)ESP.getHeapSize());
+  LOG_INFO("[debug] Available Heap  : %lu B",
+           (unsigned long)ESP.getFreeHeap());
+  LOG_INFO("[debug] Min Free Heap   : %lu B",
+           (unsigned long)ESP.getMinFreeHeap());
+  LOG_INFO("[debug] Max Allocatable : %lu B",
+           (unsigned long)ESP.getMaxAllocHeap());
   return;
 }
 
@@ -76,6 +76,11 @@ const String OWM_ENDPOINT = "api.openweathermap.org";
 //   calls.
 const String OWM_ONECALL_VERSION = "3.0";
 
+// WEATHER PROXY
+// Address of the HTTPServer, used if USE_WEATHER_PROXY is defined in config.h.
+const String   WEATHER_PROXY_HOST = "192.168.1.100";
+const uint16_t WEATHER_PROXY_PORT = 8080;
+
 // LOCATION
 // Set your latitude and longitude.
 // (used to get weather data as part of API requests to OpenWeatherMap)
@@ -138,6 +143,30 @@ const int WAKE_TIME = 06; // Hour of first update after BED_TIME, 06:00.
 // Number of hours to display on the outlook graph. (range: [8-48])
 const int HOURLY_GRAPH_MAX = 24;
 
+// FORECAST REFRESH
+// How often, in minutes, the daily forecast is requested. The daily forecast
+// changes much more slowly than current conditions, so in between it is left
+// out of the One Call request and the last one received is used. It is always
+// requested again once the day has changed. Set to SLEEP_DURATION (or less) to
+// request it on every update.
+const int DAILY_REFRESH_INTERVAL = 180; // minutes
+
+// WEATHER CACHE
+// The last weather received is kept in flash so it can be shown if a later
+// update fails. Current conditions are small and rewritten on every update,
+// but to spare the flash the hourly and daily forecasts are only rewritten this
+// often, or sooner when the daily forecast changed. Shown after a failed
+// update, an older snapshot is just moved forward to the current hour.
+const int WEATHER_CACHE_INTERVAL = 120; // minutes
+
+// PARTIAL REFRESH
+// When only parts of the screen changed since the last update, panels that
+// support fast partial refresh redraw just those parts, without the flashing
+// of a full refresh. Partial refreshes slowly leave ghosting behind, so after
+// this many in a row the next update is a full refresh. Set to 0 to always do
+// a full refresh.
+const int PARTIAL_REFRESH_LIMIT = 8;
+
 // BATTERY
 // To protect the battery upon LOW_BATTERY_VOLTAGE, the display will cease to
 // update until battery is charged again. The ESP32 will deep-sleep (consuming
@@ -127,3 +127,32 @@ float millimeters_to_centimeters(float millimeter)
   return millimeter / 10.0f;
 } // end milimeters_to_centimeter
 
+
+// Defines the array form of conversion fn, converting n values at once with
+// the same arithmetic as the single value form.
+#define ARRAY_CONVERSION(fn)                   \
+  void fn(float *out, const float *in, int n)  \
+  {                                            \
+    for (int i = 0; i < n; ++i)                \
+    {                                          \
+      out[i] = fn(in[i]);                      \
+    }                                          \
+  }
+
+ARRAY_CONVERSION(kelvin_to_celsius)
+ARRAY_CONVERSION(kelvin_to_fahrenheit)
+ARRAY_CONVERSION(millimeters_to_inches)
+ARRAY_CONVERSION(millimeters_to_centimeters)
+
+/* Maps n values to plot y coordinates, rounded to the nearest pixel:
+ *   y = yBase - pxPerUnit * (value - valueMin)
+ */
+void to_plot_y(int16_t *y, const float *values, int n, float valueMin,
+               float pxPerUnit, int yBase)
+{
+  for (int i = 0; i < n; ++i)
+  {
+    y[i] = static_cast<int16_t>(
+             std::round(yBase - (pxPerUnit * (values[i] - valueMin))));
+  }
+} // end to_plot_y
@@ -15,63 +15,26 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <vector>
 #include <Arduino.h>
-#include <driver/adc.h>
-#include <esp_adc_cal.h>
 
 #include <aqi.h>
+#include <rom/crc.h>
 
 #include "_locale.h"
 #include "_strftime.h"
 #include "api_response.h"
+#include "aqi_history.h"
 #include "config.h"
 #include "display_utils.h"
 
-// icon header files
-#include "icons/icons.h"
-
-/* Returns battery voltage in millivolts (mv).
- */
-uint32_t readBatteryVoltage()
-{
-  esp_adc_cal_characteristics_t adc_chars;
-  // __attribute__((unused)) disables compiler warnings about this variable
-  // being unused (Clang, GCC) which is the case when DEBUG_LEVEL == 0.
-  esp_adc_cal_value_t val_type __attribute__((unused));
-  adc_power_acquire();
-  uint16_t adc_val = analogRead(PIN_BAT_ADC);
-  adc_power_release();
-
-  // We will use the eFuse ADC calibration bits, to get accurate voltage
-  // readings. The DFRobot FireBeetle Esp32-E V1.0's ADC is 12 bit, and uses
-  // 11db attenuation, which gives it a measurable input voltage range of 150mV
-  // to 2450mV.
-  val_type = esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_11db,
-                                      ADC_WIDTH_BIT_12, 1100, &adc_chars);
-
-#if DEBUG_LEVEL >= 1
-  if (val_type == ESP_ADC_CAL_VAL_EFUSE_VREF)
-  {
-    Serial.println("[debug] ADC Cal eFuse Vref");
-  }
-  else if (val_type == ESP_ADC_CAL_VAL_EFUSE_TP)
-  {
-    Serial.println("[debug] ADC Cal Two Point");
-  }
-  else
-  {
-    Serial.println("[debug] ADC Cal Default");
-  }
-#endif
-
-  uint32_t batteryVoltage = esp_adc_cal_raw_to_voltage(adc_val, &adc_chars);
-  // DFRobot FireBeetle Esp32-E V1.0 voltage divider (1M+1M), so readings are
-  // multiplied by 2.
-  batteryVoltage *= 2;
-  return batteryVoltage;
-} // end readBatteryVoltage
+// icons
+#include "icon_atlas.h"
+// alert terminology of the locale, see tools/gen_alert_terms.py
+#include "alert_automaton.h"
 
 /* Returns battery percentage, rounded to the nearest integer.
  * Takes a voltage in millivolts and uses a sigmoidal approximation to find an
@@ -136,16 +99,34 @@ const uint8_t *getBatBitmap24(uint32_t batPercent)
   }
 } // end getBatBitmap24
 
+/* Replaces each pair of spaces in s by one space, like String::replace, but in
+ * place.
+ */
+static void removeDoubleSpaces(char *s)
+{
+  char *out = s;
+  while (*s != '\0')
+  {
+    if (s[0] == ' ' && s[1] == ' ')
+    {
+      ++s;
+    }
+    *out++ = *s++;
+  }
+  *out = '\0';
+  return;
+} // end removeDoubleSpaces
+
 /* Gets string with the current date.
  */
 void getDateStr(String &s, tm *timeInfo)
 {
   char buf[48] = {};
   _strftime(buf, sizeof(buf), DATE_FORMAT, timeInfo);
-  s = buf;
 
   // remove double spaces. %e will add an extra space, ie. " 1" instead of "1"
-  s.replace("  ", " ");
+  removeDoubleSpaces(buf);
+  s = buf;
   return;
 } // end getDateStr
 
@@ -161,94 +142,133 @@ void getRefreshTimeStr(String &s, bool timeSuccess, tm *timeInfo)
 
   char buf[48] = {};
   _strftime(buf, sizeof(buf), REFRESH_TIME_FORMAT, timeInfo);
-  s = buf;
 
   // remove double spaces.
-  s.replace("  ", " ");
+  removeDoubleSpaces(buf);
+  s = buf;
   return;
 } // end getRefreshTimeStr
 
-/* Takes a String and capitalizes the first letter of every word.
+/* Takes a string and capitalizes the first letter of every word.
  *
  * Ex:
  *   input   : "severe thunderstorm warning" or "SEVERE THUNDERSTORM WARNING"
  *   becomes : "Severe Thunderstorm Warning"
  */
-void toTitleCase(String &text)
+void toTitleCase(char *text)
 {
-  text.setCharAt(0, toUpperCase(text.charAt(0)));
+  if (text[0] == '\0')
+  {
+    return;
+  }
+
+  text[0] = toUpperCase(text[0]);
 
-  for (int i = 1; i < text.length(); ++i)
+  for (int i = 1; text[i] != '\0'; ++i)
   {
-    if (text.charAt(i - 1) == ' '
-     || text.charAt(i - 1) == '-'
-     || text.charAt(i - 1) == '(')
+    if (text[i - 1] == ' '
+     || text[i - 1] == '-'
+     || text[i - 1] == '(')
     {
-      text.setCharAt(i, toUpperCase(text.charAt(i)));
+      text[i] = toUpperCase(text[i]);
     }
     else
     {
-      text.setCharAt(i, toLowerCase(text.charAt(i)));
+      text[i] = toLowerCase(text[i]);
     }
   }
 
   return;
 } // end toTitleCase
 
-/* Takes a String and truncates at any of these characters ,.( and trims any
+/* Takes a string and truncates at any of these characters ,.( and trims any
  * trailing whitespace.
  *
  * Ex:
  *   input   : "Severe Thunderstorm Warning, (Starting At 10 Pm)"
  *   becomes : "Severe Thunderstorm Warning"
  */
-void truncateExtraAlertInfo(String &text)
+void truncateExtraAlertInfo(char *text)
 {
-  if (text.isEmpty())
+  if (text[0] == '\0')
   {
     return;
   }
 
   int i = 1;
   int lastChar = i;
-  while (i < text.length()
-    && text.charAt(i) != ','
-    && text.charAt(i) != '.'
-    && text.charAt(i) != '(')
+  while (text[i] != '\0'
+    && text[i] != ','
+    && text[i] != '.'
+    && text[i] != '(')
   {
-    if (text.charAt(i) != ' ')
+    if (text[i] != ' ')
     {
       lastChar = i + 1;
     }
     ++i;
   }
 
-  text = text.substring(0, lastChar);
+  text[lastChar] = '\0';
   return;
 } // end truncateExtraAlertInfo
 
+/* Finds the alert terminology and urgency keywords of the locale in s, in one
+ * pass over it. Sets bit n of categories if s contains a term of the TERM_*
+ * list of alert_category n, and bit n of urgency if it contains
+ * ALERT_URGENCY[n].
+ *
+ * The keywords are compiled into an Aho-Corasick automaton at build time.
+ * Note: This function is case sensitive.
+ */
+static void scanAlertTerms(const char *s, uint32_t &categories,
+                           uint16_t &urgency)
+{
+  alert_ac_state_t state = 0;
+  categories = ALERT_AC_CATEGORIES[0];
+  urgency = ALERT_AC_URGENCY[0];
+  for (; *s != '\0'; ++s)
+  {
+    const uint8_t c = static_cast<uint8_t>(*s);
+    for (;;)
+    {
+      const uint8_t *first = &ALERT_AC_BYTE[ALERT_AC_FIRST[state]];
+      const uint8_t *last  = &ALERT_AC_BYTE[ALERT_AC_FIRST[state + 1]];
+      const uint8_t *edge  = std::lower_bound(first, last, c);
+      if (edge != last && *edge == c)
+      {
+        state = ALERT_AC_NEXT[edge - ALERT_AC_BYTE];
+        break;
+      }
+      if (state == 0)
+      {
+        break;
+      }
+      state = ALERT_AC_FAIL[state];
+    }
+    categories |= ALERT_AC_CATEGORIES[state];
+    urgency |= ALERT_AC_URGENCY[state];
+  }
+  return;
+} // end scanAlertTerms
+
 /* Returns the urgency of an event based by checking if the event String
  * contains any indicator keywords.
  *
  * Urgency keywords are defined in config.h because they are very regional.
  *   ex: United States - (Watch < Advisory < Warning)
  *
- * The index in vector<String> ALERT_URGENCY indicates the urgency level.
+ * The index in ALERT_URGENCY indicates the urgency level.
  * If an event string matches none of these keywords the urgency is unknown, -1
- * is returned.
+ * is returned. If it matches several, the most urgent one counts.
  * In the United States example, Watch = 0, Advisory = 1, Warning = 2
  */
-int eventUrgency(const String &event)
+int eventUrgency(const char *event)
 {
-  int urgency_lvl = -1;
-  for (int i = 0; i < ALERT_URGENCY.size(); ++i)
-  {
-    if (event.indexOf(ALERT_URGENCY[i]) >= 0)
-    {
-      urgency_lvl = i;
-    }
-  }
-  return urgency_lvl;
+  uint32_t categories;
+  uint16_t urgency;
+  scanAlertTerms(event, categories, urgency);
+  return urgency ? 31 - __builtin_clz(urgency) : -1;
 } // end eventUrgency
 
 /* This algorithm filters alerts from the API responses to be displayed by
@@ -262,8 +282,8 @@ int eventUrgency(const String &event)
  * Depending on the region different keywords are used to convey the level of
  * urgency.
  *
- * A vector array is used to store these keywords. (defined in config.h) Urgency
- * is ranked from low to high where the first index of the vector is the least
+ * An array is used to store these keywords. (defined in config.h) Urgency
+ * is ranked from low to high where the first index of the array is the least
  * urgent keyword and the last index is the most urgent keyword. Expected as all
  * lowercase.
  *
@@ -285,34 +305,45 @@ int eventUrgency(const String &event)
  * Truncate Extraneous Info (anything that follows a comma, period, or open
  *   parentheses)
  */
-void filterAlerts(std::vector<owm_alerts_t> &resp, int *ignore_list)
+void filterAlerts(owm_alerts_t *resp, int num_alerts, int *ignore_list)
 {
   // Convert all event text and tags to lowercase.
-  for (auto &alert : resp)
+  for (int i = 0; i < num_alerts; ++i)
   {
-    alert.event.toLowerCase();
-    alert.tags.toLowerCase();
+    for (char *c = resp[i].event; *c != '\0'; ++c)
+    {
+      *c = toLowerCase(*c);
+    }
+    for (char *c = resp[i].tags; *c != '\0'; ++c)
+    {
+      *c = toLowerCase(*c);
+    }
   }
 
   // Deduplicate alerts with the same first tag. Keeping only the most urgent
   // alerts of each tag and alerts who's urgency cannot be determined.
-  for (int i = 0; i < resp.size(); ++i)
+  int urgency[OWM_NUM_ALERTS];
+  for (int i = 0; i < num_alerts; ++i)
+  {
+    urgency[i] = eventUrgency(resp[i].event);
+  }
+  for (int i = 0; i < num_alerts; ++i)
   {
     if (ignore_list[i] == 1)
     {
       continue;
     }
-    if (resp[i].tags.isEmpty())
+    if (resp[i].tags[0] == '\0')
     {
       continue; // urgency can not be determined so it remains in the list
     }
 
-    for (int j = 0; j < resp.size(); ++j)
+    for (int j = 0; j < num_alerts; ++j)
     {
-      if (i != j && resp[i].tags == resp[j].tags)
+      if (i != j && strcmp(resp[i].tags, resp[j].tags) == 0)
       {
         // comparing alerts of the same tag, removing the less urgent alert
-        if (eventUrgency(resp[i].event) >= eventUrgency(resp[j].event))
+        if (urgency[i] >= urgency[j])
         {
           ignore_list[j] = 1;
         }
@@ -322,7 +353,7 @@ void filterAlerts(std::vector<owm_alerts_t> &resp, int *ignore_list)
 
   // Save only the 2 most recent alerts
   int valid_cnt = 0;
-  for (int i = 0; i < resp.size(); ++i)
+  for (int i = 0; i < num_alerts; ++i)
   {
     if (valid_cnt < 2 && !ignore_list[i])
     {
@@ -335,9 +366,9 @@ void filterAlerts(std::vector<owm_alerts_t> &resp, int *ignore_list)
   }
 
   // Remove trailing/extraneous information
-  for (auto &alert : resp)
+  for (int i = 0; i < num_alerts; ++i)
   {
-    truncateExtraAlertInfo(alert.event);
+    truncateExtraAlertInfo(resp[i].event);
   }
 
   return;
@@ -369,6 +400,14 @@ const char *getUVIdesc(unsigned int uvi)
   }
 } // end getUVIdesc
 
+/* Returns the Air Quality Index of AQI_SCALE, with every average the scale
+ * needs taken from the prefix sums of the history.
+ */
+int getAQI(const aqi_history_t &h)
+{
+  return calcAqi(AQI_SCALE, h);
+} // end getAQI
+
 /* Returns the wifi signal strength descriptor text for the given RSSI.
  */
 const char *getWiFidesc(int rssi)
@@ -423,10 +462,10 @@ const uint8_t *getWiFiBitmap16(int rssi)
 
 /* Returns true if icon is a daytime icon, false otherwise.
  */
-bool isDay(String icon) 
+bool isDay(owm_icon_t icon)
 {
   // OpenWeatherMap indicates sun is up with d otherwise n for night
-  return icon.endsWith("d");
+  return icon != OWM_ICON_UNKNOWN && !(icon & 1);
 }
 
 /* Returns true if the moon is currently in the sky above, false otherwise.
@@ -760,580 +799,49 @@ const uint8_t *getAlertBitmap48(const owm_alerts_t &alert)
   }
 } // end getAlertBitmap48
 
-/* Returns true of a String, s, contains any of the strings in the terminology
- * vector.
- *
- * Note: This function is case sensitive.
- */
-bool containsTerminology(const String s, const std::vector<String> &terminology)
-{
-  for (const String &term : terminology)
-  {
-    if (s.indexOf(term) >= 0)
-    {
-      return true;
-    }
-  }
-  return false;
-} // end containsTerminology
-
 /* Returns the category of an alert based on the terminology found in the event
- * name.
+ * name. If terms of several categories are found, the category listed first in
+ * enum alert_category is returned.
  *
  * Weather alert terminology is defined in the included locale header.
  */
 enum alert_category getAlertCategory(const owm_alerts_t &alert)
 {
-  if (containsTerminology(alert.event, TERM_SMOG))
-  {
-    return alert_category::SMOG;
-  }
-  if (containsTerminology(alert.event, TERM_SMOKE))
-  {
-    return alert_category::SMOKE;
-  }
-  if (containsTerminology(alert.event, TERM_FOG))
+  uint32_t categories;
+  uint16_t urgency;
+  scanAlertTerms(alert.event, categories, urgency);
+  if (categories == 0)
   {
-    return alert_category::FOG;
+    return alert_category::NOT_FOUND;
   }
-  if (containsTerminology(alert.event, TERM_METEOR))
-  {
-    return alert_category::METEOR;
-  }
-  if (containsTerminology(alert.event, TERM_NUCLEAR))
-  {
-    return alert_category::NUCLEAR;
-  }
-  if (containsTerminology(alert.event, TERM_BIOHAZARD))
-  {
-    return alert_category::BIOHAZARD;
-  }
-  if (containsTerminology(alert.event, TERM_EARTHQUAKE))
-  {
-    return alert_category::EARTHQUAKE;
-  }
-  if (containsTerminology(alert.event, TERM_FIRE))
-  {
-    return alert_category::FIRE;
-  }
-  if (containsTerminology(alert.event, TERM_HEAT))
-  {
-    return alert_category::HEAT;
-  }
-  if (containsTerminology(alert.event, TERM_WINTER))
-  {
-    return alert_category::WINTER;
-  }
-  if (containsTerminology(alert.event, TERM_TSUNAMI))
-  {
-    return alert_category::TSUNAMI;
-  }
-  if (containsTerminology(alert.event, TERM_LIGHTNING))
-  {
-    return alert_category::LIGHTNING;
-  }
-  if (containsTerminology(alert.event, TERM_SANDSTORM))
-  {
-    return alert_category::SANDSTORM;
-  }
-  if (containsTerminology(alert.event, TERM_FLOOD))
-  {
-    return alert_category::FLOOD;
-  }
-  if (containsTerminology(alert.event, TERM_VOLCANO))
-  {
-    return alert_category::VOLCANO;
-  }
-  if (containsTerminology(alert.event, TERM_AIR_QUALITY))
-  {
-    return alert_category::AIR_QUALITY;
-  }
-  if (containsTerminology(alert.event, TERM_TORNADO))
-  {
-    return alert_category::TORNADO;
-  }
-  if (containsTerminology(alert.event, TERM_SMALL_CRAFT_ADVISORY))
-  {
-    return alert_category::SMALL_CRAFT_ADVISORY;
-  }
-  if (containsTerminology(alert.event, TERM_GALE_WARNING))
-  {
-    return alert_category::GALE_WARNING;
-  }
-  if (containsTerminology(alert.event, TERM_STORM_WARNING))
-  {
-    return alert_category::STORM_WARNING;
-  }
-  if (containsTerminology(alert.event, TERM_HURRICANE_WARNING))
-  {
-    return alert_category::HURRICANE_WARNING;
-  }
-  if (containsTerminology(alert.event, TERM_HURRICANE))
-  {
-    return alert_category::HURRICANE;
-  }
-  if (containsTerminology(alert.event, TERM_DUST))
-  {
-    return alert_category::DUST;
-  }
-  if (containsTerminology(alert.event, TERM_STRONG_WIND))
-  {
-    return alert_category::STRONG_WIND;
-  }
-  return alert_category::NOT_FOUND;
+  return static_cast<alert_category>(__builtin_ctz(categories));
 } // end getAlertCategory
 
-#ifdef WIND_ICONS_CARDINAL
-static const unsigned char *wind_direction_icon_arr[] = {
-  wind_direction_meteorological_0deg_24x24,    // N
-  wind_direction_meteorological_90deg_24x24,   // E
-  wind_direction_meteorological_180deg_24x24,  // S
-  wind_direction_meteorological_270deg_24x24}; // W
-#endif // end WIND_ICONS_CARDINAL
-#ifdef WIND_ICONS_INTERCARDINAL
-static const unsigned char *wind_direction_icon_arr[] = {
-  wind_direction_meteorological_0deg_24x24,    // N
-  wind_direction_meteorological_45deg_24x24,   // NE
-  wind_direction_meteorological_90deg_24x24,   // E
-  wind_direction_meteorological_135deg_24x24,  // SE
-  wind_direction_meteorological_180deg_24x24,  // S
-  wind_direction_meteorological_225deg_24x24,  // SW
-  wind_direction_meteorological_270deg_24x24,  // W
-  wind_direction_meteorological_315deg_24x24}; // NW
-#endif // end WIND_ICONS_INTERCARDINAL
-#ifdef WIND_ICONS_SECONDARY_INTERCARDINAL
-static const unsigned char *wind_direction_icon_arr[] = {
-  wind_direction_meteorological_0deg_24x24,      // N
-  wind_direction_meteorological_22_5deg_24x24,   // NNE
-  wind_direction_meteorological_45deg_24x24,     // NE
-  wind_direction_meteorological_67_5deg_24x24,   // ENE
-  wind_direction_meteorological_90deg_24x24,     // E
-  wind_direction_meteorological_112_5deg_24x24,  // ESE
-  wind_direction_meteorological_135deg_24x24,    // SE
-  wind_direction_meteorological_157_5deg_24x24,  // SSE
-  wind_direction_meteorological_180deg_24x24,    // S
-  wind_direction_meteorological_202_5deg_24x24,  // SSW
-  wind_direction_meteorological_225deg_24x24,    // SW
-  wind_direction_meteorological_247_5deg_24x24,  // WSW
-  wind_direction_meteorological_270deg_24x24,    // W
-  wind_direction_meteorological_292_5deg_24x24,  // WNW
-  wind_direction_meteorological_315deg_24x24,    // NW
-  wind_direction_meteorological_337_5deg_24x24}; // NNW
-#endif // end WIND_ICONS_SECONDARY_INTERCARDINAL
-#ifdef WIND_ICONS_TERTIARY_INTERCARDINAL
-static const unsigned char *wind_direction_icon_arr[] = {
-  wind_direction_meteorological_0deg_24x24,       // N
-  wind_direction_meteorological_11_25deg_24x24,   // NbE
-  wind_direction_meteorological_22_5deg_24x24,    // NNE
-  wind_direction_meteorological_33_75deg_24x24,   // NEbN
-  wind_direction_meteorological_45deg_24x24,      // NE
-  wind_direction_meteorological_56_25deg_24x24,   // NEbE
-  wind_direction_meteorological_67_5deg_24x24,    // ENE
-  wind_direction_meteorological_78_75deg_24x24,   // EbN
-  wind_direction_meteorological_90deg_24x24,      // E
-  wind_direction_meteorological_101_25deg_24x24,  // EbS
-  wind_direction_meteorological_112_5deg_24x24,   // ESE
-  wind_direction_meteorological_123_75deg_24x24,  // SEbE
-  wind_direction_meteorological_135deg_24x24,     // SE
-  wind_direction_meteorological_146_25deg_24x24,  // SEbS
-  wind_direction_meteorological_157_5deg_24x24,   // SSE
-  wind_direction_meteorological_168_75deg_24x24,  // SbE
-  wind_direction_meteorological_180deg_24x24,     // S
-  wind_direction_meteorological_191_25deg_24x24,  // SbW
-  wind_direction_meteorological_202_5deg_24x24,   // SSW
-  wind_direction_meteorological_213_75deg_24x24,  // SWbS
-  wind_direction_meteorological_225deg_24x24,     // SW
-  wind_direction_meteorological_236_25deg_24x24,  // SWbW
-  wind_direction_meteorological_247_5deg_24x24,   // WSW
-  wind_direction_meteorological_258_75deg_24x24,  // WbS
-  wind_direction_meteorological_270deg_24x24,     // W
-  wind_direction_meteorological_281_25deg_24x24,  // WbN
-  wind_direction_meteorological_292_5deg_24x24,   // WNW
-  wind_direction_meteorological_303_75deg_24x24,  // NWbW
-  wind_direction_meteorological_315deg_24x24,     // NW
-  wind_direction_meteorological_326_25deg_24x24,  // NWbN
-  wind_direction_meteorological_337_5deg_24x24,   // NNW
-  wind_direction_meteorological_348_75deg_24x24}; // NbW
-#endif // end WIND_ICONS_TERTIARY_INTERCARDINAL
-#ifdef WIND_ICONS_360
-static const unsigned char *wind_direction_icon_arr[] = {
-  wind_direction_meteorological_0deg_24x24,
-  wind_direction_meteorological_1deg_24x24,
-  wind_direction_meteorological_2deg_24x24,
-  wind_direction_meteorological_3deg_24x24,
-  wind_direction_meteorological_4deg_24x24,
-  wind_direction_meteorological_5deg_24x24,
-  wind_direction_meteorological_6deg_24x24,
-  wind_direction_meteorological_7deg_24x24,
-  wind_direction_meteorological_8deg_24x24,
-  wind_direction_meteorological_9deg_24x24,
-  wind_direction_meteorological_10deg_24x24,
-  wind_direction_meteorological_11deg_24x24,
-  wind_direction_meteorological_12deg_24x24,
-  wind_direction_meteorological_13deg_24x24,
-  wind_direction_meteorological_14deg_24x24,
-  wind_direction_meteorological_15deg_24x24,
-  wind_direction_meteorological_16deg_24x24,
-  wind_direction_meteorological_17deg_24x24,
-  wind_direction_meteorological_18deg_24x24,
-  wind_direction_meteorological_19deg_24x24,
-  wind_direction_meteorological_20deg_24x24,
-  wind_direction_meteorological_21deg_24x24,
-  wind_direction_meteorological_22deg_24x24,
-  wind_direction_meteorological_23deg_24x24,
-  wind_direction_meteorological_24deg_24x24,
-  wind_direction_meteorological_25deg_24x24,
-  wind_direction_meteorological_26deg_24x24,
-  wind_direction_meteorological_27deg_24x24,
-  wind_direction_meteorological_28deg_24x24,
-  wind_direction_meteorological_29deg_24x24,
-  wind_direction_meteorological_30deg_24x24,
-  wind_direction_meteorological_31deg_24x24,
-  wind_direction_meteorological_32deg_24x24,
-  wind_direction_meteorological_33deg_24x24,
-  wind_direction_meteorological_34deg_24x24,
-  wind_direction_meteorological_35deg_24x24,
-  wind_direction_meteorological_36deg_24x24,
-  wind_direction_meteorological_37deg_24x24,
-  wind_direction_meteorological_38deg_24x24,
-  wind_direction_meteorological_39deg_24x24,
-  wind_direction_meteorological_40deg_24x24,
-  wind_direction_meteorological_41deg_24x24,
-  wind_direction_meteorological_42deg_24x24,
-  wind_direction_meteorological_43deg_24x24,
-  wind_direction_meteorological_44deg_24x24,
-  wind_direction_meteorological_45deg_24x24,
-  wind_direction_meteorological_46deg_24x24,
-  wind_direction_meteorological_47deg_24x24,
-  wind_direction_meteorological_48deg_24x24,
-  wind_direction_meteorological_49deg_24x24,
-  wind_direction_meteorological_50deg_24x24,
-  wind_direction_meteorological_51deg_24x24,
-  wind_direction_meteorological_52deg_24x24,
-  wind_direction_meteorological_53deg_24x24,
-  wind_direction_meteorological_54deg_24x24,
-  wind_direction_meteorological_55deg_24x24,
-  wind_direction_meteorological_56deg_24x24,
-  wind_direction_meteorological_57deg_24x24,
-  wind_direction_meteorological_58deg_24x24,
-  wind_direction_meteorological_59deg_24x24,
-  wind_direction_meteorological_60deg_24x24,
-  wind_direction_meteorological_61deg_24x24,
-  wind_direction_meteorological_62deg_24x24,
-  wind_direction_meteorological_63deg_24x24,
-  wind_direction_meteorological_64deg_24x24,
-  wind_direction_meteorological_65deg_24x24,
-  wind_direction_meteorological_66deg_24x24,
-  wind_direction_meteorological_67deg_24x24,
-  wind_direction_meteorological_68deg_24x24,
-  wind_direction_meteorological_69deg_24x24,
-  wind_direction_meteorological_70deg_24x24,
-  wind_direction_meteorological_71deg_24x24,
-  wind_direction_meteorological_72deg_24x24,
-  wind_direction_meteorological_73deg_24x24,
-  wind_direction_meteorological_74deg_24x24,
-  wind_direction_meteorological_75deg_24x24,
-  wind_direction_meteorological_76deg_24x24,
-  wind_direction_meteorological_77deg_24x24,
-  wind_direction_meteorological_78deg_24x24,
-  wind_direction_meteorological_79deg_24x24,
-  wind_direction_meteorological_80deg_24x24,
-  wind_direction_meteorological_81deg_24x24,
-  wind_direction_meteorological_82deg_24x24,
-  wind_direction_meteorological_83deg_24x24,
-  wind_direction_meteorological_84deg_24x24,
-  wind_direction_meteorological_85deg_24x24,
-  wind_direction_meteorological_86deg_24x24,
-  wind_direction_meteorological_87deg_24x24,
-  wind_direction_meteorological_88deg_24x24,
-  wind_direction_meteorological_89deg_24x24,
-  wind_direction_meteorological_90deg_24x24,
-  wind_direction_meteorological_91deg_24x24,
-  wind_direction_meteorological_92deg_24x24,
-  wind_direction_meteorological_93deg_24x24,
-  wind_direction_meteorological_94deg_24x24,
-  wind_direction_meteorological_95deg_24x24,
-  wind_direction_meteorological_96deg_24x24,
-  wind_direction_meteorological_97deg_24x24,
-  wind_direction_meteorological_98deg_24x24,
-  wind_direction_meteorological_99deg_24x24,
-  wind_direction_meteorological_100deg_24x24,
-  wind_direction_meteorological_101deg_24x24,
-  wind_direction_meteorological_102deg_24x24,
-  wind_direction_meteorological_103deg_24x24,
-  wind_direction_meteorological_104deg_24x24,
-  wind_direction_meteorological_105deg_24x24,
-  wind_direction_meteorological_106deg_24x24,
-  wind_direction_meteorological_107deg_24x24,
-  wind_direction_meteorological_108deg_24x24,
-  wind_direction_meteorological_109deg_24x24,
-  wind_direction_meteorological_110deg_24x24,
-  wind_direction_meteorological_111deg_24x24,
-  wind_direction_meteorological_112deg_24x24,
-  wind_direction_meteorological_113deg_24x24,
-  wind_direction_meteorological_114deg_24x24,
-  wind_direction_meteorological_115deg_24x24,
-  wind_direction_meteorological_116deg_24x24,
-  wind_direction_meteorological_117deg_24x24,
-  wind_direction_meteorological_118deg_24x24,
-  wind_direction_meteorological_119deg_24x24,
-  wind_direction_meteorological_120deg_24x24,
-  wind_direction_meteorological_121deg_24x24,
-  wind_direction_meteorological_122deg_24x24,
-  wind_direction_meteorological_123deg_24x24,
-  wind_direction_meteorological_124deg_24x24,
-  wind_direction_meteorological_125deg_24x24,
-  wind_direction_meteorological_126deg_24x24,
-  wind_direction_meteorological_127deg_24x24,
-  wind_direction_meteorological_128deg_24x24,
-  wind_direction_meteorological_129deg_24x24,
-  wind_direction_meteorological_130deg_24x24,
-  wind_direction_meteorological_131deg_24x24,
-  wind_direction_meteorological_132deg_24x24,
-  wind_direction_meteorological_133deg_24x24,
-  wind_direction_meteorological_134deg_24x24,
-  wind_direction_meteorological_135deg_24x24,
-  wind_direction_meteorological_136deg_24x24,
-  wind_direction_meteorological_137deg_24x24,
-  wind_direction_meteorological_138deg_24x24,
-  wind_direction_meteorological_139deg_24x24,
-  wind_direction_meteorological_140deg_24x24,
-  wind_direction_meteorological_141deg_24x24,
-  wind_direction_meteorological_142deg_24x24,
-  wind_direction_meteorological_143deg_24x24,
-  wind_direction_meteorological_144deg_24x24,
-  wind_direction_meteorological_145deg_24x24,
-  wind_direction_meteorological_146deg_24x24,
-  wind_direction_meteorological_147deg_24x24,
-  wind_direction_meteorological_148deg_24x24,
-  wind_direction_meteorological_149deg_24x24,
-  wind_direction_meteorological_150deg_24x24,
-  wind_direction_meteorological_151deg_24x24,
-  wind_direction_meteorological_152deg_24x24,
-  wind_direction_meteorological_153deg_24x24,
-  wind_direction_meteorological_154deg_24x24,
-  wind_direction_meteorological_155deg_24x24,
-  wind_direction_meteorological_156deg_24x24,
-  wind_direction_meteorological_157deg_24x24,
-  wind_direction_meteorological_158deg_24x24,
-  wind_direction_meteorological_159deg_24x24,
-  wind_direction_meteorological_160deg_24x24,
-  wind_direction_meteorological_161deg_24x24,
-  wind_direction_meteorological_162deg_24x24,
-  wind_direction_meteorological_163deg_24x24,
-  wind_direction_meteorological_164deg_24x24,
-  wind_direction_meteorological_165deg_24x24,
-  wind_direction_meteorological_166deg_24x24,
-  wind_direction_meteorological_167deg_24x24,
-  wind_direction_meteorological_168deg_24x24,
-  wind_direction_meteorological_169deg_24x24,
-  wind_direction_meteorological_170deg_24x24,
-  wind_direction_meteorological_171deg_24x24,
-  wind_direction_meteorological_172deg_24x24,
-  wind_direction_meteorological_173deg_24x24,
-  wind_direction_meteorological_174deg_24x24,
-  wind_direction_meteorological_175deg_24x24,
-  wind_direction_meteorological_176deg_24x24,
-  wind_direction_meteorological_177deg_24x24,
-  wind_direction_meteorological_178deg_24x24,
-  wind_direction_meteorological_179deg_24x24,
-  wind_direction_meteorological_180deg_24x24,
-  wind_direction_meteorological_181deg_24x24,
-  wind_direction_meteorological_182deg_24x24,
-  wind_direction_meteorological_183deg_24x24,
-  wind_direction_meteorological_184deg_24x24,
-  wind_direction_meteorological_185deg_24x24,
-  wind_direction_meteorological_186deg_24x24,
-  wind_direction_meteorological_187deg_24x24,
-  wind_direction_meteorological_188deg_24x24,
-  wind_direction_meteorological_189deg_24x24,
-  wind_direction_meteorological_190deg_24x24,
-  wind_direction_meteorological_191deg_24x24,
-  wind_direction_meteorological_192deg_24x24,
-  wind_direction_meteorological_193deg_24x24,
-  wind_direction_meteorological_194deg_24x24,
-  wind_direction_meteorological_195deg_24x24,
-  wind_direction_meteorological_196deg_24x24,
-  wind_direction_meteorological_197deg_24x24,
-  wind_direction_meteorological_198deg_24x24,
-  wind_direction_meteorological_199deg_24x24,
-  wind_direction_meteorological_200deg_24x24,
-  wind_direction_meteorological_201deg_24x24,
-  wind_direction_meteorological_202deg_24x24,
-  wind_direction_meteorological_203deg_24x24,
-  wind_direction_meteorological_204deg_24x24,
-  wind_direction_meteorological_205deg_24x24,
-  wind_direction_meteorological_206deg_24x24,
-  wind_direction_meteorological_207deg_24x24,
-  wind_direction_meteorological_208deg_24x24,
-  wind_direction_meteorological_209deg_24x24,
-  wind_direction_meteorological_210deg_24x24,
-  wind_direction_meteorological_211deg_24x24,
-  wind_direction_meteorological_212deg_24x24,
-  wind_direction_meteorological_213deg_24x24,
-  wind_direction_meteorological_214deg_24x24,
-  wind_direction_meteorological_215deg_24x24,
-  wind_direction_meteorological_216deg_24x24,
-  wind_direction_meteorological_217deg_24x24,
-  wind_direction_meteorological_218deg_24x24,
-  wind_direction_meteorological_219deg_24x24,
-  wind_direction_meteorological_220deg_24x24,
-  wind_direction_meteorological_221deg_24x24,
-  wind_direction_meteorological_222deg_24x24,
-  wind_direction_meteorological_223deg_24x24,
-  wind_direction_meteorological_224deg_24x24,
-  wind_direction_meteorological_225deg_24x24,
-  wind_direction_meteorological_226deg_24x24,
-  wind_direction_meteorological_227deg_24x24,
-  wind_direction_meteorological_228deg_24x24,
-  wind_direction_meteorological_229deg_24x24,
-  wind_direction_meteorological_230deg_24x24,
-  wind_direction_meteorological_231deg_24x24,
-  wind_direction_meteorological_232deg_24x24,
-  wind_direction_meteorological_233deg_24x24,
-  wind_direction_meteorological_234deg_24x24,
-  wind_direction_meteorological_235deg_24x24,
-  wind_direction_meteorological_236deg_24x24,
-  wind_direction_meteorological_237deg_24x24,
-  wind_direction_meteorological_238deg_24x24,
-  wind_direction_meteorological_239deg_24x24,
-  wind_direction_meteorological_240deg_24x24,
-  wind_direction_meteorological_241deg_24x24,
-  wind_direction_meteorological_242deg_24x24,
-  wind_direction_meteorological_243deg_24x24,
-  wind_direction_meteorological_244deg_24x24,
-  wind_direction_meteorological_245deg_24x24,
-  wind_direction_meteorological_246deg_24x24,
-  wind_direction_meteorological_247deg_24x24,
-  wind_direction_meteorological_248deg_24x24,
-  wind_direction_meteorological_249deg_24x24,
-  wind_direction_meteorological_250deg_24x24,
-  wind_direction_meteorological_251deg_24x24,
-  wind_direction_meteorological_252deg_24x24,
-  wind_direction_meteorological_253deg_24x24,
-  wind_direction_meteorological_254deg_24x24,
-  wind_direction_meteorological_255deg_24x24,
-  wind_direction_meteorological_256deg_24x24,
-  wind_direction_meteorological_257deg_24x24,
-  wind_direction_meteorological_258deg_24x24,
-  wind_direction_meteorological_259deg_24x24,
-  wind_direction_meteorological_260deg_24x24,
-  wind_direction_meteorological_261deg_24x24,
-  wind_direction_meteorological_262deg_24x24,
-  wind_direction_meteorological_263deg_24x24,
-  wind_direction_meteorological_264deg_24x24,
-  wind_direction_meteorological_265deg_24x24,
-  wind_direction_meteorological_266deg_24x24,
-  wind_direction_meteorological_267deg_24x24,
-  wind_direction_meteorological_268deg_24x24,
-  wind_direction_meteorological_269deg_24x24,
-  wind_direction_meteorological_270deg_24x24,
-  wind_direction_meteorological_271deg_24x24,
-  wind_direction_meteorological_272deg_24x24,
-  wind_direction_meteorological_273deg_24x24,
-  wind_direction_meteorological_274deg_24x24,
-  wind_direction_meteorological_275deg_24x24,
-  wind_direction_meteorological_276deg_24x24,
-  wind_direction_meteorological_277deg_24x24,
-  wind_direction_meteorological_278deg_24x24,
-  wind_direction_meteorological_279deg_24x24,
-  wind_direction_meteorological_280deg_24x24,
-  wind_direction_meteorological_281deg_24x24,
-  wind_direction_meteorological_282deg_24x24,
-  wind_direction_meteorological_283deg_24x24,
-  wind_direction_meteorological_284deg_24x24,
-  wind_direction_meteorological_285deg_24x24,
-  wind_direction_meteorological_286deg_24x24,
-  wind_direction_meteorological_287deg_24x24,
-  wind_direction_meteorological_288deg_24x24,
-  wind_direction_meteorological_289deg_24x24,
-  wind_direction_meteorological_290deg_24x24,
-  wind_direction_meteorological_291deg_24x24,
-  wind_direction_meteorological_292deg_24x24,
-  wind_direction_meteorological_293deg_24x24,
-  wind_direction_meteorological_294deg_24x24,
-  wind_direction_meteorological_295deg_24x24,
-  wind_direction_meteorological_296deg_24x24,
-  wind_direction_meteorological_297deg_24x24,
-  wind_direction_meteorological_298deg_24x24,
-  wind_direction_meteorological_299deg_24x24,
-  wind_direction_meteorological_300deg_24x24,
-  wind_direction_meteorological_301deg_24x24,
-  wind_direction_meteorological_302deg_24x24,
-  wind_direction_meteorological_303deg_24x24,
-  wind_direction_meteorological_304deg_24x24,
-  wind_direction_meteorological_305deg_24x24,
-  wind_direction_meteorological_306deg_24x24,
-  wind_direction_meteorological_307deg_24x24,
-  wind_direction_meteorological_308deg_24x24,
-  wind_direction_meteorological_309deg_24x24,
-  wind_direction_meteorological_310deg_24x24,
-  wind_direction_meteorological_311deg_24x24,
-  wind_direction_meteorological_312deg_24x24,
-  wind_direction_meteorological_313deg_24x24,
-  wind_direction_meteorological_314deg_24x24,
-  wind_direction_meteorological_315deg_24x24,
-  wind_direction_meteorological_316deg_24x24,
-  wind_direction_meteorological_317deg_24x24,
-  wind_direction_meteorological_318deg_24x24,
-  wind_direction_meteorological_319deg_24x24,
-  wind_direction_meteorological_320deg_24x24,
-  wind_direction_meteorological_321deg_24x24,
-  wind_direction_meteorological_322deg_24x24,
-  wind_direction_meteorological_323deg_24x24,
-  wind_direction_meteorological_324deg_24x24,
-  wind_direction_meteorological_325deg_24x24,
-  wind_direction_meteorological_326deg_24x24,
-  wind_direction_meteorological_327deg_24x24,
-  wind_direction_meteorological_328deg_24x24,
-  wind_direction_meteorological_329deg_24x24,
-  wind_direction_meteorological_330deg_24x24,
-  wind_direction_meteorological_331deg_24x24,
-  wind_direction_meteorological_332deg_24x24,
-  wind_direction_meteorological_333deg_24x24,
-  wind_direction_meteorological_334deg_24x24,
-  wind_direction_meteorological_335deg_24x24,
-  wind_direction_meteorological_336deg_24x24,
-  wind_direction_meteorological_337deg_24x24,
-  wind_direction_meteorological_338deg_24x24,
-  wind_direction_meteorological_339deg_24x24,
-  wind_direction_meteorological_340deg_24x24,
-  wind_direction_meteorological_341deg_24x24,
-  wind_direction_meteorological_342deg_24x24,
-  wind_direction_meteorological_343deg_24x24,
-  wind_direction_meteorological_344deg_24x24,
-  wind_direction_meteorological_345deg_24x24,
-  wind_direction_meteorological_346deg_24x24,
-  wind_direction_meteorological_347deg_24x24,
-  wind_direction_meteorological_348deg_24x24,
-  wind_direction_meteorological_349deg_24x24,
-  wind_direction_meteorological_350deg_24x24,
-  wind_direction_meteorological_351deg_24x24,
-  wind_direction_meteorological_352deg_24x24,
-  wind_direction_meteorological_353deg_24x24,
-  wind_direction_meteorological_354deg_24x24,
-  wind_direction_meteorological_355deg_24x24,
-  wind_direction_meteorological_356deg_24x24,
-  wind_direction_meteorological_357deg_24x24,
-  wind_direction_meteorological_358deg_24x24,
-  wind_direction_meteorological_359deg_24x24};
-#endif // end WIND_ICONS_360
-
-/* Returns a 24x24 wind direction icon bitmap for angles 0 to 359 degrees
+/* Returns the direction to draw the wind arrow at, for angles 0 to 359 degrees,
+ * rounded to the wind direction icon precision selected in config.h.
  * Parameter is meteorological wind direction, arrow points in the direction the
  * wind is going.
  */
-const uint8_t *getWindBitmap24(int windDeg)
+int getWindArrowDeg(int windDeg)
 {
   windDeg %= 360; // enforce domain
   // number of directions
-  int n = sizeof(wind_direction_icon_arr)
-          / sizeof(wind_direction_icon_arr[0]);
+#if defined(WIND_ICONS_CARDINAL)
+  const int n = 4;
+#elif defined(WIND_ICONS_INTERCARDINAL)
+  const int n = 8;
+#elif defined(WIND_ICONS_SECONDARY_INTERCARDINAL)
+  const int n = 16;
+#elif defined(WIND_ICONS_TERTIARY_INTERCARDINAL)
+  const int n = 32;
+#else // WIND_ICONS_360
+  const int n = 360;
+#endif
   int arr_offset = (int) ( (windDeg + (360 / n / 2)) % 360 )
                          / ( 360 / (float) n );
 
-  return wind_direction_icon_arr[arr_offset];
-} // end getWindBitmap24
+  return static_cast<int>(arr_offset * (360 / (float) n) + 0.5f);
+} // end getWindArrowDeg
 
 /* Returns a pointer to a string that expresses the Compass Point Notation (CPN)
  * of the given windDeg.
@@ -1519,6 +1027,72 @@ const char *getWifiStatusPhrase(wl_status_t status)
   }
 } // end getWifiStatusPhrase
 
+/* Helpers for getRenderSignature.
+ */
+static uint32_t hashInt(uint32_t crc, int64_t value)
+{
+  return crc32_le(crc, reinterpret_cast<const uint8_t *>(&value),
+                  sizeof(value));
+}
+
+static uint32_t hashStr(uint32_t crc, const char *s)
+{
+  return crc32_le(crc, reinterpret_cast<const uint8_t *>(s), strlen(s) + 1);
+}
+
+static uint32_t hashBitmap(uint32_t crc, const uint8_t *bitmap)
+{
+  return hashInt(crc, reinterpret_cast<intptr_t>(bitmap));
+}
+
+/* Returns a signature of everything the full refresh would draw, except the
+ * refresh time. If it matches the signature of what is already on the panel,
+ * the refresh can be skipped. Never returns 0, which stands for "unknown".
+ *
+ * The sections drawn from the view model are covered by hashing the view
+ * itself. The rest must be kept in step with what their draw functions use.
+ */
+uint32_t getRenderSignature(const weather_view_t &view,
+                            const owm_resp_onecall_t &onecall,
+                            const String &dateStr, const String &statusStr,
+                            int rssi, uint32_t batVoltage)
+{
+  // current conditions, outlook graph and forecast, exactly as they are drawn
+  uint32_t crc = crc32_le(0, reinterpret_cast<const uint8_t *>(&view),
+                          sizeof(view));
+
+  // alerts
+#if DISPLAY_ALERTS
+  for (int i = 0; i < onecall.num_alerts; ++i)
+  {
+    crc = hashStr(crc, onecall.alerts[i].event);
+    crc = hashStr(crc, onecall.alerts[i].tags);
+  }
+#endif
+
+  // location, date and status bar
+  crc = hashStr(crc, CITY_STRING.c_str());
+  crc = hashStr(crc, dateStr.c_str());
+  crc = hashStr(crc, statusStr.c_str());
+  crc = hashStr(crc, getWiFidesc(rssi));
+  crc = hashInt(crc, rssi >= -70);
+#if STATUS_BAR_EXTRAS_WIFI_RSSI
+  crc = hashInt(crc, rssi);
+#else
+  crc = hashBitmap(crc, getWiFiBitmap16(rssi));
+#endif
+#if BATTERY_MONITORING
+  crc = hashInt(crc, calcBatPercent(batVoltage, MIN_BATTERY_VOLTAGE,
+                                    MAX_BATTERY_VOLTAGE));
+  crc = hashInt(crc, batVoltage < WARN_BATTERY_VOLTAGE);
+#if STATUS_BAR_EXTRAS_BAT_VOLTAGE
+  crc = hashInt(crc, batVoltage / 10);
+#endif
+#endif
+
+  return crc != 0 ? crc : 1;
+} // end getRenderSignature
+
 /* This function sets the builtin LED to LOW and disables it even during deep
  * sleep.
  */
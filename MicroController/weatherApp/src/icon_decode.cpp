@@ -0,0 +1,105 @@
+/* Icon decoder for esp32-weather-epd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <Arduino.h>
+#include "icon_decode.h"
+
+/* Reads one run length of an ICON_RLE icon.
+ */
+static int32_t readRun(icon_decoder_t &d)
+{
+  int32_t run = 0;
+  uint8_t b;
+  do
+  {
+    b = pgm_read_byte(d.data++);
+    run += b;
+  } while (b == 255);
+  return run;
+} // end readRun
+
+/* Starts decoding a packed icon from icon_atlas.
+ */
+void beginIcon(icon_decoder_t &d, const uint8_t *icon)
+{
+  d.width    = pgm_read_byte(icon);
+  d.height   = pgm_read_byte(icon + 1);
+  d.encoding = pgm_read_byte(icon + 2);
+  d.data     = icon + 3;
+  d.pos      = 0;
+  d.ink      = 0;
+  return;
+} // end beginIcon
+
+/* Finds the next run of ink of an icon, top to bottom and left to right. Runs
+ * that go past the end of a row are returned one row at a time.
+ *
+ * Returns false once the whole icon has been read.
+ */
+bool nextIconSpan(icon_decoder_t &d, icon_span_t &span)
+{
+  const int32_t size = static_cast<int32_t>(d.width) * d.height;
+
+  if (d.encoding == ICON_RLE)
+  {
+    while (d.ink == 0)
+    {
+      if (d.pos >= size)
+      {
+        return false;
+      }
+      d.pos += readRun(d);
+      if (d.pos >= size)
+      {
+        return false;
+      }
+      d.ink = readRun(d);
+    }
+    span.y = d.pos / d.width;
+    span.x = d.pos - span.y * d.width;
+    span.w = std::min<int32_t>(d.ink, d.width - span.x);
+    d.pos += span.w;
+    d.ink -= span.w;
+    return true;
+  }
+
+  // ICON_RAW, a pixel is ink where its bit is clear
+  const int32_t rowBytes = (d.width + 7) / 8;
+  auto isInk = [&](int16_t x, int16_t y) {
+    uint8_t b = pgm_read_byte(&d.data[y * rowBytes + x / 8]);
+    return !(b & (0x80 >> (x & 7)));
+  };
+  while (d.pos < size)
+  {
+    int16_t y = d.pos / d.width;
+    int16_t x = d.pos - y * d.width;
+    if (!isInk(x, y))
+    {
+      ++d.pos;
+      continue;
+    }
+    int16_t x1 = x + 1;
+    while (x1 < d.width && isInk(x1, y))
+    {
+      ++x1;
+    }
+    span = {x, y, static_cast<int16_t>(x1 - x)};
+    d.pos += x1 - x;
+    return true;
+  }
+  return false;
+} // end nextIconSpan
@@ -0,0 +1,424 @@
+/* Streaming JSON reader for esp32-weather-epd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <Arduino.h>
+
+#include "config.h"
+#include "json_stream.h"
+
+JsonStreamReader::JsonStreamReader(Stream &stream)
+  : stream(stream), len(0), pos(0), first(true),
+    err(DeserializationError::Ok)
+{
+}
+
+DeserializationError JsonStreamReader::error() const
+{
+  return DeserializationError(err);
+}
+
+void JsonStreamReader::fail(DeserializationError::Code code)
+{
+  if (err == DeserializationError::Ok)
+  {
+    err = code;
+  }
+}
+
+/* Reads the next chunk of input into buf. Takes whatever has already arrived,
+ * or waits (up to the stream's timeout) for at least one byte.
+ *
+ * Returns the number of bytes read, 0 at the end of input.
+ */
+int JsonStreamReader::fill()
+{
+  int avail = stream.available();
+  if (avail > JSON_STREAM_BUFFER_SIZE)
+  {
+    avail = JSON_STREAM_BUFFER_SIZE;
+  }
+  len = stream.readBytes(buf, avail > 0 ? avail : 1);
+  pos = 0;
+#if DEBUG_LEVEL >= 2
+  Serial.write(buf, len);
+#endif
+  return len;
+}
+
+/* Returns the next byte of input, or -1 at the end of input/after an error.
+ */
+int JsonStreamReader::nextChar()
+{
+  if (err != DeserializationError::Ok)
+  {
+    return -1;
+  }
+  if (pos >= len && fill() <= 0)
+  {
+    fail(DeserializationError::IncompleteInput);
+    return -1;
+  }
+  return static_cast<unsigned char>(buf[pos++]);
+}
+
+int JsonStreamReader::nextNonSpace()
+{
+  int c;
+  do
+  {
+    c = nextChar();
+  } while (c == ' ' || c == '\n' || c == '\r' || c == '\t');
+  return c;
+}
+
+/* Returns the next non-whitespace character without consuming it, or 0 at the
+ * end of input/after an error.
+ */
+char JsonStreamReader::peek()
+{
+  int c = nextNonSpace();
+  if (c < 0)
+  {
+    return 0;
+  }
+  --pos;
+  return static_cast<char>(c);
+}
+
+bool JsonStreamReader::expect(char c)
+{
+  int got = nextNonSpace();
+  if (got != c)
+  {
+    fail(got < 0 ? DeserializationError::IncompleteInput
+                 : DeserializationError::InvalidInput);
+    return false;
+  }
+  return true;
+}
+
+bool JsonStreamReader::beginObject()
+{
+  first = true;
+  return expect('{');
+}
+
+bool JsonStreamReader::beginArray()
+{
+  first = true;
+  return expect('[');
+}
+
+/* Reads the next key of the current object into key (truncated to fit) and
+ * consumes the ':' after it. The caller must then read or skip the value.
+ *
+ * Returns false once the closing '}' has been consumed, or on error.
+ */
+bool JsonStreamReader::nextKey(char *key, size_t size)
+{
+  int c = nextNonSpace();
+  if (c == '}')
+  {
+    first = false;
+    return false;
+  }
+  if (!first)
+  {
+    if (c != ',')
+    {
+      fail(c < 0 ? DeserializationError::IncompleteInput
+                 : DeserializationError::InvalidInput);
+      return false;
+    }
+    c = nextNonSpace();
+  }
+  first = false;
+  if (c != '"')
+  {
+    fail(c < 0 ? DeserializationError::IncompleteInput
+               : DeserializationError::InvalidInput);
+    return false;
+  }
+  --pos; // let readString consume the opening quote
+  return readString(key, size) && expect(':');
+}
+
+/* Moves to the next element of the current array. The caller must then read
+ * or skip the value.
+ *
+ * Returns false once the closing ']' has been consumed, or on error.
+ */
+bool JsonStreamReader::nextElement()
+{
+  char c = peek();
+  if (c == ']')
+  {
+    ++pos;
+    first = false;
+    return false;
+  }
+  if (!first)
+  {
+    if (!expect(','))
+    {
+      return false;
+    }
+  }
+  first = false;
+  return err == DeserializationError::Ok;
+}
+
+/* Copies the characters of a number into num. A null is accepted and leaves
+ * num empty, anything else that isn't a number is skipped.
+ *
+ * Returns true if num holds a number.
+ */
+bool JsonStreamReader::readNumber(char *num, size_t size)
+{
+  char c = peek();
+  if (c != '-' && (c < '0' || c > '9'))
+  {
+    skipValue(); // null, true, false, or a value of the wrong type
+    return false;
+  }
+
+  size_t n = 0;
+  while (true)
+  {
+    int ch = nextChar();
+    if ((ch >= '0' && ch <= '9') || ch == '-' || ch == '+'
+     || ch == '.' || ch == 'e' || ch == 'E')
+    {
+      if (n < size - 1)
+      {
+        num[n++] = static_cast<char>(ch);
+      }
+    }
+    else
+    {
+      if (ch >= 0)
+      {
+        --pos; // delimiter belongs to the caller
+      }
+      break;
+    }
+  }
+  num[n] = '\0';
+  return n > 0;
+}
+
+float JsonStreamReader::readFloat()
+{
+  char num[32];
+  return readNumber(num, sizeof(num)) ? strtof(num, nullptr) : 0.0f;
+}
+
+int JsonStreamReader::readInt()
+{
+  char num[32];
+  // strtod rather than strtol so values like 1.5e2 convert like ArduinoJson's
+  return readNumber(num, sizeof(num)) ? static_cast<int>(strtod(num, nullptr))
+                                      : 0;
+}
+
+int64_t JsonStreamReader::readInt64()
+{
+  char num[32];
+  return readNumber(num, sizeof(num)) ? strtoll(num, nullptr, 10) : 0;
+}
+
+/* Reads a string value into str as UTF-8, truncated to fit. A null (or any
+ * other non-string value) is skipped and leaves str empty.
+ *
+ * Returns false on error.
+ */
+bool JsonStreamReader::readString(char *str, size_t size)
+{
+  size_t n = 0;
+  str[0] = '\0';
+  if (peek() != '"')
+  {
+    skipValue();
+    return err == DeserializationError::Ok;
+  }
+  nextChar();
+
+  while (true)
+  {
+    int c = nextChar();
+    if (c < 0)
+    {
+      return false;
+    }
+    if (c == '"')
+    {
+      break;
+    }
+
+    char out[4];
+    int outLen = 1;
+    out[0] = static_cast<char>(c);
+    if (c == '\\')
+    {
+      c = nextChar();
+      switch (c)
+      {
+      case 'b': out[0] = '\b'; break;
+      case 'f': out[0] = '\f'; break;
+      case 'n': out[0] = '\n'; break;
+      case 'r': out[0] = '\r'; break;
+      case 't': out[0] = '\t'; break;
+      case 'u':
+      {
+        uint32_t cp = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+          int h = nextChar();
+          cp <<= 4;
+          if (h >= '0' && h <= '9')      { cp |= h - '0'; }
+          else if (h >= 'a' && h <= 'f') { cp |= h - 'a' + 10; }
+          else if (h >= 'A' && h <= 'F') { cp |= h - 'A' + 10; }
+          else
+          {
+            fail(h < 0 ? DeserializationError::IncompleteInput
+                       : DeserializationError::InvalidInput);
+            return false;
+          }
+        }
+        // surrogate pairs are rare enough in weather data that each half is
+        // simply replaced
+        if (cp >= 0xD800 && cp <= 0xDFFF)
+        {
+          cp = 0xFFFD;
+        }
+        if (cp < 0x80)
+        {
+          out[0] = static_cast<char>(cp);
+        }
+        else if (cp < 0x800)
+        {
+          out[0] = static_cast<char>(0xC0 | (cp >> 6));
+          out[1] = static_cast<char>(0x80 | (cp & 0x3F));
+          outLen = 2;
+        }
+        else
+        {
+          out[0] = static_cast<char>(0xE0 | (cp >> 12));
+          out[1] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+          out[2] = static_cast<char>(0x80 | (cp & 0x3F));
+          outLen = 3;
+        }
+        break;
+      }
+      default:
+        if (c < 0)
+        {
+          return false;
+        }
+        out[0] = static_cast<char>(c); // \" \\ \/
+        break;
+      }
+    }
+
+    // never split a multi-byte character when truncating
+    if (n + outLen < size)
+    {
+      memcpy(str + n, out, outLen);
+      n += outLen;
+    }
+  }
+  str[n] = '\0';
+  return true;
+}
+
+bool JsonStreamReader::skipString()
+{
+  while (true)
+  {
+    int c = nextChar();
+    if (c < 0)
+    {
+      return false;
+    }
+    if (c == '\\')
+    {
+      nextChar();
+    }
+    else if (c == '"')
+    {
+      return true;
+    }
+  }
+}
+
+/* Skips the next value, including everything nested inside it. Iterative, so
+ * stack use doesn't grow with nesting depth.
+ */
+void JsonStreamReader::skipValue()
+{
+  int depth = 0;
+  do
+  {
+    int c = nextNonSpace();
+    switch (c)
+    {
+    case -1:
+      return;
+    case '{':
+    case '[':
+      ++depth;
+      break;
+    case '}':
+    case ']':
+      if (--depth < 0)
+      {
+        fail(DeserializationError::InvalidInput); // there was no value
+        return;
+      }
+      break;
+    case '"':
+      skipString();
+      break;
+    case ',':
+    case ':':
+      if (depth == 0)
+      {
+        fail(DeserializationError::InvalidInput);
+        return;
+      }
+      break;
+    default:
+      // number or literal, consume up to the delimiter
+      while (true)
+      {
+        c = nextChar();
+        if (c < 0)
+        {
+          return;
+        }
+        if (c == ',' || c == '}' || c == ']' || c == ' '
+         || c == '\n' || c == '\r' || c == '\t')
+        {
+          --pos;
+          break;
+        }
+      }
+      break;
+    }
+  } while (depth > 0);
+}
@@ -16,22 +16,31 @@
  */
 
 #include "config.h"
+#include <algorithm>
+#include <cstring>
 #include <Arduino.h>
 #include <Adafruit_Sensor.h>
-#include <Preferences.h>
 #include <time.h>
 #include <WiFi.h>
 #include <Wire.h>
 
+#include <BatteryPolicy.h>
+#include <BootPartition.h>
+#include <Logger.h>
+#include <PanelState.h>
+#include <TimingProbe.h>
+
 #include "_locale.h"
 #include "api_response.h"
+#include "aqi_history.h"
 #include "client_utils.h"
 #include "config.h"
 #include "display_utils.h"
-#include "icons/icons_196x196.h"
+#include "icon_atlas.h"
+#include "partial_refresh.h"
 #include "renderer.h"
-#include "esp_ota_ops.h"
-#include "esp_partition.h"
+#include "view_model.h"
+#include "weather_cache.h"
 
 
 #if defined(SENSOR_BME280)
@@ -50,35 +59,34 @@
 // too large to allocate locally on stack
 static owm_resp_onecall_t       owm_onecall;
 static owm_resp_air_pollution_t owm_air_pollution;
+static aqi_history_t            aqi_history;
+static weather_view_t           weather_view;
+static screen_state_t           screen;
+static screen_state_t           last_screen;
+#if DISPLAY_ALERTS
+static owm_alerts_t             screen_alerts[OWM_NUM_ALERTS];
+#endif
+#ifndef USE_WEATHER_PROXY
+static char                     owm_onecall_text[OWM_TEXT_ARENA_SIZE];
+#endif
 
-Preferences prefs;
-
-/*
-* Set the boot partition back to the selector app for the next boot (wake)
-*/
-bool resetBootPartition() {
-  // Find the factory partition (selector app)
-  const esp_partition_t* factory_partition = esp_partition_find_first(
-    ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_APP_FACTORY, NULL);
-  
-  if (factory_partition != NULL) {
-    //Serial.printf("Found factory partition at address 0x%x\n", factory_partition->address);
-    
-    // Set boot partition
-    esp_err_t err = esp_ota_set_boot_partition(factory_partition);
-    if (err == ESP_OK) {
-      Serial.println("Boot partition set to selector app");
-      return true;
-    } else {
-      Serial.printf("Failed to set boot partition, error: %d\n", err);
-      return false;
-    }
-  } else {
-    Serial.println("ERROR: Factory partition not found!");
-    return false;
-  }
-}
-
+/* Draws the weather screen described by s, or one page of it.
+ */
+static void drawWeatherScreen(const screen_state_t &s)
+{
+  drawCurrentConditions(s.view.current);
+  drawOutlookGraph(s.view.outlook);
+  drawForecast(s.view.forecast);
+  drawLocationDate(CITY_STRING, s.header.date);
+#if DISPLAY_ALERTS
+  // drawAlerts edits the alerts it is given
+  memcpy(screen_alerts, s.header.alerts, sizeof(screen_alerts));
+  drawAlerts(screen_alerts, s.header.num_alerts, CITY_STRING, s.header.date);
+#endif
+  drawStatusBar(s.info.status, s.info.refresh_time, s.info.rssi,
+                s.info.bat_voltage);
+  return;
+} // end drawWeatherScreen
 
 /* Put esp32 into ultra low-power deep sleep (<11μA).
  * Aligns wake time to the minute. Sleep times defined in config.cpp.
@@ -87,7 +95,7 @@ void beginDeepSleep(unsigned long startTime, tm *timeInfo)
 {
   if (!getLocalTime(timeInfo))
   {
-    Serial.println(TXT_REFERENCING_OLDER_TIME_NOTICE);
+    LOG_WARN("%s", TXT_REFERENCING_OLDER_TIME_NOTICE);
   }
 
   // To simplify sleep time calculations, the current time stored by timeInfo
@@ -143,13 +151,17 @@ void beginDeepSleep(unsigned long startTime, tm *timeInfo)
 
 #if DEBUG_LEVEL >= 1
   printHeapUsage();
+  // draw functions are timed once per page, compare with FULL_FRAME_BUFFER
+  LOG_INFO("[debug] display pages    : %d", (int)DISP_PAGES);
+  flushLog();
+  printTimingReport(Serial);
 #endif
 
   esp_sleep_enable_timer_wakeup(sleepDuration * 1000000ULL);
-  Serial.print(TXT_AWAKE_FOR);
-  Serial.println(" "  + String((millis() - startTime) / 1000.0, 3) + "s");
-  Serial.print(TXT_ENTERING_DEEP_SLEEP_FOR);
-  Serial.println(" " + String(sleepDuration) + "s");
+  LOG_INFO("%s %.3fs", TXT_AWAKE_FOR, (millis() - startTime) / 1000.0);
+  LOG_INFO("%s %llus", TXT_ENTERING_DEEP_SLEEP_FOR,
+           (unsigned long long)sleepDuration);
+  flushLog();
   esp_deep_sleep_start();
 } // end beginDeepSleep
 
@@ -166,158 +178,236 @@ void setup()
 
   disableBuiltinLED();
 
-  // Open namespace for read/write to non-volatile storage
-  prefs.begin(NVS_NAMESPACE, false);
-
 #if BATTERY_MONITORING
-  uint32_t batteryVoltage = readBatteryVoltage();
-  Serial.print(TXT_BATTERY_VOLTAGE);
-  Serial.println(": " + String(batteryVoltage) + "mv");
+  BatteryPolicy batteryPolicy;
+  batteryPolicy.init(PIN_BAT_ADC,
+                     {LOW_BATTERY_VOLTAGE, VERY_LOW_BATTERY_VOLTAGE,
+                      CRIT_LOW_BATTERY_VOLTAGE,
+                      LOW_BATTERY_SLEEP_INTERVAL * 60,
+                      VERY_LOW_BATTERY_SLEEP_INTERVAL * 60},
+                     NVS_NAMESPACE);
+  uint32_t batteryVoltage = batteryPolicy.readVoltage();
+  LOG_INFO("%s: %lumv", TXT_BATTERY_VOLTAGE, (unsigned long)batteryVoltage);
 
   // When the battery is low, the display should be updated to reflect that, but
   // only the first time we detect low voltage. The next time the display will
-  // refresh is when voltage is no longer low. To keep track of that we will
-  // make use of non-volatile storage.
-  bool lowBat = prefs.getBool("lowBat", false);
+  // refresh is when voltage is no longer low. BatteryPolicy keeps track of that
+  // in non-volatile storage.
+  if (batteryPolicy.shouldShowWarning() && initDisplay())
+  { // battery is now low for the first time
+    do
+    {
+      drawError(battery_alert_0deg_196x196, TXT_LOW_BATTERY);
+    } while (display->nextPage());
+    powerOffDisplay();
+    setPanelContents(APP_ID, 0);
+  }
 
   // low battery, deep sleep now
-  if (batteryVoltage <= LOW_BATTERY_VOLTAGE)
+  if (!batteryPolicy.allowWiFi())
   {
-    if (lowBat == false)
-    { // battery is now low for the first time
-      prefs.putBool("lowBat", true);
-      prefs.end();
-      initDisplay();
-      do
-      {
-        drawError(battery_alert_0deg_196x196, TXT_LOW_BATTERY);
-      } while (display.nextPage());
-      powerOffDisplay();
-    }
-
-    if (batteryVoltage <= CRIT_LOW_BATTERY_VOLTAGE)
-    { // critically low battery
-      // don't set esp_sleep_enable_timer_wakeup();
+    switch (batteryPolicy.getLevel())
+    {
+    case BATTERY_CRITICAL:
       // We won't wake up again until someone manually presses the RST button.
-      Serial.println(TXT_CRIT_LOW_BATTERY_VOLTAGE);
-      Serial.println(TXT_HIBERNATING_INDEFINITELY_NOTICE);
-    }
-    else if (batteryVoltage <= VERY_LOW_BATTERY_VOLTAGE)
-    { // very low battery
-      esp_sleep_enable_timer_wakeup(VERY_LOW_BATTERY_SLEEP_INTERVAL
-                                    * 60ULL * 1000000ULL);
-      Serial.println(TXT_VERY_LOW_BATTERY_VOLTAGE);
-      Serial.print(TXT_ENTERING_DEEP_SLEEP_FOR);
-      Serial.println(" " + String(VERY_LOW_BATTERY_SLEEP_INTERVAL) + "min");
-    }
-    else
-    { // low battery
-      esp_sleep_enable_timer_wakeup(LOW_BATTERY_SLEEP_INTERVAL
-                                    * 60ULL * 1000000ULL);
-      Serial.println(TXT_LOW_BATTERY_VOLTAGE);
-      Serial.print(TXT_ENTERING_DEEP_SLEEP_FOR);
-      Serial.println(" " + String(LOW_BATTERY_SLEEP_INTERVAL) + "min");
+      LOG_WARN("%s", TXT_CRIT_LOW_BATTERY_VOLTAGE);
+      LOG_WARN("%s", TXT_HIBERNATING_INDEFINITELY_NOTICE);
+      break;
+    case BATTERY_VERY_LOW:
+      LOG_WARN("%s", TXT_VERY_LOW_BATTERY_VOLTAGE);
+      break;
+    default:
+      LOG_WARN("%s", TXT_LOW_BATTERY_VOLTAGE);
+      break;
     }
-    esp_deep_sleep_start();
-  }
-  // battery is no longer low, reset variable in non-volatile storage
-  if (lowBat == true)
-  {
-    prefs.putBool("lowBat", false);
+    batteryPolicy.deepSleep();
   }
 #else
   uint32_t batteryVoltage = UINT32_MAX;
 #endif
 
-  // All data should have been loaded from NVS. Close filesystem.
-  prefs.end();
-
   String statusStr = {};
-  String tmpStr = {};
   tm timeInfo = {};
 
   // START WIFI
   int wifiRSSI = 0; // “Received Signal Strength Indicator"
-  wl_status_t wifiStatus = startWiFi(wifiRSSI);
+  wl_status_t wifiStatus;
+  {
+    TimingProbe probe("wifi");
+    wifiStatus = startWiFi(wifiRSSI);
+  }
+
+  // If any step fails, this is set to the error that would be drawn and the
+  // last successfully fetched weather is shown instead, when there is any.
+  const uint8_t *errBitmap = nullptr;
+  String errMsgLn1, errMsgLn2;
+  bool timeConfigured = false;
+
   if (wifiStatus != WL_CONNECTED)
   { // WiFi Connection Failed
-    killWiFi();
-    initDisplay();
-    if (wifiStatus == WL_NO_SSID_AVAIL)
-    {
-      Serial.println(TXT_NETWORK_NOT_AVAILABLE);
-      do
-      {
-        drawError(wifi_x_196x196, TXT_NETWORK_NOT_AVAILABLE);
-      } while (display.nextPage());
-    }
-    else
-    {
-      Serial.println(TXT_WIFI_CONNECTION_FAILED);
-      do
-      {
-        drawError(wifi_x_196x196, TXT_WIFI_CONNECTION_FAILED);
-      } while (display.nextPage());
-    }
-    powerOffDisplay();
-    beginDeepSleep(startTime, &timeInfo);
+    errBitmap = wifi_x_196x196;
+    errMsgLn1 = wifiStatus == WL_NO_SSID_AVAIL ? TXT_NETWORK_NOT_AVAILABLE
+                                               : TXT_WIFI_CONNECTION_FAILED;
+    LOG_ERROR("%s", errMsgLn1.c_str());
   }
 
   // TIME SYNCHRONIZATION
-  configTzTime(TIMEZONE, NTP_SERVER_1, NTP_SERVER_2);
-  bool timeConfigured = waitForSNTPSync(&timeInfo);
-  if (!timeConfigured)
+  if (!errBitmap)
   {
-    Serial.println(TXT_TIME_SYNCHRONIZATION_FAILED);
-    killWiFi();
-    initDisplay();
-    do
+    configTzTime(TIMEZONE, NTP_SERVER_1, NTP_SERVER_2);
+    timeConfigured = waitForSNTPSync(&timeInfo);
+    if (!timeConfigured)
     {
-      drawError(wi_time_4_196x196, TXT_TIME_SYNCHRONIZATION_FAILED);
-    } while (display.nextPage());
-    powerOffDisplay();
-    beginDeepSleep(startTime, &timeInfo);
+      errBitmap = wi_time_4_196x196;
+      errMsgLn1 = TXT_TIME_SYNCHRONIZATION_FAILED;
+      LOG_ERROR("%s", errMsgLn1.c_str());
+    }
   }
 
   // MAKE API REQUESTS
+  // Only what has gone stale since the last update is requested, the rest is
+  // kept from the cached responses.
+  weather_cache_info_t cacheInfo = {};
+#ifdef USE_WEATHER_PROXY
+  // the proxy keeps its own cache, so everything is requested every time
+  if (!errBitmap)
+  {
+    WiFiClient client;
+    int rxStatus;
+    {
+      TimingProbe probe("weather proxy");
+      rxStatus = getWeatherProxy(client, owm_onecall, owm_air_pollution);
+    }
+    if (rxStatus != HTTP_CODE_OK)
+    {
+      errBitmap = wi_cloud_down_196x196;
+      errMsgLn1 = "Weather Proxy";
+      errMsgLn2 = String(rxStatus, DEC) + ": "
+                  + getHttpResponsePhrase(rxStatus);
+    }
+    else
+    {
+      cacheInfo.fetched = time(nullptr);
+      cacheInfo.daily_fetched = cacheInfo.fetched;
+      resetAqiHistory(aqi_history);
+      updateAqiHistory(aqi_history, owm_air_pollution);
+    }
+  }
+#else
+  if (!errBitmap)
+  {
+    bool cached = loadWeatherCache(owm_onecall, aqi_history, cacheInfo);
+    fetch_plan_t plan = planWeatherFetch(cached, owm_onecall, aqi_history,
+                                         cacheInfo, time(nullptr));
+
 #ifdef USE_HTTP
-  WiFiClient client;
+    WiFiClient client;
 #elif defined(USE_HTTPS_NO_CERT_VERIF)
-  WiFiClientSecure client;
-  client.setInsecure();
+    WiFiClientSecure client;
+    client.setInsecure();
 #elif defined(USE_HTTPS_WITH_CERT_VERIF)
-  WiFiClientSecure client;
-  client.setCACert(cert_Sectigo_RSA_Organization_Validation_Secure_Server_CA);
+    WiFiClientSecure client;
+    client.setCACert(cert_Sectigo_RSA_Organization_Validation_Secure_Server_CA);
 #endif
-  int rxStatus = getOWMonecall(client, owm_onecall);
-  if (rxStatus != HTTP_CODE_OK)
-  {
-    killWiFi();
-    statusStr = "One Call " + OWM_ONECALL_VERSION + " API";
-    tmpStr = String(rxStatus, DEC) + ": " + getHttpResponsePhrase(rxStatus);
-    initDisplay();
-    do
+    int rxStatus;
     {
-      drawError(wi_cloud_down_196x196, statusStr, tmpStr);
-    } while (display.nextPage());
-    powerOffDisplay();
-    beginDeepSleep(startTime, &timeInfo);
+      TimingProbe probe("onecall");
+      memcpy(owm_onecall_text, owm_onecall.text, sizeof(owm_onecall_text));
+      rxStatus = getOWMonecall(client, owm_onecall, plan.daily);
+    }
+    if (rxStatus != HTTP_CODE_OK)
+    {
+      errBitmap = wi_cloud_down_196x196;
+      errMsgLn1 = "One Call " + OWM_ONECALL_VERSION + " API";
+      errMsgLn2 = String(rxStatus, DEC) + ": "
+                  + getHttpResponsePhrase(rxStatus);
+    }
+    else
+    {
+      cacheInfo.fetched = time(nullptr);
+      if (plan.daily)
+      {
+        cacheInfo.daily_fetched = cacheInfo.fetched;
+      }
+      else
+      {
+        keepDailyForecast(owm_onecall, owm_onecall_text);
+      }
+    }
+
+    // Only the hours since the cached AQI history are requested, usually
+    // just the newest one, and appended to it. If the request fails the
+    // cached history is still there to fall back on. The new One Call
+    // response is kept either way.
+    if (!errBitmap && plan.air_pollution)
+    {
+      TimingProbe probe("air pollution");
+      owm_air_pollution = {};
+      rxStatus = getOWMairpollution(client, owm_air_pollution,
+                                    plan.air_pollution_start);
+      if (rxStatus == HTTP_CODE_OK)
+      {
+        if (plan.air_pollution_start == 0)
+        {
+          resetAqiHistory(aqi_history);
+        }
+        updateAqiHistory(aqi_history, owm_air_pollution);
+      }
+      else if (cached)
+      {
+        LOG_WARN("Air Pollution API %d: %s, using the cached history",
+                 rxStatus, getHttpResponsePhrase(rxStatus).c_str());
+      }
+      else
+      {
+        errBitmap = wi_cloud_down_196x196;
+        errMsgLn1 = "Air Pollution API";
+        errMsgLn2 = String(rxStatus, DEC) + ": "
+                    + getHttpResponsePhrase(rxStatus);
+      }
+    }
+  }
+#endif
+  killWiFi(); // WiFi no longer needed
+
+  // the refresh time shown is when the weather data was fetched
+  tm fetchedInfo = timeInfo;
+  if (!errBitmap)
+  {
+    saveWeatherCache(owm_onecall, aqi_history, cacheInfo);
   }
-  rxStatus = getOWMairpollution(client, owm_air_pollution);
-  if (rxStatus != HTTP_CODE_OK)
+  else
   {
-    killWiFi();
-    statusStr = "Air Pollution API";
-    tmpStr = String(rxStatus, DEC) + ": " + getHttpResponsePhrase(rxStatus);
-    initDisplay();
-    do
+    time_t fetched = 0;
+    if (loadWeatherCache(owm_onecall, aqi_history, cacheInfo))
     {
-      drawError(wi_cloud_down_196x196, statusStr, tmpStr);
-    } while (display.nextPage());
-    powerOffDisplay();
-    beginDeepSleep(startTime, &timeInfo);
+      fetched = cacheInfo.fetched;
+    }
+
+    // the RTC keeps time through deep sleep, so even without SNTP the clock is
+    // usually right
+    setenv("TZ", TIMEZONE, 1);
+    tzset();
+    time_t now = std::max(time(nullptr), fetched);
+    if (fetched == 0 || !shiftWeatherToNow(owm_onecall, now))
+    {
+      if (initDisplay())
+      {
+        do
+        {
+          drawError(errBitmap, errMsgLn1, errMsgLn2);
+        } while (display->nextPage());
+        powerOffDisplay();
+        setPanelContents(APP_ID, 0);
+      }
+      beginDeepSleep(startTime, &timeInfo);
+    }
+
+    LOG_WARN("%s", TXT_USING_CACHED_WEATHER);
+    localtime_r(&now, &timeInfo);
+    localtime_r(&fetched, &fetchedInfo);
+    timeConfigured = true;
   }
-  killWiFi(); // WiFi no longer needed
 
   // GET INDOOR TEMPERATURE AND HUMIDITY, start BMEx80...
   pinMode(PIN_BME_PWR, OUTPUT);
@@ -327,14 +417,14 @@ void setup()
   float inTemp     = NAN;
   float inHumidity = NAN;
 #if defined(SENSOR_BME280)
-  Serial.print(String(TXT_READING_FROM) + " BME280... ");
+  const char *bmeName = "BME280";
   Adafruit_BME280 bme;
 
   if(bme.begin(BME_ADDRESS, &I2C_bme))
   {
 #endif
 #if defined(SENSOR_BME680)
-  Serial.print(String(TXT_READING_FROM) + " BME680... ");
+  const char *bmeName = "BME680";
   Adafruit_BME680 bme(&I2C_bme);
 
   if(bme.begin(BME_ADDRESS))
@@ -350,40 +440,102 @@ void setup()
     if (std::isnan(inTemp) || std::isnan(inHumidity))
     {
       statusStr = "BME " + String(TXT_READ_FAILED);
-      Serial.println(statusStr);
+      LOG_WARN("%s %s... %s", TXT_READING_FROM, bmeName, statusStr.c_str());
     }
     else
     {
-      Serial.println(TXT_SUCCESS);
+      LOG_INFO("%s %s... %s", TXT_READING_FROM, bmeName, TXT_SUCCESS);
     }
   }
   else
   {
     statusStr = "BME " + String(TXT_NOT_FOUND); // check wiring
-    Serial.println(statusStr);
+    LOG_WARN("%s %s... %s", TXT_READING_FROM, bmeName, statusStr.c_str());
   }
   digitalWrite(PIN_BME_PWR, LOW);
 
+  if (errBitmap)
+  { // drawing cached weather, warn that it may be out of date
+    statusStr = statusStr.isEmpty() ? String(TXT_OFFLINE)
+                                    : String(TXT_OFFLINE) + ", " + statusStr;
+  }
+
   String refreshTimeStr;
-  getRefreshTimeStr(refreshTimeStr, timeConfigured, &timeInfo);
+  getRefreshTimeStr(refreshTimeStr, timeConfigured, &fetchedInfo);
   String dateStr;
   getDateStr(dateStr, &timeInfo);
 
-  // RENDER FULL REFRESH
-  initDisplay();
-  do
+  // RENDER
+  // Skipped if it would draw what is already on the panel. The refresh time in
+  // the status bar then shows when the display last changed. Otherwise only the
+  // regions that changed are refreshed when the panel supports it, with a full
+  // refresh every PARTIAL_REFRESH_LIMIT refreshes to clear ghosting.
+  buildWeatherView(weather_view, owm_onecall, aqi_history,
+                   inTemp, inHumidity, timeInfo);
+  uint32_t signature = getRenderSignature(weather_view, owm_onecall, dateStr,
+                                          statusStr, wifiRSSI, batteryVoltage);
+  if (panelShows(APP_ID, signature))
   {
-    drawCurrentConditions(owm_onecall.current, owm_onecall.daily[0],
-                          owm_air_pollution, inTemp, inHumidity);
-    drawOutlookGraph(owm_onecall.hourly, owm_onecall.daily, timeInfo);
-    drawForecast(owm_onecall.daily, timeInfo);
-    drawLocationDate(CITY_STRING, dateStr);
-#if DISPLAY_ALERTS
-    drawAlerts(owm_onecall.alerts, CITY_STRING, dateStr);
+#if DEBUG_LEVEL >= 1
+    LOG_INFO("[debug] display unchanged, skipping refresh");
 #endif
-    drawStatusBar(statusStr, refreshTimeStr, wifiRSSI, batteryVoltage);
-  } while (display.nextPage());
-  powerOffDisplay();
+  }
+  else
+  {
+    bool drawn = true;
+    unsigned long renderStart = micros();
+    setScreenState(screen, weather_view, owm_onecall, dateStr, statusStr,
+                   refreshTimeStr, wifiRSSI, batteryVoltage, signature);
+    screen_rect_t windows[NUM_SCREEN_REGIONS];
+    int numWindows = 0;
+    if (loadScreenState(last_screen)
+     && (numWindows = planPartialRefresh(last_screen, screen,
+                                         panelSignature(APP_ID), windows)) > 0
+     && initDisplayPartial())
+    {
+      // the controller lost the old image while it was off. Load what is on
+      // the panel as the image to refresh from, the new screen as the one to
+      // refresh to, then refresh each changed region once.
+      drawWeatherScreen(last_screen);
+      for (int i = 0; i < numWindows; ++i)
+      {
+        writeDisplayWindow(windows[i].x, windows[i].y,
+                           windows[i].w, windows[i].h, true);
+      }
+      clearDisplayCanvas();
+      drawWeatherScreen(screen);
+      for (int i = 0; i < numWindows; ++i)
+      {
+        writeDisplayWindow(windows[i].x, windows[i].y,
+                           windows[i].w, windows[i].h, false);
+      }
+      for (int i = 0; i < numWindows; ++i)
+      {
+        refreshDisplayWindow(windows[i].x, windows[i].y,
+                             windows[i].w, windows[i].h);
+      }
+      screen.info.partial_refreshes = last_screen.info.partial_refreshes + 1;
+    }
+    else if (initDisplay())
+    {
+      do
+      {
+        drawWeatherScreen(screen);
+      } while (display->nextPage());
+      screen.info.partial_refreshes = 0;
+    }
+    else
+    { // nothing to draw with, the panel keeps what it showed
+      drawn = false;
+    }
+    if (drawn)
+    {
+      powerOffDisplay();
+      setPanelContents(APP_ID, signature);
+      saveScreenState(screen);
+      recordTiming("render", micros() - renderStart);
+    }
+  }
 
   //make sure we the next boot is the selector app
   resetBootPartition();
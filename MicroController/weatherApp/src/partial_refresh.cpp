@@ -0,0 +1,247 @@
+/* Partial refresh for esp32-weather-epd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstddef>
+#include <cstring>
+#include <Arduino.h>
+#include <Preferences.h>
+#include <esp_ota_ops.h>
+#include <rom/crc.h>
+#include <Logger.h>
+
+#include "config.h"
+#include "partial_refresh.h"
+#include "renderer.h"
+
+// NVS keys, at most 15 characters
+#define KEY_SCREEN_INFO "wxScrInfo"
+
+// Where each region is drawn. Regions may overlap, everything that falls in
+// the refreshed window is drawn again.
+static const screen_rect_t REGION_RECTS[NUM_SCREEN_REGIONS] = {
+#ifndef DISP_BW_V1
+  {  0,   0, 392, DISP_HEIGHT},                    // REGION_CURRENT
+#else
+  {  0,   0, 320, DISP_HEIGHT},                    // REGION_CURRENT
+#endif
+  {296, 176, DISP_WIDTH - 296, DISP_HEIGHT - 196}, // REGION_OUTLOOK
+#ifndef DISP_BW_V1
+  {392,  56, DISP_WIDTH - 392, 144},               // REGION_FORECAST
+#else
+  {312,  56, DISP_WIDTH - 312, 144},               // REGION_FORECAST
+#endif
+  {192,   0, DISP_WIDTH - 192, 64},                // REGION_HEADER
+  {  0, DISP_HEIGHT - 24, DISP_WIDTH, 24},         // REGION_STATUS_BAR
+};
+
+// Where the part of the state each region other than the status bar is drawn
+// from is kept, so a refresh only writes the parts that changed. The status
+// bar is drawn from the info, which is written every time.
+typedef struct region_part
+{
+  const char *key;
+  size_t      offset;
+  size_t      size;
+} region_part_t;
+
+static const region_part_t REGION_PARTS[REGION_STATUS_BAR] = {
+  {"wxScrCurrent",  offsetof(screen_state_t, view.current),
+                    sizeof(current_view_t)},                // REGION_CURRENT
+  {"wxScrOutlook",  offsetof(screen_state_t, view.outlook),
+                    sizeof(outlook_view_t)},                // REGION_OUTLOOK
+  {"wxScrForecast", offsetof(screen_state_t, view.forecast),
+                    sizeof(forecast_view_t)},               // REGION_FORECAST
+  {"wxScrHeader",   offsetof(screen_state_t, header),
+                    sizeof(screen_header_t)},               // REGION_HEADER
+};
+
+/* Returns the part of s that region i is drawn from.
+ */
+static uint8_t *partOf(screen_state_t &s, int i)
+{
+  return reinterpret_cast<uint8_t *>(&s) + REGION_PARTS[i].offset;
+} // end partOf
+
+static const uint8_t *partOf(const screen_state_t &s, int i)
+{
+  return reinterpret_cast<const uint8_t *>(&s) + REGION_PARTS[i].offset;
+} // end partOf
+
+/* Fills in the state of a refresh that draws the given inputs. Unused bytes
+ * are zeroed, so states can be compared byte for byte.
+ */
+void setScreenState(screen_state_t &s, const weather_view_t &view,
+                    const owm_resp_onecall_t &onecall, const String &dateStr,
+                    const String &statusStr, const String &refreshTimeStr,
+                    int rssi, uint32_t batVoltage, uint32_t signature)
+{
+  memset(&s, 0, sizeof(s));
+  esp_ota_get_app_elf_sha256(s.info.firmware, sizeof(s.info.firmware));
+  s.info.signature = signature;
+  s.view = view;
+#if DISPLAY_ALERTS
+  s.header.num_alerts = onecall.num_alerts;
+  memcpy(s.header.alerts, onecall.alerts,
+         s.header.num_alerts * sizeof(s.header.alerts[0]));
+#endif
+  strncpy(s.header.date, dateStr.c_str(), sizeof(s.header.date) - 1);
+  strncpy(s.info.status, statusStr.c_str(), sizeof(s.info.status) - 1);
+  strncpy(s.info.refresh_time, refreshTimeStr.c_str(),
+          sizeof(s.info.refresh_time) - 1);
+  s.info.rssi = rssi;
+  s.info.bat_voltage = batVoltage;
+  for (int i = 0; i < REGION_STATUS_BAR; ++i)
+  {
+    s.info.crc[i] = crc32_le(0, partOf(s, i), REGION_PARTS[i].size);
+  }
+  return;
+} // end setScreenState
+
+/* Loads the state saved by saveScreenState.
+ *
+ * Returns false if there is none, it was only partly written, or it was
+ * written by other firmware. Its view points into that firmware's icons and
+ * strings.
+ */
+bool loadScreenState(screen_state_t &s)
+{
+  Preferences prefs;
+  if (!prefs.begin(NVS_NAMESPACE, true))
+  {
+    return false;
+  }
+  bool ok = prefs.getBytesLength(KEY_SCREEN_INFO) == sizeof(s.info)
+         && prefs.getBytes(KEY_SCREEN_INFO, &s.info, sizeof(s.info))
+            == sizeof(s.info);
+  for (int i = 0; ok && i < REGION_STATUS_BAR; ++i)
+  {
+    const region_part_t &part = REGION_PARTS[i];
+    ok = prefs.getBytesLength(part.key) == part.size
+      && prefs.getBytes(part.key, partOf(s, i), part.size) == part.size
+      && crc32_le(0, partOf(s, i), part.size) == s.info.crc[i];
+  }
+  prefs.end();
+
+  char firmware[sizeof(s.info.firmware)] = {};
+  esp_ota_get_app_elf_sha256(firmware, sizeof(firmware));
+  return ok && strcmp(s.info.firmware, firmware) == 0;
+} // end loadScreenState
+
+/* Saves the state of the refresh that was just drawn.
+ *
+ * Only the parts whose CRC differs from the saved state are written, in a
+ * typical refresh that is the info and one or two regions, and nothing at all
+ * if the info is unchanged. When a region is written the info is cleared
+ * first and written last, so a state that was only partly written when power
+ * was lost is never loaded.
+ *
+ * Returns true if it was written.
+ */
+bool saveScreenState(const screen_state_t &s)
+{
+  Preferences prefs;
+  if (!prefs.begin(NVS_NAMESPACE, false))
+  {
+    return false;
+  }
+
+  screen_info_t saved = {};
+  bool haveSaved = prefs.getBytes(KEY_SCREEN_INFO, &saved, sizeof(saved))
+                   == sizeof(saved);
+  // setScreenState zeroes the padding, so the info compares bytewise
+  if (haveSaved && memcmp(&saved, &s.info, sizeof(saved)) == 0)
+  {
+    prefs.end();
+    return true;
+  }
+
+  bool regionChanged = !haveSaved;
+  for (int i = 0; !regionChanged && i < REGION_STATUS_BAR; ++i)
+  {
+    regionChanged = s.info.crc[i] != saved.crc[i];
+  }
+  if (regionChanged)
+  {
+    prefs.remove(KEY_SCREEN_INFO);
+  }
+  bool ok = true;
+  for (int i = 0; ok && i < REGION_STATUS_BAR; ++i)
+  {
+    const region_part_t &part = REGION_PARTS[i];
+    if (!haveSaved || s.info.crc[i] != saved.crc[i])
+    {
+      ok = prefs.putBytes(part.key, partOf(s, i), part.size) == part.size;
+#if DEBUG_LEVEL >= 1
+      LOG_INFO("[debug] screen state saved: %s", part.key);
+#endif
+    }
+  }
+  ok = ok && prefs.putBytes(KEY_SCREEN_INFO, &s.info, sizeof(s.info))
+             == sizeof(s.info);
+  prefs.end();
+  return ok;
+} // end saveScreenState
+
+/* Decides whether going from last to next can be a partial refresh, and if so
+ * which windows of the screen to refresh, one for each region that changed.
+ * They are refreshed one at a time rather than as the window covering all of
+ * them, which would be most of the screen: the status bar is as wide as it and
+ * always changes, it shows the refresh time.
+ *
+ * last must be what is on the panel, so its signature has to match the one
+ * stored with the panel contents.
+ *
+ * Returns the number of windows, or 0 if a full refresh is needed.
+ */
+int planPartialRefresh(const screen_state_t &last, const screen_state_t &next,
+                       uint32_t panelSignature,
+                       screen_rect_t windows[NUM_SCREEN_REGIONS])
+{
+  if (PARTIAL_REFRESH_LIMIT <= 0
+   || last.info.signature == 0 || last.info.signature != panelSignature
+   || last.info.partial_refreshes >= PARTIAL_REFRESH_LIMIT)
+  {
+    return 0;
+  }
+
+  bool changed[NUM_SCREEN_REGIONS];
+  for (int i = 0; i < REGION_STATUS_BAR; ++i)
+  {
+    changed[i] = memcmp(partOf(last, i), partOf(next, i),
+                        REGION_PARTS[i].size) != 0;
+  }
+  changed[REGION_STATUS_BAR] = true;
+
+  int numWindows = 0;
+  for (int i = 0; i < NUM_SCREEN_REGIONS; ++i)
+  {
+    if (changed[i])
+    {
+      windows[numWindows++] = REGION_RECTS[i];
+    }
+  }
+
+#if DEBUG_LEVEL >= 1
+  char changedStr[2 * NUM_SCREEN_REGIONS + 1] = {};
+  for (int i = 0; i < NUM_SCREEN_REGIONS; ++i)
+  {
+    changedStr[2 * i] = changed[i] ? '1' : '0';
+    changedStr[2 * i + 1] = ' ';
+  }
+  LOG_INFO("[debug] changed regions  : [ %s]", changedStr);
+#endif
+  return numWindows;
+} // end planPartialRefresh
@@ -15,6 +15,11 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <new>
+#include <esp_heap_caps.h>
+#include <Logger.h>
+#include <TimingProbe.h>
+
 #include "_locale.h"
 #include "_strftime.h"
 #include "renderer.h"
@@ -22,87 +27,135 @@
 #include "config.h"
 #include "conversions.h"
 #include "display_utils.h"
+#include "text_layout.h"
 
-// fonts
-#include FONT_HEADER
+// fonts, the sizes of FONT_HEADER that are used
+#include "font_subset.h"
 
-// icon header files
-#include "icons/icons_16x16.h"
-#include "icons/icons_24x24.h"
-#include "icons/icons_32x32.h"
-#include "icons/icons_48x48.h"
-#include "icons/icons_64x64.h"
-#include "icons/icons_96x96.h"
-#include "icons/icons_128x128.h"
-#include "icons/icons_160x160.h"
-#include "icons/icons_196x196.h"
+// icons
+#include "icon_atlas.h"
+#include "icon_decode.h"
+#include "wind_arrow.h"
 
 #ifdef DISP_BW_V2
-  GxEPD2_BW<GxEPD2_750_GDEY075T7,
-    GxEPD2_750_GDEY075T7::HEIGHT / 2> display(
-              GxEPD2_750_GDEY075T7(PIN_EPD_CS,
-                  PIN_EPD_DC,
-                  PIN_EPD_RST,
-                  PIN_EPD_BUSY));
+  #define DISPLAY_EPD GxEPD2_750_GDEY075T7
 #endif
 #ifdef DISP_3C_B
-  GxEPD2_3C<GxEPD2_750c_Z08,
-            GxEPD2_750c_Z08::HEIGHT / 2> display(
-    GxEPD2_750c_Z08(PIN_EPD_CS,
-                    PIN_EPD_DC,
-                    PIN_EPD_RST,
-                    PIN_EPD_BUSY));
+  #define DISPLAY_EPD GxEPD2_750c_Z08
 #endif
 #ifdef DISP_7C_F
-  GxEPD2_7C<GxEPD2_730c_GDEY073D46,
-            GxEPD2_730c_GDEY073D46::HEIGHT / 4> display(
-    GxEPD2_730c_GDEY073D46(PIN_EPD_CS,
-                           PIN_EPD_DC,
-                           PIN_EPD_RST,
-                           PIN_EPD_BUSY));
+  #define DISPLAY_EPD GxEPD2_730c_GDEY073D46
 #endif
 #ifdef DISP_BW_V1
-  GxEPD2_BW<GxEPD2_750,
-            GxEPD2_750::HEIGHT> display(
-    GxEPD2_750(PIN_EPD_CS,
-               PIN_EPD_DC,
-               PIN_EPD_RST,
-               PIN_EPD_BUSY));
+  #define DISPLAY_EPD GxEPD2_750
+#endif
+
+#ifdef FULL_FRAME_BUFFER
+/* The display object holds the page buffer, and a full frame (48 KB for black
+ * and white, up to 192 KB for 7-color) is too big to keep in internal RAM
+ * alongside WiFi. The stock core ignores EXT_RAM_ATTR on globals, so the
+ * object is constructed in PSRAM from the heap instead, the first time the
+ * display is initialized. config.h requires a board with PSRAM.
+ *
+ * Returns false, after logging it, if PSRAM has no room for it.
+ */
+display_t *display = NULL;
+
+static bool newDisplay()
+{
+  if (display != NULL)
+  {
+    return true;
+  }
+  void *mem = heap_caps_malloc(sizeof(display_t),
+                               MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (mem == NULL)
+  {
+    LOG_ERROR("Renderer: No PSRAM for the %u B frame buffer",
+              (unsigned)sizeof(display_t));
+    return false;
+  }
+  display = new (mem) display_t(DISPLAY_EPD(PIN_EPD_CS,
+                                            PIN_EPD_DC,
+                                            PIN_EPD_RST,
+                                            PIN_EPD_BUSY));
+  return true;
+} // end newDisplay
+#else
+static display_t pagedDisplay(DISPLAY_EPD(PIN_EPD_CS,
+                                          PIN_EPD_DC,
+                                          PIN_EPD_RST,
+                                          PIN_EPD_BUSY));
+display_t *display = &pagedDisplay;
+
+static bool newDisplay()
+{
+  return true;
+} // end newDisplay
 #endif
 
 #ifndef ACCENT_COLOR
   #define ACCENT_COLOR GxEPD_BLACK
 #endif
 
+// What the draw functions draw on: the display's page buffer, or during a
+// partial refresh a canvas of the whole screen, see initDisplayPartial.
+static Adafruit_GFX *gfx = NULL;
+static GFXcanvas1 *canvas = NULL;
+
+// font set by setFont, needed to measure text
+static const GFXfont *currentFont = nullptr;
+
+/* Sets the font for text drawn on the display. Use this rather than
+ * the display's setFont, so text can be measured in the same font.
+ */
+void setFont(const GFXfont *font)
+{
+  gfx->setFont(font);
+  currentFont = font;
+  return;
+} // end setFont
+
+/* Returns the bounds of the first len bytes of text followed by suffix, in
+ * the current font.
+ */
+static text_bounds_t getTextBounds(const char *text, size_t len,
+                                   const char *suffix = "")
+{
+  if (currentFont != nullptr)
+  {
+    return measureText(currentFont, text, len, suffix);
+  }
+
+  // the built-in font isn't laid out by measureText
+  String str = String(text).substring(0, len) + suffix;
+  text_bounds_t bounds;
+  gfx->getTextBounds(str, 0, 0, &bounds.x1, &bounds.y1,
+                        &bounds.w, &bounds.h);
+  return bounds;
+} // end getTextBounds
+
 /* Returns the string width in pixels
  */
 uint16_t getStringWidth(const String &text)
 {
-  int16_t x1, y1;
-  uint16_t w, h;
-  display.getTextBounds(text, 0, 0, &x1, &y1, &w, &h);
-  return w;
+  return getTextBounds(text.c_str(), text.length()).w;
 }
 
 /* Returns the string height in pixels
  */
 uint16_t getStringHeight(const String &text)
 {
-  int16_t x1, y1;
-  uint16_t w, h;
-  display.getTextBounds(text, 0, 0, &x1, &y1, &w, &h);
-  return h;
+  return getTextBounds(text.c_str(), text.length()).h;
 }
 
-/* Draws a string with alignment
+/* Draws the first len bytes of text followed by suffix with alignment.
  */
-void drawString(int16_t x, int16_t y, const String &text, alignment_t alignment,
-                uint16_t color)
+static void drawText(int16_t x, int16_t y, const char *text, size_t len,
+                     const char *suffix, alignment_t alignment, uint16_t color)
 {
-  int16_t x1, y1;
-  uint16_t w, h;
-  display.setTextColor(color);
-  display.getTextBounds(text, x, y, &x1, &y1, &w, &h);
+  uint16_t w = getTextBounds(text, len, suffix).w;
+  gfx->setTextColor(color);
   if (alignment == RIGHT)
   {
     x = x - w;
@@ -111,11 +164,68 @@ void drawString(int16_t x, int16_t y, const String &text, alignment_t alignment,
   {
     x = x - w / 2;
   }
-  display.setCursor(x, y);
-  display.print(text);
+  gfx->setCursor(x, y);
+  gfx->write(reinterpret_cast<const uint8_t *>(text), len);
+  gfx->print(suffix);
+  return;
+} // end drawText
+
+/* Draws a string with alignment
+ */
+void drawString(int16_t x, int16_t y, const String &text, alignment_t alignment,
+                uint16_t color)
+{
+  drawText(x, y, text.c_str(), text.length(), "", alignment, color);
   return;
 } // end drawString
 
+/* Draws a packed icon from icon_atlas with its top left corner at x, y. The
+ * icon is decoded as it is drawn, one run of ink at a time, so background
+ * pixels cost nothing.
+ */
+void drawIcon(int16_t x, int16_t y, const uint8_t *icon, uint16_t color)
+{
+  icon_decoder_t d;
+  icon_span_t span;
+  beginIcon(d, icon);
+  gfx->startWrite();
+  while (nextIconSpan(d, span))
+  {
+    gfx->writeFastHLine(x + span.x, y + span.y, span.w, color);
+  }
+  gfx->endWrite();
+  return;
+} // end drawIcon
+
+/* Draws a size x size wind direction arrow with its top left corner at x, y.
+ * windDeg is the meteorological wind direction, the arrow points in the
+ * direction the wind is going.
+ */
+void drawWindArrow(int16_t x, int16_t y, int16_t size, int windDeg,
+                   uint16_t color)
+{
+  wind_arrow_t a;
+  icon_span_t span;
+  beginWindArrow(a, size, windDeg);
+  gfx->startWrite();
+  while (nextWindArrowSpan(a, span))
+  {
+    gfx->writeFastHLine(x + span.x, y + span.y, span.w, color);
+  }
+  gfx->endWrite();
+  return;
+} // end drawWindArrow
+
+/* Returns the index of the last c in the first len bytes of text, or -1.
+ */
+static int lastIndexOf(const char *text, int len, char c)
+{
+  while (--len >= 0 && text[len] != c)
+  {
+  }
+  return len;
+} // end lastIndexOf
+
 /* Draws a string that will flow into the next line when max_width is reached.
  * If a string exceeds max_lines an ellipsis (...) will terminate the last word.
  * Lines will break at spaces(' ') and dashes('-').
@@ -124,6 +234,9 @@ void drawString(int16_t x, int16_t y, const String &text, alignment_t alignment,
  *       will be displayed. If an unbroken string of characters longer than
  *       max_width exist in text, then the string will be printed beyond
  *       max_width.
+ *
+ * Lines are found by measuring prefixes of the text in place, nothing is
+ * copied.
  */
 void drawMultiLnString(int16_t x, int16_t y, const String &text,
                        alignment_t alignment, uint16_t max_width,
@@ -131,18 +244,18 @@ void drawMultiLnString(int16_t x, int16_t y, const String &text,
                        uint16_t color)
 {
   uint16_t current_line = 0;
-  String textRemaining = text;
+  const char *textRemaining = text.c_str();
+  int remainingLen = text.length();
   // print until we reach max_lines or no more text remains
-  while (current_line < max_lines && !textRemaining.isEmpty())
+  while (current_line < max_lines && remainingLen > 0)
   {
-    int16_t  x1, y1;
-    uint16_t w, h;
-
-    display.getTextBounds(textRemaining, 0, 0, &x1, &y1, &w, &h);
+    uint16_t w = getTextBounds(textRemaining, remainingLen).w;
 
-    int endIndex = textRemaining.length();
-    // check if remaining text is to wide, if it is then print what we can
-    String subStr = textRemaining;
+    int endIndex = remainingLen;
+    // check if remaining text is to wide, if it is then print what we can.
+    // The line is the first lineLen bytes of textRemaining.
+    int lineLen = remainingLen;
+    const char *ellipsis = "";
     int splitAt = 0;
     int keepLastChar = 0;
     while (w > max_width && splitAt != -1)
@@ -151,19 +264,19 @@ void drawMultiLnString(int16_t x, int16_t y, const String &text,
       {
         // if we kept the last character during the last iteration of this while
         // loop, remove it now so we don't get stuck in an infinite loop.
-        subStr.remove(subStr.length() - 1);
+        --lineLen;
       }
 
       // find the last place in the string that we can break it.
       if (current_line < max_lines - 1)
       {
-        splitAt = std::max(subStr.lastIndexOf(" "),
-                           subStr.lastIndexOf("-"));
+        splitAt = std::max(lastIndexOf(textRemaining, lineLen, ' '),
+                           lastIndexOf(textRemaining, lineLen, '-'));
       }
       else
       {
         // this is the last line, only break at spaces so we can add ellipsis
-        splitAt = subStr.lastIndexOf(" ");
+        splitAt = lastIndexOf(textRemaining, lineLen, ' ');
       }
 
       // if splitAt == -1 then there is an unbroken set of characters that is
@@ -172,14 +285,14 @@ void drawMultiLnString(int16_t x, int16_t y, const String &text,
       if (splitAt != -1)
       {
         endIndex = splitAt;
-        subStr = subStr.substring(0, endIndex + 1);
+        lineLen = endIndex + 1;
 
-        char lastChar = subStr.charAt(endIndex);
+        char lastChar = textRemaining[endIndex];
         if (lastChar == ' ')
         {
           // remove this char now so it is not counted towards line width
           keepLastChar = 0;
-          subStr.remove(endIndex);
+          lineLen = endIndex;
           --endIndex;
         }
         else if (lastChar == '-')
@@ -191,28 +304,31 @@ void drawMultiLnString(int16_t x, int16_t y, const String &text,
         if (current_line < max_lines - 1)
         {
           // this is not the last line
-          display.getTextBounds(subStr, 0, 0, &x1, &y1, &w, &h);
+          w = getTextBounds(textRemaining, lineLen).w;
         }
         else
         {
           // this is the last line, we need to make sure there is space for
           // ellipsis
-          display.getTextBounds(subStr + "...", 0, 0, &x1, &y1, &w, &h);
+          w = getTextBounds(textRemaining, lineLen, "...").w;
           if (w <= max_width)
           {
-            // ellipsis fit, add them to subStr
-            subStr = subStr + "...";
+            // ellipsis fit, add them to the line
+            ellipsis = "...";
           }
         }
 
       } // end if (splitAt != -1)
     } // end inner while
 
-    drawString(x, y + (current_line * line_spacing), subStr, alignment, color);
+    drawText(x, y + (current_line * line_spacing), textRemaining, lineLen,
+             ellipsis, alignment, color);
 
     // update textRemaining to no longer include what was printed
     // +1 for exclusive bounds, +1 to get passed space/dash
-    textRemaining = textRemaining.substring(endIndex + 2 - keepLastChar);
+    int printed = std::min(endIndex + 2 - keepLastChar, remainingLen);
+    textRemaining += printed;
+    remainingLen -= printed;
 
     ++current_line;
   } // end outer while
@@ -220,36 +336,141 @@ void drawMultiLnString(int16_t x, int16_t y, const String &text,
   return;
 } // end drawMultiLnString
 
-/* Initialize e-paper display
+/* Powers up the display and sets the text defaults. initial selects a full
+ * first refresh; pass false to keep the panel's image for partial refreshes.
  */
-void initDisplay()
+static void beginDisplay(bool initial)
 {
   pinMode(PIN_EPD_PWR, OUTPUT);
   digitalWrite(PIN_EPD_PWR, HIGH);
 #ifdef DRIVER_WAVESHARE
-  display.init(115200, true, 2, false);
+  display->init(115200, initial, 2, false);
 #endif
 #ifdef DRIVER_DESPI_C02
-  display.init(115200);
+  display->init(115200, initial);
 #endif
   
 
-  display.setRotation(2);//flip it upside down
-  display.setTextSize(1);
-  display.setTextColor(GxEPD_BLACK);
-  display.setTextWrap(false);
-  // display.fillScreen(GxEPD_WHITE);
-  display.setFullWindow();
-  display.firstPage(); // use paged drawing mode, sets fillScreen(GxEPD_WHITE)
+  display->setRotation(2);//flip it upside down
+  display->setTextSize(1);
+  display->setTextColor(GxEPD_BLACK);
+  display->setTextWrap(false);
   return;
+} // end beginDisplay
+
+/* Initialize e-paper display
+ *
+ * Returns false, without powering the display, if there is no memory for it.
+ */
+bool initDisplay()
+{
+  if (!newDisplay())
+  {
+    return false;
+  }
+  beginDisplay(true);
+  // display->fillScreen(GxEPD_WHITE);
+  display->setFullWindow();
+  display->firstPage(); // use paged drawing mode, sets fillScreen(GxEPD_WHITE)
+  gfx = display;
+  return true;
 } // end initDisplay
 
+/* Initialize e-paper display for partial refreshes, leaving the image on the
+ * panel in place. Until powerOffDisplay, drawing goes to a canvas of the whole
+ * screen, which is cleared to white. Its windows are sent to the controller
+ * with writeDisplayWindow and refreshed with refreshDisplayWindow.
+ *
+ * Returns false, without powering the display, if the panel has no fast
+ * partial update or there is no memory for the canvas. Use initDisplay then.
+ */
+bool initDisplayPartial()
+{
+  if (!newDisplay() || !display->epd2.hasFastPartialUpdate)
+  {
+    return false;
+  }
+  canvas = new GFXcanvas1(DISP_WIDTH, DISP_HEIGHT);
+  if (canvas->getBuffer() == NULL)
+  {
+    delete canvas;
+    canvas = NULL;
+    return false;
+  }
+  beginDisplay(false);
+  // same orientation as the display, so the canvas's memory is laid out like
+  // the controller's
+  canvas->setRotation(display->getRotation());
+  canvas->setTextSize(1);
+  canvas->setTextWrap(false);
+  canvas->setFont(currentFont);
+  canvas->fillScreen(GxEPD_WHITE);
+  gfx = canvas;
+  return true;
+} // end initDisplayPartial
+
+/* Clears the canvas of a partial refresh to white.
+ */
+void clearDisplayCanvas()
+{
+  canvas->fillScreen(GxEPD_WHITE);
+  return;
+} // end clearDisplayCanvas
+
+/* Converts a window of the screen to the controller's coordinates, which are
+ * rotated 180 degrees. x and w are multiples of 8, so the window still starts
+ * on a byte.
+ */
+static void toPanelWindow(int16_t &x, int16_t &y, int16_t w, int16_t h)
+{
+  x = DISP_WIDTH - x - w;
+  y = DISP_HEIGHT - y - h;
+  return;
+} // end toPanelWindow
+
+/* Sends a window of the canvas to the controller, without refreshing. With
+ * previous set it becomes the image the next refresh starts from, otherwise
+ * the image it ends on.
+ */
+void writeDisplayWindow(int16_t x, int16_t y, int16_t w, int16_t h,
+                        bool previous)
+{
+  toPanelWindow(x, y, w, h);
+  if (previous)
+  {
+    display->epd2.writeImagePartAgain(canvas->getBuffer(), x, y,
+                                     DISP_WIDTH, DISP_HEIGHT, x, y, w, h);
+  }
+  else
+  {
+    display->epd2.writeImagePart(canvas->getBuffer(), x, y,
+                                DISP_WIDTH, DISP_HEIGHT, x, y, w, h);
+  }
+  return;
+} // end writeDisplayWindow
+
+/* Refreshes a window of the panel from the previous image to the current one,
+ * then makes the canvas the previous image there, so a window that overlaps
+ * this one doesn't drive the same pixels again.
+ */
+void refreshDisplayWindow(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+  int16_t panelX = x, panelY = y;
+  toPanelWindow(panelX, panelY, w, h);
+  display->epd2.refresh(panelX, panelY, w, h);
+  writeDisplayWindow(x, y, w, h, true);
+  return;
+} // end refreshDisplayWindow
+
 /* Power-off e-paper display
  */
 void powerOffDisplay()
 {
-  display.hibernate(); // turns powerOff() and sets controller to deep sleep for
+  display->hibernate(); // turns powerOff() and sets controller to deep sleep for
                        // minimum power use
+  delete canvas;
+  canvas = NULL;
+  gfx = display;
   digitalWrite(PIN_EPD_PWR, LOW);
   return;
 } // end initDisplay
@@ -257,111 +478,57 @@ void powerOffDisplay()
 /* This function is responsible for drawing the current conditions and
  * associated icons.
  */
-void drawCurrentConditions(const owm_current_t &current,
-                           const owm_daily_t &today,
-                           const owm_resp_air_pollution_t &owm_air_pollution,
-                           float inTemp, float inHumidity)
+void drawCurrentConditions(const current_view_t &view)
 {
-  String dataStr, unitStr;
+  TimingProbe probe("drawCurrentConditions");
   // current weather icon
-  display.drawInvertedBitmap(0, 0,
-                             getCurrentConditionsBitmap196(current, today),
-                             196, 196, GxEPD_BLACK);
+  drawIcon(0, 0, view.icon, GxEPD_BLACK);
 
   // current temp
-#ifdef UNITS_TEMP_KELVIN
-  dataStr = String(static_cast<int>(std::round(current.temp)));
-  unitStr = TXT_UNITS_TEMP_KELVIN;
-#endif
-#ifdef UNITS_TEMP_CELSIUS
-  dataStr = String(static_cast<int>(
-            std::round(kelvin_to_celsius(current.temp))));
-  unitStr = TXT_UNITS_TEMP_CELSIUS;
-#endif
-#ifdef UNITS_TEMP_FAHRENHEIT
-  dataStr = String(static_cast<int>(
-            std::round(kelvin_to_fahrenheit(current.temp))));
-  unitStr = TXT_UNITS_TEMP_FAHRENHEIT;
-#endif
   // FONT_**_temperature fonts only have the character set used for displaying
   // temperature (0123456789.-\260)
-  display.setFont(&FONT_48pt8b_temperature);
+  setFont(&FONT_48pt8b_temperature);
 #ifndef DISP_BW_V1
-    drawString(196 + 164 / 2 - 20, 196 / 2 + 69 / 2, dataStr, CENTER);
+    drawString(196 + 164 / 2 - 20, 196 / 2 + 69 / 2, view.temp, CENTER);
 #elif defined(DISP_BW_V1)
-    drawString(156 + 164 / 2 - 20, 196 / 2 + 69 / 2, dataStr, CENTER);
+    drawString(156 + 164 / 2 - 20, 196 / 2 + 69 / 2, view.temp, CENTER);
 #endif
-  display.setFont(&FONT_14pt8b);
-  drawString(display.getCursorX(), 196 / 2 - 69 / 2 + 20, unitStr, LEFT);
+  setFont(&FONT_14pt8b);
+  drawString(gfx->getCursorX(), 196 / 2 - 69 / 2 + 20, view.tempUnit, LEFT);
 
   // current feels like
-#ifdef UNITS_TEMP_KELVIN
-  dataStr = String(TXT_FEELS_LIKE) + ' '
-            + String(static_cast<int>(std::round(current.feels_like)));
-#endif
-#ifdef UNITS_TEMP_CELSIUS
-  dataStr = String(TXT_FEELS_LIKE) + ' '
-            + String(static_cast<int>(std::round(
-                     kelvin_to_celsius(current.feels_like))))
-            + '\260';
-#endif
-#ifdef UNITS_TEMP_FAHRENHEIT
-  dataStr = String(TXT_FEELS_LIKE) + ' '
-            + String(static_cast<int>(std::round(
-                     kelvin_to_fahrenheit(current.feels_like))))
-            + '\260';
-#endif
-  display.setFont(&FONT_12pt8b);
+  setFont(&FONT_12pt8b);
 #ifndef DISP_BW_V1
-  drawString(196 + 164 / 2, 98 + 69 / 2 + 12 + 17, dataStr, CENTER);
+  drawString(196 + 164 / 2, 98 + 69 / 2 + 12 + 17, view.feelsLike, CENTER);
 #elif defined(DISP_BW_V1)
-  drawString(156 + 164 / 2, 98 + 69 / 2 + 12 + 17, dataStr, CENTER);
+  drawString(156 + 164 / 2, 98 + 69 / 2 + 12 + 17, view.feelsLike, CENTER);
 #endif
   // line dividing top and bottom display areas
-  // display.drawLine(0, 196, DISP_WIDTH - 1, 196, GxEPD_BLACK);
+  // display->drawLine(0, 196, DISP_WIDTH - 1, 196, GxEPD_BLACK);
 
   // current weather data icons
-  display.drawInvertedBitmap(0, 204 + (48 + 8) * 0,
-                             wi_sunrise_48x48, 48, 48, GxEPD_BLACK);
-  display.drawInvertedBitmap(0, 204 + (48 + 8) * 1,
-                             wi_strong_wind_48x48, 48, 48, GxEPD_BLACK);
-  display.drawInvertedBitmap(0, 204 + (48 + 8) * 2,
-                             wi_day_sunny_48x48, 48, 48, GxEPD_BLACK);
+  drawIcon(0, 204 + (48 + 8) * 0, wi_sunrise_48x48, GxEPD_BLACK);
+  drawIcon(0, 204 + (48 + 8) * 1, wi_strong_wind_48x48, GxEPD_BLACK);
+  drawIcon(0, 204 + (48 + 8) * 2, wi_day_sunny_48x48, GxEPD_BLACK);
 #ifndef DISP_BW_V1
-  display.drawInvertedBitmap(0, 204 + (48 + 8) * 3,
-                             air_filter_48x48, 48, 48, GxEPD_BLACK);
-  display.drawInvertedBitmap(0, 204 + (48 + 8) * 4,
-                             house_thermometer_48x48, 48, 48, GxEPD_BLACK);
+  drawIcon(0, 204 + (48 + 8) * 3, air_filter_48x48, GxEPD_BLACK);
+  drawIcon(0, 204 + (48 + 8) * 4, house_thermometer_48x48, GxEPD_BLACK);
 #endif
-  display.drawInvertedBitmap(170, 204 + (48 + 8) * 0,
-                             wi_sunset_48x48, 48, 48, GxEPD_BLACK);
-  display.drawInvertedBitmap(170, 204 + (48 + 8) * 1,
-                             wi_humidity_48x48, 48, 48, GxEPD_BLACK);
-  display.drawInvertedBitmap(170, 204 + (48 + 8) * 2,
-                             wi_barometer_48x48, 48, 48, GxEPD_BLACK);
+  drawIcon(170, 204 + (48 + 8) * 0, wi_sunset_48x48, GxEPD_BLACK);
+  drawIcon(170, 204 + (48 + 8) * 1, wi_humidity_48x48, GxEPD_BLACK);
+  drawIcon(170, 204 + (48 + 8) * 2, wi_barometer_48x48, GxEPD_BLACK);
 #ifndef DISP_BW_V1
-  display.drawInvertedBitmap(170, 204 + (48 + 8) * 3,
-                             visibility_icon_48x48, 48, 48, GxEPD_BLACK);
-  display.drawInvertedBitmap(170, 204 + (48 + 8) * 4,
-                             house_humidity_48x48, 48, 48, GxEPD_BLACK);
+  drawIcon(170, 204 + (48 + 8) * 3, visibility_icon_48x48, GxEPD_BLACK);
+  drawIcon(170, 204 + (48 + 8) * 4, house_humidity_48x48, GxEPD_BLACK);
 #endif
 
   // current weather data labels
-  display.setFont(&FONT_7pt8b);
+  setFont(&FONT_7pt8b);
   drawString(48, 204 + 10 + (48 + 8) * 0, TXT_SUNRISE, LEFT);
   drawString(48, 204 + 10 + (48 + 8) * 1, TXT_WIND, LEFT);
   drawString(48, 204 + 10 + (48 + 8) * 2, TXT_UV_INDEX, LEFT);
 #ifndef DISP_BW_V1
-  const char *air_quality_index_label;
-  if (aqi_desc_type(AQI_SCALE) == AIR_QUALITY_DESC)
-  {
-    air_quality_index_label = TXT_AIR_QUALITY;
-  }
-  else // (aqi_desc_type(AQI_SCALE) == AIR_POLLUTION_DESC)
-  {
-    air_quality_index_label = TXT_AIR_POLLUTION;
-  }
-  drawString(48, 204 + 10 + (48 + 8) * 3, air_quality_index_label, LEFT);
+  drawString(48, 204 + 10 + (48 + 8) * 3, view.aqiLabel, LEFT);
   drawString(48, 204 + 10 + (48 + 8) * 4, TXT_INDOOR_TEMPERATURE, LEFT);
 #endif
   drawString(170 + 48, 204 + 10 + (48 + 8) * 0, TXT_SUNSET, LEFT);
@@ -373,103 +540,56 @@ void drawCurrentConditions(const owm_current_t &current,
 #endif
 
   // sunrise
-  display.setFont(&FONT_12pt8b);
-  char timeBuffer[12] = {}; // big enough to accommodate "hh:mm:ss am"
-  time_t ts = current.sunrise;
-  tm *timeInfo = localtime(&ts);
-  _strftime(timeBuffer, sizeof(timeBuffer), TIME_FORMAT, timeInfo);
-  drawString(48, 204 + 17 / 2 + (48 + 8) * 0 + 48 / 2, timeBuffer, LEFT);
+  setFont(&FONT_12pt8b);
+  drawString(48, 204 + 17 / 2 + (48 + 8) * 0 + 48 / 2, view.sunrise, LEFT);
 
   // wind
 #ifdef WIND_INDICATOR_ARROW
-  display.drawInvertedBitmap(48, 204 + 24 / 2 + (48 + 8) * 1,
-                             getWindBitmap24(current.wind_deg),
-                             24, 24, GxEPD_BLACK);
-#endif
-#ifdef UNITS_SPEED_METERSPERSECOND
-  dataStr = String(static_cast<int>(std::round(current.wind_speed)));
-  unitStr = String(" ") + TXT_UNITS_SPEED_METERSPERSECOND;
-#endif
-#ifdef UNITS_SPEED_FEETPERSECOND
-  dataStr = String(static_cast<int>(std::round(
-                   meterspersecond_to_feetpersecond(current.wind_speed) )));
-  unitStr = String(" ") + TXT_UNITS_SPEED_FEETPERSECOND;
-#endif
-#ifdef UNITS_SPEED_KILOMETERSPERHOUR
-  dataStr = String(static_cast<int>(std::round(
-                   meterspersecond_to_kilometersperhour(current.wind_speed) )));
-  unitStr = String(" ") + TXT_UNITS_SPEED_KILOMETERSPERHOUR;
-#endif
-#ifdef UNITS_SPEED_MILESPERHOUR
-  dataStr = String(static_cast<int>(std::round(
-                   meterspersecond_to_milesperhour(current.wind_speed) )));
-  unitStr = String(" ") + TXT_UNITS_SPEED_MILESPERHOUR;
-#endif
-#ifdef UNITS_SPEED_KNOTS
-  dataStr = String(static_cast<int>(std::round(
-                   meterspersecond_to_knots(current.wind_speed) )));
-  unitStr = String(" ") + TXT_UNITS_SPEED_KNOTS;
-#endif
-#ifdef UNITS_SPEED_BEAUFORT
-  dataStr = String(meterspersecond_to_beaufort(current.wind_speed));
-  unitStr = String(" ") + TXT_UNITS_SPEED_BEAUFORT;
-#endif
-
-#ifdef WIND_INDICATOR_ARROW
-  drawString(48 + 24, 204 + 17 / 2 + (48 + 8) * 1 + 48 / 2, dataStr, LEFT);
+  drawWindArrow(48, 204 + 24 / 2 + (48 + 8) * 1, 24, view.windArrowDeg,
+                GxEPD_BLACK);
+  drawString(48 + 24, 204 + 17 / 2 + (48 + 8) * 1 + 48 / 2, view.windSpeed,
+             LEFT);
 #else
-  drawString(48     , 204 + 17 / 2 + (48 + 8) * 1 + 48 / 2, dataStr, LEFT);
-#endif
-  display.setFont(&FONT_8pt8b);
-  drawString(display.getCursorX(), 204 + 17 / 2 + (48 + 8) * 1 + 48 / 2,
-             unitStr, LEFT);
-
-#if defined(WIND_INDICATOR_NUMBER)
-  dataStr = String(current.wind_deg) + "\260";
-  display.setFont(&FONT_12pt8b);
-  drawString(display.getCursorX() + 6, 204 + 17 / 2 + (48 + 8) * 1 + 48 / 2,
-             dataStr, LEFT);
-#endif
-#if defined(WIND_INDICATOR_CPN_CARDINAL)                \
- || defined(WIND_INDICATOR_CPN_INTERCARDINAL)           \
- || defined(WIND_INDICATOR_CPN_SECONDARY_INTERCARDINAL) \
- || defined(WIND_INDICATOR_CPN_TERTIARY_INTERCARDINAL)
-  dataStr = getCompassPointNotation(current.wind_deg);
-  display.setFont(&FONT_12pt8b);
-  drawString(display.getCursorX() + 6, 204 + 17 / 2 + (48 + 8) * 1 + 48 / 2,
-             dataStr, LEFT);
+  drawString(48     , 204 + 17 / 2 + (48 + 8) * 1 + 48 / 2, view.windSpeed,
+             LEFT);
 #endif
+  setFont(&FONT_8pt8b);
+  drawString(gfx->getCursorX(), 204 + 17 / 2 + (48 + 8) * 1 + 48 / 2,
+             view.windUnit, LEFT);
+  if (view.windDir[0] != '\0')
+  {
+    setFont(&FONT_12pt8b);
+    drawString(gfx->getCursorX() + 6, 204 + 17 / 2 + (48 + 8) * 1 + 48 / 2,
+               view.windDir, LEFT);
+  }
 
   // uv and air quality indices
   // spacing between end of index value and start of descriptor text
   const int sp = 8;
 
   // uv index
-  display.setFont(&FONT_12pt8b);
-  unsigned int uvi = static_cast<unsigned int>(
-                                std::max(std::round(current.uvi), 0.0f));
-  dataStr = String(uvi);
-  drawString(48, 204 + 17 / 2 + (48 + 8) * 2 + 48 / 2, dataStr, LEFT);
-  display.setFont(&FONT_7pt8b);
-  dataStr = String(getUVIdesc(uvi));
-  int max_w = 170 - (display.getCursorX() + sp);
+  setFont(&FONT_12pt8b);
+  drawString(48, 204 + 17 / 2 + (48 + 8) * 2 + 48 / 2, view.uvi, LEFT);
+  setFont(&FONT_7pt8b);
+  String dataStr = view.uviDesc;
+  int max_w = 170 - (gfx->getCursorX() + sp);
   if (getStringWidth(dataStr) <= max_w)
   { // Fits on a single line, draw along bottom
-    drawString(display.getCursorX() + sp, 204 + 17 / 2 + (48 + 8) * 2 + 48 / 2,
+    drawString(gfx->getCursorX() + sp, 204 + 17 / 2 + (48 + 8) * 2 + 48 / 2,
                dataStr, LEFT);
   }
   else
   { // use smaller font
-    display.setFont(&FONT_5pt8b);
+    setFont(&FONT_5pt8b);
     if (getStringWidth(dataStr) <= max_w)
     { // Fits on a single line with smaller font, draw along bottom
-      drawString(display.getCursorX() + sp,
+      drawString(gfx->getCursorX() + sp,
                  204 + 17 / 2 + (48 + 8) * 2 + 48 / 2,
                  dataStr, LEFT);
     }
     else
     { // Does not fit on a single line, draw higher to allow room for 2nd line
-      drawMultiLnString(display.getCursorX() + sp,
+      drawMultiLnString(gfx->getCursorX() + sp,
                         204 + 17 / 2 + (48 + 8) * 2 + 48 / 2 - 10,
                         dataStr, LEFT, max_w, 2, 10);
     }
@@ -477,184 +597,71 @@ void drawCurrentConditions(const owm_current_t &current,
 
 #ifndef DISP_BW_V1
   // air quality index
-  display.setFont(&FONT_12pt8b);
-  const owm_components_t &c = owm_air_pollution.components;
-  // OpenWeatherMap does not provide pb (lead) conentrations, so we pass NULL.
-  int aqi = calc_aqi(AQI_SCALE, c.co, c.nh3, c.no, c.no2, c.o3, NULL, c.so2,
-                                c.pm10, c.pm2_5);
-  int aqi_max = aqi_scale_max(AQI_SCALE);
-  if (aqi > aqi_max)
-  {
-    dataStr = "> " + String(aqi_max);
-  }
-  else
-  {
-    dataStr = String(aqi);
-  }
-  drawString(48, 204 + 17 / 2 + (48 + 8) * 3 + 48 / 2, dataStr, LEFT);
-  display.setFont(&FONT_7pt8b);
-  dataStr = String(aqi_desc(AQI_SCALE, aqi));
-  max_w = 170 - (display.getCursorX() + sp);
+  setFont(&FONT_12pt8b);
+  drawString(48, 204 + 17 / 2 + (48 + 8) * 3 + 48 / 2, view.aqi, LEFT);
+  setFont(&FONT_7pt8b);
+  dataStr = view.aqiDesc;
+  max_w = 170 - (gfx->getCursorX() + sp);
   if (getStringWidth(dataStr) <= max_w)
   { // Fits on a single line, draw along bottom
-    drawString(display.getCursorX() + sp, 204 + 17 / 2 + (48 + 8) * 3 + 48 / 2,
+    drawString(gfx->getCursorX() + sp, 204 + 17 / 2 + (48 + 8) * 3 + 48 / 2,
                dataStr, LEFT);
   }
   else
   { // use smaller font
-    display.setFont(&FONT_5pt8b);
+    setFont(&FONT_5pt8b);
     if (getStringWidth(dataStr) <= max_w)
     { // Fits on a single line with smaller font, draw along bottom
-      drawString(display.getCursorX() + sp,
+      drawString(gfx->getCursorX() + sp,
                  204 + 17 / 2 + (48 + 8) * 3 + 48 / 2,
                  dataStr, LEFT);
     }
     else
     { // Does not fit on a single line, draw higher to allow room for 2nd line
-      drawMultiLnString(display.getCursorX() + sp,
+      drawMultiLnString(gfx->getCursorX() + sp,
                         204 + 17 / 2 + (48 + 8) * 3 + 48 / 2 - 10,
                         dataStr, LEFT, max_w, 2, 10);
     }
   }
 
   // indoor temperature
-  display.setFont(&FONT_12pt8b);
-  if (!std::isnan(inTemp))
-  {
-#ifdef UNITS_TEMP_KELVIN
-    dataStr = String(std::round(celsius_to_kelvin(inTemp) * 10) / 10.0f, 1);
-#endif
-#ifdef UNITS_TEMP_CELSIUS
-    dataStr = String(std::round(inTemp * 10) / 10.0f, 1);
-#endif
-#ifdef UNITS_TEMP_FAHRENHEIT
-    dataStr = String(static_cast<int>(
-              std::round(celsius_to_fahrenheit(inTemp))));
-#endif
-  }
-  else
-  {
-    dataStr = "--";
-  }
-#if defined(UNITS_TEMP_CELSIUS) || defined(UNITS_TEMP_FAHRENHEIT)
-  dataStr += "\260";
-#endif
-  drawString(48, 204 + 17 / 2 + (48 + 8) * 4 + 48 / 2, dataStr, LEFT);
+  setFont(&FONT_12pt8b);
+  drawString(48, 204 + 17 / 2 + (48 + 8) * 4 + 48 / 2, view.inTemp, LEFT);
 #endif // defined(DISP_BW_V2) || defined(DISP_3C_B) || defined(DISP_7C_F)
 
   // sunset
-  memset(timeBuffer, '\0', sizeof(timeBuffer));
-  ts = current.sunset;
-  timeInfo = localtime(&ts);
-  _strftime(timeBuffer, sizeof(timeBuffer), TIME_FORMAT, timeInfo);
-  drawString(170 + 48, 204 + 17 / 2 + (48 + 8) * 0 + 48 / 2, timeBuffer, LEFT);
+  drawString(170 + 48, 204 + 17 / 2 + (48 + 8) * 0 + 48 / 2, view.sunset, LEFT);
 
   // humidity
-  dataStr = String(current.humidity);
-  drawString(170 + 48, 204 + 17 / 2 + (48 + 8) * 1 + 48 / 2, dataStr, LEFT);
-  display.setFont(&FONT_8pt8b);
-  drawString(display.getCursorX(), 204 + 17 / 2 + (48 + 8) * 1 + 48 / 2,
+  drawString(170 + 48, 204 + 17 / 2 + (48 + 8) * 1 + 48 / 2, view.humidity,
+             LEFT);
+  setFont(&FONT_8pt8b);
+  drawString(gfx->getCursorX(), 204 + 17 / 2 + (48 + 8) * 1 + 48 / 2,
              "%", LEFT);
 
   // pressure
-#ifdef UNITS_PRES_HECTOPASCALS
-  dataStr = String(current.pressure);
-  unitStr = String(" ") + TXT_UNITS_PRES_HECTOPASCALS;
-#endif
-#ifdef UNITS_PRES_PASCALS
-  dataStr = String(static_cast<int>(std::round(
-                   hectopascals_to_pascals(current.pressure) )));
-  unitStr = String(" ") + TXT_UNITS_PRES_PASCALS;
-#endif
-#ifdef UNITS_PRES_MILLIMETERSOFMERCURY
-  dataStr = String(static_cast<int>(std::round(
-                   hectopascals_to_millimetersofmercury(current.pressure) )));
-  unitStr = String(" ") + TXT_UNITS_PRES_MILLIMETERSOFMERCURY;
-#endif
-#ifdef UNITS_PRES_INCHESOFMERCURY
-  dataStr = String(std::round(1e1f *
-                   hectopascals_to_inchesofmercury(current.pressure)
-                   ) / 1e1f, 1);
-  unitStr = String(" ") + TXT_UNITS_PRES_INCHESOFMERCURY;
-#endif
-#ifdef UNITS_PRES_MILLIBARS
-  dataStr = String(static_cast<int>(std::round(
-                   hectopascals_to_millibars(current.pressure) )));
-  unitStr = String(" ") + TXT_UNITS_PRES_MILLIBARS;
-#endif
-#ifdef UNITS_PRES_ATMOSPHERES
-  dataStr = String(std::round(1e3f *
-                   hectopascals_to_atmospheres(current.pressure) )
-                   / 1e3f, 3);
-  unitStr = String(" ") + TXT_UNITS_PRES_ATMOSPHERES;
-#endif
-#ifdef UNITS_PRES_GRAMSPERSQUARECENTIMETER
-  dataStr = String(static_cast<int>(std::round(
-                   hectopascals_to_gramspersquarecentimeter(current.pressure)
-                   )));
-  unitStr = String(" ") + TXT_UNITS_PRES_GRAMSPERSQUARECENTIMETER;
-#endif
-#ifdef UNITS_PRES_POUNDSPERSQUAREINCH
-  dataStr = String(std::round(1e2f *
-                   hectopascals_to_poundspersquareinch(current.pressure)
-                   ) / 1e2f, 2);
-  unitStr = String(" ") + TXT_UNITS_PRES_POUNDSPERSQUAREINCH;
-#endif
-  display.setFont(&FONT_12pt8b);
-  drawString(170 + 48, 204 + 17 / 2 + (48 + 8) * 2 + 48 / 2, dataStr, LEFT);
-  display.setFont(&FONT_8pt8b);
-  drawString(display.getCursorX(), 204 + 17 / 2 + (48 + 8) * 2 + 48 / 2,
-             unitStr, LEFT);
+  setFont(&FONT_12pt8b);
+  drawString(170 + 48, 204 + 17 / 2 + (48 + 8) * 2 + 48 / 2, view.pressure,
+             LEFT);
+  setFont(&FONT_8pt8b);
+  drawString(gfx->getCursorX(), 204 + 17 / 2 + (48 + 8) * 2 + 48 / 2,
+             view.pressureUnit, LEFT);
 
 #ifndef DISP_BW_V1
   // visibility
-  display.setFont(&FONT_12pt8b);
-#ifdef UNITS_DIST_KILOMETERS
-  float vis = meters_to_kilometers(current.visibility);
-  unitStr = String(" ") + TXT_UNITS_DIST_KILOMETERS;
-#endif
-#ifdef UNITS_DIST_MILES
-  float vis = meters_to_miles(current.visibility);
-  unitStr = String(" ") + TXT_UNITS_DIST_MILES;
-#endif
-  // if visibility is less than 1.95, round to 1 decimal place
-  // else round to int
-  if (vis < 1.95)
-  {
-    dataStr = String(std::round(10 * vis) / 10.0, 1);
-  }
-  else
-  {
-    dataStr = String(static_cast<int>(std::round(vis)));
-  }
-#ifdef UNITS_DIST_KILOMETERS
-  if (vis >= 10)
-  {
-#endif
-#ifdef UNITS_DIST_MILES
-  if (vis >= 6)
-  {
-#endif
-    dataStr = "> " + dataStr;
-  }
-  drawString(170 + 48, 204 + 17 / 2 + (48 + 8) * 3 + 48 / 2, dataStr, LEFT);
-  display.setFont(&FONT_8pt8b);
-  drawString(display.getCursorX(), 204 + 17 / 2 + (48 + 8) * 3 + 48 / 2,
-             unitStr, LEFT);
+  setFont(&FONT_12pt8b);
+  drawString(170 + 48, 204 + 17 / 2 + (48 + 8) * 3 + 48 / 2, view.visibility,
+             LEFT);
+  setFont(&FONT_8pt8b);
+  drawString(gfx->getCursorX(), 204 + 17 / 2 + (48 + 8) * 3 + 48 / 2,
+             view.visibilityUnit, LEFT);
 
   // indoor humidity
-  display.setFont(&FONT_12pt8b);
-  if (!std::isnan(inHumidity))
-  {
-    dataStr = String(static_cast<int>(std::round(inHumidity)));
-  }
-  else
-  {
-    dataStr = "--";
-  }
-  drawString(170 + 48, 204 + 17 / 2 + (48 + 8) * 4 + 48 / 2, dataStr, LEFT);
-  display.setFont(&FONT_8pt8b);
-  drawString(display.getCursorX(), 204 + 17 / 2 + (48 + 8) * 4 + 48 / 2,
+  setFont(&FONT_12pt8b);
+  drawString(170 + 48, 204 + 17 / 2 + (48 + 8) * 4 + 48 / 2, view.inHumidity,
+             LEFT);
+  setFont(&FONT_8pt8b);
+  drawString(gfx->getCursorX(), 204 + 17 / 2 + (48 + 8) * 4 + 48 / 2,
              "%", LEFT);
 #endif // defined(DISP_BW_V2) || defined(DISP_3C_B) || defined(DISP_7C_F)
   return;
@@ -662,144 +669,81 @@ void drawCurrentConditions(const owm_current_t &current,
 
 /* This function is responsible for drawing the five day forecast.
  */
-void drawForecast(const owm_daily_t *daily, tm timeInfo)
+void drawForecast(const forecast_view_t &view)
 {
+  TimingProbe probe("drawForecast");
   // 5 day, forecast
-  String hiStr, loStr;
-  String dataStr, unitStr;
-  for (int i = 0; i < 5; ++i)
+  for (int i = 0; i < FORECAST_DAYS; ++i)
   {
+    const forecast_day_view_t &day = view.days[i];
 #ifndef DISP_BW_V1
     int x = 398 + (i * 82);
 #elif defined(DISP_BW_V1)
     int x = 318 + (i * 64);
 #endif
     // icons
-    display.drawInvertedBitmap(x, 98 + 69 / 2 - 32 - 6,
-                               getDailyForecastBitmap64(daily[i]),
-                               64, 64, GxEPD_BLACK);
+    drawIcon(x, 98 + 69 / 2 - 32 - 6, day.icon, GxEPD_BLACK);
     // day of week label
-    display.setFont(&FONT_11pt8b);
-    char dayBuffer[8] = {};
-    _strftime(dayBuffer, sizeof(dayBuffer), "%a", &timeInfo); // abbrv'd day
-    drawString(x + 31 - 2, 98 + 69 / 2 - 32 - 26 - 6 + 16, dayBuffer, CENTER);
-    timeInfo.tm_wday = (timeInfo.tm_wday + 1) % 7; // increment to next day
+    setFont(&FONT_11pt8b);
+    drawString(x + 31 - 2, 98 + 69 / 2 - 32 - 26 - 6 + 16, day.day, CENTER);
 
     // high | low
-    display.setFont(&FONT_8pt8b);
+    setFont(&FONT_8pt8b);
     drawString(x + 31, 98 + 69 / 2 + 38 - 6 + 12, "|", CENTER);
-#ifdef UNITS_TEMP_KELVIN
-    hiStr = String(static_cast<int>(std::round(daily[i].temp.max)));
-    loStr = String(static_cast<int>(std::round(daily[i].temp.min)));
-#endif
-#ifdef UNITS_TEMP_CELSIUS
-    hiStr = String(static_cast<int>(
-                std::round(kelvin_to_celsius(daily[i].temp.max)))) +
-            "\260";
-    loStr = String(static_cast<int>(
-                std::round(kelvin_to_celsius(daily[i].temp.min)))) +
-            "\260";
-#endif
-#ifdef UNITS_TEMP_FAHRENHEIT
-    hiStr = String(static_cast<int>(
-                std::round(kelvin_to_fahrenheit(daily[i].temp.max)))) +
-            "\260";
-    loStr = String(static_cast<int>(
-                std::round(kelvin_to_fahrenheit(daily[i].temp.min)))) +
-            "\260";
-#endif
-    drawString(x + 31 - 4, 98 + 69 / 2 + 38 - 6 + 12, hiStr, RIGHT);
-    drawString(x + 31 + 5, 98 + 69 / 2 + 38 - 6 + 12, loStr, LEFT);
-
-// daily forecast precipitation
-#if DISPLAY_DAILY_PRECIP
-    float dailyPrecip;
-#if defined(UNITS_DAILY_PRECIP_POP)
-    dailyPrecip = daily[i].pop * 100;
-    dataStr = String(static_cast<int>(dailyPrecip));
-    unitStr = "%";
-#else
-    dailyPrecip = daily[i].snow + daily[i].rain;
-#if defined(UNITS_DAILY_PRECIP_MILLIMETERS)
-    // Round up to nearest mm
-    dailyPrecip = std::round(dailyPrecip);
-    dataStr = String(static_cast<int>(dailyPrecip));
-    unitStr = String(" ") + TXT_UNITS_PRECIP_MILLIMETERS;
-#elif defined(UNITS_DAILY_PRECIP_CENTIMETERS)
-    // Round up to nearest 0.1 cm
-    dailyPrecip = millimeters_to_centimeters(dailyPrecip);
-    dailyPrecip = std::round(dailyPrecip * 10) / 10.0f;
-    dataStr = String(dailyPrecip, 1);
-    unitStr = String(" ") + TXT_UNITS_PRECIP_CENTIMETERS;
-#elif defined(UNITS_DAILY_PRECIP_INCHES)
-    // Round up to nearest 0.1 inch
-    dailyPrecip = millimeters_to_inches(dailyPrecip);
-    dailyPrecip = std::round(dailyPrecip * 10) / 10.0f;
-    dataStr = String(dailyPrecip, 1);
-    unitStr = String(" ") + TXT_UNITS_PRECIP_INCHES;
-#endif
-#endif
-#if (DISPLAY_DAILY_PRECIP == 2) // smart
-      if (dailyPrecip > 0.0f)
-      {
-#endif
-        display.setFont(&FONT_6pt8b);
-        drawString(x + 31, 98 + 69 / 2 + 38 - 6 + 26,
-                   dataStr + unitStr, CENTER);
-#if (DISPLAY_DAILY_PRECIP == 2) // smart
-      }
-#endif
-#endif // DISPLAY_DAILY_PRECIP
+    drawString(x + 31 - 4, 98 + 69 / 2 + 38 - 6 + 12, day.hi, RIGHT);
+    drawString(x + 31 + 5, 98 + 69 / 2 + 38 - 6 + 12, day.lo, LEFT);
+
+    // daily forecast precipitation
+    if (day.precip[0] != '\0')
+    {
+      setFont(&FONT_6pt8b);
+      drawString(x + 31, 98 + 69 / 2 + 38 - 6 + 26, day.precip, CENTER);
     }
+  }
 
-    return;
-  } // end drawForecast
+  return;
+} // end drawForecast
 
   /* This function is responsible for drawing the current alerts if any.
    * Up to 2 alerts can be drawn.
    */
-  void drawAlerts(std::vector<owm_alerts_t> & alerts,
+  void drawAlerts(owm_alerts_t *alerts, int num_alerts,
                   const String &city, const String &date)
   {
+  TimingProbe probe("drawAlerts");
 #if DEBUG_LEVEL >= 1
-  Serial.println("[debug] alerts.size()    : " + String(alerts.size()));
+  LOG_INFO("[debug] num_alerts       : %d", num_alerts);
 #endif
-  if (alerts.size() == 0)
+  if (num_alerts == 0)
   { // no alerts to draw
     return;
   }
 
-  int *ignore_list = (int *) calloc(alerts.size(), sizeof(*ignore_list));
-  int *alert_indices = (int *) calloc(alerts.size(), sizeof(*alert_indices));
-  if (!ignore_list || !alert_indices)
-  {
-    Serial.println("Error: Failed to allocate memory while handling alerts.");
-    free(ignore_list);
-    free(alert_indices);
-    return;
-  }
+  int ignore_list[OWM_NUM_ALERTS] = {};
+  int alert_indices[OWM_NUM_ALERTS] = {};
 
   // Converts all event text and tags to lowercase, removes extra information,
   // and filters out redundant alerts of lesser urgency.
-  filterAlerts(alerts, ignore_list);
+  filterAlerts(alerts, num_alerts, ignore_list);
 
   // limit alert text width so that is does not run into the location or date
   // strings
-  display.setFont(&FONT_16pt8b);
+  setFont(&FONT_16pt8b);
   int city_w = getStringWidth(city);
-  display.setFont(&FONT_12pt8b);
+  setFont(&FONT_12pt8b);
   int date_w = getStringWidth(date);
   int max_w = DISP_WIDTH - 2 - std::max(city_w, date_w) - (196 + 4) - 8;
 
   // find indices of valid alerts
   int num_valid_alerts = 0;
 #if DEBUG_LEVEL >= 1
-  Serial.print("[debug] ignore_list      : [ ");
+  char ignoreStr[2 * OWM_NUM_ALERTS + 1] = {};
 #endif
-  for (int i = 0; i < alerts.size(); ++i)
+  for (int i = 0; i < num_alerts; ++i)
   {
 #if DEBUG_LEVEL >= 1
-    Serial.print(String(ignore_list[i]) + " ");
+    ignoreStr[2 * i] = ignore_list[i] ? '1' : '0';
+    ignoreStr[2 * i + 1] = ' ';
 #endif
     if (!ignore_list[i])
     {
@@ -808,7 +752,8 @@ void drawForecast(const owm_daily_t *daily, tm timeInfo)
     }
   }
 #if DEBUG_LEVEL >= 1
-  Serial.println("]\n[debug] num_valid_alerts : " + String(num_valid_alerts));
+  LOG_INFO("[debug] ignore_list      : [ %s]", ignoreStr);
+  LOG_INFO("[debug] num_valid_alerts : %d", num_valid_alerts);
 #endif
 
   if (num_valid_alerts == 1)
@@ -817,19 +762,18 @@ void drawForecast(const owm_daily_t *daily, tm timeInfo)
     max_w -= 48;
 
     owm_alerts_t &cur_alert = alerts[alert_indices[0]];
-    display.drawInvertedBitmap(196, 8, getAlertBitmap48(cur_alert), 48, 48,
-                               ACCENT_COLOR);
+    drawIcon(196, 8, getAlertBitmap48(cur_alert), ACCENT_COLOR);
     // must be called after getAlertBitmap
     toTitleCase(cur_alert.event);
 
-    display.setFont(&FONT_14pt8b);
+    setFont(&FONT_14pt8b);
     if (getStringWidth(cur_alert.event) <= max_w)
     { // Fits on a single line, draw along bottom
       drawString(196 + 48 + 4, 24 + 8 - 12 + 20 + 1, cur_alert.event, LEFT);
     }
     else
     { // use smaller font
-      display.setFont(&FONT_12pt8b);
+      setFont(&FONT_12pt8b);
       if (getStringWidth(cur_alert.event) <= max_w)
       { // Fits on a single line with smaller font, draw along bottom
         drawString(196 + 48 + 4, 24 + 8 - 12 + 17 + 1, cur_alert.event, LEFT);
@@ -846,13 +790,12 @@ void drawForecast(const owm_daily_t *daily, tm timeInfo)
     // adjust max width to for 32x32 icons
     max_w -= 32;
 
-    display.setFont(&FONT_12pt8b);
+    setFont(&FONT_12pt8b);
     for (int i = 0; i < 2; ++i)
     {
       owm_alerts_t &cur_alert = alerts[alert_indices[i]];
 
-      display.drawInvertedBitmap(196, (i * 32), getAlertBitmap32(cur_alert),
-                                 32, 32, ACCENT_COLOR);
+      drawIcon(196, (i * 32), getAlertBitmap32(cur_alert), ACCENT_COLOR);
       // must be called after getAlertBitmap
       toTitleCase(cur_alert.event);
 
@@ -861,9 +804,6 @@ void drawForecast(const owm_daily_t *daily, tm timeInfo)
     } // end for-loop
   } // end 2 alerts
 
-  free(ignore_list);
-  free(alert_indices);
-
   return;
 } // end drawAlerts
 
@@ -872,382 +812,116 @@ void drawForecast(const owm_daily_t *daily, tm timeInfo)
  */
 void drawLocationDate(const String &city, const String &date)
 {
+  TimingProbe probe("drawLocationDate");
   // location, date
-  display.setFont(&FONT_16pt8b);
+  setFont(&FONT_16pt8b);
   drawString(DISP_WIDTH - 2, 23, city, RIGHT, ACCENT_COLOR);
-  display.setFont(&FONT_12pt8b);
+  setFont(&FONT_12pt8b);
   drawString(DISP_WIDTH - 2, 30 + 4 + 17, date, RIGHT);
   return;
 } // end drawLocationDate
 
-/* The % operator in C++ is not a true modulo operator but it instead a
- * remainder operator. The remainder operator and modulo operator are equivalent
- * for positive numbers, but not for negatives. The follow implementation of the
- * modulo operator works for +/-a and +b.
- */
-inline int modulo(int a, int b)
-{
-  const int result = a % b;
-  return result >= 0 ? result : result + b;
-}
-
-/* Convert temperature in kelvin to the display y coordinate to be plotted.
+/* Draws an x axis tick mark of the outlook graph and its label.
  */
-int kelvin_to_plot_y(float kelvin, int tempBoundMin, float yPxPerUnit,
-                     int yBoundMin)
+static void drawOutlookTick(const outlook_tick_t &tick, int yPos1)
 {
-#ifdef UNITS_TEMP_KELVIN
-  return static_cast<int>(std::round(
-    yBoundMin - (yPxPerUnit * (kelvin - tempBoundMin)) ));
-#endif
-#ifdef UNITS_TEMP_CELSIUS
-  return static_cast<int>(std::round(
-    yBoundMin - (yPxPerUnit * (kelvin_to_celsius(kelvin) - tempBoundMin)) ));
-#endif
-#ifdef UNITS_TEMP_FAHRENHEIT
-  return static_cast<int>(std::round(
-    yBoundMin - (yPxPerUnit * (kelvin_to_fahrenheit(kelvin) - tempBoundMin)) ));
-#endif
-}
+  // draw x tick marks
+  gfx->drawLine(tick.x    , yPos1 + 1, tick.x    , yPos1 + 4, GxEPD_BLACK);
+  gfx->drawLine(tick.x + 1, yPos1 + 1, tick.x + 1, yPos1 + 4, GxEPD_BLACK);
+  // draw x axis labels
+  drawString(tick.x, yPos1 + 1 + 12 + 4 + 3, tick.label, CENTER);
+  return;
+} // end drawOutlookTick
 
 /* This function is responsible for drawing the outlook graph for the specified
  * number of hours(up to 48).
  */
-void drawOutlookGraph(const owm_hourly_t *hourly, const owm_daily_t *daily,
-                      tm timeInfo)
+void drawOutlookGraph(const outlook_view_t &view)
 {
-  const int xPos0 = 350;
-  int xPos1 = DISP_WIDTH;
-  const int yPos0 = 216;
-  const int yPos1 = DISP_HEIGHT - 46;
-
-  // calculate y max/min and intervals
-  int yMajorTicks = 5;
-#ifdef UNITS_TEMP_KELVIN
-  float tempMin = hourly[0].temp;
-#endif
-#ifdef UNITS_TEMP_CELSIUS
-  float tempMin = kelvin_to_celsius(hourly[0].temp);
-#endif
-#ifdef UNITS_TEMP_FAHRENHEIT
-  float tempMin = kelvin_to_fahrenheit(hourly[0].temp);
-#endif
-  float tempMax = tempMin;
-#ifdef UNITS_HOURLY_PRECIP_POP
-  float precipMax = hourly[0].pop;
-#else
-  float precipMax = hourly[0].rain_1h + hourly[0].snow_1h;
-#endif
-  int yTempMajorTicks = 5;
-  float newTemp = 0;
-  for (int i = 1; i < HOURLY_GRAPH_MAX; ++i)
-  {
-#ifdef UNITS_TEMP_KELVIN
-    newTemp = hourly[i].temp;
-#endif
-#ifdef UNITS_TEMP_CELSIUS
-    newTemp = kelvin_to_celsius(hourly[i].temp);
-#endif
-#ifdef UNITS_TEMP_FAHRENHEIT
-    newTemp = kelvin_to_fahrenheit(hourly[i].temp);
-#endif
-    tempMin = std::min(tempMin, newTemp);
-    tempMax = std::max(tempMax, newTemp);
-#ifdef UNITS_HOURLY_PRECIP_POP
-    precipMax = std::max<float>(precipMax, hourly[i].pop);
-#else
-    precipMax = std::max<float>(
-                precipMax, hourly[i].rain_1h + hourly[i].snow_1h);
-#endif
-  }
-  int tempBoundMin = static_cast<int>(tempMin - 1)
-                      - modulo(static_cast<int>(tempMin - 1), yTempMajorTicks);
-  int tempBoundMax = static_cast<int>(tempMax + 1)
-   + (yTempMajorTicks - modulo(static_cast<int>(tempMax + 1), yTempMajorTicks));
-
-  // while we have to many major ticks then increase the step
-  while ((tempBoundMax - tempBoundMin) / yTempMajorTicks > yMajorTicks)
-  {
-    yTempMajorTicks += 5;
-    tempBoundMin = static_cast<int>(tempMin - 1)
-                      - modulo(static_cast<int>(tempMin - 1), yTempMajorTicks);
-    tempBoundMax = static_cast<int>(tempMax + 1) + (yTempMajorTicks
-                      - modulo(static_cast<int>(tempMax + 1), yTempMajorTicks));
-  }
-  // while we have not enough major ticks, add to either bound
-  while ((tempBoundMax - tempBoundMin) / yTempMajorTicks < yMajorTicks)
-  {
-    // add to whatever bound is closer to the actual min/max
-    if (tempMin - tempBoundMin <= tempBoundMax - tempMax)
-    {
-      tempBoundMin -= yTempMajorTicks;
-    }
-    else
-    {
-      tempBoundMax += yTempMajorTicks;
-    }
-  }
-
-#ifdef UNITS_HOURLY_PRECIP_POP
-  xPos1 = DISP_WIDTH - 23;
-  float precipBoundMax;
-  if (precipMax > 0)
-  {
-    precipBoundMax = 100.0f;
-  }
-  else
-  {
-    precipBoundMax = 0.0f;
-  }
-#else
-#ifdef UNITS_HOURLY_PRECIP_MILLIMETERS
-  xPos1 = DISP_WIDTH - 24;
-  float precipBoundMax = std::ceil(precipMax); // Round up to nearest mm
-  int yPrecipMajorTickDecimals = (precipBoundMax < 10);
-#endif
-#ifdef UNITS_HOURLY_PRECIP_CENTIMETERS
-  xPos1 = DISP_WIDTH - 25;
-  precipMax = millimeters_to_centimeters(precipMax);
-  // Round up to nearest 0.1 cm
-  float precipBoundMax = std::ceil(precipMax * 10) / 10.0f;
-  int yPrecipMajorTickDecimals;
-  if (precipBoundMax < 1)
-  {
-    yPrecipMajorTickDecimals = 2;
-    if (precipBoundMax > 0)
-    {
-      xPos1 -= 6; // needs extra room
-    }
-  }
-  else if (precipBoundMax < 10)
-  {
-    yPrecipMajorTickDecimals = 1;
-  }
-  else
-  {
-    yPrecipMajorTickDecimals = 0;
-  }
-#endif
-#ifdef UNITS_HOURLY_PRECIP_INCHES
-  xPos1 = DISP_WIDTH - 25;
-  precipMax = millimeters_to_inches(precipMax);
-  // Round up to nearest 0.1 inch
-  float precipBoundMax = std::ceil(precipMax * 10) / 10.0f;
-  int yPrecipMajorTickDecimals;
-  if (precipBoundMax < 1)
-  {
-    yPrecipMajorTickDecimals = 2;
-  }
-  else if (precipBoundMax < 10)
-  {
-    yPrecipMajorTickDecimals = 1;
-  }
-  else
-  {
-    yPrecipMajorTickDecimals = 0;
-  }
-#endif
-  float yPrecipMajorTickValue = precipBoundMax / yMajorTicks;
-  float precipRoundingMultiplier = std::pow(10.f, yPrecipMajorTickDecimals);
-#endif
-
-  if (precipBoundMax > 0)
-  { // fill need extra room for labels
-    xPos1 -= 23;
-  }
+  TimingProbe probe("drawOutlookGraph");
+  const int xPos0 = view.x0;
+  const int xPos1 = view.x1;
+  const int yPos1 = view.y1;
 
   // draw x axis
-  display.drawLine(xPos0, yPos1    , xPos1, yPos1    , GxEPD_BLACK);
-  display.drawLine(xPos0, yPos1 - 1, xPos1, yPos1 - 1, GxEPD_BLACK);
+  gfx->drawLine(xPos0, yPos1    , xPos1, yPos1    , GxEPD_BLACK);
+  gfx->drawLine(xPos0, yPos1 - 1, xPos1, yPos1 - 1, GxEPD_BLACK);
 
   // draw y axis
-  float yInterval = (yPos1 - yPos0) / static_cast<float>(yMajorTicks);
-  for (int i = 0; i <= yMajorTicks; ++i)
+  for (int i = 0; i <= OUTLOOK_Y_TICKS; ++i)
   {
-    String dataStr;
-    int yTick = static_cast<int>(yPos0 + (i * yInterval));
-    display.setFont(&FONT_8pt8b);
+    int yTick = view.yTicks[i];
+    setFont(&FONT_8pt8b);
     // Temperature
-    dataStr = String(tempBoundMax - (i * yTempMajorTicks));
-#if defined(UNITS_TEMP_CELSIUS) || defined(UNITS_TEMP_FAHRENHEIT)
-    dataStr += "\260";
-#endif
-    drawString(xPos0 - 8, yTick + 4, dataStr, RIGHT, ACCENT_COLOR);
+    drawString(xPos0 - 8, yTick + 4, view.tempLabels[i], RIGHT, ACCENT_COLOR);
 
-    if (precipBoundMax > 0)
+    if (view.showPrecipLabels)
     { // don't labels if precip is 0
-#ifdef UNITS_HOURLY_PRECIP_POP
-      // PoP
-      dataStr = String(100 - (i * 20));
-      String precipUnit = "%";
-#else
-      // Precipitation volume
-      float precipTick = precipBoundMax - (i * yPrecipMajorTickValue);
-      precipTick = std::round(precipTick * precipRoundingMultiplier)
-                              / precipRoundingMultiplier;
-      dataStr = String(precipTick, yPrecipMajorTickDecimals);
-#ifdef UNITS_HOURLY_PRECIP_MILLIMETERS
-      String precipUnit = String(" ") + TXT_UNITS_PRECIP_MILLIMETERS;
-#endif
-#ifdef UNITS_HOURLY_PRECIP_CENTIMETERS
-      String precipUnit = String(" ") + TXT_UNITS_PRECIP_CENTIMETERS;
-#endif
-#ifdef UNITS_HOURLY_PRECIP_INCHES
-      String precipUnit = String(" ") + TXT_UNITS_PRECIP_INCHES;
-#endif
-#endif
-
-      drawString(xPos1 + 8, yTick + 4, dataStr, LEFT);
-      display.setFont(&FONT_5pt8b);
-      drawString(display.getCursorX(), yTick + 4, precipUnit, LEFT);
+      drawString(xPos1 + 8, yTick + 4, view.precipLabels[i], LEFT);
+      setFont(&FONT_5pt8b);
+      drawString(gfx->getCursorX(), yTick + 4, view.precipUnit, LEFT);
     } // end draw labels if precip is >0
 
     // draw dotted line
-    if (i < yMajorTicks)
+    if (i < OUTLOOK_Y_TICKS)
     {
       for (int x = xPos0; x <= xPos1 + 1; x += 3)
       {
-        display.drawPixel(x, yTick + (yTick % 2), GxEPD_BLACK);
+        gfx->drawPixel(x, yTick + (yTick % 2), GxEPD_BLACK);
       }
     }
   }
 
-  int xMaxTicks = 8;
-  int hourInterval = static_cast<int>(ceil(HOURLY_GRAPH_MAX
-                                           / static_cast<float>(xMaxTicks)));
-  float xInterval = (xPos1 - xPos0 - 1) / static_cast<float>(HOURLY_GRAPH_MAX);
-  display.setFont(&FONT_8pt8b);
-  
-  // precalculate all x and y coordinates for temperature values
-  float yPxPerUnit = (yPos1 - yPos0)
-                     / static_cast<float>(tempBoundMax - tempBoundMin);
-  std::vector<int> x_t;
-  std::vector<int> y_t;
-  x_t.reserve(HOURLY_GRAPH_MAX);
-  y_t.reserve(HOURLY_GRAPH_MAX);
-    for (int i = 0; i < HOURLY_GRAPH_MAX; ++i)
-  {
-    y_t[i] = kelvin_to_plot_y(hourly[i].temp, tempBoundMin, yPxPerUnit, yPos1);
-    x_t[i] = static_cast<int>(std::round(xPos0 + (i * xInterval)
-                                          + (0.5 * xInterval) ));
-  }
-
-#if DISPLAY_HOURLY_ICONS
-  int day_idx = 0;
-#endif
-  display.setFont(&FONT_8pt8b);
-  for (int i = 0; i < HOURLY_GRAPH_MAX; ++i)
+  setFont(&FONT_8pt8b);
+  int tick = 0;
+  for (int i = 0; i < view.hours; ++i)
   {
-    int xTick = static_cast<int>(xPos0 + (i * xInterval));
     int x0_t, x1_t, y0_t, y1_t;
 
     if (i > 0)
     {
       // temperature
-      x0_t = x_t[i - 1];
-      x1_t = x_t[i    ];
-      y0_t = y_t[i - 1];
-      y1_t = y_t[i    ];
+      x0_t = view.tempX[i - 1];
+      x1_t = view.tempX[i    ];
+      y0_t = view.tempY[i - 1];
+      y1_t = view.tempY[i    ];
       // graph temperature
-      display.drawLine(x0_t    , y0_t    , x1_t    , y1_t    , ACCENT_COLOR);
-      display.drawLine(x0_t    , y0_t + 1, x1_t    , y1_t + 1, ACCENT_COLOR);
-      display.drawLine(x0_t - 1, y0_t    , x1_t - 1, y1_t    , ACCENT_COLOR);
+      gfx->drawLine(x0_t    , y0_t    , x1_t    , y1_t    , ACCENT_COLOR);
+      gfx->drawLine(x0_t    , y0_t + 1, x1_t    , y1_t + 1, ACCENT_COLOR);
+      gfx->drawLine(x0_t - 1, y0_t    , x1_t - 1, y1_t    , ACCENT_COLOR);
 
       // draw hourly bitmap
-#if DISPLAY_HOURLY_ICONS
-      if (daily[day_idx].dt + 86400 <= hourly[i].dt) {
-        ++day_idx;
-      }
-      if ((i % hourInterval) == 0) // skip first and last tick
+      if (view.icons[i] != nullptr)
       {
-        int y_b = INT_MAX;
-        // find the highest (lowest in coordinate value) temperature point that
-        // exists within the width of the icon.
-        // find closest point above the temperature line where the icon won't
-        // interect the temperature line.
-        // y = mx + b
-        int span = static_cast<int>(std::round(16 / xInterval));
-        int l_idx = std::max(i - 1 - span, 0);
-        int r_idx = std::min(i + span, HOURLY_GRAPH_MAX - 1);
-        // left intersecting slope
-        float m_l = (y_t[l_idx + 1] - y_t[l_idx]) / xInterval;
-        int x_l = xTick - 16 - x_t[l_idx];
-        int y_l = static_cast<int>(std::round(m_l * x_l + y_t[l_idx]));
-        y_b = std::min(y_l, y_b);
-        // right intersecting slope
-        float m_r = (y_t[r_idx] - y_t[r_idx - 1]) / xInterval;
-        int x_r = xTick + 16 - x_t[r_idx - 1];
-        int y_r = static_cast<int>(std::round(m_r * x_r + y_t[r_idx - 1]));
-        y_b = std::min(y_r, y_b);
-        // any peaks in between
-        for (int idx = l_idx + 1; idx < r_idx; ++idx)
-        {
-          y_b = std::min(y_t[idx], y_b);
-        }
-        const uint8_t *bitmap = getHourlyForecastBitmap32(hourly[i],
-                                                          daily[day_idx]);
-        display.drawInvertedBitmap(xTick - 16, y_b - 32,
-                                   bitmap, 32, 32, GxEPD_BLACK);
+        drawIcon(view.hourX[i] - 16, view.iconY[i] - 32, view.icons[i],
+                 GxEPD_BLACK);
       }
-#endif
     }
 
-#ifdef UNITS_HOURLY_PRECIP_POP
-    float precipVal = hourly[i].pop * 100;
-#else
-    float precipVal = hourly[i].rain_1h + hourly[i].snow_1h;
-#ifdef UNITS_HOURLY_PRECIP_CENTIMETERS
-    precipVal = millimeters_to_centimeters(precipVal);
-#endif
-#ifdef UNITS_HOURLY_PRECIP_INCHES
-    precipVal = millimeters_to_inches(precipVal);
-#endif
-#endif
-
-    x0_t = static_cast<int>(std::round( xPos0 + 1 + (i * xInterval)));
-    x1_t = static_cast<int>(std::round( xPos0 + 1 + ((i + 1) * xInterval) ));
-    yPxPerUnit = (yPos1 - yPos0) / precipBoundMax;
-    y0_t = static_cast<int>(std::round( yPos1 - (yPxPerUnit * (precipVal)) ));
-    y1_t = yPos1;
-
     // graph Precipitation
+    x0_t = view.barX[i];
+    x1_t = view.barX[i + 1];
+    y0_t = view.barY[i];
+    y1_t = yPos1;
     for (int y = y1_t - 1; y > y0_t; y -= 2)
     {
       for (int x = x0_t + (x0_t % 2); x < x1_t; x += 2)
       {
-        display.drawPixel(x, y, GxEPD_BLACK);
+        gfx->drawPixel(x, y, GxEPD_BLACK);
       }
     }
 
-    if ((i % hourInterval) == 0)
+    if (tick < view.numTicks && view.ticks[tick].hour == i)
     {
-      // draw x tick marks
-      display.drawLine(xTick    , yPos1 + 1, xTick    , yPos1 + 4, GxEPD_BLACK);
-      display.drawLine(xTick + 1, yPos1 + 1, xTick + 1, yPos1 + 4, GxEPD_BLACK);
-      // draw x axis labels
-      char timeBuffer[12] = {}; // big enough to accommodate "hh:mm:ss am"
-      time_t ts = hourly[i].dt;
-      tm *timeInfo = localtime(&ts);
-      _strftime(timeBuffer, sizeof(timeBuffer), HOUR_FORMAT, timeInfo);
-      drawString(xTick, yPos1 + 1 + 12 + 4 + 3, timeBuffer, CENTER);
+      drawOutlookTick(view.ticks[tick], yPos1);
+      ++tick;
     }
-
   }
 
   // draw the last tick mark
-  if ((HOURLY_GRAPH_MAX % hourInterval) == 0)
+  if (tick < view.numTicks)
   {
-    int xTick = static_cast<int>(
-                std::round(xPos0 + (HOURLY_GRAPH_MAX * xInterval)));
-    // draw x tick marks
-    display.drawLine(xTick    , yPos1 + 1, xTick    , yPos1 + 4, GxEPD_BLACK);
-    display.drawLine(xTick + 1, yPos1 + 1, xTick + 1, yPos1 + 4, GxEPD_BLACK);
-    // draw x axis labels
-    char timeBuffer[12] = {}; // big enough to accommodate "hh:mm:ss am"
-    time_t ts = hourly[HOURLY_GRAPH_MAX - 1].dt + 3600;
-    tm *timeInfo = localtime(&ts);
-    _strftime(timeBuffer, sizeof(timeBuffer), HOUR_FORMAT, timeInfo);
-    drawString(xTick, yPos1 + 1 + 12 + 4 + 3, timeBuffer, CENTER);
+    drawOutlookTick(view.ticks[tick], yPos1);
   }
 
   return;
@@ -1259,9 +933,10 @@ void drawOutlookGraph(const owm_hourly_t *hourly, const owm_daily_t *daily,
 void drawStatusBar(const String &statusStr, const String &refreshTimeStr,
                    int rssi, uint32_t batVoltage)
 {
+  TimingProbe probe("drawStatusBar");
   String dataStr;
   uint16_t dataColor = GxEPD_BLACK;
-  display.setFont(&FONT_6pt8b);
+  setFont(&FONT_6pt8b);
   int pos = DISP_WIDTH - 2;
   const int sp = 2;
 
@@ -1282,8 +957,7 @@ void drawStatusBar(const String &statusStr, const String &refreshTimeStr,
 #endif
   drawString(pos, DISP_HEIGHT - 1 - 2, dataStr, RIGHT, dataColor);
   pos -= getStringWidth(dataStr) + 25;
-  display.drawInvertedBitmap(pos, DISP_HEIGHT - 1 - 17,
-                             getBatBitmap24(batPercent), 24, 24, dataColor);
+  drawIcon(pos, DISP_HEIGHT - 1 - 17, getBatBitmap24(batPercent), dataColor);
   pos -= sp + 9;
 #endif
 
@@ -1298,16 +972,14 @@ void drawStatusBar(const String &statusStr, const String &refreshTimeStr,
 #endif
   drawString(pos, DISP_HEIGHT - 1 - 2, dataStr, RIGHT, dataColor);
   pos -= getStringWidth(dataStr) + 19;
-  display.drawInvertedBitmap(pos, DISP_HEIGHT - 1 - 13, getWiFiBitmap16(rssi),
-                             16, 16, dataColor);
+  drawIcon(pos, DISP_HEIGHT - 1 - 13, getWiFiBitmap16(rssi), dataColor);
   pos -= sp + 8;
 
   // last refresh
   dataColor = GxEPD_BLACK;
   drawString(pos, DISP_HEIGHT - 1 - 2, refreshTimeStr, RIGHT, dataColor);
   pos -= getStringWidth(refreshTimeStr) + 25;
-  display.drawInvertedBitmap(pos, DISP_HEIGHT - 1 - 21, wi_refresh_32x32,
-                             32, 32, dataColor);
+  drawIcon(pos, DISP_HEIGHT - 1 - 21, wi_refresh_32x32, dataColor);
   pos -= sp;
 
   // status
@@ -1316,8 +988,7 @@ void drawStatusBar(const String &statusStr, const String &refreshTimeStr,
   {
     drawString(pos, DISP_HEIGHT - 1 - 2, statusStr, RIGHT, dataColor);
     pos -= getStringWidth(statusStr) + 24;
-    display.drawInvertedBitmap(pos, DISP_HEIGHT - 1 - 18, error_icon_24x24,
-                               24, 24, dataColor);
+    drawIcon(pos, DISP_HEIGHT - 1 - 18, error_icon_24x24, dataColor);
   }
 
   return;
@@ -1332,7 +1003,7 @@ void drawStatusBar(const String &statusStr, const String &refreshTimeStr,
 void drawError(const uint8_t *bitmap_196x196,
                const String &errMsgLn1, const String &errMsgLn2)
 {
-  display.setFont(&FONT_26pt8b);
+  setFont(&FONT_26pt8b);
   if (!errMsgLn2.isEmpty())
   {
     drawString(DISP_WIDTH / 2,
@@ -1348,9 +1019,8 @@ void drawError(const uint8_t *bitmap_196x196,
                       DISP_HEIGHT / 2 + 196 / 2 + 21,
                       errMsgLn1, CENTER, DISP_WIDTH - 200, 2, 55);
   }
-  display.drawInvertedBitmap(DISP_WIDTH / 2 - 196 / 2,
-                             DISP_HEIGHT / 2 - 196 / 2 - 21,
-                             bitmap_196x196, 196, 196, ACCENT_COLOR);
+  drawIcon(DISP_WIDTH / 2 - 196 / 2, DISP_HEIGHT / 2 - 196 / 2 - 21,
+           bitmap_196x196, ACCENT_COLOR);
   return;
 } // end drawError
 
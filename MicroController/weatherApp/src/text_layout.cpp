@@ -0,0 +1,155 @@
+/* Text layout for esp32-weather-epd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include "text_layout.h"
+
+static_assert((TEXT_LAYOUT_CACHE_SIZE & (TEXT_LAYOUT_CACHE_SIZE - 1)) == 0,
+              "TEXT_LAYOUT_CACHE_SIZE must be a power of 2");
+
+typedef struct text_layout_entry
+{
+  const GFXfont *font;
+  uint32_t       hash;
+  uint32_t       hash2;
+  uint16_t       len;
+  text_bounds_t  bounds;
+  char           prefix[TEXT_LAYOUT_PREFIX_SIZE]; // start of the string, not null-terminated
+} text_layout_entry_t;
+
+static text_layout_entry_t cache[TEXT_LAYOUT_CACHE_SIZE];
+
+/* Running bounds of the glyphs laid out so far, following
+ * Adafruit_GFX::charBounds with a text size of 1 and wrapping off, so the
+ * result is exactly what getTextBounds returns.
+ */
+typedef struct glyph_run
+{
+  int16_t x, y;
+  int16_t minx, miny, maxx, maxy;
+} glyph_run_t;
+
+static void addGlyphs(glyph_run_t &run, const GFXfont *font,
+                      const char *text, size_t len)
+{
+  for (size_t i = 0; i < len; ++i)
+  {
+    uint8_t c = static_cast<uint8_t>(text[i]);
+    if (c == '\n')
+    {
+      run.x = 0;
+      run.y += font->yAdvance;
+    }
+    else if (c != '\r' && c >= font->first && c <= font->last)
+    {
+      const GFXglyph &glyph = font->glyph[c - font->first];
+      int16_t x1 = run.x + glyph.xOffset;
+      int16_t y1 = run.y + glyph.yOffset;
+      int16_t x2 = x1 + glyph.width - 1;
+      int16_t y2 = y1 + glyph.height - 1;
+      if (x1 < run.minx) { run.minx = x1; }
+      if (y1 < run.miny) { run.miny = y1; }
+      if (x2 > run.maxx) { run.maxx = x2; }
+      if (y2 > run.maxy) { run.maxy = y2; }
+      run.x += glyph.xAdvance;
+    }
+  }
+} // end addGlyphs
+
+// FNV-1a
+static uint32_t hashText(uint32_t hash, const char *text, size_t len)
+{
+  for (size_t i = 0; i < len; ++i)
+  {
+    hash = (hash ^ static_cast<uint8_t>(text[i])) * 16777619u;
+  }
+  return hash;
+} // end hashText
+
+// djb2, independent of hashText so a string that collides in both is unlikely
+static uint32_t hashText2(uint32_t hash, const char *text, size_t len)
+{
+  for (size_t i = 0; i < len; ++i)
+  {
+    hash = hash * 33 + static_cast<uint8_t>(text[i]);
+  }
+  return hash;
+} // end hashText2
+
+/* Compares the first TEXT_LAYOUT_PREFIX_SIZE bytes of text followed by suffix
+ * with prefix, or copies them into it if store is true.
+ */
+static bool matchPrefix(char *prefix, const char *text, size_t len,
+                        const char *suffix, size_t suffixLen, bool store)
+{
+  size_t n = len < TEXT_LAYOUT_PREFIX_SIZE ? len : TEXT_LAYOUT_PREFIX_SIZE;
+  size_t m = TEXT_LAYOUT_PREFIX_SIZE - n;
+  m = suffixLen < m ? suffixLen : m;
+  if (store)
+  {
+    memcpy(prefix, text, n);
+    memcpy(prefix + n, suffix, m);
+    return true;
+  }
+  return memcmp(prefix, text, n) == 0 && memcmp(prefix + n, suffix, m) == 0;
+} // end matchPrefix
+
+/* Returns the bounds of the first len bytes of text followed by suffix, drawn
+ * in font. Glyph metrics are read straight from the font's glyph table, and
+ * strings that were measured recently are answered from a cache, so drawing
+ * the same layout again for each page of a paged render costs a lookup. A hit
+ * must match the font, length and two hashes of the string, and its first
+ * TEXT_LAYOUT_PREFIX_SIZE bytes byte for byte, so strings up to that long are
+ * compared in full.
+ */
+text_bounds_t measureText(const GFXfont *font, const char *text, size_t len,
+                          const char *suffix)
+{
+  size_t suffixLen = strlen(suffix);
+  uint32_t hash = hashText(hashText(2166136261u, text, len), suffix, suffixLen);
+  uint32_t hash2 = hashText2(hashText2(5381u, text, len), suffix, suffixLen);
+  text_layout_entry_t &entry = cache[hash & (TEXT_LAYOUT_CACHE_SIZE - 1)];
+  if (entry.font == font && entry.hash == hash && entry.hash2 == hash2
+   && entry.len == static_cast<uint16_t>(len + suffixLen)
+   && matchPrefix(entry.prefix, text, len, suffix, suffixLen, false))
+  {
+    return entry.bounds;
+  }
+
+  glyph_run_t run = {0, 0, 0x7FFF, 0x7FFF, -1, -1};
+  addGlyphs(run, font, text, len);
+  addGlyphs(run, font, suffix, suffixLen);
+
+  text_bounds_t bounds = {0, 0, 0, 0};
+  if (run.maxx >= run.minx)
+  {
+    bounds.x1 = run.minx;
+    bounds.w  = run.maxx - run.minx + 1;
+  }
+  if (run.maxy >= run.miny)
+  {
+    bounds.y1 = run.miny;
+    bounds.h  = run.maxy - run.miny + 1;
+  }
+
+  entry.font   = font;
+  entry.hash   = hash;
+  entry.hash2  = hash2;
+  entry.len    = static_cast<uint16_t>(len + suffixLen);
+  entry.bounds = bounds;
+  matchPrefix(entry.prefix, text, len, suffix, suffixLen, true);
+  return bounds;
+} // end measureText
@@ -0,0 +1,679 @@
+/* View model for esp32-weather-epd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <TimingProbe.h>
+
+#include "_locale.h"
+#include "_strftime.h"
+#include "config.h"
+#include "conversions.h"
+#include "display_utils.h"
+#include "renderer.h"
+#include "view_model.h"
+
+// appended to temperatures, except the large current temperature
+#if defined(UNITS_TEMP_CELSIUS) || defined(UNITS_TEMP_FAHRENHEIT)
+  #define TEMP_SUFFIX "\260"
+#else
+  #define TEMP_SUFFIX ""
+#endif
+
+/* Converts a temperature in kelvin to the configured units.
+ */
+static float toTempUnits(float kelvin)
+{
+#ifdef UNITS_TEMP_KELVIN
+  return kelvin;
+#endif
+#ifdef UNITS_TEMP_CELSIUS
+  return kelvin_to_celsius(kelvin);
+#endif
+#ifdef UNITS_TEMP_FAHRENHEIT
+  return kelvin_to_fahrenheit(kelvin);
+#endif
+} // end toTempUnits
+
+/* Converts n temperatures in kelvin to the configured units.
+ */
+static void toTempUnits(float *out, const float *kelvin, int n)
+{
+#ifdef UNITS_TEMP_KELVIN
+  memmove(out, kelvin, n * sizeof(*out));
+#endif
+#ifdef UNITS_TEMP_CELSIUS
+  kelvin_to_celsius(out, kelvin, n);
+#endif
+#ifdef UNITS_TEMP_FAHRENHEIT
+  kelvin_to_fahrenheit(out, kelvin, n);
+#endif
+  return;
+} // end toTempUnits
+
+/* Formats a temperature already in the configured units as a whole number.
+ */
+static void formatWholeTemp(char *s, size_t size, float temp,
+                            const char *suffix)
+{
+  snprintf(s, size, "%d%s", static_cast<int>(std::round(temp)), suffix);
+} // end formatWholeTemp
+
+/* Formats a temperature in kelvin as a whole number in the configured units.
+ */
+static void formatTemp(char *s, size_t size, float kelvin, const char *suffix)
+{
+  formatWholeTemp(s, size, toTempUnits(kelvin), suffix);
+} // end formatTemp
+
+// The time formats of the view, compiled once by compileTimeFormats.
+static strftime_program_t timeFormat;  // TIME_FORMAT
+static strftime_program_t hourFormat;  // HOUR_FORMAT
+static strftime_program_t dayFormat;   // abbreviated weekday
+
+/* Compiles the time formats of the view, unless they already are.
+ */
+static void compileTimeFormats()
+{
+  static bool compiled = false;
+  if (compiled)
+  {
+    return;
+  }
+  _strftime_compile(&timeFormat, TIME_FORMAT);
+  _strftime_compile(&hourFormat, HOUR_FORMAT);
+  _strftime_compile(&dayFormat, "%a");
+  compiled = true;
+  return;
+} // end compileTimeFormats
+
+/* Formats a Unix time as a local time of day with a compiled format.
+ */
+static void formatTime(char *s, size_t size, int64_t dt,
+                       const strftime_program_t &format)
+{
+  time_t ts = dt;
+  tm *timeInfo = localtime(&ts);
+  _strftime_run(s, size, &format, timeInfo);
+} // end formatTime
+
+/* The % operator in C++ is not a true modulo operator but it instead a
+ * remainder operator. The remainder operator and modulo operator are equivalent
+ * for positive numbers, but not for negatives. The follow implementation of the
+ * modulo operator works for +/-a and +b.
+ */
+inline int modulo(int a, int b)
+{
+  const int result = a % b;
+  return result >= 0 ? result : result + b;
+}
+
+/* Fills in the current conditions.
+ */
+static void buildCurrentView(current_view_t &v,
+                             const owm_current_t &current,
+                             const owm_daily_t &today,
+                             const aqi_history_t &aqi_history,
+                             float inTemp, float inHumidity)
+{
+  v.icon = getCurrentConditionsBitmap196(current, today);
+
+  // current temp and feels like
+  formatTemp(v.temp, sizeof(v.temp), current.temp, "");
+#ifdef UNITS_TEMP_KELVIN
+  v.tempUnit = TXT_UNITS_TEMP_KELVIN;
+#endif
+#ifdef UNITS_TEMP_CELSIUS
+  v.tempUnit = TXT_UNITS_TEMP_CELSIUS;
+#endif
+#ifdef UNITS_TEMP_FAHRENHEIT
+  v.tempUnit = TXT_UNITS_TEMP_FAHRENHEIT;
+#endif
+  snprintf(v.feelsLike, sizeof(v.feelsLike), "%s %d%s", TXT_FEELS_LIKE,
+           static_cast<int>(std::round(toTempUnits(current.feels_like))),
+           TEMP_SUFFIX);
+
+  formatTime(v.sunrise, sizeof(v.sunrise), current.sunrise, timeFormat);
+  formatTime(v.sunset,  sizeof(v.sunset),  current.sunset,  timeFormat);
+
+  // wind
+#ifdef WIND_INDICATOR_ARROW
+  v.windArrowDeg = getWindArrowDeg(current.wind_deg);
+#endif
+#ifdef UNITS_SPEED_METERSPERSECOND
+  int windSpeed = static_cast<int>(std::round(current.wind_speed));
+  const char *windUnit = TXT_UNITS_SPEED_METERSPERSECOND;
+#endif
+#ifdef UNITS_SPEED_FEETPERSECOND
+  int windSpeed = static_cast<int>(std::round(
+                  meterspersecond_to_feetpersecond(current.wind_speed) ));
+  const char *windUnit = TXT_UNITS_SPEED_FEETPERSECOND;
+#endif
+#ifdef UNITS_SPEED_KILOMETERSPERHOUR
+  int windSpeed = static_cast<int>(std::round(
+                  meterspersecond_to_kilometersperhour(current.wind_speed) ));
+  const char *windUnit = TXT_UNITS_SPEED_KILOMETERSPERHOUR;
+#endif
+#ifdef UNITS_SPEED_MILESPERHOUR
+  int windSpeed = static_cast<int>(std::round(
+                  meterspersecond_to_milesperhour(current.wind_speed) ));
+  const char *windUnit = TXT_UNITS_SPEED_MILESPERHOUR;
+#endif
+#ifdef UNITS_SPEED_KNOTS
+  int windSpeed = static_cast<int>(std::round(
+                  meterspersecond_to_knots(current.wind_speed) ));
+  const char *windUnit = TXT_UNITS_SPEED_KNOTS;
+#endif
+#ifdef UNITS_SPEED_BEAUFORT
+  int windSpeed = meterspersecond_to_beaufort(current.wind_speed);
+  const char *windUnit = TXT_UNITS_SPEED_BEAUFORT;
+#endif
+  snprintf(v.windSpeed, sizeof(v.windSpeed), "%d", windSpeed);
+  snprintf(v.windUnit, sizeof(v.windUnit), " %s", windUnit);
+#if defined(WIND_INDICATOR_NUMBER)
+  snprintf(v.windDir, sizeof(v.windDir), "%d\260", current.wind_deg);
+#endif
+#if defined(WIND_INDICATOR_CPN_CARDINAL)                \
+ || defined(WIND_INDICATOR_CPN_INTERCARDINAL)           \
+ || defined(WIND_INDICATOR_CPN_SECONDARY_INTERCARDINAL) \
+ || defined(WIND_INDICATOR_CPN_TERTIARY_INTERCARDINAL)
+  snprintf(v.windDir, sizeof(v.windDir), "%s",
+           getCompassPointNotation(current.wind_deg));
+#endif
+
+  // uv index
+  unsigned int uvi = static_cast<unsigned int>(
+                                std::max(std::round(current.uvi), 0.0f));
+  snprintf(v.uvi, sizeof(v.uvi), "%u", uvi);
+  v.uviDesc = getUVIdesc(uvi);
+
+  // air quality index
+  if (aqi_desc_type(AQI_SCALE) == AIR_QUALITY_DESC)
+  {
+    v.aqiLabel = TXT_AIR_QUALITY;
+  }
+  else // (aqi_desc_type(AQI_SCALE) == AIR_POLLUTION_DESC)
+  {
+    v.aqiLabel = TXT_AIR_POLLUTION;
+  }
+  int aqi = getAQI(aqi_history);
+  int aqi_max = aqi_scale_max(AQI_SCALE);
+  if (aqi > aqi_max)
+  {
+    snprintf(v.aqi, sizeof(v.aqi), "> %d", aqi_max);
+  }
+  else
+  {
+    snprintf(v.aqi, sizeof(v.aqi), "%d", aqi);
+  }
+  v.aqiDesc = aqi_desc(AQI_SCALE, aqi);
+
+  // indoor temperature
+  if (!std::isnan(inTemp))
+  {
+#ifdef UNITS_TEMP_KELVIN
+    snprintf(v.inTemp, sizeof(v.inTemp), "%.1f",
+             std::round(celsius_to_kelvin(inTemp) * 10) / 10.0f);
+#endif
+#ifdef UNITS_TEMP_CELSIUS
+    snprintf(v.inTemp, sizeof(v.inTemp), "%.1f\260",
+             std::round(inTemp * 10) / 10.0f);
+#endif
+#ifdef UNITS_TEMP_FAHRENHEIT
+    snprintf(v.inTemp, sizeof(v.inTemp), "%d\260", static_cast<int>(
+             std::round(celsius_to_fahrenheit(inTemp))));
+#endif
+  }
+  else
+  {
+    snprintf(v.inTemp, sizeof(v.inTemp), "--%s", TEMP_SUFFIX);
+  }
+
+  // humidity
+  snprintf(v.humidity, sizeof(v.humidity), "%d", current.humidity);
+
+  // pressure
+#ifdef UNITS_PRES_HECTOPASCALS
+  snprintf(v.pressure, sizeof(v.pressure), "%d", current.pressure);
+  const char *pressureUnit = TXT_UNITS_PRES_HECTOPASCALS;
+#endif
+#ifdef UNITS_PRES_PASCALS
+  snprintf(v.pressure, sizeof(v.pressure), "%d", static_cast<int>(std::round(
+           hectopascals_to_pascals(current.pressure) )));
+  const char *pressureUnit = TXT_UNITS_PRES_PASCALS;
+#endif
+#ifdef UNITS_PRES_MILLIMETERSOFMERCURY
+  snprintf(v.pressure, sizeof(v.pressure), "%d", static_cast<int>(std::round(
+           hectopascals_to_millimetersofmercury(current.pressure) )));
+  const char *pressureUnit = TXT_UNITS_PRES_MILLIMETERSOFMERCURY;
+#endif
+#ifdef UNITS_PRES_INCHESOFMERCURY
+  snprintf(v.pressure, sizeof(v.pressure), "%.1f", std::round(1e1f *
+           hectopascals_to_inchesofmercury(current.pressure)) / 1e1f);
+  const char *pressureUnit = TXT_UNITS_PRES_INCHESOFMERCURY;
+#endif
+#ifdef UNITS_PRES_MILLIBARS
+  snprintf(v.pressure, sizeof(v.pressure), "%d", static_cast<int>(std::round(
+           hectopascals_to_millibars(current.pressure) )));
+  const char *pressureUnit = TXT_UNITS_PRES_MILLIBARS;
+#endif
+#ifdef UNITS_PRES_ATMOSPHERES
+  snprintf(v.pressure, sizeof(v.pressure), "%.3f", std::round(1e3f *
+           hectopascals_to_atmospheres(current.pressure)) / 1e3f);
+  const char *pressureUnit = TXT_UNITS_PRES_ATMOSPHERES;
+#endif
+#ifdef UNITS_PRES_GRAMSPERSQUARECENTIMETER
+  snprintf(v.pressure, sizeof(v.pressure), "%d", static_cast<int>(std::round(
+           hectopascals_to_gramspersquarecentimeter(current.pressure) )));
+  const char *pressureUnit = TXT_UNITS_PRES_GRAMSPERSQUARECENTIMETER;
+#endif
+#ifdef UNITS_PRES_POUNDSPERSQUAREINCH
+  snprintf(v.pressure, sizeof(v.pressure), "%.2f", std::round(1e2f *
+           hectopascals_to_poundspersquareinch(current.pressure)) / 1e2f);
+  const char *pressureUnit = TXT_UNITS_PRES_POUNDSPERSQUAREINCH;
+#endif
+  snprintf(v.pressureUnit, sizeof(v.pressureUnit), " %s", pressureUnit);
+
+  // visibility
+#ifdef UNITS_DIST_KILOMETERS
+  float vis = meters_to_kilometers(current.visibility);
+  const char *visibilityUnit = TXT_UNITS_DIST_KILOMETERS;
+  const char *visibilityPrefix = vis >= 10 ? "> " : "";
+#endif
+#ifdef UNITS_DIST_MILES
+  float vis = meters_to_miles(current.visibility);
+  const char *visibilityUnit = TXT_UNITS_DIST_MILES;
+  const char *visibilityPrefix = vis >= 6 ? "> " : "";
+#endif
+  // if visibility is less than 1.95, round to 1 decimal place
+  // else round to int
+  if (vis < 1.95)
+  {
+    snprintf(v.visibility, sizeof(v.visibility), "%s%.1f", visibilityPrefix,
+             std::round(10 * vis) / 10.0);
+  }
+  else
+  {
+    snprintf(v.visibility, sizeof(v.visibility), "%s%d", visibilityPrefix,
+             static_cast<int>(std::round(vis)));
+  }
+  snprintf(v.visibilityUnit, sizeof(v.visibilityUnit), " %s", visibilityUnit);
+
+  // indoor humidity
+  if (!std::isnan(inHumidity))
+  {
+    snprintf(v.inHumidity, sizeof(v.inHumidity), "%d",
+             static_cast<int>(std::round(inHumidity)));
+  }
+  else
+  {
+    snprintf(v.inHumidity, sizeof(v.inHumidity), "--");
+  }
+  return;
+} // end buildCurrentView
+
+/* Fills in the five day forecast, starting with the day in timeInfo.
+ */
+static void buildForecastView(forecast_view_t &v, const owm_daily_t *daily,
+                              tm timeInfo)
+{
+  // the highs and lows, gathered from the days and converted at once
+  float hi[FORECAST_DAYS];
+  float lo[FORECAST_DAYS];
+  for (int i = 0; i < FORECAST_DAYS; ++i)
+  {
+    hi[i] = daily[i].temp.max;
+    lo[i] = daily[i].temp.min;
+  }
+  toTempUnits(hi, hi, FORECAST_DAYS);
+  toTempUnits(lo, lo, FORECAST_DAYS);
+
+  for (int i = 0; i < FORECAST_DAYS; ++i)
+  {
+    forecast_day_view_t &day = v.days[i];
+    day.icon = getDailyForecastBitmap64(daily[i]);
+    // abbrv'd day
+    _strftime_run(day.day, sizeof(day.day), &dayFormat, &timeInfo);
+    timeInfo.tm_wday = (timeInfo.tm_wday + 1) % 7; // increment to next day
+
+    formatWholeTemp(day.hi, sizeof(day.hi), hi[i], TEMP_SUFFIX);
+    formatWholeTemp(day.lo, sizeof(day.lo), lo[i], TEMP_SUFFIX);
+
+// daily forecast precipitation
+#if DISPLAY_DAILY_PRECIP
+    float dailyPrecip;
+#if defined(UNITS_DAILY_PRECIP_POP)
+    dailyPrecip = daily[i].pop * 100;
+    snprintf(day.precip, sizeof(day.precip), "%d%%",
+             static_cast<int>(dailyPrecip));
+#else
+    dailyPrecip = daily[i].snow + daily[i].rain;
+#if defined(UNITS_DAILY_PRECIP_MILLIMETERS)
+    // Round up to nearest mm
+    dailyPrecip = std::round(dailyPrecip);
+    snprintf(day.precip, sizeof(day.precip), "%d %s",
+             static_cast<int>(dailyPrecip), TXT_UNITS_PRECIP_MILLIMETERS);
+#elif defined(UNITS_DAILY_PRECIP_CENTIMETERS)
+    // Round up to nearest 0.1 cm
+    dailyPrecip = millimeters_to_centimeters(dailyPrecip);
+    dailyPrecip = std::round(dailyPrecip * 10) / 10.0f;
+    snprintf(day.precip, sizeof(day.precip), "%.1f %s",
+             dailyPrecip, TXT_UNITS_PRECIP_CENTIMETERS);
+#elif defined(UNITS_DAILY_PRECIP_INCHES)
+    // Round up to nearest 0.1 inch
+    dailyPrecip = millimeters_to_inches(dailyPrecip);
+    dailyPrecip = std::round(dailyPrecip * 10) / 10.0f;
+    snprintf(day.precip, sizeof(day.precip), "%.1f %s",
+             dailyPrecip, TXT_UNITS_PRECIP_INCHES);
+#endif
+#endif
+#if (DISPLAY_DAILY_PRECIP == 2) // smart
+    if (dailyPrecip <= 0.0f)
+    {
+      day.precip[0] = '\0';
+    }
+#endif
+#endif // DISPLAY_DAILY_PRECIP
+  }
+  return;
+} // end buildForecastView
+
+/* Lays out the outlook graph for the first HOURLY_GRAPH_MAX hours.
+ */
+static void buildOutlookView(outlook_view_t &v,
+                             const owm_hourly_series_t &hourly,
+                             const owm_daily_t *daily)
+{
+  const int hours = std::min(HOURLY_GRAPH_MAX, OWM_NUM_HOURLY);
+  const int xPos0 = 350;
+  int xPos1 = DISP_WIDTH;
+  const int yPos0 = 216;
+  const int yPos1 = DISP_HEIGHT - 46;
+
+  // the graphed values, converted to the configured units once
+  float temp[OWM_NUM_HOURLY];
+  float precip[OWM_NUM_HOURLY];
+  toTempUnits(temp, hourly.temp, hours);
+  for (int i = 0; i < hours; ++i)
+  {
+#ifdef UNITS_HOURLY_PRECIP_POP
+    precip[i] = hourly.pop[i] * 100;
+#else
+    precip[i] = hourly.rain_1h[i] + hourly.snow_1h[i];
+#endif
+  }
+#ifdef UNITS_HOURLY_PRECIP_CENTIMETERS
+  millimeters_to_centimeters(precip, precip, hours);
+#endif
+#ifdef UNITS_HOURLY_PRECIP_INCHES
+  millimeters_to_inches(precip, precip, hours);
+#endif
+
+  // calculate y max/min and intervals
+  int yMajorTicks = OUTLOOK_Y_TICKS;
+  float tempMin = temp[0];
+  float tempMax = tempMin;
+  float precipMax = precip[0];
+  int yTempMajorTicks = 5;
+  for (int i = 1; i < hours; ++i)
+  {
+    tempMin = std::min(tempMin, temp[i]);
+    tempMax = std::max(tempMax, temp[i]);
+    precipMax = std::max(precipMax, precip[i]);
+  }
+  int tempBoundMin = static_cast<int>(tempMin - 1)
+                      - modulo(static_cast<int>(tempMin - 1), yTempMajorTicks);
+  int tempBoundMax = static_cast<int>(tempMax + 1)
+   + (yTempMajorTicks - modulo(static_cast<int>(tempMax + 1), yTempMajorTicks));
+
+  // while we have to many major ticks then increase the step
+  while ((tempBoundMax - tempBoundMin) / yTempMajorTicks > yMajorTicks)
+  {
+    yTempMajorTicks += 5;
+    tempBoundMin = static_cast<int>(tempMin - 1)
+                      - modulo(static_cast<int>(tempMin - 1), yTempMajorTicks);
+    tempBoundMax = static_cast<int>(tempMax + 1) + (yTempMajorTicks
+                      - modulo(static_cast<int>(tempMax + 1), yTempMajorTicks));
+  }
+  // while we have not enough major ticks, add to either bound
+  while ((tempBoundMax - tempBoundMin) / yTempMajorTicks < yMajorTicks)
+  {
+    // add to whatever bound is closer to the actual min/max
+    if (tempMin - tempBoundMin <= tempBoundMax - tempMax)
+    {
+      tempBoundMin -= yTempMajorTicks;
+    }
+    else
+    {
+      tempBoundMax += yTempMajorTicks;
+    }
+  }
+
+#ifdef UNITS_HOURLY_PRECIP_POP
+  xPos1 = DISP_WIDTH - 23;
+  float precipBoundMax;
+  if (precipMax > 0)
+  {
+    precipBoundMax = 100.0f;
+  }
+  else
+  {
+    precipBoundMax = 0.0f;
+  }
+  snprintf(v.precipUnit, sizeof(v.precipUnit), "%%");
+#else
+#ifdef UNITS_HOURLY_PRECIP_MILLIMETERS
+  xPos1 = DISP_WIDTH - 24;
+  float precipBoundMax = std::ceil(precipMax); // Round up to nearest mm
+  int yPrecipMajorTickDecimals = (precipBoundMax < 10);
+  snprintf(v.precipUnit, sizeof(v.precipUnit), " %s",
+           TXT_UNITS_PRECIP_MILLIMETERS);
+#endif
+#ifdef UNITS_HOURLY_PRECIP_CENTIMETERS
+  xPos1 = DISP_WIDTH - 25;
+  // Round up to nearest 0.1 cm
+  float precipBoundMax = std::ceil(precipMax * 10) / 10.0f;
+  int yPrecipMajorTickDecimals;
+  if (precipBoundMax < 1)
+  {
+    yPrecipMajorTickDecimals = 2;
+    if (precipBoundMax > 0)
+    {
+      xPos1 -= 6; // needs extra room
+    }
+  }
+  else if (precipBoundMax < 10)
+  {
+    yPrecipMajorTickDecimals = 1;
+  }
+  else
+  {
+    yPrecipMajorTickDecimals = 0;
+  }
+  snprintf(v.precipUnit, sizeof(v.precipUnit), " %s",
+           TXT_UNITS_PRECIP_CENTIMETERS);
+#endif
+#ifdef UNITS_HOURLY_PRECIP_INCHES
+  xPos1 = DISP_WIDTH - 25;
+  // Round up to nearest 0.1 inch
+  float precipBoundMax = std::ceil(precipMax * 10) / 10.0f;
+  int yPrecipMajorTickDecimals;
+  if (precipBoundMax < 1)
+  {
+    yPrecipMajorTickDecimals = 2;
+  }
+  else if (precipBoundMax < 10)
+  {
+    yPrecipMajorTickDecimals = 1;
+  }
+  else
+  {
+    yPrecipMajorTickDecimals = 0;
+  }
+  snprintf(v.precipUnit, sizeof(v.precipUnit), " %s",
+           TXT_UNITS_PRECIP_INCHES);
+#endif
+  float yPrecipMajorTickValue = precipBoundMax / yMajorTicks;
+  float precipRoundingMultiplier = std::pow(10.f, yPrecipMajorTickDecimals);
+#endif
+
+  if (precipBoundMax > 0)
+  { // fill need extra room for labels
+    xPos1 -= 23;
+  }
+
+  v.x0 = xPos0;
+  v.y0 = yPos0;
+  v.x1 = xPos1;
+  v.y1 = yPos1;
+  v.hours = hours;
+  v.showPrecipLabels = precipBoundMax > 0;
+
+  // y axis labels
+  float yInterval = (yPos1 - yPos0) / static_cast<float>(yMajorTicks);
+  for (int i = 0; i <= yMajorTicks; ++i)
+  {
+    v.yTicks[i] = static_cast<int>(yPos0 + (i * yInterval));
+    snprintf(v.tempLabels[i], sizeof(v.tempLabels[i]), "%d%s",
+             tempBoundMax - (i * yTempMajorTicks), TEMP_SUFFIX);
+#ifdef UNITS_HOURLY_PRECIP_POP
+    snprintf(v.precipLabels[i], sizeof(v.precipLabels[i]), "%d", 100 - (i * 20));
+#else
+    float precipTick = precipBoundMax - (i * yPrecipMajorTickValue);
+    precipTick = std::round(precipTick * precipRoundingMultiplier)
+                            / precipRoundingMultiplier;
+    snprintf(v.precipLabels[i], sizeof(v.precipLabels[i]), "%.*f",
+             yPrecipMajorTickDecimals, precipTick);
+#endif
+  }
+
+  int xMaxTicks = 8;
+  int hourInterval = static_cast<int>(ceil(hours
+                                           / static_cast<float>(xMaxTicks)));
+  float xInterval = (xPos1 - xPos0 - 1) / static_cast<float>(hours);
+
+  // temperature line
+  float yPxPerUnit = (yPos1 - yPos0)
+                     / static_cast<float>(tempBoundMax - tempBoundMin);
+  to_plot_y(v.tempY, temp, hours, tempBoundMin, yPxPerUnit, yPos1);
+  for (int i = 0; i < hours; ++i)
+  {
+    v.tempX[i] = static_cast<int>(std::round(xPos0 + (i * xInterval)
+                                             + (0.5 * xInterval) ));
+  }
+
+  // hourly icons, precipitation bars and x axis ticks
+  if (precipBoundMax > 0)
+  {
+    yPxPerUnit = (yPos1 - yPos0) / precipBoundMax;
+    to_plot_y(v.barY, precip, hours, 0.f, yPxPerUnit, yPos1);
+  }
+  else
+  {
+    std::fill(v.barY, v.barY + hours, yPos1);
+  }
+#if DISPLAY_HOURLY_ICONS
+  int day_idx = 0;
+#endif
+  for (int i = 0; i < hours; ++i)
+  {
+    int xTick = static_cast<int>(xPos0 + (i * xInterval));
+    v.hourX[i] = xTick;
+
+#if DISPLAY_HOURLY_ICONS
+    if (i > 0)
+    {
+      if (daily[day_idx].dt + 86400 <= hourly.dt[i]) {
+        ++day_idx;
+      }
+      if ((i % hourInterval) == 0) // skip first and last tick
+      {
+        int y_b = INT_MAX;
+        // find the highest (lowest in coordinate value) temperature point that
+        // exists within the width of the icon.
+        // find closest point above the temperature line where the icon won't
+        // interect the temperature line.
+        // y = mx + b
+        int span = static_cast<int>(std::round(16 / xInterval));
+        int l_idx = std::max(i - 1 - span, 0);
+        int r_idx = std::min(i + span, hours - 1);
+        // left intersecting slope
+        float m_l = (v.tempY[l_idx + 1] - v.tempY[l_idx]) / xInterval;
+        int x_l = xTick - 16 - v.tempX[l_idx];
+        int y_l = static_cast<int>(std::round(m_l * x_l + v.tempY[l_idx]));
+        y_b = std::min(y_l, y_b);
+        // right intersecting slope
+        float m_r = (v.tempY[r_idx] - v.tempY[r_idx - 1]) / xInterval;
+        int x_r = xTick + 16 - v.tempX[r_idx - 1];
+        int y_r = static_cast<int>(std::round(m_r * x_r + v.tempY[r_idx - 1]));
+        y_b = std::min(y_r, y_b);
+        // any peaks in between
+        for (int idx = l_idx + 1; idx < r_idx; ++idx)
+        {
+          y_b = std::min<int>(v.tempY[idx], y_b);
+        }
+        v.icons[i] = getHourlyForecastBitmap32(owmHour(hourly, i),
+                                               daily[day_idx]);
+        v.iconY[i] = y_b;
+      }
+    }
+#endif
+
+    v.barX[i] = static_cast<int>(std::round( xPos0 + 1 + (i * xInterval)));
+
+    if ((i % hourInterval) == 0)
+    {
+      outlook_tick_t &tick = v.ticks[v.numTicks++];
+      tick.hour = i;
+      tick.x = xTick;
+      formatTime(tick.label, sizeof(tick.label), hourly.dt[i], hourFormat);
+    }
+  }
+  v.barX[hours] = static_cast<int>(std::round( xPos0 + 1 + (hours * xInterval)));
+
+  // the last tick mark
+  if ((hours % hourInterval) == 0)
+  {
+    outlook_tick_t &tick = v.ticks[v.numTicks++];
+    tick.hour = hours;
+    tick.x = static_cast<int>(std::round(xPos0 + (hours * xInterval)));
+    formatTime(tick.label, sizeof(tick.label), hourly.dt[hours - 1] + 3600,
+               hourFormat);
+  }
+  return;
+} // end buildOutlookView
+
+/* Builds the view model for the weather screen from the API responses and
+ * indoor readings. timeInfo is the current local time.
+ */
+void buildWeatherView(weather_view_t &view,
+                      const owm_resp_onecall_t &onecall,
+                      const aqi_history_t &aqi_history,
+                      float inTemp, float inHumidity, tm timeInfo)
+{
+  TimingProbe probe("buildWeatherView");
+  // clears the padding too, so views can be compared with memcmp
+  memset(&view, 0, sizeof(view));
+  compileTimeFormats();
+  buildCurrentView(view.current, onecall.current, onecall.daily[0],
+                   aqi_history, inTemp, inHumidity);
+  buildOutlookView(view.outlook, onecall.hourly, onecall.daily);
+  buildForecastView(view.forecast, onecall.daily, timeInfo);
+  return;
+} // end buildWeatherView
@@ -0,0 +1,375 @@
+/* Last-good weather snapshot for esp32-weather-epd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <Arduino.h>
+#include <Logger.h>
+#include <Preferences.h>
+#include <rom/crc.h>
+
+#include "api_response.h"
+#include "aqi_history.h"
+#include "config.h"
+#include "view_model.h"
+#include "weather_cache.h"
+
+// NVS keys, at most 15 characters
+#define KEY_VERSION       "wxVersion"
+#define KEY_INFO          "wxInfo"
+#define KEY_CURRENT       "wxCurrent"
+#define KEY_ONECALL       "wxOnecall"
+#define KEY_AQI_HISTORY   "wxAqiHistory"
+
+// longest weather main/description the parser keeps
+#define CURRENT_TEXT_SIZE 64
+
+/*
+ * Current conditions, saved on their own after every successful update. Their
+ * weather text is copied out of the text arena, so they can be put back into
+ * an older saved One Call response.
+ */
+typedef struct weather_cache_current
+{
+  owm_current_t current;
+  char          main[CURRENT_TEXT_SIZE];
+  char          description[CURRENT_TEXT_SIZE];
+} weather_cache_current_t;
+
+template <typename T>
+static uint32_t crcOf(const T &value)
+{
+  return crc32_le(0, reinterpret_cast<const uint8_t *>(&value), sizeof(value));
+}
+
+static uint32_t crcOfText(uint32_t crc, const char *s)
+{
+  return crc32_le(crc, reinterpret_cast<const uint8_t *>(s), strlen(s) + 1);
+}
+
+/* CRC-32 of the daily forecast. The weather text is hashed by content, since
+ * its offsets into the text arena change whenever the arena is rebuilt, as
+ * keepDailyForecast does.
+ */
+static uint32_t dailyCrc(const owm_resp_onecall_t &onecall)
+{
+  uint32_t crc = 0;
+  for (int i = 0; i < OWM_NUM_DAILY; ++i)
+  {
+    owm_daily_t d = onecall.daily[i];
+    d.weather.main        = 0;
+    d.weather.description = 0;
+    crc = crc32_le(crc, reinterpret_cast<const uint8_t *>(&d), sizeof(d));
+    crc = crcOfText(crc, owmText(onecall, onecall.daily[i].weather.main));
+    crc = crcOfText(crc,
+                    owmText(onecall, onecall.daily[i].weather.description));
+  }
+  return crc;
+} // end dailyCrc
+
+/* Saves the responses from a successful refresh to NVS.
+ *
+ * Current conditions are small and written on every update, so the snapshot
+ * is never older than the last successful one. The rest of the One Call
+ * response, the hourly and daily forecasts, is rewritten only when the daily
+ * forecast changed or every WEATHER_CACHE_INTERVAL minutes, to spare the
+ * flash. In between, the saved forecast is kept as it is. The AQI history is
+ * written whenever it changed.
+ *
+ * The info is cleared first and written last, so a snapshot that was only
+ * partly written when power was lost is never loaded.
+ *
+ * Returns true if the snapshot in NVS is complete.
+ */
+bool saveWeatherCache(const owm_resp_onecall_t   &onecall,
+                      const aqi_history_t        &aqi_history,
+                      const weather_cache_info_t &info)
+{
+  Preferences prefs;
+  if (!prefs.begin(NVS_NAMESPACE, false))
+  {
+    return false;
+  }
+
+  weather_cache_info_t saved = {};
+  bool haveSaved = prefs.getUInt(KEY_VERSION, 0) == WEATHER_CACHE_VERSION
+                && prefs.getBytes(KEY_INFO, &saved, sizeof(saved))
+                   == sizeof(saved);
+
+  weather_cache_current_t current;
+  memset(&current, 0, sizeof(current));
+  current.current = onecall.current;
+  snprintf(current.main, sizeof(current.main), "%s",
+           owmText(onecall, onecall.current.weather.main));
+  snprintf(current.description, sizeof(current.description), "%s",
+           owmText(onecall, onecall.current.weather.description));
+
+  weather_cache_info_t next = info;
+  next.current_crc     = crcOf(current);
+  next.daily_crc       = dailyCrc(onecall);
+  next.aqi_history_crc = crcOf(aqi_history);
+  bool writeCurrent = !haveSaved || next.current_crc != saved.current_crc;
+  bool writeOnecall = !haveSaved
+                   || next.daily_crc != saved.daily_crc
+                   || next.fetched - saved.hourly_fetched
+                      >= WEATHER_CACHE_INTERVAL * 60LL;
+  bool writeAqiHistory = !haveSaved
+                      || next.aqi_history_crc != saved.aqi_history_crc;
+  if (writeOnecall)
+  {
+    next.hourly_fetched = next.fetched;
+    next.onecall_crc    = crcOf(onecall);
+  }
+  else
+  {
+    next.hourly_fetched = saved.hourly_fetched;
+    next.onecall_crc    = saved.onecall_crc;
+  }
+
+  bool ok = true;
+  if (writeCurrent || writeOnecall || writeAqiHistory
+   || memcmp(&next, &saved, sizeof(next)) != 0)
+  {
+    prefs.remove(KEY_INFO);
+    ok = (haveSaved || prefs.putUInt(KEY_VERSION, WEATHER_CACHE_VERSION) > 0)
+      && (!writeCurrent
+          || prefs.putBytes(KEY_CURRENT, &current, sizeof(current))
+             == sizeof(current))
+      && (!writeOnecall
+          || prefs.putBytes(KEY_ONECALL, &onecall, sizeof(onecall))
+             == sizeof(onecall))
+      && (!writeAqiHistory
+          || prefs.putBytes(KEY_AQI_HISTORY, &aqi_history,
+                            sizeof(aqi_history)) == sizeof(aqi_history))
+      && prefs.putBytes(KEY_INFO, &next, sizeof(next)) == sizeof(next);
+  }
+  prefs.end();
+
+#if DEBUG_LEVEL >= 1
+  LOG_INFO("[debug] weather cache saved: %s%s%s%s",
+           writeCurrent ? "current " : "", writeOnecall ? "onecall " : "",
+           writeAqiHistory ? "aqi history " : "", ok ? "ok" : "failed");
+#endif
+  return ok;
+} // end saveWeatherCache
+
+/* Loads the responses saved by saveWeatherCache, with the current conditions
+ * put back into the One Call response, which may be older.
+ *
+ * Returns false if there is no complete snapshot, it was written by firmware
+ * with a different layout, or it doesn't match its CRCs.
+ */
+bool loadWeatherCache(owm_resp_onecall_t   &onecall,
+                      aqi_history_t        &aqi_history,
+                      weather_cache_info_t &info)
+{
+  Preferences prefs;
+  if (!prefs.begin(NVS_NAMESPACE, true))
+  {
+    return false;
+  }
+
+  weather_cache_current_t current;
+  bool ok = prefs.getUInt(KEY_VERSION, 0) == WEATHER_CACHE_VERSION
+         && prefs.getBytesLength(KEY_INFO) == sizeof(info)
+         && prefs.getBytesLength(KEY_CURRENT) == sizeof(current)
+         && prefs.getBytesLength(KEY_ONECALL) == sizeof(onecall)
+         && prefs.getBytesLength(KEY_AQI_HISTORY) == sizeof(aqi_history)
+         && prefs.getBytes(KEY_INFO, &info, sizeof(info)) == sizeof(info)
+         && prefs.getBytes(KEY_CURRENT, &current, sizeof(current))
+            == sizeof(current)
+         && prefs.getBytes(KEY_ONECALL, &onecall, sizeof(onecall))
+            == sizeof(onecall)
+         && prefs.getBytes(KEY_AQI_HISTORY, &aqi_history,
+                           sizeof(aqi_history)) == sizeof(aqi_history)
+         && crcOf(current) == info.current_crc
+         && crcOf(onecall) == info.onecall_crc
+         && crcOf(aqi_history) == info.aqi_history_crc;
+  prefs.end();
+
+  if (ok)
+  {
+    current.main[sizeof(current.main) - 1] = '\0';
+    current.description[sizeof(current.description) - 1] = '\0';
+    onecall.current = current.current;
+    onecall.current.weather.main = owmAddText(onecall, current.main);
+    onecall.current.weather.description = owmAddText(onecall,
+                                                     current.description);
+  }
+  return ok;
+} // end loadWeatherCache
+
+/* Decides what needs to be requested this update.
+ *
+ * Current conditions and the hourly forecast are always requested. The daily
+ * forecast is only requested every DAILY_REFRESH_INTERVAL minutes, or when the
+ * day has changed. Air pollution history is only requested for the hours that
+ * are newer than the cached AQI history, usually just the newest one, and not
+ * at all if there are none yet.
+ */
+fetch_plan_t planWeatherFetch(bool cached,
+                              const owm_resp_onecall_t   &onecall,
+                              const aqi_history_t        &aqi_history,
+                              const weather_cache_info_t &info,
+                              time_t now)
+{
+  fetch_plan_t plan = {true, true, 0};
+  if (!cached)
+  {
+    return plan;
+  }
+
+  // daily dt is midday local time, so compare local days
+  const int64_t today = (now + onecall.timezone_offset) / 86400;
+  plan.daily = now - info.daily_fetched >= DAILY_REFRESH_INTERVAL * 60LL
+            || (onecall.daily[0].dt + onecall.timezone_offset) / 86400 != today;
+
+  const int64_t newest = aqi_history.newest;
+  if (aqi_history.count > 0 && newest > now - 3600LL * AQI_HISTORY_HOURS)
+  { // cached history still overlaps the last 24 hours
+    if (now < newest + 3600)
+    { // the newest hour is already cached
+      plan.air_pollution = false;
+    }
+    else
+    {
+      plan.air_pollution_start = newest + 1;
+    }
+  }
+
+#if DEBUG_LEVEL >= 1
+  LOG_INFO("[debug] fetch daily     : %d", (int)plan.daily);
+  LOG_INFO("[debug] fetch air from  : %lld",
+           plan.air_pollution ? (long long)plan.air_pollution_start : -1LL);
+#endif
+  return plan;
+} // end planWeatherFetch
+
+/* A One Call response fetched without the daily forecast still holds the cached
+ * daily forecast, but parsing it reset the text arena the daily weather
+ * descriptions point into. Adds them back from a copy of the old arena.
+ */
+void keepDailyForecast(owm_resp_onecall_t &r, const char *oldText)
+{
+  for (int i = 0; i < OWM_NUM_DAILY; ++i)
+  {
+    owm_weather_t &w = r.daily[i].weather;
+    w.main        = owmAddText(r, &oldText[w.main]);
+    w.description = owmAddText(r, &oldText[w.description]);
+  }
+} // end keepDailyForecast
+
+/* Drops the first n hours of the hourly forecast h, moving the rest down.
+ */
+static void dropHours(owm_hourly_series_t &h, int n)
+{
+#define DROP_HOURS(field) memmove(&h.field[0], &h.field[n], \
+                                  (OWM_NUM_HOURLY - n) * sizeof(h.field[0]))
+  DROP_HOURS(dt);
+  DROP_HOURS(temp);
+  DROP_HOURS(feels_like);
+  DROP_HOURS(pressure);
+  DROP_HOURS(humidity);
+  DROP_HOURS(dew_point);
+  DROP_HOURS(clouds);
+  DROP_HOURS(uvi);
+  DROP_HOURS(visibility);
+  DROP_HOURS(wind_speed);
+  DROP_HOURS(wind_gust);
+  DROP_HOURS(wind_deg);
+  DROP_HOURS(pop);
+  DROP_HOURS(rain_1h);
+  DROP_HOURS(snow_1h);
+  DROP_HOURS(weather);
+#undef DROP_HOURS
+  return;
+} // end dropHours
+
+/* Moves a cached OneCall response forward so that the first hour of hourly is
+ * the current hour and daily[0] is today. Once the hour current conditions were
+ * fetched in has passed, they are replaced by that hour's forecast. Expired
+ * alerts are dropped.
+ *
+ * Returns false if too little of the forecast is left to fill the display.
+ */
+bool shiftWeatherToNow(owm_resp_onecall_t &r, time_t now)
+{
+  int h = 0;
+  while (h < OWM_NUM_HOURLY && r.hourly.dt[h] + 3600 <= now)
+  {
+    ++h;
+  }
+  if (OWM_NUM_HOURLY - h < HOURLY_GRAPH_MAX)
+  {
+    return false;
+  }
+
+  // daily dt is midday local time, so compare local days
+  const int64_t today = (now + r.timezone_offset) / 86400;
+  int d = 0;
+  while (d < OWM_NUM_DAILY
+      && (r.daily[d].dt + r.timezone_offset) / 86400 < today)
+  {
+    ++d;
+  }
+  if (OWM_NUM_DAILY - d < FORECAST_DAYS)
+  {
+    return false;
+  }
+
+  if (h > 0)
+  {
+    dropHours(r.hourly, h);
+  }
+  // the hourly forecast may have been saved before the current conditions
+  if (r.hourly.dt[0] > r.current.dt)
+  {
+    const owm_hourly_t hour = owmHour(r.hourly, 0);
+    r.current.dt         = now;
+    r.current.temp       = hour.temp;
+    r.current.feels_like = hour.feels_like;
+    r.current.pressure   = hour.pressure;
+    r.current.humidity   = hour.humidity;
+    r.current.dew_point  = hour.dew_point;
+    r.current.clouds     = hour.clouds;
+    r.current.uvi        = hour.uvi;
+    r.current.visibility = hour.visibility;
+    r.current.wind_speed = hour.wind_speed;
+    r.current.wind_gust  = hour.wind_gust;
+    r.current.wind_deg   = hour.wind_deg;
+    r.current.rain_1h    = hour.rain_1h;
+    r.current.snow_1h    = hour.snow_1h;
+    r.current.weather    = hour.weather;
+  }
+  if (d > 0)
+  {
+    memmove(&r.daily[0], &r.daily[d],
+            (OWM_NUM_DAILY - d) * sizeof(r.daily[0]));
+    r.current.sunrise = r.daily[0].sunrise;
+    r.current.sunset  = r.daily[0].sunset;
+  }
+
+  int num_alerts = 0;
+  for (int i = 0; i < r.num_alerts; ++i)
+  {
+    if (r.alerts[i].end > now)
+    {
+      r.alerts[num_alerts++] = r.alerts[i];
+    }
+  }
+  r.num_alerts = num_alerts;
+
+  return true;
+} // end shiftWeatherToNow
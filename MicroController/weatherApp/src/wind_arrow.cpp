@@ -0,0 +1,127 @@
+/* Wind arrow for esp32-weather-epd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include "wind_arrow.h"
+
+// sin of 0 to 90 degrees, with 14 fractional bits
+static const int16_t SIN_TABLE[91] = {
+      0,   286,   572,   857,  1143,  1428,  1713,  1997,  2280,  2563,
+   2845,  3126,  3406,  3686,  3964,  4240,  4516,  4790,  5063,  5334,
+   5604,  5872,  6138,  6402,  6664,  6924,  7182,  7438,  7692,  7943,
+   8192,  8438,  8682,  8923,  9162,  9397,  9630,  9860, 10087, 10311,
+  10531, 10749, 10963, 11174, 11381, 11585, 11786, 11982, 12176, 12365,
+  12551, 12733, 12911, 13085, 13255, 13421, 13583, 13741, 13894, 14044,
+  14189, 14330, 14466, 14598, 14726, 14849, 14968, 15082, 15191, 15296,
+  15396, 15491, 15582, 15668, 15749, 15826, 15897, 15964, 16026, 16083,
+  16135, 16182, 16225, 16262, 16294, 16322, 16344, 16362, 16374, 16382,
+  16384,
+};
+
+// The arrow pointing down, for wind from the north, in 64ths of its size
+// relative to its center: tip, right barb, notch, left barb. This is the shape
+// of the wind_direction_meteorological icons.
+static const int8_t ARROW_X[WIND_ARROW_VERTICES] = {  0,  17,   0, -17};
+static const int8_t ARROW_Y[WIND_ARROW_VERTICES] = { 25, -26, -15, -26};
+
+/* Returns sin of deg degrees, with 14 fractional bits.
+ */
+static int32_t sinDeg(int deg)
+{
+  deg %= 360;
+  if (deg < 0)
+  {
+    deg += 360;
+  }
+  if (deg <= 90)  { return  SIN_TABLE[deg]; }
+  if (deg <= 180) { return  SIN_TABLE[180 - deg]; }
+  if (deg <= 270) { return -SIN_TABLE[deg - 180]; }
+  return -SIN_TABLE[360 - deg];
+} // end sinDeg
+
+/* Finds where the arrow's edges cross the center of the current row.
+ */
+static void crossRow(wind_arrow_t &a)
+{
+  const int32_t yc = (static_cast<int32_t>(a.row) << 8) + 128;
+  int n = 0;
+  for (int i = 0; i < WIND_ARROW_VERTICES; ++i)
+  {
+    int j = (i + 1) % WIND_ARROW_VERTICES;
+    int32_t y0 = a.y[i], y1 = a.y[j];
+    if ((y0 <= yc && yc < y1) || (y1 <= yc && yc < y0))
+    {
+      a.edges[n++] = a.x[i] + (yc - y0) * (a.x[j] - a.x[i]) / (y1 - y0);
+    }
+  }
+  std::sort(a.edges, a.edges + n);
+  a.spans = n / 2;
+  return;
+} // end crossRow
+
+/* Starts rasterizing a size x size wind arrow. windDeg is the meteorological
+ * wind direction, where the wind comes from, the arrow points where it goes.
+ */
+void beginWindArrow(wind_arrow_t &a, int16_t size, int windDeg)
+{
+  const int32_t s = sinDeg(windDeg);
+  const int32_t c = sinDeg(windDeg + 90);
+  const int32_t center = static_cast<int32_t>(size) << 7;
+  for (int i = 0; i < WIND_ARROW_VERTICES; ++i)
+  {
+    // 64ths of size to fixed point, then rotate clockwise on screen
+    int32_t x = ARROW_X[i] * size * 4;
+    int32_t y = ARROW_Y[i] * size * 4;
+    a.x[i] = center + ((x * c - y * s) >> 14);
+    a.y[i] = center + ((x * s + y * c) >> 14);
+  }
+  a.size  = size;
+  a.row   = 0;
+  a.spans = 0;
+  crossRow(a);
+  return;
+} // end beginWindArrow
+
+/* Finds the next run of the arrow's pixels, top to bottom.
+ *
+ * Returns false once the whole arrow has been rasterized.
+ */
+bool nextWindArrowSpan(wind_arrow_t &a, icon_span_t &span)
+{
+  while (a.row < a.size)
+  {
+    while (a.spans > 0)
+    {
+      --a.spans;
+      // pixels whose center is in [x0, x1)
+      int32_t x0 = (a.edges[2 * a.spans] + 127) >> 8;
+      int32_t x1 = (a.edges[2 * a.spans + 1] + 127) >> 8;
+      x0 = std::max<int32_t>(x0, 0);
+      x1 = std::min<int32_t>(x1, a.size);
+      if (x1 > x0)
+      {
+        span = {static_cast<int16_t>(x0), a.row,
+                static_cast<int16_t>(x1 - x0)};
+        return true;
+      }
+    }
+    if (++a.row < a.size)
+    {
+      crossRow(a);
+    }
+  }
+  return false;
+} // end nextWindArrowSpan
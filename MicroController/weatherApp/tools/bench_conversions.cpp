@@ -0,0 +1,187 @@
+/* Host benchmark of the batch unit conversions for esp32-weather-epd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Compares laying out the outlook graph's temperature line and precipitation
+ * bars over the hourly forecast the way buildOutlookView did before the array
+ * conversions, converting each temperature once for the min/max scan and again
+ * for its plot y, with converting every value once with the array forms and
+ * to_plot_y. Random forecasts are laid out both ways first, and every pixel
+ * has to match. Build and run from MicroController:
+ *
+ *   g++ -O2 -std=gnu++17 -I weatherApp/include \
+ *       weatherApp/tools/bench_conversions.cpp weatherApp/src/conversions.cpp \
+ *       -o bench_conversions && ./bench_conversions
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+
+#include "conversions.h"
+
+#define HOURS      48 // OWM_NUM_HOURLY
+#define Y_BASE     354
+#define CHECKS     200000
+#define ROUNDS     2000000
+
+typedef struct forecast
+{
+  float kelvin[HOURS];
+  float precipMm[HOURS];
+} forecast_t;
+
+typedef struct layout
+{
+  float   tempMin, tempMax, precipMax;
+  int16_t tempY[HOURS];
+  int16_t barY[HOURS];
+} layout_t;
+
+typedef float (*temp_fn_t)(float);
+typedef float (*precip_fn_t)(float);
+typedef void (*temp_array_fn_t)(float *, const float *, int);
+typedef void (*precip_array_fn_t)(float *, const float *, int);
+
+/* The layout as it was, one value at a time. pxPerUnit is the same for both
+ * plots, the graph's scale doesn't change the cost.
+ */
+static void layoutScalar(layout_t &l, const forecast_t &f, temp_fn_t toTemp,
+                         precip_fn_t toPrecip, float pxPerUnit)
+{
+  l.tempMin = toTemp(f.kelvin[0]);
+  l.tempMax = l.tempMin;
+  float precipMax = f.precipMm[0];
+  for (int i = 1; i < HOURS; ++i)
+  {
+    float t = toTemp(f.kelvin[i]);
+    l.tempMin = std::min(l.tempMin, t);
+    l.tempMax = std::max(l.tempMax, t);
+    precipMax = std::max(precipMax, f.precipMm[i]);
+  }
+  l.precipMax = toPrecip(precipMax);
+  const int tempBoundMin = static_cast<int>(l.tempMin - 1);
+  for (int i = 0; i < HOURS; ++i)
+  {
+    l.tempY[i] = static_cast<int>(std::round(
+      Y_BASE - (pxPerUnit * (toTemp(f.kelvin[i]) - tempBoundMin))));
+    l.barY[i] = static_cast<int>(std::round(
+      Y_BASE - (pxPerUnit * toPrecip(f.precipMm[i]))));
+  }
+} // end layoutScalar
+
+/* The layout as buildOutlookView does it now, every value converted once.
+ */
+static void layoutBatch(layout_t &l, const forecast_t &f,
+                        temp_array_fn_t toTemp, precip_array_fn_t toPrecip,
+                        float pxPerUnit)
+{
+  float temp[HOURS];
+  float precip[HOURS];
+  toTemp(temp, f.kelvin, HOURS);
+  toPrecip(precip, f.precipMm, HOURS);
+  l.tempMin = temp[0];
+  l.tempMax = temp[0];
+  l.precipMax = precip[0];
+  for (int i = 1; i < HOURS; ++i)
+  {
+    l.tempMin = std::min(l.tempMin, temp[i]);
+    l.tempMax = std::max(l.tempMax, temp[i]);
+    l.precipMax = std::max(l.precipMax, precip[i]);
+  }
+  const int tempBoundMin = static_cast<int>(l.tempMin - 1);
+  to_plot_y(l.tempY, temp, HOURS, tempBoundMin, pxPerUnit, Y_BASE);
+  to_plot_y(l.barY, precip, HOURS, 0.f, pxPerUnit, Y_BASE);
+} // end layoutBatch
+
+static bool sameLayout(const layout_t &a, const layout_t &b)
+{
+  return a.tempMin == b.tempMin && a.tempMax == b.tempMax
+      && a.precipMax == b.precipMax
+      && std::equal(a.tempY, a.tempY + HOURS, b.tempY)
+      && std::equal(a.barY, a.barY + HOURS, b.barY);
+} // end sameLayout
+
+static std::mt19937 rng(49);
+
+static void randomForecast(forecast_t &f)
+{
+  std::uniform_real_distribution<float> kelvin(230.f, 330.f);
+  std::uniform_real_distribution<float> mm(0.f, 30.f);
+  for (int i = 0; i < HOURS; ++i)
+  {
+    f.kelvin[i] = kelvin(rng);
+    f.precipMm[i] = rng() % 4 == 0 ? mm(rng) : 0.f;
+  }
+} // end randomForecast
+
+template <typename F>
+static double nsPerLayout(F layout)
+{
+  forecast_t f;
+  randomForecast(f);
+  volatile int16_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < ROUNDS; ++r)
+  {
+    layout_t l;
+    layout(l, f);
+    sink = sink + l.tempY[r % HOURS];
+    f.kelvin[r % HOURS] += 1e-4f; // keep the work from being hoisted
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count()
+         / ROUNDS;
+} // end nsPerLayout
+
+int main()
+{
+  std::uniform_real_distribution<float> pxPerUnit(1.f, 30.f);
+  long mismatches = 0;
+  for (int c = 0; c < CHECKS; ++c)
+  {
+    forecast_t f;
+    randomForecast(f);
+    const float px = pxPerUnit(rng);
+    layout_t scalar, batch;
+    if (c % 2 == 0)
+    {
+      layoutScalar(scalar, f, kelvin_to_celsius, millimeters_to_centimeters,
+                   px);
+      layoutBatch(batch, f, kelvin_to_celsius, millimeters_to_centimeters, px);
+    }
+    else
+    {
+      layoutScalar(scalar, f, kelvin_to_fahrenheit, millimeters_to_inches, px);
+      layoutBatch(batch, f, kelvin_to_fahrenheit, millimeters_to_inches, px);
+    }
+    mismatches += !sameLayout(scalar, batch);
+  }
+
+  double scalar = nsPerLayout([](layout_t &l, const forecast_t &f) {
+    layoutScalar(l, f, kelvin_to_celsius, millimeters_to_centimeters, 2.f);
+  });
+  double batch = nsPerLayout([](layout_t &l, const forecast_t &f) {
+    layoutBatch(l, f, kelvin_to_celsius, millimeters_to_centimeters, 2.f);
+  });
+
+  printf("%d hour layouts compared : %ld differ\n", HOURS, mismatches);
+  printf("one value at a time     : %8.1f ns\n", scalar);
+  printf("array conversions       : %8.1f ns\n", batch);
+  return mismatches == 0 ? 0 : 1;
+} // end main
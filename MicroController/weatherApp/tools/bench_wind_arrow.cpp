@@ -0,0 +1,102 @@
+/* Host benchmark of the wind arrow for esp32-weather-epd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Compares drawing the 24x24 wind arrow with wind_arrow.cpp against blitting
+ * the 24x24 wind direction bitmap it replaced, the way drawInvertedBitmap does.
+ * Both draw into a 1-bpp frame buffer. Build and run from MicroController:
+ *
+ *   g++ -O2 -std=gnu++17 -I weatherApp/include \
+ *       -I weatherApp/lib/esp32-weather-epd-assets \
+ *       weatherApp/tools/bench_wind_arrow.cpp weatherApp/src/wind_arrow.cpp \
+ *       -o bench_wind_arrow && ./bench_wind_arrow
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#define PROGMEM
+#include "icons/24x24/wind_direction_meteorological_0deg_24x24.h"
+#include "wind_arrow.h"
+
+#define SIZE   24
+#define ROUNDS 20000
+
+static uint8_t frame[SIZE * SIZE / 8];
+
+static void setPixel(int16_t x, int16_t y)
+{
+  frame[(y * SIZE + x) / 8] |= 0x80 >> (x & 7);
+}
+
+// what Adafruit_GFX::drawInvertedBitmap does, one pixel at a time
+static void blitBitmap(const uint8_t *bitmap)
+{
+  const int16_t rowBytes = (SIZE + 7) / 8;
+  for (int16_t y = 0; y < SIZE; ++y)
+  {
+    for (int16_t x = 0; x < SIZE; ++x)
+    {
+      if (!(bitmap[y * rowBytes + x / 8] & (0x80 >> (x & 7))))
+      {
+        setPixel(x, y);
+      }
+    }
+  }
+}
+
+static void rasterizeArrow(int windDeg)
+{
+  wind_arrow_t a;
+  icon_span_t span;
+  beginWindArrow(a, SIZE, windDeg);
+  while (nextWindArrowSpan(a, span))
+  {
+    for (int16_t x = span.x; x < span.x + span.w; ++x)
+    {
+      setPixel(x, span.y);
+    }
+  }
+}
+
+template <typename F>
+static double nsPerDraw(F draw)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < ROUNDS; ++i)
+  {
+    memset(frame, 0, sizeof(frame));
+    draw(i % 360);
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count()
+         / ROUNDS;
+}
+
+int main()
+{
+  double blit = nsPerDraw([](int) {
+    blitBitmap(wind_direction_meteorological_0deg_24x24);
+  });
+  double raster = nsPerDraw([](int deg) { rasterizeArrow(deg); });
+
+  printf("24x24 bitmap blit    : %8.1f ns\n", blit);
+  printf("24x24 arrow raster   : %8.1f ns\n", raster);
+  printf("flash per direction  : %8zu B bitmap, 0 B raster\n",
+         sizeof(wind_direction_meteorological_0deg_24x24));
+  return 0;
+}
@@ -0,0 +1,657 @@
+/* Host check of the streaming API response parser for esp32-weather-epd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Parses the One Call and air pollution payloads in a directory with
+ * deserializeOneCall/deserializeAirQuality, and again with ArduinoJson the way
+ * they were parsed before the streaming reader, then compares the two field by
+ * field. The streaming parse is repeated with the input arriving a few bytes
+ * at a time, so values split across chunks are covered too. Also prints the
+ * parse time and the peak heap of each path. ArduinoJson's pool holds
+ * pointers, so its peak on a 64-bit host is up to twice what the ESP32 needs.
+ *
+ * The payloads in tools/fixtures are written in the shape of the 3.0
+ * responses. tools/record_payload.py records and anonymizes live ones to check
+ * instead.
+ *
+ * Needs ArduinoJson 7, e.g. the copy PlatformIO fetches into
+ * .pio/libdeps/weatherApp. Build and run from MicroController:
+ *
+ *   g++ -O2 -std=gnu++17 -I weatherApp/tools/host -I weatherApp/include \
+ *       -I $ARDUINOJSON/src weatherApp/tools/check_api_response.cpp \
+ *       weatherApp/src/api_response.cpp weatherApp/src/json_stream.cpp \
+ *       -o check_api_response && ./check_api_response weatherApp/tools/fixtures
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+
+#include <ArduinoJson.h>
+#include "api_response.h"
+#include "config.h"
+#include "json_stream.h"
+
+#define ROUNDS 200
+
+// feeds a payload to the parser at most chunk bytes at a time
+class FixtureClient : public WiFiClient
+{
+public:
+  FixtureClient(const std::string &data, size_t chunk)
+    : data(data), chunk(chunk), pos(0) {}
+
+  int available() override
+  {
+    size_t left = data.size() - pos;
+    return static_cast<int>(left < chunk ? left : chunk);
+  }
+
+  size_t readBytes(char *buffer, size_t length) override
+  {
+    size_t n = data.size() - pos;
+    n = n < length ? n : length;
+    memcpy(buffer, data.data() + pos, n);
+    pos += n;
+    return n;
+  }
+
+private:
+  const std::string &data;
+  size_t chunk;
+  size_t pos;
+};
+
+static owm_resp_onecall_t       expectedOneCall;
+static owm_resp_onecall_t       actualOneCall;
+static owm_resp_air_pollution_t expectedAir;
+static owm_resp_air_pollution_t actualAir;
+
+// weather icons as the API sends them, the streaming parser keeps owm_icon_t
+static char expectedIcons[1 + OWM_NUM_HOURLY + OWM_NUM_DAILY][4];
+
+static int compared;
+static int mismatches;
+
+/* Heap in use and its peak since resetHeapPeak, counted through global new
+ * and the allocator of each JsonDocument. A size header in front of each
+ * block lets frees be counted too.
+ */
+static size_t heapInUse;
+static size_t heapPeak;
+
+static void *countedAlloc(void *block, size_t size)
+{
+  if (block == nullptr)
+  {
+    return nullptr;
+  }
+  *static_cast<size_t *>(block) = size;
+  heapInUse += size;
+  heapPeak = heapInUse > heapPeak ? heapInUse : heapPeak;
+  return static_cast<max_align_t *>(block) + 1;
+}
+
+static void *countedMalloc(size_t size)
+{
+  return countedAlloc(malloc(sizeof(max_align_t) + size), size);
+}
+
+static void countedFree(void *ptr)
+{
+  if (ptr != nullptr)
+  {
+    max_align_t *block = static_cast<max_align_t *>(ptr) - 1;
+    heapInUse -= *reinterpret_cast<size_t *>(block);
+    free(block);
+  }
+}
+
+static void *countedRealloc(void *ptr, size_t size)
+{
+  if (ptr == nullptr)
+  {
+    return countedMalloc(size);
+  }
+  max_align_t *block = static_cast<max_align_t *>(ptr) - 1;
+  heapInUse -= *reinterpret_cast<size_t *>(block);
+  void *moved = realloc(block, sizeof(max_align_t) + size);
+  if (moved == nullptr)
+  {
+    heapInUse += *reinterpret_cast<size_t *>(block);
+    return nullptr;
+  }
+  return countedAlloc(moved, size);
+}
+
+static void resetHeapPeak()
+{
+  heapPeak = heapInUse;
+}
+
+void *operator new(size_t size)
+{
+  void *ptr = countedMalloc(size);
+  if (ptr == nullptr)
+  {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void *ptr) noexcept
+{
+  countedFree(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+  countedFree(ptr);
+}
+
+class CountingAllocator : public ArduinoJson::Allocator
+{
+public:
+  void *allocate(size_t size) override
+  {
+    return countedMalloc(size);
+  }
+
+  void deallocate(void *ptr) override
+  {
+    countedFree(ptr);
+  }
+
+  void *reallocate(void *ptr, size_t new_size) override
+  {
+    return countedRealloc(ptr, new_size);
+  }
+};
+
+static CountingAllocator countingAllocator;
+
+static bool readFile(const std::string &path, std::string &out)
+{
+  FILE *f = fopen(path.c_str(), "rb");
+  if (f == nullptr)
+  {
+    return false;
+  }
+  char buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+  {
+    out.append(buf, n);
+  }
+  fclose(f);
+  return true;
+} // end readFile
+
+static void copyString(char *dst, size_t size, const char *src)
+{
+  snprintf(dst, size, "%s", src ? src : "");
+}
+
+/* The ArduinoJson parse, as deserializeOneCall did it before the streaming
+ * reader, writing into the current structs.
+ */
+static void referenceWeather(JsonObject weather, owm_resp_onecall_t &r,
+                             owm_weather_t &w, char *icon)
+{
+  w.id          = weather["id"].as<int>();
+  w.main        = owmAddText(r, weather["main"]       .as<const char *>());
+  w.description = owmAddText(r, weather["description"].as<const char *>());
+  copyString(icon, 4, weather["icon"].as<const char *>());
+}
+
+static DeserializationError referenceOneCall(const std::string &json,
+                                             owm_resp_onecall_t &r)
+{
+  JsonDocument doc(&countingAllocator);
+  DeserializationError error = deserializeJson(doc, json);
+  if (error)
+  {
+    return error;
+  }
+
+  r.text[0] = '\0';
+  r.text_len = 1;
+  r.lat             = doc["lat"]            .as<float>();
+  r.lon             = doc["lon"]            .as<float>();
+  copyString(r.timezone, sizeof(r.timezone), doc["timezone"].as<const char *>());
+  r.timezone_offset = doc["timezone_offset"].as<int>();
+
+  JsonObject current = doc["current"];
+  r.current.dt         = current["dt"]        .as<int64_t>();
+  r.current.sunrise    = current["sunrise"]   .as<int64_t>();
+  r.current.sunset     = current["sunset"]    .as<int64_t>();
+  r.current.temp       = current["temp"]      .as<float>();
+  r.current.feels_like = current["feels_like"].as<float>();
+  r.current.pressure   = current["pressure"]  .as<int>();
+  r.current.humidity   = current["humidity"]  .as<int>();
+  r.current.dew_point  = current["dew_point"] .as<float>();
+  r.current.clouds     = current["clouds"]    .as<int>();
+  r.current.uvi        = current["uvi"]       .as<float>();
+  r.current.visibility = current["visibility"].as<int>();
+  r.current.wind_speed = current["wind_speed"].as<float>();
+  r.current.wind_gust  = current["wind_gust"] .as<float>();
+  r.current.wind_deg   = current["wind_deg"]  .as<int>();
+  r.current.rain_1h    = current["rain"]["1h"].as<float>();
+  r.current.snow_1h    = current["snow"]["1h"].as<float>();
+  referenceWeather(current["weather"][0], r, r.current.weather,
+                   expectedIcons[0]);
+
+  int i = 0;
+  for (JsonObject hourly : doc["hourly"].as<JsonArray>())
+  {
+    owm_hourly_t h = {};
+    h.dt         = hourly["dt"]        .as<int64_t>();
+    h.temp       = hourly["temp"]      .as<float>();
+    h.feels_like = hourly["feels_like"].as<float>();
+    h.pressure   = hourly["pressure"]  .as<int>();
+    h.humidity   = hourly["humidity"]  .as<int>();
+    h.dew_point  = hourly["dew_point"] .as<float>();
+    h.clouds     = hourly["clouds"]    .as<int>();
+    h.uvi        = hourly["uvi"]       .as<float>();
+    h.visibility = hourly["visibility"].as<int>();
+    h.wind_speed = hourly["wind_speed"].as<float>();
+    h.wind_gust  = hourly["wind_gust"] .as<float>();
+    h.wind_deg   = hourly["wind_deg"]  .as<int>();
+    h.pop        = hourly["pop"]       .as<float>();
+    h.rain_1h    = hourly["rain"]["1h"].as<float>();
+    h.snow_1h    = hourly["snow"]["1h"].as<float>();
+    referenceWeather(hourly["weather"][0], r, h.weather,
+                     expectedIcons[1 + i]);
+    owmSetHour(r.hourly, i, h);
+
+    if (i == OWM_NUM_HOURLY - 1)
+    {
+      break;
+    }
+    ++i;
+  }
+
+  i = 0;
+  for (JsonObject daily : doc["daily"].as<JsonArray>())
+  {
+    owm_daily_t &d = r.daily[i];
+    d.dt         = daily["dt"]        .as<int64_t>();
+    d.sunrise    = daily["sunrise"]   .as<int64_t>();
+    d.sunset     = daily["sunset"]    .as<int64_t>();
+    d.moonrise   = daily["moonrise"]  .as<int64_t>();
+    d.moonset    = daily["moonset"]   .as<int64_t>();
+    d.moon_phase = daily["moon_phase"].as<float>();
+    JsonObject daily_temp = daily["temp"];
+    d.temp.morn  = daily_temp["morn"] .as<float>();
+    d.temp.day   = daily_temp["day"]  .as<float>();
+    d.temp.eve   = daily_temp["eve"]  .as<float>();
+    d.temp.night = daily_temp["night"].as<float>();
+    d.temp.min   = daily_temp["min"]  .as<float>();
+    d.temp.max   = daily_temp["max"]  .as<float>();
+    JsonObject daily_feels_like = daily["feels_like"];
+    d.feels_like.morn  = daily_feels_like["morn"] .as<float>();
+    d.feels_like.day   = daily_feels_like["day"]  .as<float>();
+    d.feels_like.eve   = daily_feels_like["eve"]  .as<float>();
+    d.feels_like.night = daily_feels_like["night"].as<float>();
+    d.pressure   = daily["pressure"]  .as<int>();
+    d.humidity   = daily["humidity"]  .as<int>();
+    d.dew_point  = daily["dew_point"] .as<float>();
+    d.clouds     = daily["clouds"]    .as<int>();
+    d.uvi        = daily["uvi"]       .as<float>();
+    d.visibility = daily["visibility"].as<int>();
+    d.wind_speed = daily["wind_speed"].as<float>();
+    d.wind_gust  = daily["wind_gust"] .as<float>();
+    d.wind_deg   = daily["wind_deg"]  .as<int>();
+    d.pop        = daily["pop"]       .as<float>();
+    d.rain       = daily["rain"]      .as<float>();
+    d.snow       = daily["snow"]      .as<float>();
+    referenceWeather(daily["weather"][0], r, d.weather,
+                     expectedIcons[1 + OWM_NUM_HOURLY + i]);
+
+    if (i == OWM_NUM_DAILY - 1)
+    {
+      break;
+    }
+    ++i;
+  }
+
+#if DISPLAY_ALERTS
+  r.num_alerts = 0;
+  for (JsonObject alerts : doc["alerts"].as<JsonArray>())
+  {
+    owm_alerts_t &a = r.alerts[r.num_alerts++];
+    copyString(a.event, sizeof(a.event), alerts["event"].as<const char *>());
+    a.start = alerts["start"].as<int64_t>();
+    a.end   = alerts["end"]  .as<int64_t>();
+    copyString(a.tags, sizeof(a.tags), alerts["tags"][0].as<const char *>());
+
+    if (r.num_alerts == OWM_NUM_ALERTS)
+    {
+      break;
+    }
+  }
+#endif
+  return error;
+} // end referenceOneCall
+
+static DeserializationError referenceAirQuality(const std::string &json,
+                                                owm_resp_air_pollution_t &r)
+{
+  JsonDocument doc(&countingAllocator);
+  DeserializationError error = deserializeJson(doc, json);
+  if (error)
+  {
+    return error;
+  }
+
+  r.coord.lat = doc["coord"]["lat"].as<float>();
+  r.coord.lon = doc["coord"]["lon"].as<float>();
+
+  int i = 0;
+  for (JsonObject list : doc["list"].as<JsonArray>())
+  {
+    r.main_aqi[i] = list["main"]["aqi"].as<int>();
+    JsonObject list_components = list["components"];
+    r.components.co[i]    = list_components["co"]   .as<float>();
+    r.components.no[i]    = list_components["no"]   .as<float>();
+    r.components.no2[i]   = list_components["no2"]  .as<float>();
+    r.components.o3[i]    = list_components["o3"]   .as<float>();
+    r.components.so2[i]   = list_components["so2"]  .as<float>();
+    r.components.pm2_5[i] = list_components["pm2_5"].as<float>();
+    r.components.pm10[i]  = list_components["pm10"] .as<float>();
+    r.components.nh3[i]   = list_components["nh3"]  .as<float>();
+    r.dt[i] = list["dt"].as<int64_t>();
+
+    if (i == OWM_NUM_AIR_POLLUTION - 1)
+    {
+      break;
+    }
+    ++i;
+  }
+  return error;
+} // end referenceAirQuality
+
+/* Field comparisons. Floats may differ by one ulp, ArduinoJson parses to double
+ * and rounds again while the streaming reader uses strtof.
+ */
+static void report(const char *field, int index, const std::string &expected,
+                   const std::string &actual)
+{
+  ++mismatches;
+  if (mismatches <= 20)
+  {
+    printf("  %s, entry %d: expected %s, got %s\n", field, index,
+           expected.c_str(), actual.c_str());
+  }
+}
+
+static void check(const char *field, int index, int64_t expected,
+                  int64_t actual)
+{
+  ++compared;
+  if (expected != actual)
+  {
+    report(field, index, std::to_string(expected), std::to_string(actual));
+  }
+}
+
+static void checkFloat(const char *field, int index, float expected,
+                       float actual)
+{
+  ++compared;
+  if (expected != actual && nextafterf(expected, actual) != actual)
+  {
+    report(field, index, std::to_string(expected), std::to_string(actual));
+  }
+}
+
+static void checkString(const char *field, int index, const char *expected,
+                        const char *actual)
+{
+  ++compared;
+  if (strcmp(expected, actual) != 0)
+  {
+    report(field, index, expected, actual);
+  }
+}
+
+static void checkWeather(const char *field, int index,
+                         const owm_weather_t &expected, const char *icon,
+                         const owm_weather_t &actual)
+{
+  char actualIcon[8];
+  snprintf(actualIcon, sizeof(actualIcon), "%02d%c", actual.icon >> 1,
+           (actual.icon & 1) ? 'n' : 'd');
+  check(field, index, expected.id, actual.id);
+  checkString(field, index, owmText(expectedOneCall, expected.main),
+              owmText(actualOneCall, actual.main));
+  checkString(field, index, owmText(expectedOneCall, expected.description),
+              owmText(actualOneCall, actual.description));
+  checkString(field, index, icon, actualIcon);
+}
+
+#define CHECK(s, field, i)       check(#s #field, i, expected.s field, actual.s field)
+#define CHECK_FLOAT(s, field, i) checkFloat(#s #field, i, expected.s field, actual.s field)
+
+static void compareOneCall()
+{
+  const owm_resp_onecall_t &expected = expectedOneCall;
+  const owm_resp_onecall_t &actual = actualOneCall;
+
+  CHECK_FLOAT(, lat, 0);
+  CHECK_FLOAT(, lon, 0);
+  checkString("timezone", 0, expected.timezone, actual.timezone);
+  CHECK(, timezone_offset, 0);
+
+  CHECK(current., dt, 0);
+  CHECK(current., sunrise, 0);
+  CHECK(current., sunset, 0);
+  CHECK_FLOAT(current., temp, 0);
+  CHECK_FLOAT(current., feels_like, 0);
+  CHECK(current., pressure, 0);
+  CHECK(current., humidity, 0);
+  CHECK_FLOAT(current., dew_point, 0);
+  CHECK(current., clouds, 0);
+  CHECK_FLOAT(current., uvi, 0);
+  CHECK(current., visibility, 0);
+  CHECK_FLOAT(current., wind_speed, 0);
+  CHECK_FLOAT(current., wind_gust, 0);
+  CHECK(current., wind_deg, 0);
+  CHECK_FLOAT(current., rain_1h, 0);
+  CHECK_FLOAT(current., snow_1h, 0);
+  checkWeather("current.weather", 0, expected.current.weather,
+               expectedIcons[0], actual.current.weather);
+
+  for (int i = 0; i < OWM_NUM_HOURLY; ++i)
+  {
+    CHECK(hourly., dt[i], i);
+    CHECK_FLOAT(hourly., temp[i], i);
+    CHECK_FLOAT(hourly., feels_like[i], i);
+    CHECK(hourly., pressure[i], i);
+    CHECK(hourly., humidity[i], i);
+    CHECK_FLOAT(hourly., dew_point[i], i);
+    CHECK(hourly., clouds[i], i);
+    CHECK_FLOAT(hourly., uvi[i], i);
+    CHECK(hourly., visibility[i], i);
+    CHECK_FLOAT(hourly., wind_speed[i], i);
+    CHECK_FLOAT(hourly., wind_gust[i], i);
+    CHECK(hourly., wind_deg[i], i);
+    CHECK_FLOAT(hourly., pop[i], i);
+    CHECK_FLOAT(hourly., rain_1h[i], i);
+    CHECK_FLOAT(hourly., snow_1h[i], i);
+    checkWeather("hourly.weather", i, expected.hourly.weather[i],
+                 expectedIcons[1 + i], actual.hourly.weather[i]);
+  }
+
+  for (int i = 0; i < OWM_NUM_DAILY; ++i)
+  {
+    CHECK(daily[i]., dt, i);
+    CHECK(daily[i]., sunrise, i);
+    CHECK(daily[i]., sunset, i);
+    CHECK(daily[i]., moonrise, i);
+    CHECK(daily[i]., moonset, i);
+    CHECK_FLOAT(daily[i]., moon_phase, i);
+    CHECK_FLOAT(daily[i]., temp.morn, i);
+    CHECK_FLOAT(daily[i]., temp.day, i);
+    CHECK_FLOAT(daily[i]., temp.eve, i);
+    CHECK_FLOAT(daily[i]., temp.night, i);
+    CHECK_FLOAT(daily[i]., temp.min, i);
+    CHECK_FLOAT(daily[i]., temp.max, i);
+    CHECK_FLOAT(daily[i]., feels_like.morn, i);
+    CHECK_FLOAT(daily[i]., feels_like.day, i);
+    CHECK_FLOAT(daily[i]., feels_like.eve, i);
+    CHECK_FLOAT(daily[i]., feels_like.night, i);
+    CHECK(daily[i]., pressure, i);
+    CHECK(daily[i]., humidity, i);
+    CHECK_FLOAT(daily[i]., dew_point, i);
+    CHECK(daily[i]., clouds, i);
+    CHECK_FLOAT(daily[i]., uvi, i);
+    CHECK(daily[i]., visibility, i);
+    CHECK_FLOAT(daily[i]., wind_speed, i);
+    CHECK_FLOAT(daily[i]., wind_gust, i);
+    CHECK(daily[i]., wind_deg, i);
+    CHECK_FLOAT(daily[i]., pop, i);
+    CHECK_FLOAT(daily[i]., rain, i);
+    CHECK_FLOAT(daily[i]., snow, i);
+    checkWeather("daily.weather", i, expected.daily[i].weather,
+                 expectedIcons[1 + OWM_NUM_HOURLY + i],
+                 actual.daily[i].weather);
+  }
+
+  CHECK(, num_alerts, 0);
+  for (int i = 0; i < expected.num_alerts; ++i)
+  {
+    checkString("alerts.event", i, expected.alerts[i].event,
+                actual.alerts[i].event);
+    CHECK(alerts[i]., start, i);
+    CHECK(alerts[i]., end, i);
+    checkString("alerts.tags", i, expected.alerts[i].tags,
+                actual.alerts[i].tags);
+  }
+} // end compareOneCall
+
+static void compareAirQuality()
+{
+  const owm_resp_air_pollution_t &expected = expectedAir;
+  const owm_resp_air_pollution_t &actual = actualAir;
+
+  CHECK_FLOAT(coord., lat, 0);
+  CHECK_FLOAT(coord., lon, 0);
+  for (int i = 0; i < OWM_NUM_AIR_POLLUTION; ++i)
+  {
+    CHECK(, main_aqi[i], i);
+    CHECK_FLOAT(components., co[i], i);
+    CHECK_FLOAT(components., no[i], i);
+    CHECK_FLOAT(components., no2[i], i);
+    CHECK_FLOAT(components., o3[i], i);
+    CHECK_FLOAT(components., so2[i], i);
+    CHECK_FLOAT(components., pm2_5[i], i);
+    CHECK_FLOAT(components., pm10[i], i);
+    CHECK_FLOAT(components., nh3[i], i);
+    CHECK(, dt[i], i);
+  }
+} // end compareAirQuality
+
+template <typename F>
+static double usPerParse(F parse)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < ROUNDS; ++i)
+  {
+    parse();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::micro>(end - start).count()
+         / ROUNDS;
+}
+
+int main(int argc, char **argv)
+{
+  std::string dir = argc > 1 ? argv[1] : "weatherApp/tools/fixtures";
+  std::string onecall, air;
+  if (!readFile(dir + "/onecall.json", onecall)
+   || !readFile(dir + "/air_pollution.json", air))
+  {
+    printf("can't read the payloads in %s\n", dir.c_str());
+    return 1;
+  }
+
+  size_t heapBase = heapInUse;
+  resetHeapPeak();
+  DeserializationError onecallError = referenceOneCall(onecall,
+                                                       expectedOneCall);
+  size_t referenceOneCallHeap = heapPeak - heapBase;
+  resetHeapPeak();
+  DeserializationError airError = referenceAirQuality(air, expectedAir);
+  size_t referenceAirHeap = heapPeak - heapBase;
+  if (onecallError || airError)
+  {
+    printf("ArduinoJson can't parse the payloads in %s\n", dir.c_str());
+    return 1;
+  }
+
+  const size_t chunks[] = {1, 7, JSON_STREAM_BUFFER_SIZE, onecall.size()};
+  size_t streamingOneCallHeap = 0;
+  size_t streamingAirHeap = 0;
+  for (size_t chunk : chunks)
+  {
+    int comparedBefore = compared;
+    int before = mismatches;
+    memset(&actualOneCall, 0, sizeof(actualOneCall));
+    memset(&actualAir, 0, sizeof(actualAir));
+    FixtureClient onecallClient(onecall, chunk);
+    FixtureClient airClient(air, chunk);
+    resetHeapPeak();
+    onecallError = deserializeOneCall(onecallClient, actualOneCall);
+    size_t onecallHeap = heapPeak - heapBase;
+    resetHeapPeak();
+    airError = deserializeAirQuality(airClient, actualAir);
+    size_t airHeap = heapPeak - heapBase;
+    streamingOneCallHeap = onecallHeap > streamingOneCallHeap
+                           ? onecallHeap : streamingOneCallHeap;
+    streamingAirHeap = airHeap > streamingAirHeap ? airHeap : streamingAirHeap;
+    if (onecallError || airError)
+    {
+      printf("%5zu byte chunks: %s / %s\n", chunk, onecallError.c_str(),
+             airError.c_str());
+      ++mismatches;
+      continue;
+    }
+    compareOneCall();
+    compareAirQuality();
+    printf("%5zu byte chunks: %d fields compared, %d mismatches\n", chunk,
+           compared - comparedBefore, mismatches - before);
+  }
+
+  double reference = usPerParse([&]() {
+    referenceOneCall(onecall, expectedOneCall);
+  });
+  double streaming = usPerParse([&]() {
+    FixtureClient client(onecall, JSON_STREAM_BUFFER_SIZE);
+    deserializeOneCall(client, actualOneCall);
+  });
+  printf("One Call parse, ArduinoJson : %8.1f us\n", reference);
+  printf("One Call parse, streaming   : %8.1f us\n", streaming);
+  printf("Peak heap, ArduinoJson      : %6zu B One Call, %6zu B air\n",
+         referenceOneCallHeap, referenceAirHeap);
+  printf("Peak heap, streaming        : %6zu B One Call, %6zu B air\n",
+         streamingOneCallHeap, streamingAirHeap);
+
+  return mismatches ? 1 : 0;
+}
@@ -0,0 +1,240 @@
+/* Host check of the AQI history for esp32-weather-epd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Compares the window averages of aqi_history.cpp, taken from prefix sums,
+ * with averages summed hour by hour from a plain list of the same hours. The
+ * hours are random, with gaps short enough to be filled in and long enough to
+ * start the history over. They are appended either as one air pollution
+ * response, the way the first update builds the history, or a few at a time
+ * over a long run like the updates after it, so the sums are rebased many
+ * times. Build and run from MicroController:
+ *
+ *   gcc -O2 -ffunction-sections \
+ *       -c weatherApp/lib/pollutant-concentration-to-aqi/aqi.c -o aqi.o
+ *   g++ -O2 -std=gnu++17 -I weatherApp/tools/host -I weatherApp/include \
+ *       -I weatherApp/lib/pollutant-concentration-to-aqi \
+ *       -I $ARDUINOJSON/src \
+ *       weatherApp/tools/check_aqi_history.cpp weatherApp/src/aqi_history.cpp \
+ *       aqi.o -Wl,--gc-sections -o check_aqi_history && ./check_aqi_history
+ *
+ * api_response.h needs ArduinoJson 7, e.g. the copy PlatformIO fetches into
+ * .pio/libdeps/weatherApp, which ARDUINOJSON points to. The scale
+ * descriptions in aqi.c need the locale's text, which the check doesn't use,
+ * so they are dropped at link time.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "aqi_history.h"
+
+#define ROUNDS        2000
+#define LONG_RUN_DAYS 400
+
+typedef struct hour_sample
+{
+  int64_t dt;
+  float   conc[AQI_NUM_POLLUTANTS];
+} hour_sample_t;
+
+// concentrations up to about the top of the scales, in μg/m^3
+static const float MAX_CONC[AQI_NUM_POLLUTANTS] = {
+  30000.f, 400.f, 1000.f, 2000.f, 800.f, 2500.f, 600.f, 500.f};
+
+static std::mt19937 rng(45);
+
+/* Returns the hours of a random series of n samples, starting after start.
+ * Most follow the hour before and some skip a few hours. With longGaps a few
+ * skip more than a day.
+ */
+static std::vector<hour_sample_t> randomHours(int64_t start, int n,
+                                              bool longGaps)
+{
+  std::uniform_real_distribution<float> unit(0.f, 1.f);
+  std::vector<hour_sample_t> hours(n);
+  int64_t dt = start;
+  for (hour_sample_t &s : hours)
+  {
+    float r = unit(rng);
+    dt += 3600 * (r < 0.85f                ? 1
+                : r < 0.97f || !longGaps ? 2 + rng() % 6
+                                         : 24 + rng() % 30);
+    s.dt = dt;
+    for (int p = 0; p < AQI_NUM_POLLUTANTS; ++p)
+    {
+      s.conc[p] = unit(rng) * MAX_CONC[p];
+    }
+  }
+  return hours;
+} // end randomHours
+
+/* The history the slow way: every hour in a list, missing hours copied from
+ * the one before, and the list emptied when a whole history is missing.
+ */
+class NaiveHistory
+{
+public:
+  void append(const hour_sample_t &s)
+  {
+    if (!hours.empty() && s.dt <= hours.back().dt)
+    {
+      return;
+    }
+    if (!hours.empty())
+    {
+      int64_t missing = (s.dt - hours.back().dt) / 3600 - 1;
+      if (missing >= AQI_HISTORY_HOURS)
+      {
+        hours.clear();
+      }
+      for (int64_t m = 0; m < missing && !hours.empty(); ++m)
+      {
+        hour_sample_t fill = hours.back();
+        fill.dt += 3600;
+        hours.push_back(fill);
+      }
+    }
+    hours.push_back(s);
+  }
+
+  double avg(int p, int n) const
+  {
+    if (hours.empty())
+    {
+      return 0.;
+    }
+    n = std::min<int>({n, AQI_HISTORY_HOURS, static_cast<int>(hours.size())});
+    double sum = 0.;
+    for (int i = 0; i < n; ++i)
+    {
+      sum += hours[hours.size() - 1 - i].conc[p];
+    }
+    return sum / n;
+  }
+
+private:
+  std::vector<hour_sample_t> hours;
+};
+
+/* Returns an air pollution response holding the samples, oldest first. Slots
+ * before the first sample are left empty, like a history that isn't full yet.
+ */
+static owm_resp_air_pollution_t toResponse(const hour_sample_t *s, int n)
+{
+  owm_resp_air_pollution_t r = {};
+  owm_components_t &c = r.components;
+  for (int i = 0; i < n; ++i)
+  {
+    int k = OWM_NUM_AIR_POLLUTION - n + i;
+    r.dt[k]    = s[i].dt;
+    c.co[k]    = s[i].conc[AQI_CO];
+    c.nh3[k]   = s[i].conc[AQI_NH3];
+    c.no[k]    = s[i].conc[AQI_NO];
+    c.no2[k]   = s[i].conc[AQI_NO2];
+    c.o3[k]    = s[i].conc[AQI_O3];
+    c.so2[k]   = s[i].conc[AQI_SO2];
+    c.pm10[k]  = s[i].conc[AQI_PM10];
+    c.pm2_5[k] = s[i].conc[AQI_PM2_5];
+  }
+  return r;
+} // end toResponse
+
+/* Compares every window average of h with the naive history's.
+ *
+ * Returns the number of averages that differ by more than float rounding of
+ * the sums allows.
+ */
+static int compare(const aqi_history_t &h, const NaiveHistory &naive,
+                   const char *what, double &maxErr)
+{
+  int mismatches = 0;
+  for (int p = 0; p < AQI_NUM_POLLUTANTS; ++p)
+  {
+    for (int n = 1; n <= AQI_HISTORY_HOURS + 2; ++n)
+    {
+      double want = naive.avg(p, n);
+      double got = aqiWindowAvg(h, static_cast<aqi_pollutant_t>(p), n);
+      // the sums hold up to two histories of hours before they are rebased
+      double tol = 2 * AQI_HISTORY_HOURS * MAX_CONC[p] * 1e-6 / n;
+      double err = std::fabs(got - want);
+      maxErr = std::max(maxErr, err / MAX_CONC[p]);
+      if (err > tol)
+      {
+        if (++mismatches <= 10)
+        {
+          printf("%s: pollutant %d, %d hours: %f, expected %f\n",
+                 what, p, n, got, want);
+        }
+      }
+    }
+  }
+  return mismatches;
+} // end compare
+
+int main()
+{
+  int mismatches = 0;
+  double maxErr = 0.;
+
+  // one response of up to a full history, the way the first update builds it
+  for (int round = 0; round < ROUNDS; ++round)
+  {
+    int n = 1 + rng() % OWM_NUM_AIR_POLLUTION;
+    std::vector<hour_sample_t> hours = randomHours(1700000000LL, n, true);
+    owm_resp_air_pollution_t r = toResponse(hours.data(), n);
+
+    aqi_history_t h;
+    resetAqiHistory(h);
+    updateAqiHistory(h, r);
+    NaiveHistory naive;
+    for (const hour_sample_t &s : hours)
+    {
+      naive.append(s);
+    }
+    mismatches += compare(h, naive, "response", maxErr);
+  }
+
+  // a long run without restarts, a few hours at a time, with responses
+  // overlapping the history like the fetches after waking
+  std::vector<hour_sample_t> hours = randomHours(1700000000LL,
+                                                 LONG_RUN_DAYS * 24, false);
+  aqi_history_t h;
+  resetAqiHistory(h);
+  NaiveHistory naive;
+  size_t next = 0;
+  while (next < hours.size())
+  {
+    int n = std::min<int>(1 + rng() % 6, hours.size() - next);
+    int overlap = std::min<int>(rng() % 3, next);
+    owm_resp_air_pollution_t r = toResponse(&hours[next - overlap],
+                                            n + overlap);
+    updateAqiHistory(h, r);
+    for (int i = 0; i < n; ++i)
+    {
+      naive.append(hours[next + i]);
+    }
+    next += n;
+    mismatches += compare(h, naive, "long run", maxErr);
+  }
+
+  printf("%d responses, then %u hours in a long run\n", ROUNDS, h.count);
+  printf("largest error: %.3g of the concentration range\n", maxErr);
+  printf("%d mismatches\n", mismatches);
+  return mismatches == 0 ? 0 : 1;
+} // end main
@@ -0,0 +1,250 @@
+/* Host check of the AQI breakpoint tables for esp32-weather-epd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Compares the table-driven AQI scales of aqi.c with the if/else ladders they
+ * replaced, frozen in tools/aqi_ladders.c. Each scale is given random
+ * concentrations, then each of its pollutants alone is swept across its range.
+ * Wherever a sweep sees the old index change, the float where it changes is
+ * found by bisection and every float within 3 ulps of it is checked too, so
+ * each breakpoint is hit on both sides. Build and run from MicroController:
+ *
+ *   gcc -O2 -ffunction-sections \
+ *       -c weatherApp/lib/pollutant-concentration-to-aqi/aqi.c -o aqi.o
+ *   gcc -O2 -c weatherApp/tools/aqi_ladders.c -o aqi_ladders.o
+ *   g++ -O2 -std=gnu++17 -I weatherApp/lib/pollutant-concentration-to-aqi \
+ *       weatherApp/tools/check_aqi_tables.cpp aqi.o aqi_ladders.o \
+ *       -Wl,--gc-sections -o check_aqi_tables && ./check_aqi_tables
+ *
+ * The scale descriptions in aqi.c need the locale's text, which the check
+ * doesn't use, so they are dropped at link time.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+#include <aqi.h>
+
+#define MAX_ARGS      10
+#define RANDOM_ROUNDS 250000
+#define SWEEP_STEPS   200000
+#define ULPS          3
+
+extern "C" {
+int old_china_aqi(float co_1h, float co_24h, float no2_1h, float no2_24h,
+                  float o3_1h, float o3_8h,  float so2_1h, float so2_24h,
+                  float pm10_24h, float pm2_5_24h);
+int old_european_union_caqi(float no2_1h, float o3_1h, float pm10_1h,
+                            float pm2_5_1h);
+int old_hong_kong_aqhi(float no2_3h,  float o3_3h, float so2_3h,
+                       float pm10_3h, float pm2_5_3h);
+int old_india_aqi(float co_8h,  float nh3_24h, float no2_24h,  float o3_8h,
+                  float pb_24h, float so2_24h, float pm10_24h, float pm2_5_24h);
+int old_singapore_psi(float co_8h,   float no2_1h,   float o3_1h, float o3_8h,
+                      float so2_24h, float pm10_24h, float pm2_5_24h);
+int old_south_korea_cai(float co_1h,  float no2_1h,   float o3_1h,
+                        float so2_1h, float pm10_24h, float pm2_5_24h);
+int old_united_kingdom_daqi(float no2_1h,   float o3_8h, float so2_15min,
+                            float pm10_24h, float pm2_5_24h);
+int old_united_states_aqi(float co_8h,    float no2_1h,
+                          float o3_1h,    float o3_8h,
+                          float so2_1h,   float so2_24h,
+                          float pm10_24h, float pm2_5_24h);
+}
+
+typedef int (*scale_fn_t)(const float *c);
+
+// highest concentration tried for each pollutant, in μg/m^3, past the top of
+// every scale
+#define CO    200000.f
+#define NH3     3000.f
+#define NO2     6000.f
+#define O3      3000.f
+#define PB         5.f
+#define SO2    12000.f
+#define PM10    1000.f
+#define PM2_5    800.f
+
+typedef struct scale_check
+{
+  const char *name;
+  int         num_args;
+  float       range[MAX_ARGS];
+  scale_fn_t  table;
+  scale_fn_t  ladder;
+} scale_check_t;
+
+static const scale_check_t SCALES[] = {
+  {"China AQI", 10, {CO, CO, NO2, NO2, O3, O3, SO2, SO2, PM10, PM2_5},
+   [](const float *c) {
+     return china_aqi(c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7], c[8],
+                      c[9]); },
+   [](const float *c) {
+     return old_china_aqi(c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7],
+                          c[8], c[9]); }},
+  {"European Union CAQI", 4, {NO2, O3, PM10, PM2_5},
+   [](const float *c) {
+     return european_union_caqi(c[0], c[1], c[2], c[3]); },
+   [](const float *c) {
+     return old_european_union_caqi(c[0], c[1], c[2], c[3]); }},
+  {"Hong Kong AQHI", 5, {NO2, O3, SO2, PM10, PM2_5},
+   [](const float *c) {
+     return hong_kong_aqhi(c[0], c[1], c[2], c[3], c[4]); },
+   [](const float *c) {
+     return old_hong_kong_aqhi(c[0], c[1], c[2], c[3], c[4]); }},
+  {"India AQI", 8, {CO, NH3, NO2, O3, PB, SO2, PM10, PM2_5},
+   [](const float *c) {
+     return india_aqi(c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7]); },
+   [](const float *c) {
+     return old_india_aqi(c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7]); }},
+  {"Singapore PSI", 7, {CO, NO2, O3, O3, SO2, PM10, PM2_5},
+   [](const float *c) {
+     return singapore_psi(c[0], c[1], c[2], c[3], c[4], c[5], c[6]); },
+   [](const float *c) {
+     return old_singapore_psi(c[0], c[1], c[2], c[3], c[4], c[5], c[6]); }},
+  {"South Korea CAI", 6, {CO, NO2, O3, SO2, PM10, PM2_5},
+   [](const float *c) {
+     return south_korea_cai(c[0], c[1], c[2], c[3], c[4], c[5]); },
+   [](const float *c) {
+     return old_south_korea_cai(c[0], c[1], c[2], c[3], c[4], c[5]); }},
+  {"United Kingdom DAQI", 5, {NO2, O3, SO2, PM10, PM2_5},
+   [](const float *c) {
+     return united_kingdom_daqi(c[0], c[1], c[2], c[3], c[4]); },
+   [](const float *c) {
+     return old_united_kingdom_daqi(c[0], c[1], c[2], c[3], c[4]); }},
+  {"United States AQI", 8, {CO, NO2, O3, O3, SO2, SO2, PM10, PM2_5},
+   [](const float *c) {
+     return united_states_aqi(c[0], c[1], c[2], c[3], c[4], c[5], c[6],
+                              c[7]); },
+   [](const float *c) {
+     return old_united_states_aqi(c[0], c[1], c[2], c[3], c[4], c[5], c[6],
+                                  c[7]); }},
+};
+
+static std::mt19937 rng(46);
+
+static long checked = 0;
+static long mismatches = 0;
+
+/* Compares the scale's two versions at concentrations c.
+ */
+static void check(const scale_check_t &s, const float *c, const char *what)
+{
+  int got = s.table(c);
+  int want = s.ladder(c);
+  ++checked;
+  if (got != want && ++mismatches <= 20)
+  {
+    printf("%s, %s:", s.name, what);
+    for (int i = 0; i < s.num_args; ++i)
+    {
+      printf(" %.9g", c[i]);
+    }
+    printf(": %d, expected %d\n", got, want);
+  }
+  return;
+} // end check
+
+/* Returns the float where the old index of argument arg changes between lo and
+ * hi, which have different indices. The other arguments are those of c.
+ */
+static float findEdge(const scale_check_t &s, float *c, int arg,
+                      float lo, float hi)
+{
+  c[arg] = lo;
+  const int atLo = s.ladder(c);
+  while (std::nextafter(lo, hi) < hi)
+  {
+    float mid = lo + (hi - lo) / 2;
+    if (mid <= lo || mid >= hi)
+    {
+      mid = std::nextafter(lo, hi);
+    }
+    c[arg] = mid;
+    if (s.ladder(c) == atLo)
+    {
+      lo = mid;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+  return hi;
+} // end findEdge
+
+int main()
+{
+  int edges = 0;
+  for (const scale_check_t &s : SCALES)
+  {
+    float c[MAX_ARGS];
+
+    // random concentrations, mostly low as in clean air, some anywhere up to
+    // the top of the range
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+    for (int round = 0; round < RANDOM_ROUNDS; ++round)
+    {
+      const float scale = std::pow(10.f, -static_cast<float>(round % 4));
+      for (int i = 0; i < s.num_args; ++i)
+      {
+        c[i] = unit(rng) * s.range[i] * scale;
+      }
+      check(s, c, "random");
+    }
+
+    // each pollutant alone, across its range and every breakpoint on the way
+    for (int arg = 0; arg < s.num_args; ++arg)
+    {
+      for (int i = 0; i < s.num_args; ++i)
+      {
+        c[i] = 0.f;
+      }
+      float prev = 0.f;
+      int prevIndex = s.ladder(c);
+      for (int k = 0; k <= SWEEP_STEPS; ++k)
+      {
+        const float x = s.range[arg] * k / SWEEP_STEPS;
+        c[arg] = x;
+        check(s, c, "sweep");
+        const int index = s.ladder(c);
+        if (k > 0 && index != prevIndex)
+        {
+          float edge = findEdge(s, c, arg, prev, x);
+          ++edges;
+          for (int u = 0; u < ULPS; ++u)
+          {
+            edge = std::nextafter(edge, 0.f);
+          }
+          for (int u = 0; u <= 2 * ULPS; ++u)
+          {
+            c[arg] = edge;
+            check(s, c, "edge");
+            edge = std::nextafter(edge, INFINITY);
+          }
+          c[arg] = x;
+        }
+        prev = x;
+        prevIndex = index;
+      }
+    }
+  }
+
+  printf("%ld concentration sets checked, %d index changes found and checked "
+         "to +-%d ulps\n", checked, edges, ULPS);
+  printf("%ld mismatches\n", mismatches);
+  return mismatches == 0 ? 0 : 1;
+} // end main
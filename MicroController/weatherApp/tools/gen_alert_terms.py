@@ -0,0 +1,212 @@
+"""Alert terminology automaton generator for esp32-weather-epd.
+
+Compiles the ALERT_URGENCY and TERM_* keyword lists of the locale selected by
+LOCALE in config.h into one Aho-Corasick automaton, so an alert's event name
+is classified by category and urgency in a single pass over its text, instead
+of one strstr per keyword.
+
+Generates weatherApp/lib/generated-assets/alert_automaton.h, read by
+getAlertCategory and eventUrgency in display_utils.cpp. Each state of the
+automaton has the keywords that end there, or at any state its failure links
+lead to, as bit masks:
+  ALERT_AC_CATEGORIES  bit n for the TERM_* list of alert_category n, e.g.
+                       TERM_FOG for FOG
+  ALERT_AC_URGENCY     bit n for ALERT_URGENCY[n]
+
+Runs before each build of the weatherApp environment, see platformio.ini, and
+can be run by hand:
+    python3 weatherApp/tools/gen_alert_terms.py
+"""
+
+import os
+import re
+from collections import deque
+
+BANNER = '// DO NOT MODIFY -- THIS FILE WAS GENERATED BY ' \
+         '`python3 weatherApp/tools/gen_alert_terms.py`\n\n'
+
+MAX_URGENCY_LEVELS = 16
+
+
+def strip_comments(text):
+    """Removes // and /* */ comments, leaving string literals alone."""
+    return re.sub(r'"(?:\\.|[^"\\])*"|//[^\n]*|/\*.*?\*/',
+                  lambda m: m[0] if m[0].startswith('"') else ' ',
+                  text, flags=re.S)
+
+
+def c_string(literal):
+    """Returns the bytes of the body of a C string literal."""
+    out = bytearray()
+    raw = literal.encode('utf-8')
+    i = 0
+    while i < len(raw):
+        c = raw[i]
+        if c != ord('\\'):
+            out.append(c)
+            i += 1
+            continue
+        e = chr(raw[i + 1])
+        if e == 'x':
+            m = re.match(rb'[0-9a-fA-F]+', raw[i + 2:])
+            out.append(int(m[0], 16) & 0xFF)
+            i += 2 + len(m[0])
+        elif e in '01234567':
+            m = re.match(rb'[0-7]{1,3}', raw[i + 1:])
+            out.append(int(m[0], 8) & 0xFF)
+            i += 1 + len(m[0])
+        else:
+            out += {'n': b'\n', 't': b'\t', 'r': b'\r'}.get(e, e.encode())
+            i += 2
+    return bytes(out)
+
+
+def read_lists(locale_path):
+    """Returns every `constexpr const char *NAME[] = {...};` in the locale, as
+    lists of bytes, by name.
+    """
+    with open(locale_path, encoding='utf-8') as f:
+        text = strip_comments(f.read())
+    lists = {}
+    for name, body in re.findall(
+            r'constexpr\s+const\s+char\s*\*\s*(\w+)\s*\[\s*\]\s*=\s*'
+            r'\{(.*?)\}\s*;',
+            text, flags=re.S):
+        lists[name] = [c_string(s)
+                       for s in re.findall(r'"((?:\\.|[^"\\])*)"', body)]
+    return lists
+
+
+def read_categories(display_utils_h):
+    """Returns the alert_category names, in the order of their values."""
+    with open(display_utils_h) as f:
+        body = re.search(r'enum\s+alert_category\s*\{(.*?)\}', f.read(),
+                         flags=re.S)[1]
+    names = [n.strip().split('=')[0].strip() for n in body.split(',')]
+    return [n for n in names if n and n != 'NOT_FOUND']
+
+
+def build(patterns):
+    """Builds the automaton. patterns is a list of (bytes, category mask,
+    urgency mask). Returns, for each state, its transitions as a sorted list of
+    (byte, state), its failure link, and its masks.
+    """
+    goto = [{}]
+    categories = [0]
+    urgency = [0]
+    for pattern, cat, urg in patterns:
+        s = 0
+        for b in pattern:
+            if b not in goto[s]:
+                goto.append({})
+                categories.append(0)
+                urgency.append(0)
+                goto[s][b] = len(goto) - 1
+            s = goto[s][b]
+        categories[s] |= cat
+        urgency[s] |= urg
+
+    fail = [0] * len(goto)
+    queue = deque(goto[0].values())
+    while queue:
+        s = queue.popleft()
+        for b, t in goto[s].items():
+            f = fail[s]
+            while f and b not in goto[f]:
+                f = fail[f]
+            fail[t] = goto[f].get(b, 0) if goto[f].get(b, 0) != t else 0
+            categories[t] |= categories[fail[t]]
+            urgency[t] |= urgency[fail[t]]
+            queue.append(t)
+    return [sorted(g.items()) for g in goto], fail, categories, urgency
+
+
+def c_array(ctype, name, values, per_line=12):
+    lines = [f'constexpr {ctype} {name}[{len(values)}] = {{\n']
+    for i in range(0, len(values), per_line):
+        lines.append('  ' + ', '.join(str(v) for v in values[i:i + per_line])
+                     + ',\n')
+    lines.append('};\n')
+    return ''.join(lines)
+
+
+def generate(locale_name, lists, category_names):
+    patterns = []
+    for n, name in enumerate(category_names):
+        for term in lists.get('TERM_' + name, []):
+            patterns.append((term, 1 << n, 0))
+    levels = lists.get('ALERT_URGENCY', [])
+    if len(levels) > MAX_URGENCY_LEVELS:
+        raise SystemExit('gen_alert_terms: more than '
+                         f'{MAX_URGENCY_LEVELS} ALERT_URGENCY levels')
+    for n, keyword in enumerate(levels):
+        patterns.append((keyword, 0, 1 << n))
+
+    goto, fail, categories, urgency = build(patterns)
+    first = [0]
+    for edges in goto:
+        first.append(first[-1] + len(edges))
+    edge_bytes = [b for edges in goto for b, _ in edges]
+    edge_next = [t for edges in goto for _, t in edges]
+    state_type = 'uint8_t' if len(goto) <= 256 else 'uint16_t'
+
+    h = [BANNER, '#ifndef __ALERT_AUTOMATON_H__\n#define __ALERT_AUTOMATON_H__\n\n',
+         '#include <cstdint>\n\n',
+         f'// Aho-Corasick automaton of the alert keywords of locale_{locale_name}.inc,\n',
+         f'// {len(patterns)} keywords in {len(goto)} states.\n\n',
+         f'typedef {state_type} alert_ac_state_t;\n\n',
+         '// the transitions of state s are edges ALERT_AC_FIRST[s] up to\n',
+         '// ALERT_AC_FIRST[s + 1], sorted by byte\n',
+         c_array('uint16_t', 'ALERT_AC_FIRST', first),
+         c_array('uint8_t', 'ALERT_AC_BYTE', edge_bytes),
+         c_array('alert_ac_state_t', 'ALERT_AC_NEXT', edge_next),
+         '// where to continue from when state s has no transition for a byte\n',
+         c_array('alert_ac_state_t', 'ALERT_AC_FAIL', fail),
+         '// keywords found on reaching state s\n',
+         c_array('uint32_t', 'ALERT_AC_CATEGORIES', categories, 6),
+         c_array('uint16_t', 'ALERT_AC_URGENCY', urgency),
+         '\n#endif\n']
+    return ''.join(h)
+
+
+def write_if_changed(path, text):
+    # leave unchanged files alone, so they are not rebuilt
+    if os.path.isfile(path):
+        with open(path) as f:
+            if f.read() == text:
+                return
+    with open(path, 'w') as f:
+        f.write(text)
+
+
+def main(project_dir):
+    app_dir = os.path.join(project_dir, 'weatherApp')
+    include_dir = os.path.join(app_dir, 'include')
+    with open(os.path.join(include_dir, 'config.h'), encoding='utf-8') as f:
+        m = re.search(r'^\s*#define\s+LOCALE\s+(\w+)', f.read(), re.M)
+    if not m:
+        raise SystemExit('gen_alert_terms: LOCALE not found in config.h')
+    locale_name = m[1]
+
+    lists = read_lists(os.path.join(include_dir, 'locales',
+                                    f'locale_{locale_name}.inc'))
+    category_names = read_categories(os.path.join(include_dir,
+                                                  'display_utils.h'))
+    if len(category_names) > 32:
+        raise SystemExit('gen_alert_terms: more than 32 alert categories')
+
+    out_dir = os.path.join(app_dir, 'lib', 'generated-assets')
+    os.makedirs(out_dir, exist_ok=True)
+    write_if_changed(os.path.join(out_dir, 'alert_automaton.h'),
+                     generate(locale_name, lists, category_names))
+
+
+try:
+    Import('env')  # noqa: F821, defined when run by PlatformIO
+except NameError:
+    env = None
+
+if env is not None:
+    main(env.subst('$PROJECT_DIR'))
+elif __name__ == '__main__':
+    main(os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..'))
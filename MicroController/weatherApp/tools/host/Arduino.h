@@ -0,0 +1,64 @@
+/* Host stand-in for the parts of the Arduino core used by the tools.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Lets firmware sources that only need Stream, String and Serial build on the
+ * host. Put this directory first on the include path. ARDUINO is left
+ * undefined, so ArduinoJson doesn't try to use these classes itself.
+ */
+
+#ifndef __HOST_ARDUINO_H__
+#define __HOST_ARDUINO_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#define PROGMEM
+
+class String : public std::string
+{
+public:
+  String() {}
+  String(const char *s) : std::string(s ? s : "") {}
+  String(const std::string &s) : std::string(s) {}
+};
+
+class Stream
+{
+public:
+  virtual ~Stream() {}
+  virtual int    available() = 0;
+  virtual size_t readBytes(char *buffer, size_t length) = 0;
+};
+
+class HardwareSerial
+{
+public:
+  size_t write(const char *buffer, size_t size)
+  {
+    return fwrite(buffer, 1, size, stdout);
+  }
+  void println(const String &s)
+  {
+    puts(s.c_str());
+  }
+};
+
+inline HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,27 @@
+/* Host stand-in for WiFi.h, see Arduino.h in this directory.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __HOST_WIFI_H__
+#define __HOST_WIFI_H__
+
+#include "Arduino.h"
+
+// a tool supplies the bytes by deriving from this
+class WiFiClient : public Stream
+{
+};
+
+#endif
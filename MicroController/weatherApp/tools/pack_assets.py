@@ -0,0 +1,283 @@
+"""Asset packer for esp32-weather-epd.
+
+Compiles only the icons and fonts the weather app uses, so which assets end up
+in flash does not depend on the compiler's dead-stripping, and prints how much
+of each class of asset the build holds.
+
+Generates, in weatherApp/lib/generated-assets:
+  icon_atlas.h, icon_atlas.cpp
+    The icons the weather app uses, packed into one compressed atlas, so big
+    icons are read from flash in a fraction of the bytes. The packed format is
+    read by icon_decode.cpp. The header declares every packed icon under its
+    usual name, e.g. wi_day_sunny_48x48, and the getBitmap(icon_name_t, size)
+    lookup, so code written against icons/icons.h works unchanged, except
+    icons are drawn with drawIcon instead of drawInvertedBitmap.
+  font_subset.h
+    The sizes of the font family selected by FONT_HEADER in config.h that the
+    weather app uses, with their FONT_* names.
+  asset_manifest.txt
+    Every asset in the build and its size in bytes.
+
+An icon is packed if the weather app's sources name it directly, e.g.
+wi_refresh_32x32, or pass it to getBitmap. getBitmap calls with a size that is
+not a number are taken to be inside a template, and get every size that
+template is instantiated with, e.g. getConditionsBitmap<64>. A font size is
+kept if the sources name it, e.g. FONT_12pt8b.
+
+Runs before each build of the weatherApp environment, see platformio.ini, and
+can be run by hand:
+    python3 weatherApp/tools/pack_assets.py
+"""
+
+import glob
+import os
+import re
+
+ENCODING_RAW = 0
+ENCODING_RLE = 1
+
+
+def load_icon(path):
+    """Returns width, height and bytes of an icon header from the assets."""
+    with open(path) as f:
+        text = f.read()
+    size = re.search(r'//\s*(\d+)\s*x\s*(\d+)', text)
+    body = text[text.index('{') + 1:text.rindex('}')]
+    data = [int(x, 16) for x in re.findall(r'0x[0-9a-fA-F]{1,2}', body)]
+    return int(size[1]), int(size[2]), data
+
+
+def encode_runs(width, height, data):
+    """Run-length encodes the pixels, row after row.
+
+    Runs alternate between background (bit set) and ink (bit clear), starting
+    with background, so a run may be 0 long. Each run is a sequence of 255s
+    and a final byte below 255, adding up to its length.
+    """
+    row_bytes = (width + 7) // 8
+    runs = []
+    ink = False
+    length = 0
+    for y in range(height):
+        for x in range(width):
+            pixel_ink = not ((data[y * row_bytes + x // 8] >> (7 - x % 8)) & 1)
+            if pixel_ink == ink:
+                length += 1
+            else:
+                runs.append(length)
+                ink = pixel_ink
+                length = 1
+    runs.append(length)
+
+    out = bytearray()
+    for run in runs:
+        while run >= 255:
+            out.append(255)
+            run -= 255
+        out.append(run)
+    return out
+
+
+def pack_icon(width, height, data):
+    """Returns the packed icon: width, height, encoding, then the pixels,
+    run-length encoded unless that would be larger than the bitmap itself.
+    """
+    rle = encode_runs(width, height, data)
+    if len(rle) < len(data):
+        return bytes([width, height, ENCODING_RLE]) + bytes(rle)
+    return bytes([width, height, ENCODING_RAW]) + bytes(data)
+
+
+BANNER = '// DO NOT MODIFY -- THIS FILE WAS GENERATED BY ' \
+         '`python3 weatherApp/tools/pack_assets.py`\n\n'
+
+
+def read_sources(source_dirs):
+    """Returns the text of every source and header, by path."""
+    sources = {}
+    for d in source_dirs:
+        for path in sorted(glob.glob(os.path.join(d, '*.cpp'))
+                           + glob.glob(os.path.join(d, '*.h'))):
+            with open(path, encoding='utf-8', errors='replace') as f:
+                sources[path] = f.read()
+    return sources
+
+
+def find_icons(icons_dir, sources):
+    """Returns the (name, size) of every icon the sources use, and the names
+    passed to getBitmap.
+    """
+    def exists(name, size):
+        return os.path.isfile(os.path.join(
+            icons_dir, f'{size}x{size}', f'{name}_{size}x{size}.h'))
+
+    used = set()
+    lookups = set()
+    for text in sources.values():
+        for name, w, h in re.findall(r'\b([a-z][a-z0-9_]*)_(\d+)x(\d+)\b',
+                                     text):
+            if w == h and exists(name, int(w)):
+                used.add((name, int(w)))
+
+        template_sizes = {int(s) for s in re.findall(r'\w+Bitmap<(\d+)>',
+                                                     text)}
+        for name, size in re.findall(r'\bgetBitmap\(\s*(\w+)\s*,\s*(\w+)\s*\)',
+                                     text):
+            lookups.add(name)
+            sizes = [int(size)] if size.isdigit() else template_sizes
+            for s in sizes:
+                if exists(name, s):
+                    used.add((name, s))
+    return sorted(used, key=lambda icon: (icon[1], icon[0])), sorted(lookups)
+
+
+def pack_atlas(icons_dir, icons, lookups):
+    """Returns the text of icon_atlas.h and icon_atlas.cpp, and the packed size
+    of each icon.
+    """
+    atlas = bytearray()
+    offsets = {}
+    sizes = {}
+    for name, size in icons:
+        w, h, data = load_icon(os.path.join(
+            icons_dir, f'{size}x{size}', f'{name}_{size}x{size}.h'))
+        offsets[(name, size)] = len(atlas)
+        packed = pack_icon(w, h, data)
+        sizes[f'{name}_{size}x{size}'] = (len(packed), len(data))
+        atlas += packed
+
+    h = [BANNER, '#ifndef __ICON_ATLAS_H__\n#define __ICON_ATLAS_H__\n\n',
+         '#include <cstddef>\n#include <cstdint>\n\n',
+         f'#define ICON_ATLAS_SIZE {len(atlas)}\n\n',
+         '// packed icons, read with beginIcon and nextIconSpan\n',
+         'extern const uint8_t icon_atlas[ICON_ATLAS_SIZE];\n\n']
+    for name, size in icons:
+        h.append(f'constexpr const uint8_t *{name}_{size}x{size} = '
+                 f'&icon_atlas[{offsets[(name, size)]}];\n')
+
+    h.append('\ntypedef enum icon_name {\n')
+    h += [f'  {name},\n' for name in lookups]
+    h.append('} icon_name_t;\n\n')
+    h.append('constexpr const uint8_t *getBitmap(icon_name_t icon, '
+             'size_t size)\n{\n  switch (icon) {\n')
+    for name in lookups:
+        h.append(f'  case {name}:\n    switch (size) {{\n')
+        for n, size in icons:
+            if n == name:
+                h.append(f'    case {size}: return {name}_{size}x{size};\n')
+        h.append('    default:\n      return nullptr;\n    }\n')
+    h.append('  default:\n    return nullptr;\n  }\n}\n\n#endif\n')
+
+    c = [BANNER, '#include <Arduino.h>\n#include "icon_atlas.h"\n\n',
+         'const uint8_t icon_atlas[ICON_ATLAS_SIZE] PROGMEM = {\n']
+    for i in range(0, len(atlas), 12):
+        c.append('  ' + ', '.join(f'0x{b:02x}' for b in atlas[i:i + 12])
+                 + ',\n')
+    c.append('};\n')
+    return ''.join(h), ''.join(c), sizes
+
+
+def find_font_family(config_path):
+    """Returns the header named by FONT_HEADER in config.h, e.g. FreeSans.h."""
+    with open(config_path, encoding='utf-8', errors='replace') as f:
+        m = re.search(r'^\s*#define\s+FONT_HEADER\s+"fonts/([^"]+)"', f.read(),
+                      re.M)
+    if not m:
+        raise SystemExit('pack_assets: FONT_HEADER not found in ' + config_path)
+    return m[1]
+
+
+def subset_fonts(fonts_dir, family_header, sources):
+    """Returns the text of font_subset.h, and the size of each font kept, and
+    of every font in the family.
+    """
+    with open(os.path.join(fonts_dir, family_header)) as f:
+        family = f.read()
+    includes = re.findall(r'#include\s+"([^"]+)"', family)
+    defines = re.findall(r'#define\s+(FONT_\w+)\s+(\w+)', family)
+
+    used = set()
+    for text in sources.values():
+        used.update(re.findall(r'\b(FONT_\w+pt8b\w*)\b', text))
+
+    def approx_size(include):
+        with open(os.path.join(fonts_dir, include), encoding='latin-1') as f:
+            m = re.search(r'Approx\.\s*(\d+)\s*bytes', f.read())
+        return int(m[1]) if m else 0
+
+    kept = {}
+    every = {}
+    h = [BANNER, '#ifndef __FONT_SUBSET_H__\n#define __FONT_SUBSET_H__\n\n',
+         f'// the sizes of fonts/{family_header} the weather app uses\n']
+    lines = []
+    for macro, font in defines:
+        include = next((i for i in includes
+                        if os.path.basename(i) == f'{font}.h'), None)
+        if include is None:
+            continue
+        every[font] = approx_size(include)
+        if macro in used:
+            kept[font] = every[font]
+            h.append(f'#include "fonts/{include}"\n')
+            lines.append(f'#define {macro} {font}\n')
+    h += ['\n'] + lines + ['\n#endif\n']
+    return ''.join(h), kept, every
+
+
+def write_if_changed(path, text):
+    # leave unchanged files alone, so they are not rebuilt
+    if os.path.isfile(path):
+        with open(path) as f:
+            if f.read() == text:
+                return
+    with open(path, 'w') as f:
+        f.write(text)
+
+
+def main(project_dir):
+    app_dir = os.path.join(project_dir, 'weatherApp')
+    assets_dir = os.path.join(app_dir, 'lib', 'esp32-weather-epd-assets')
+    icons_dir = os.path.join(assets_dir, 'icons')
+    fonts_dir = os.path.join(assets_dir, 'fonts')
+    out_dir = os.path.join(app_dir, 'lib', 'generated-assets')
+    sources = read_sources([os.path.join(app_dir, 'src'),
+                            os.path.join(app_dir, 'include')])
+
+    icons, lookups = find_icons(icons_dir, sources)
+    atlas_h, atlas_cpp, icon_sizes = pack_atlas(icons_dir, icons, lookups)
+    num_icons = len(glob.glob(os.path.join(icons_dir, '*x*', '*.h')))
+
+    family = find_font_family(os.path.join(app_dir, 'include', 'config.h'))
+    fonts_h, font_sizes, family_sizes = subset_fonts(fonts_dir, family, sources)
+
+    manifest = ['# assets compiled into the weather app, and their size in '
+                'bytes\n']
+    manifest += [f'icon {name} {packed}\n'
+                 for name, (packed, _) in icon_sizes.items()]
+    manifest += [f'font {name} {size}\n' for name, size in font_sizes.items()]
+
+    os.makedirs(out_dir, exist_ok=True)
+    write_if_changed(os.path.join(out_dir, 'icon_atlas.h'), atlas_h)
+    write_if_changed(os.path.join(out_dir, 'icon_atlas.cpp'), atlas_cpp)
+    write_if_changed(os.path.join(out_dir, 'font_subset.h'), fonts_h)
+    write_if_changed(os.path.join(out_dir, 'asset_manifest.txt'),
+                     ''.join(manifest))
+
+    packed = sum(p for p, _ in icon_sizes.values())
+    raw = sum(r for _, r in icon_sizes.values())
+    print(f'assets: icons {len(icon_sizes):5} of {num_icons:5}  '
+          f'{packed:7} bytes packed, {raw} as bitmaps')
+    print(f'assets: fonts {len(font_sizes):5} of {len(family_sizes):5}  '
+          f'{sum(font_sizes.values()):7} bytes, '
+          f'{sum(family_sizes.values())} for all of {family}')
+
+
+try:
+    Import('env')  # noqa: F821, defined when run by PlatformIO
+except NameError:
+    env = None
+
+if env is not None:
+    main(env.subst('$PROJECT_DIR'))
+elif __name__ == '__main__':
+    main(os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..'))
@@ -0,0 +1,84 @@
+"""API payload recorder for esp32-weather-epd.
+
+Fetches the One Call and air pollution history responses with the queries
+getOWMonecall and getOWMairpollution send, and writes them to a directory as
+onecall.json and air_pollution.json for tools/check_api_response.cpp.
+
+The payloads are anonymized on the raw text, so every number keeps the exact
+digits the API sent:
+  - lat and lon are rounded to whole degrees
+  - alert sender names and descriptions, which name the area, are replaced
+Everything the firmware parses is left as it was.
+
+Run from MicroController, with the API key, location and language from
+config.cpp:
+    python3 weatherApp/tools/record_payload.py API_KEY LAT LON DIR [LANG]
+"""
+
+import json
+import os
+import re
+import sys
+import time
+import urllib.request
+
+OWM_ENDPOINT = 'https://api.openweathermap.org'
+OWM_ONECALL_VERSION = '3.0'
+OWM_NUM_AIR_POLLUTION = 24
+
+STRING = r'"(?:\\.|[^"\\])*"'
+
+
+def fetch(uri):
+    """Returns the body of a GET request, as text."""
+    with urllib.request.urlopen(OWM_ENDPOINT + uri, timeout=30) as response:
+        return response.read().decode('utf-8')
+
+
+def round_coordinates(text):
+    """Rounds every lat and lon to whole degrees."""
+    return re.sub(r'"(lat|lon)"\s*:\s*(-?[0-9.]+)',
+                  lambda m: '"%s":%d' % (m[1], round(float(m[2]))), text)
+
+
+def anonymize_alerts(text):
+    """Replaces the sender and description of each alert."""
+    alerts = text.find('"alerts"')
+    if alerts < 0:
+        return text
+    tail = re.sub(r'"sender_name"\s*:\s*' + STRING,
+                  '"sender_name":"Weather service"', text[alerts:])
+    tail = re.sub(r'"description"\s*:\s*' + STRING,
+                  '"description":"Description removed."', tail)
+    return text[:alerts] + tail
+
+
+def save(directory, name, text):
+    json.loads(text)  # fails here rather than in the check
+    with open(os.path.join(directory, name), 'w', encoding='utf-8') as f:
+        f.write(text)
+    print('wrote %s, %d bytes' % (name, len(text.encode('utf-8'))))
+
+
+def main():
+    if len(sys.argv) not in (5, 6):
+        sys.exit(__doc__)
+    key, lat, lon, directory = sys.argv[1:5]
+    lang = sys.argv[5] if len(sys.argv) == 6 else 'en'
+    os.makedirs(directory, exist_ok=True)
+
+    onecall = fetch('/data/%s/onecall?lat=%s&lon=%s&lang=%s'
+                    '&units=standard&exclude=minutely&appid=%s'
+                    % (OWM_ONECALL_VERSION, lat, lon, lang, key))
+    save(directory, 'onecall.json',
+         anonymize_alerts(round_coordinates(onecall)))
+
+    end = int(time.time())
+    start = end - (3600 * OWM_NUM_AIR_POLLUTION - 1)
+    air = fetch('/data/2.5/air_pollution/history?lat=%s&lon=%s'
+                '&start=%d&end=%d&appid=%s' % (lat, lon, start, end, key))
+    save(directory, 'air_pollution.json', round_coordinates(air))
+
+
+if __name__ == '__main__':
+    main()